@@ -41,10 +41,10 @@ void Application::Init(int width, int height, HINSTANCE instance, const char* ti
 	Instance = new Application(width, height, instance, title);
 }
 
-void Application::InitGraphics()
+void Application::InitGraphics(const GraphicsOptions& options)
 {
 	ASSERT(!Instance->GraphicsInterface, "Graphics interface already initialized");
-	Instance->GraphicsInterface = MakeUnique<Graphics>(*Instance->MainWindow);
+	Instance->GraphicsInterface = MakeUnique<Graphics>(*Instance->MainWindow, options);
 }
 
 void Application::Shutdown()
@@ -173,13 +173,12 @@ void Camera::Tick(float delta)
 {
 	auto& input = Application::GetApp().GetWindow()->Input;
 
-	static bool startup = true;
-	if (startup)
+	if (FollowingPath)
 	{
 		LoadStateFromFile("cameraPath.txt", Position, Rotation, delta);
 		UpdateViewMatrix();
 		if (!Application::GetApp().GetWindow()->IsCursorVisible())
-			startup = false;
+			FollowingPath = false;
 	}
 
 	glm::vec3 cameraPosition{ 0.0f };
@@ -16,6 +16,8 @@ public:
 	inline const glm::mat4x4& GetProjection() const { return Projection; }
 	inline const glm::mat4x4& GetView() const { return View; }
 	inline const glm::mat4x4& GetViewProjection() const { return ViewProjection; }
+	// True while the camera replays Content/cameraPath.txt, until the cursor is captured
+	inline bool IsFollowingPath() const { return FollowingPath; }
 
 	void Tick(float delta);
 
@@ -37,4 +39,5 @@ private:
 	glm::vec3 Rotation = { 0.0f, 0.0f, 0.0f };
 
 	float TranslationSpeed = 20.0f, RotationSpeed = 0.05f;
+	bool FollowingPath = true;
 };
\ No newline at end of file
@@ -21,6 +21,7 @@
 #include <d3d12.h>
 #include <d3dx12.h>
 #include <d3dcompiler.h>
+#include <d3d12shader.h>
 #include <comdef.h>
 #include <dxgi1_6.h>
 #include <dxgiformat.h>
@@ -34,6 +35,8 @@
 #include <string>
 #include <vector>
 
+#include "Core/Memory.h"
+
 #include <imgui.h>
 #include <backends\imgui_impl_dx12.h>
 #include <backends\imgui_impl_win32.h>
@@ -41,11 +44,6 @@
 static constexpr const uint32_t DefaultSwapChainBuffers = 3;
 static constexpr const float aspectRatio = 16.0f / 9.0f;
 
-// Globals
-constexpr const uint32_t NumUserDescriptorRanges = 16;
-constexpr const uint32_t NumGlobalSRVDescriptorRanges = 7 + NumUserDescriptorRanges;
-constexpr const uint32_t NumGlobalCBVDescriptorRanges = 7;
-
 #define MAKE_SMART_COM_PTR(_a) _COM_SMARTPTR_TYPEDEF(_a, __uuidof(_a))
 MAKE_SMART_COM_PTR(ID3D12Device5);
 MAKE_SMART_COM_PTR(ID3D12GraphicsCommandList4);
@@ -56,37 +54,19 @@ MAKE_SMART_COM_PTR(IDXGIAdapter1);
 MAKE_SMART_COM_PTR(ID3D12Fence);
 MAKE_SMART_COM_PTR(ID3D12CommandAllocator);
 MAKE_SMART_COM_PTR(ID3D12Resource);
+MAKE_SMART_COM_PTR(ID3D12Heap);
 MAKE_SMART_COM_PTR(ID3D12DescriptorHeap);
 MAKE_SMART_COM_PTR(ID3D12Debug);
 MAKE_SMART_COM_PTR(ID3D12StateObject);
 MAKE_SMART_COM_PTR(ID3D12PipelineState);
+MAKE_SMART_COM_PTR(ID3D12PipelineLibrary);
 MAKE_SMART_COM_PTR(ID3D12RootSignature);
 MAKE_SMART_COM_PTR(ID3DBlob);
 MAKE_SMART_COM_PTR(IDxcBlobEncoding);
-
-template<typename T>
-using UniquePtr = std::unique_ptr<T>;
-template<typename T, typename ... Args>
-constexpr UniquePtr<T> MakeUnique(Args&& ... args)
-{
-	return std::make_unique<T>(std::forward<Args>(args)...);
-}
-
-template<typename T>
-using UniquePtrCustomDeleter = std::unique_ptr<T, std::function<void(T*)>>;
-
-template<typename T>
-using SharedPtr = std::shared_ptr<T>;
-template<typename T, typename ... Args>
-constexpr SharedPtr<T> MakeShared(Args&& ... args)
-{
-	return std::make_shared<T>(std::forward<Args>(args)...);
-}
-
-template<typename T>
-using WeakPtr = std::weak_ptr<T>;
-template<typename T, typename ... Args>
-constexpr WeakPtr<T> MakeWeak(Args&& ... args)
-{
-	return std::weak_ptr<T>(std::forward<Args>(args)...);
-}
\ No newline at end of file
+MAKE_SMART_COM_PTR(IDxcBlob);
+MAKE_SMART_COM_PTR(IDxcLibrary);
+MAKE_SMART_COM_PTR(IDxcCompiler);
+MAKE_SMART_COM_PTR(IDxcOperationResult);
+MAKE_SMART_COM_PTR(IDxcIncludeHandler);
+MAKE_SMART_COM_PTR(IDxcContainerReflection);
+MAKE_SMART_COM_PTR(ID3D12ShaderReflection);
@@ -136,8 +136,9 @@ private:
 
 
 //#ifndef NDEBUG
+// A single statement, safe under an unbraced if/else. Needs its semicolon
 #define ASSERT(condition, msg)\
-if(!condition) throw EXCEPTION(msg);
+do { if (!(condition)) throw EXCEPTION(msg); } while (false)
 
 #define GRAPHICS_ASSERT(hrcall)\
 {	DXGIInfoManager InfoManager;\
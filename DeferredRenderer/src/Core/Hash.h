@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// FNV-1a, equal in every run - for keys written to disk and content hashes. Structs are hashed member
+// by member, never as raw bytes, padding and pointers would make equal values hash differently
+class Hasher
+{
+public:
+	void Add(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			Hash ^= bytes[i];
+			Hash *= 1099511628211ull;
+		}
+	}
+
+	template<typename T>
+		requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+	void Add(T value) { Add(&value, sizeof(T)); }
+
+	void Add(const char* string)
+	{
+		// Length first, so "ab" + "c" and "a" + "bc" differ
+		size_t length = string ? std::strlen(string) : 0;
+		Add(length);
+		Add(string, length);
+	}
+
+	inline uint64_t Get() const { return Hash; }
+
+private:
+	uint64_t Hash = 14695981039346656037ull;
+};
@@ -1,16 +1,13 @@
 #include "Application.h"
 #include "Core/Exception.h"
 #include "Layer.h"
+#include "Rendering/Resources.h"
 #include "Rendering/Utils.h"
 
 static bool showDemoWindow = false;
 
 void ImGui_ImplWin32_InitPlatformInterface();
 
-ImGuiLayer::ImGuiLayer(ID3D12DescriptorHeapPtr descHeap)
-	:DescriptorHeap(descHeap)
-{}
-
 void ImGuiLayer::OnAttach(ID3D12Device5Ptr device)
 {
 	IMGUI_CHECKVERSION();
@@ -22,28 +19,15 @@ void ImGuiLayer::OnAttach(ID3D12Device5Ptr device)
 
 	ImGui::StyleColorsDark();
 
-	D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
-	heapDesc.NumDescriptors = 1 + ((DescriptorHeap) ? DescriptorHeap->GetDesc().NumDescriptors : 0);
-	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-
-	auto temp = DescriptorHeap.Detach();
-	GRAPHICS_ASSERT(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&DescriptorHeap)));
-
-	auto handle = DescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-	auto tempHandle = temp->GetCPUDescriptorHandleForHeapStart();
-	handle.ptr += device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-
-	if(temp)
-		device->CopyDescriptorsSimple(temp->GetDesc().NumDescriptors, handle, tempHandle, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	FontTable = Globals.Descriptors->Allocate(1);
 
 	ImGui_ImplWin32_Init(Application::GetApp().GetWindow()->GetHandle());
 	ImGui_ImplDX12_Init(device, 
 						DefaultSwapChainBuffers, 
 						DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
-						DescriptorHeap,
-						DescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
-						DescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+						Globals.Descriptors->GetResourceHeap(),
+						FontTable.GetCPUHandle(),
+						FontTable.GetGPUHandle());
 }
 
 void ImGuiLayer::OnDetach()
@@ -51,6 +35,7 @@ void ImGuiLayer::OnDetach()
 	ImGui_ImplDX12_Shutdown();
 	ImGui_ImplWin32_Shutdown();
 	ImGui::DestroyContext();
+	Globals.Descriptors->Free(FontTable);
 }
 
 void ImGuiLayer::OnEvent(Event& e)
@@ -67,7 +52,7 @@ void ImGuiLayer::Begin()
 	ImGui::NewFrame();
 }
 
-void ImGuiLayer::End(ID3D12GraphicsCommandList4Ptr cmdList)
+void ImGuiLayer::End(CommandContext& cmdList)
 {
 	ImGuiIO& io = ImGui::GetIO();
 	Application& app = Application::GetApp();
@@ -78,10 +63,9 @@ void ImGuiLayer::End(ID3D12GraphicsCommandList4Ptr cmdList)
 
 	ImGui::Render();
 
-	ID3D12DescriptorHeap* descriptorHeaps[] = { DescriptorHeap.GetInterfacePtr() };
-	cmdList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-
-	ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), cmdList);
+	ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), cmdList.Get());
+	// ImGui sets its own pipeline, root signature and heaps
+	cmdList.Invalidate();
 
 	if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
 	{
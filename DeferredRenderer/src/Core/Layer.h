@@ -1,12 +1,13 @@
 #pragma once
 #include "Core.h"
 #include "Events\Event.h"
+#include "Rendering/DescriptorHeaps.h"
 
 struct Graphics;
 
 struct ImGuiLayer
 {
-	ImGuiLayer(ID3D12DescriptorHeapPtr descHeap = nullptr);
+	ImGuiLayer() = default;
 	~ImGuiLayer() = default;
 
 	void OnAttach(ID3D12Device5Ptr device);
@@ -14,7 +15,8 @@ struct ImGuiLayer
 	void OnEvent(Event& e);
 
 	void Begin();
-	void End(ID3D12GraphicsCommandList4Ptr cmdList);
+	void End(CommandContext& cmdList);
 
-	ID3D12DescriptorHeapPtr DescriptorHeap;
+	// Font texture SRV - lives in the global heap the render graph already set on the list
+	DescriptorTable FontTable;
 };
@@ -0,0 +1,33 @@
+#pragma once
+#include <functional>
+#include <memory>
+
+// Smart pointer aliases of the renderer - without the Windows and D3D12 headers of Core.h, so modules
+// that do not touch the device can be built on any platform
+
+template<typename T>
+using UniquePtr = std::unique_ptr<T>;
+template<typename T, typename ... Args>
+constexpr UniquePtr<T> MakeUnique(Args&& ... args)
+{
+	return std::make_unique<T>(std::forward<Args>(args)...);
+}
+
+template<typename T>
+using UniquePtrCustomDeleter = std::unique_ptr<T, std::function<void(T*)>>;
+
+template<typename T>
+using SharedPtr = std::shared_ptr<T>;
+template<typename T, typename ... Args>
+constexpr SharedPtr<T> MakeShared(Args&& ... args)
+{
+	return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+template<typename T>
+using WeakPtr = std::weak_ptr<T>;
+template<typename T, typename ... Args>
+constexpr WeakPtr<T> MakeWeak(Args&& ... args)
+{
+	return std::weak_ptr<T>(std::forward<Args>(args)...);
+}
@@ -0,0 +1,92 @@
+#include "ThreadPool.h"
+
+#include <utility>
+
+ThreadPool::ThreadPool(size_t workerCount)
+{
+	Workers.reserve(workerCount);
+	for (size_t i = 0; i < workerCount; i++)
+		Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(Mutex);
+		Stopping = true;
+	}
+	WorkReady.notify_all();
+
+	for (auto& worker : Workers)
+		worker.join();
+}
+
+size_t ThreadPool::DefaultWorkerCount()
+{
+	// One core is left to the calling thread
+	size_t cores = std::thread::hardware_concurrency();
+	return cores > 1 ? cores - 1 : 0;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+	if (count == 0) return;
+
+	{
+		std::lock_guard lock(Mutex);
+		Job = &job;
+		JobCount = count;
+		NextJob = 0;
+		WorkersDone = 0;
+		Error = nullptr;
+		Generation++;
+	}
+	WorkReady.notify_all();
+
+	RunJobs();
+
+	std::unique_lock lock(Mutex);
+	WorkDone.wait(lock, [this]() { return WorkersDone == Workers.size(); });
+	Job = nullptr;
+
+	if (Error)
+		std::rethrow_exception(std::exchange(Error, nullptr));
+}
+
+void ThreadPool::WorkerLoop()
+{
+	uint64_t seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock lock(Mutex);
+			WorkReady.wait(lock, [this, seenGeneration]() { return Stopping || Generation != seenGeneration; });
+			if (Stopping) return;
+
+			seenGeneration = Generation;
+		}
+
+		RunJobs();
+
+		std::lock_guard lock(Mutex);
+		if (++WorkersDone == Workers.size())
+			WorkDone.notify_all();
+	}
+}
+
+void ThreadPool::RunJobs()
+{
+	// Jobs are handed out one at a time, so uneven jobs still spread over all threads
+	for (size_t index = NextJob++; index < JobCount; index = NextJob++)
+	{
+		try
+		{
+			(*Job)(index);
+		}
+		catch (...)
+		{
+			std::lock_guard lock(Mutex);
+			if (!Error) Error = std::current_exception();
+		}
+	}
+}
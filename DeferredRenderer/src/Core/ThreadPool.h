@@ -0,0 +1,48 @@
+#pragma once
+#include "Core.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+// Fixed set of worker threads running parallel-for style jobs. The calling thread takes part in
+// every job, so a pool of N workers records on N + 1 threads
+class ThreadPool
+{
+public:
+	explicit ThreadPool(size_t workerCount = DefaultWorkerCount());
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Runs job(i) for every i in [0, count) and returns once all of them finished.
+	// The first exception thrown by a job is rethrown here
+	void ParallelFor(size_t count, const std::function<void(size_t)>& job);
+
+	inline size_t GetThreadCount() const { return Workers.size() + 1; }
+
+	static size_t DefaultWorkerCount();
+
+private:
+	void WorkerLoop();
+	void RunJobs();
+
+private:
+	std::vector<std::thread> Workers;
+
+	std::mutex Mutex;
+	std::condition_variable WorkReady;
+	std::condition_variable WorkDone;
+
+	const std::function<void(size_t)>* Job = nullptr;
+	size_t JobCount = 0;
+	std::atomic<size_t> NextJob = 0;
+	// Every worker checks in once per ParallelFor, so no worker can still be running when the next one starts
+	size_t WorkersDone = 0;
+	uint64_t Generation = 0;
+	std::exception_ptr Error;
+	bool Stopping = false;
+};
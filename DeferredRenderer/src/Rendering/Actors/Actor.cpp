@@ -4,63 +4,63 @@
 #include "Rendering/RootSignature.h"
 #include "Camera.h"
 
+#include <algorithm>
+#include <limits>
+
 Actor::Actor(ID3D12Device5Ptr device, const Camera& camera)
     : SceneCamera(camera),
     Position(0.0f, 0.0f, 0.0f),
     Rotation(0.0f, 0.0f, 0.0f),
     Scale(1.0f, 1.0f, 1.0f)
 {
-    ActorInfo = MakeUnique<ResourceGPU_CBV<ActorData>>();
-    ActorInfo->Resource.CPUData.Material.MatericalColor = glm::vec3(1.0f, 1.0f, 1.0f);
-    ActorInfo->Resource.CPUData.Material.SpecularIntensity = 1.0f;
-    ActorInfo->Resource.CPUData.Material.Shininess = 12.0f;
-    ActorInfo->Resource.CPUData.Material.Reflectiveness = 0.0f;
+    Data.Material.MatericalColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    Data.Material.SpecularIntensity = 1.0f;
+    Data.Material.Shininess = 12.0f;
+    Data.Material.Reflectiveness = 0.0f;
     Roughness.Resource.CPUData = 0.0f;
 
-    AddResourceToMap<ForwardRenderPass>(*ActorInfo, LightCBuffer + 1);
-    AddResourceToMap<GeometryPass>(*ActorInfo, 3);
     AddResourceToMap<CombinedBlurPass>(Roughness, 3);
 }
 
-void Actor::Tick()
+bool Actor::Tick()
 {
-    ActorInfo->Resource.CPUData.Model = glm::translate(Position) * glm::mat4_cast(glm::quat(glm::radians(Rotation))) * glm::scale(Scale);
-    ActorInfo->Resource.CPUData.ModelView = SceneCamera.GetView() * ActorInfo->Resource.CPUData.Model;
-    ActorInfo->Resource.Tick();
+    if (!Dirty) return false;
+
+    // The view is applied in the shader, so camera movement leaves the actor clean
+    Data.Model = glm::translate(Position) * glm::mat4_cast(glm::quat(glm::radians(Rotation))) * glm::scale(Scale);
+    Dirty = false;
+    return true;
 }
 
-void Actor::SetUpGPUResources(ID3D12Device5Ptr device, D3D12_CPU_DESCRIPTOR_HANDLE destDescriptor)
+MeshletCullStats Actor::Cull(const StaticGeometry& geometry)
 {
-    ActorInfo->Resource.Init(device, destDescriptor);
+    // Projected size of a mesh unit at the nearest point of the bounds, the full mesh from inside them
+    const auto& model = Data.Model;
+    float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+    glm::vec3 center = model * glm::vec4(Mesh.Center, 1.0f);
+    float distance = glm::length(center - SceneCamera.GetPosition()) - Mesh.Radius * scale;
+    float pixelsPerUnit = std::numeric_limits<float>::infinity();
+    if (distance > 0.0f)
+        pixelsPerUnit = scale * std::abs(SceneCamera.GetProjection()[1][1]) * 0.5f * Globals.WindowDimensions.y / distance;
+    Lod = SelectLod(Mesh, Lod, pixelsPerUnit);
+
+    const auto& lod = Mesh.Lods[Lod];
+    auto view = MeshletCullView::Create(SceneCamera.GetViewProjection(), SceneCamera.GetPosition(), model, ConeCulling);
+    return CullMeshlets(geometry.GetMeshlets().data() + lod.FirstMeshlet, lod.MeshletCount, view, Draws);
 }
 
-Cube::Cube(ID3D12Device5Ptr device, const Camera& camera)
+Cube::Cube(ID3D12Device5Ptr device, const Camera& camera, StaticGeometry& geometry)
     :Actor(device, camera)
 {
-    struct VertexElementNorm : VertexElement
-    {
-        glm::float3 Normal;
-    };
-
-    auto data = Primitives::Cube::CreateWNormals<VertexElementNorm>();
-
-    BufferLayout layout{ {"POSITION", DataType::float3},
-                    {"NORMAL", DataType::float3} };
-
-    VBuffer.Init(device, data.Vertices, layout);
-    IBuffer.Init(device, data.Indices);
+    auto data = Primitives::Cube::CreateWNormals<StaticVertex>();
+    SetMesh(geometry.Add(data.Vertices, data.Indices));
 }
 
-Sphere::Sphere(ID3D12Device5Ptr device, const Camera& camera)
+Sphere::Sphere(ID3D12Device5Ptr device, const Camera& camera, StaticGeometry& geometry)
     :Actor(device, camera)
 {
     Scale = glm::vec3(0.1f, 0.1f, 0.1f);
     
-    auto data = Primitives::Sphere::Create<VertexElement>();
-
-    BufferLayout layout{ {"POSITION", DataType::float3},
-                    {"NORMAL", DataType::float3}};
-
-    VBuffer.Init(device, data.Vertices, layout);
-    IBuffer.Init(device, data.Indices);
+    auto data = Primitives::Sphere::Create<StaticVertex>();
+    SetMesh(geometry.Add(data.Vertices, data.Indices));
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "Core/Core.h"
 #include "Rendering/Buffer.h"
+#include "Rendering/StaticGeometry.h"
 #include "Rendering/Shaders/HLSLCompat.h"
 
 #include "Rendering/Resources.h"
@@ -38,17 +39,32 @@ public:
 
 	template<typename Pass>
 	requires std::is_base_of_v<RenderPass, Pass>
-	void Bind(ID3D12GraphicsCommandList4Ptr cmdList) const;
+	void Bind(CommandContext& cmdList) const;
 
-	void Tick();
+	// Returns true when Data changed since the last tick and has to be written to the scene buffer
+	bool Tick();
+	// Picks the level of detail for the camera and keeps the meshlets of that level it may see for the
+	// draws of this frame. Call after Tick, it reads the model matrix
+	MeshletCullStats Cull(const StaticGeometry& geometry);
+	inline uint32_t GetLod() const { return Lod; }
 
-    void SetPosition(const glm::vec3& position) { Position = position; }
-    void SetRotation(const glm::vec3& rotation) { Rotation = rotation; }
-    void SetScale(const glm::vec3& scale) { Scale = scale; }
+    void SetPosition(const glm::vec3& position) { Position = position; Dirty = true; }
+    void SetRotation(const glm::vec3& rotation) { Rotation = rotation; Dirty = true; }
+    void SetScale(const glm::vec3& scale) { Scale = scale; Dirty = true; }
 
-	void SetUpGPUResources(ID3D12Device5Ptr device, D3D12_CPU_DESCRIPTOR_HANDLE destDescriptor);
+	inline const ActorData& GetData() const { return Data; }
 
 protected:
+	// The shaders decode the mesh's positions with the quantization written to Data
+	void SetMesh(const MeshRange& mesh)
+	{
+		Mesh = mesh;
+		Draws = { { mesh.Lods[0].FirstIndex, mesh.Lods[0].IndexCount } };
+		Data.PositionOffset = mesh.Quantization.Offset;
+		Data.PositionScale = mesh.Quantization.Scale;
+		Dirty = true;
+	}
+
 	template<typename Pass, typename T>
 	requires std::is_base_of_v<ResourceGPUBase, T> && std::is_base_of_v<RenderPass, Pass>
 	void AddResourceToMap(T& rscPtr, UINT slot)
@@ -60,7 +76,7 @@ protected:
 private:
 	template<typename Pass>
 	requires std::is_base_of_v<RenderPass, Pass>
-	void BindLocalResources(ID3D12GraphicsCommandList4Ptr cmdList) const
+	void BindLocalResources(CommandContext& cmdList) const
 	{
 		auto it = ResourceMap.find(std::type_index(typeid(Pass)));
 		if (it != ResourceMap.end())
@@ -72,17 +88,24 @@ private:
 
 protected:
 	const Camera& SceneCamera;
-	VertexBuffer VBuffer;
-	IndexBuffer IBuffer;
+	// Draw arguments into the scene's static geometry buffers, bound once per pass
+	MeshRange Mesh;
+	// Index ranges of the visible meshlets, the whole mesh until the first Cull
+	std::vector<IndexRange> Draws;
+	uint32_t Lod = 0;
+	// Off for materials seen from both sides - their back facing meshlets are still visible
+	bool ConeCulling = true;
 
 	glm::vec3 Position;  
 	glm::vec3 Rotation;  
 	glm::vec3 Scale;
 
-	//ConstantBuffer<ActorData> ActorInfo;
 	Resources2RenderPassMap ResourceMap;
 
-	UniquePtr<ResourceGPU_CBV<ActorData>> ActorInfo;
+	// Lives in the scene's GPU buffer at SceneIndex, draws pass the index as a root constant
+	ActorData Data{};
+	uint32_t SceneIndex = 0;
+	bool Dirty = true;
 	mutable ResourceGPU_CBV<uint> Roughness;
 
 	friend class Scene;
@@ -90,31 +113,31 @@ protected:
 
 template<typename Pass>
 requires std::is_base_of_v<RenderPass, Pass>
-void Actor::Bind(ID3D12GraphicsCommandList4Ptr cmdList) const
+void Actor::Bind(CommandContext& cmdList) const
 {}
 
 template<>
-inline void Actor::Bind<ForwardRenderPass>(ID3D12GraphicsCommandList4Ptr cmdList) const
+inline void Actor::Bind<ForwardRenderPass>(CommandContext& cmdList) const
 {
-	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	cmdList->IASetVertexBuffers(0, 1, &VBuffer.GetView());
-	cmdList->IASetIndexBuffer(&IBuffer.GetView());
+	if (Draws.empty()) return;
+	cmdList.SetGraphicsRoot32BitConstant(ForwardRenderPass::ActorIndexSlot, SceneIndex, 0);
 	BindLocalResources<ForwardRenderPass>(cmdList);
-	cmdList->DrawIndexedInstanced(IBuffer.GetIndexCount(), 1, 0, 0, 0);
+	for (const auto& draw : Draws)
+		cmdList->DrawIndexedInstanced(draw.Count, 1, draw.First, static_cast<INT>(Mesh.BaseVertex), 0);
 }
 
 template<>
-inline void Actor::Bind<GeometryPass>(ID3D12GraphicsCommandList4Ptr cmdList) const
+inline void Actor::Bind<GeometryPass>(CommandContext& cmdList) const
 {
-	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	cmdList->IASetVertexBuffers(0, 1, &VBuffer.GetView());
-	cmdList->IASetIndexBuffer(&IBuffer.GetView());
+	if (Draws.empty()) return;
+	cmdList.SetGraphicsRoot32BitConstant(GeometryPass::ActorIndexSlot, SceneIndex, 0);
 	BindLocalResources<GeometryPass>(cmdList);
-	cmdList->DrawIndexedInstanced(IBuffer.GetIndexCount(), 1, 0, 0, 0);
+	for (const auto& draw : Draws)
+		cmdList->DrawIndexedInstanced(draw.Count, 1, draw.First, static_cast<INT>(Mesh.BaseVertex), 0);
 }
 
 template<>
-inline void Actor::Bind<CombinedBlurPass>(ID3D12GraphicsCommandList4Ptr cmdList) const
+inline void Actor::Bind<CombinedBlurPass>(CommandContext& cmdList) const
 {
 	if (Roughness.Resource.CPUData = 0) return;
 	Roughness.BindCompute(cmdList, 3);
@@ -126,11 +149,11 @@ inline void Actor::Bind<CombinedBlurPass>(ID3D12GraphicsCommandList4Ptr cmdList)
 class Cube : public Actor
 {
 public:
-	Cube(ID3D12Device5Ptr device, const Camera& camera);
+	Cube(ID3D12Device5Ptr device, const Camera& camera, StaticGeometry& geometry);
 };
 
 class Sphere : public Actor
 {
 public:
-	Sphere(ID3D12Device5Ptr device, const Camera& camera);
+	Sphere(ID3D12Device5Ptr device, const Camera& camera, StaticGeometry& geometry);
 };
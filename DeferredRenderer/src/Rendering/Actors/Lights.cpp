@@ -1,4 +1,5 @@
 #include "Lights.h"
+#include "Rendering/Resources.h"
 
 DirectionalLight::DirectionalLight()
 	:Position(0.0f, 50.0f, 0.0f)
@@ -8,7 +9,7 @@ DirectionalLight::DirectionalLight()
 	Info.CPUData.DiffuseIntensity = 1.0f;
 }
 
-void DirectionalLight::Bind(ID3D12GraphicsCommandList4Ptr cmdList) const
+void DirectionalLight::Bind(CommandContext& cmdList) const
 {
 	//cmdList->SetGraphicsRootConstantBufferView(LightCBuffer + 1, Info.GetGPUVirtualAddress());// ATTENTION WITH THE SLOT!!!!
 }
@@ -36,7 +37,7 @@ void DirectionalLight::Tick()
 {
 	Info.CPUData.Position = Position;
 	Info.CPUData.Direction = glm::normalize(-Position);
-	Info.Tick();
+	Info.Tick(Globals.FrameIndex);
 }
 
 void DirectionalLight::SetUpGPUResources(ID3D12Device5Ptr device, D3D12_CPU_DESCRIPTOR_HANDLE destDescriptor)
@@ -9,7 +9,7 @@ class DirectionalLight
 public:
 	DirectionalLight();
 
-	void Bind(ID3D12GraphicsCommandList4Ptr cmdList) const;
+	void Bind(CommandContext& cmdList) const;
 	void GUI() const;
 	void Tick();
 
@@ -19,6 +19,6 @@ private:
 	mutable glm::vec3 Position;
 	mutable glm::vec3 Direction;
 
-	mutable ConstantBuffer<DirLightData> Info;
+	mutable FrameConstantBuffer<DirLightData> Info;
 };
 
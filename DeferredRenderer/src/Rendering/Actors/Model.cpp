@@ -9,6 +9,7 @@ uint RoughnessToKernel(float roughness)
 
 Model::Model(ID3D12Device5Ptr device, 
 			 const Camera& camera, 
+			 StaticGeometry& geometry,
 			 const aiMesh& mesh,
 			 aiMaterial** materials,
 			 const std::vector<std::pair<std::string, uint32_t>>& textureIndexMap)
@@ -28,23 +29,9 @@ Model::Model(ID3D12Device5Ptr device,
 			return result;  // Return -1 if not found
 		};
 
-	BufferLayout layout{ {"POSITION", DataType::float3},
-						{"NORMAL", DataType::float3},
-						{"TANGENT", DataType::float3},
-						{"BITANGENT", DataType::float3},
-						{"TEXCOORD", DataType::float2}, };
-
-	struct VertexElementNorm : VertexElement
-	{
-		glm::float3 Normal;
-		glm::float3 Tangent;
-		glm::float3 Bitangent;
-		glm::float2 TexCoords;
-	};
-
 	aiString filename;
 	auto& material = materials[mesh.mMaterialIndex];
-	auto& data = ActorInfo->Resource.CPUData;
+	auto& data = Data;
 
 	material->GetTexture(aiTextureType_DIFFUSE, 0, &filename);
 
@@ -63,7 +50,12 @@ Model::Model(ID3D12Device5Ptr device,
 
 	if (data.KsID < 0) material->Get(AI_MATKEY_SHININESS, data.Material.Shininess);
 
-	std::vector<VertexElementNorm> vertices;
+	// Alpha tested cards are seen from both sides, so are two sided materials
+	int twoSided = 0;
+	material->Get(AI_MATKEY_TWOSIDED, twoSided);
+	ConeCulling = !twoSided && material->GetTextureCount(aiTextureType_OPACITY) == 0;
+
+	std::vector<StaticVertex> vertices;
 	vertices.reserve(mesh.mNumVertices);
 	std::vector<uint32_t> indices;
 	indices.reserve(mesh.mNumFaces * 3);
@@ -91,6 +83,5 @@ Model::Model(ID3D12Device5Ptr device,
 		indices.push_back(face.mIndices[2]);
 	}
 
-	VBuffer.Init(device, vertices, layout);
-	IBuffer.Init(device, indices);
+	SetMesh(geometry.Add(std::move(vertices), std::move(indices), mesh.mName.C_Str()));
 }
@@ -12,6 +12,7 @@ class Model : public Actor
 public:
 	Model(ID3D12Device5Ptr device, 
 		  const class Camera& camera, 
+		  StaticGeometry& geometry,
 		  const aiMesh& mesh,
 		  aiMaterial** materials,
 		  const std::vector<std::pair<std::string, uint32_t>>& textureIndexMap);
@@ -0,0 +1,143 @@
+#include "Barriers.h"
+
+#include <algorithm>
+
+void BarrierBatches::Build(const std::vector<std::vector<BarrierDesc>>& layers)
+{
+	Barriers.clear();
+	LayerStarts.clear();
+	Stats = {};
+
+	for (const auto& layer : layers)
+	{
+		auto merged = layer;
+		MergeLayer(merged);
+
+		LayerStarts.push_back(Barriers.size());
+		Barriers.insert(Barriers.end(), merged.begin(), merged.end());
+
+		Stats.Merged += static_cast<uint32_t>(layer.size() - merged.size());
+		Stats.Split += static_cast<uint32_t>(std::ranges::count(merged, D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY, &BarrierDesc::Flags));
+		if (!merged.empty()) Stats.Calls++;
+	}
+	LayerStarts.push_back(Barriers.size());
+
+	Stats.Barriers = static_cast<uint32_t>(Barriers.size());
+}
+
+void BarrierBatches::AddTransition(std::vector<std::vector<BarrierDesc>>& layers, const BarrierDesc& transition,
+								   size_t beginLayer, size_t endLayer)
+{
+	if (beginLayer >= endLayer)
+	{
+		layers[endLayer].push_back(transition);
+		return;
+	}
+
+	auto begin = transition;
+	begin.Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+	layers[beginLayer].push_back(begin);
+
+	auto end = transition;
+	end.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+	layers[endLayer].push_back(end);
+}
+
+void BarrierBatches::MergeLayer(std::vector<BarrierDesc>& layer)
+{
+	std::vector<BarrierDesc> merged;
+	merged.reserve(layer.size());
+
+	for (const auto& barrier : layer)
+	{
+		if (barrier.Kind == BarrierDesc::Type::Transition && barrier.Flags == D3D12_RESOURCE_BARRIER_FLAG_NONE)
+		{
+			// Latest barrier on the same resource - a chain only continues from a whole transition
+			auto it = std::find_if(merged.rbegin(), merged.rend(), [&barrier](const BarrierDesc& other)
+								   {
+									   return other.Resource == barrier.Resource;
+								   });
+
+			if (it != merged.rend() && it->Kind == BarrierDesc::Type::Transition &&
+				it->Flags == D3D12_RESOURCE_BARRIER_FLAG_NONE && it->After == barrier.Before)
+			{
+				it->After = barrier.After;
+				continue;
+			}
+		}
+
+		merged.push_back(barrier);
+	}
+
+	std::erase_if(merged, [](const BarrierDesc& barrier)
+				  {
+					  return barrier.Kind == BarrierDesc::Type::Transition && barrier.Before == barrier.After;
+				  });
+
+	layer = std::move(merged);
+}
+
+static std::string StateToString(D3D12_RESOURCE_STATES state)
+{
+	switch (state)
+	{
+	case D3D12_RESOURCE_STATE_COMMON: return "COMMON/PRESENT";
+	case D3D12_RESOURCE_STATE_RENDER_TARGET: return "RENDER_TARGET";
+	case D3D12_RESOURCE_STATE_UNORDERED_ACCESS: return "UNORDERED_ACCESS";
+	case D3D12_RESOURCE_STATE_DEPTH_WRITE: return "DEPTH_WRITE";
+	case D3D12_RESOURCE_STATE_DEPTH_READ: return "DEPTH_READ";
+	case D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE: return "NON_PIXEL_SHADER_RESOURCE";
+	case D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE: return "PIXEL_SHADER_RESOURCE";
+	case D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE: return "ALL_SHADER_RESOURCE";
+	case D3D12_RESOURCE_STATE_COPY_DEST: return "COPY_DEST";
+	case D3D12_RESOURCE_STATE_COPY_SOURCE: return "COPY_SOURCE";
+	case D3D12_RESOURCE_STATE_GENERIC_READ: return "GENERIC_READ";
+	default: return std::to_string(static_cast<uint32_t>(state));
+	}
+}
+
+void BarrierBatches::Dump(std::ostream& os, const std::function<std::string(size_t)>& layerName,
+						  const std::function<std::string(const ID3D12ResourcePtr*)>& resourceName) const
+{
+	// Nearest layer holding the other half of a split transition
+	auto findHalf = [this](size_t layer, const BarrierDesc& barrier, D3D12_RESOURCE_BARRIER_FLAGS half)
+		{
+			const bool forward = half == D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+			for (size_t other = layer; forward ? other + 1 < GetLayerCount() : other > 0;)
+			{
+				other = forward ? other + 1 : other - 1;
+
+				const BarrierDesc* barriers = GetLayer(other);
+				for (size_t i = 0; i < GetLayerSize(other); i++)
+					if (barriers[i].Resource == barrier.Resource && barriers[i].Flags == half)
+						return other;
+			}
+			return layer;
+		};
+
+	for (size_t layer = 0; layer < GetLayerCount(); layer++)
+	{
+		if (GetLayerSize(layer) == 0) continue;
+
+		os << "[" << layer << "] " << layerName(layer) << "\n";
+		const BarrierDesc* barriers = GetLayer(layer);
+		for (size_t i = 0; i < GetLayerSize(layer); i++)
+		{
+			const auto& barrier = barriers[i];
+			os << "    " << resourceName(barrier.Resource) << ": ";
+
+			if (barrier.Kind == BarrierDesc::Type::Aliasing)
+			{
+				os << "alias" << (barrier.AliasBefore ? " from " + resourceName(barrier.AliasBefore) : "") << "\n";
+				continue;
+			}
+
+			os << StateToString(barrier.Before) << " -> " << StateToString(barrier.After);
+			if (barrier.Flags == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY)
+				os << " (begin, ends in [" << findHalf(layer, barrier, D3D12_RESOURCE_BARRIER_FLAG_END_ONLY) << "])";
+			else if (barrier.Flags == D3D12_RESOURCE_BARRIER_FLAG_END_ONLY)
+				os << " (end, begun in [" << findHalf(layer, barrier, D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY) << "])";
+			os << "\n";
+		}
+	}
+}
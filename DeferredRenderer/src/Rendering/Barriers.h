@@ -0,0 +1,103 @@
+#pragma once
+#include "Core/Core.h"
+#include "CommandContext.h"
+
+#include <ostream>
+#include <type_traits>
+
+// Flat barrier record. Resources are referenced through the pointer objects shared by the graph,
+// so swapping the back buffer behind them does not invalidate a compiled plan
+struct BarrierDesc
+{
+	enum class Type : uint8_t
+	{
+		Transition,
+		Aliasing	// Hands the memory over to Resource and discards it after the batch
+	};
+
+	Type Kind = Type::Transition;
+	ID3D12ResourcePtr* Resource = nullptr;
+	// Aliasing only - nullptr aliases every resource sharing the memory
+	ID3D12ResourcePtr* AliasBefore = nullptr;
+	D3D12_RESOURCE_STATES Before{};
+	D3D12_RESOURCE_STATES After{};
+	// BEGIN_ONLY / END_ONLY halves of a split transition
+	D3D12_RESOURCE_BARRIER_FLAGS Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+};
+
+static_assert(std::is_trivially_copyable_v<BarrierDesc>, "Barriers are stored and copied as plain data");
+
+struct BarrierStats
+{
+	uint32_t Barriers = 0;	// Barriers recorded per frame
+	uint32_t Merged = 0;	// Barriers removed by merging chains on the same resource
+	uint32_t Split = 0;		// Transitions split into a begin and an end half
+	uint32_t Calls = 0;		// ResourceBarrier calls per frame - one per non-empty layer
+};
+
+// Barriers of a whole frame in one flat array, with a contiguous range per layer.
+// Building and merging are pure CPU work, only Emit touches the command list
+class BarrierBatches
+{
+public:
+	// Flattens the layers. Within a layer chains on the same resource are folded (A->B, B->C becomes A->C)
+	// and transitions ending in the state they started from are dropped
+	void Build(const std::vector<std::vector<BarrierDesc>>& layers);
+
+	// Records the layer with a single ResourceBarrier call. Safe to call for different command lists
+	// from several threads at once
+	template<typename List>
+	void Emit(BasicCommandContext<List>& cmdList, size_t layer) const;
+
+	inline size_t GetLayerCount() const { return LayerStarts.empty() ? 0 : LayerStarts.size() - 1; }
+	inline const BarrierDesc* GetLayer(size_t layer) const { return Barriers.data() + LayerStarts[layer]; }
+	inline size_t GetLayerSize(size_t layer) const { return LayerStarts[layer + 1] - LayerStarts[layer]; }
+	inline const BarrierStats& GetStats() const { return Stats; }
+
+	// Adds a transition that has to be complete by endLayer. When the resource is idle from beginLayer on,
+	// the transition starts there and only its end waits in endLayer
+	static void AddTransition(std::vector<std::vector<BarrierDesc>>& layers, const BarrierDesc& transition,
+							  size_t beginLayer, size_t endLayer);
+	static void MergeLayer(std::vector<BarrierDesc>& layer);
+
+	// One line per barrier, layer by layer. Split halves name the layer holding their other half
+	void Dump(std::ostream& os, const std::function<std::string(size_t)>& layerName,
+			  const std::function<std::string(const ID3D12ResourcePtr*)>& resourceName) const;
+
+private:
+	std::vector<BarrierDesc> Barriers;
+	std::vector<size_t> LayerStarts;
+	BarrierStats Stats;
+};
+
+template<typename List>
+void BarrierBatches::Emit(BasicCommandContext<List>& cmdList, size_t layer) const
+{
+	const size_t count = GetLayerSize(layer);
+	if (count == 0) return;
+
+	// One scratch array per recording thread, so recording a frame does not allocate
+	thread_local std::vector<D3D12_RESOURCE_BARRIER> scratch;
+
+	const BarrierDesc* barriers = GetLayer(layer);
+	scratch.clear();
+	for (size_t i = 0; i < count; i++)
+	{
+		const auto& barrier = barriers[i];
+		if (barrier.Kind == BarrierDesc::Type::Aliasing)
+		{
+			auto* before = barrier.AliasBefore ? barrier.AliasBefore->GetInterfacePtr() : nullptr;
+			scratch.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, *barrier.Resource));
+		}
+		else
+			scratch.push_back(CD3DX12_RESOURCE_BARRIER::Transition(*barrier.Resource, barrier.Before, barrier.After,
+																   D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, barrier.Flags));
+	}
+
+	cmdList->ResourceBarrier(static_cast<UINT>(scratch.size()), scratch.data());
+
+	// The memory holds whatever the previous owner left, so aliased resources are discarded before use
+	for (size_t i = 0; i < count; i++)
+		if (barriers[i].Kind == BarrierDesc::Type::Aliasing)
+			cmdList->DiscardResource(*barriers[i].Resource, nullptr);
+}
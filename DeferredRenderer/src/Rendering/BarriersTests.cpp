@@ -0,0 +1,191 @@
+#include "Test.h"
+#include "RecordingCommandList.h"
+#include "Rendering/Barriers.h"
+
+namespace
+{
+	BarrierDesc Transition(ID3D12ResourcePtr& resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+	{
+		BarrierDesc barrier;
+		barrier.Resource = std::addressof(resource);
+		barrier.Before = before;
+		barrier.After = after;
+		return barrier;
+	}
+
+	BarrierDesc Aliasing(ID3D12ResourcePtr& resource)
+	{
+		BarrierDesc barrier;
+		barrier.Kind = BarrierDesc::Type::Aliasing;
+		barrier.Resource = std::addressof(resource);
+		return barrier;
+	}
+
+	size_t CountBarriers(const std::vector<std::vector<BarrierDesc>>& layers)
+	{
+		size_t count = 0;
+		for (const auto& layer : layers)
+			count += layer.size();
+		return count;
+	}
+}
+
+TEST_CASE(BarrierLayersFoldChainsAndDropRoundTrips)
+{
+	// Barriers reference the pointer objects, the resources behind them are never touched
+	ID3D12ResourcePtr A, B, C, D;
+
+	std::vector<std::vector<BarrierDesc>> layers(3);
+	layers[0] = {
+		Transition(A, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		Transition(B, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		Transition(A, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+		Transition(B, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET),
+		Transition(C, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+	};
+	layers[2] = {
+		Aliasing(D),
+		Transition(D, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_RENDER_TARGET),
+	};
+
+	BarrierBatches batches;
+	batches.Build(layers);
+	const auto& stats = batches.GetStats();
+
+	// A's chain folds into RT -> UA, B's round trip disappears
+	CHECK_EQ(stats.Barriers, 4u);
+	CHECK_EQ(stats.Merged, 3u);
+	CHECK_EQ(stats.Split, 0u);
+	CHECK_EQ(stats.Calls, 2u);
+	CHECK_EQ(stats.Barriers + stats.Merged, CountBarriers(layers));
+
+	REQUIRE(batches.GetLayerCount() == 3);
+	REQUIRE(batches.GetLayerSize(0) == 2);
+	CHECK(batches.GetLayer(0)[0].Resource == std::addressof(A));
+	CHECK_EQ(batches.GetLayer(0)[0].Before, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	CHECK_EQ(batches.GetLayer(0)[0].After, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	CHECK(batches.GetLayer(0)[1].Resource == std::addressof(C));
+	CHECK_EQ(batches.GetLayerSize(1), 0u);
+	CHECK_EQ(batches.GetLayerSize(2), 2u);
+}
+
+TEST_CASE(BarrierLayersEmitOneCallPerNonEmptyLayer)
+{
+	// Barriers reference the pointer objects, the resources behind them are never touched
+	ID3D12ResourcePtr A, B, C, D;
+
+	// Shaped like a frame: G-buffer targets become shader resources, the lighting target aliases
+	// the memory of a dead resource, and the back buffer goes to present at the end
+	std::vector<std::vector<BarrierDesc>> layers(4);
+	layers[0] = {
+		Transition(A, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_RENDER_TARGET),
+		Transition(B, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_RENDER_TARGET),
+		Transition(C, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_DEPTH_WRITE),
+	};
+	layers[1] = {
+		Transition(A, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		Transition(B, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		Transition(C, D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_DEPTH_READ),
+		Aliasing(D),
+		Transition(D, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_RENDER_TARGET),
+	};
+	layers[3] = {
+		Transition(D, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT),
+	};
+
+	BarrierBatches batches;
+	batches.Build(layers);
+
+	RecordingCommandList list;
+	RecordingContext context(&list);
+	for (size_t layer = 0; layer < batches.GetLayerCount(); layer++)
+		batches.Emit(context, layer);
+
+	// One ResourceBarrier call per transition before batching, one per non-empty layer now
+	const size_t naiveCalls = CountBarriers(layers);
+	CHECK_EQ(naiveCalls, 9u);
+	CHECK_EQ(batches.GetStats().Calls, 3u);
+	CHECK_EQ(list.Count("ResourceBarrier"), batches.GetStats().Calls);
+
+	REQUIRE(list.Barriers.size() == 3);
+	CHECK_EQ(list.Barriers[0].size(), 3u);
+	CHECK_EQ(list.Barriers[1].size(), 5u);
+	CHECK_EQ(list.Barriers[2].size(), 1u);
+
+	// The aliasing barrier keeps its place before the transition of the resource it hands memory to
+	CHECK_EQ(list.Barriers[1][3].Type, D3D12_RESOURCE_BARRIER_TYPE_ALIASING);
+	CHECK_EQ(list.Barriers[1][4].Type, D3D12_RESOURCE_BARRIER_TYPE_TRANSITION);
+	CHECK_EQ(list.Barriers[1][4].Transition.StateAfter, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+	// ... and the resource is discarded right after the batch
+	CHECK_EQ(list.Discarded.size(), 1u);
+	REQUIRE(list.Calls.size() == 4);
+	CHECK_EQ(list.Calls[2], "DiscardResource");
+
+	// Barriers go straight to the list, so the context's state filtering does not see them
+	CHECK_EQ(context.GetStats().Issued, 0u);
+}
+
+TEST_CASE(SplitTransitionsBeginAndEndInTheirLayers)
+{
+	ID3D12ResourcePtr A, B;
+
+	// A is idle from layer 1 on and needed in layer 3, B is needed right where it becomes idle
+	std::vector<std::vector<BarrierDesc>> layers(4);
+	BarrierBatches::AddTransition(layers, Transition(A, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE), 1, 3);
+	BarrierBatches::AddTransition(layers, Transition(B, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE), 2, 2);
+
+	BarrierBatches batches;
+	batches.Build(layers);
+	CHECK_EQ(batches.GetStats().Split, 1u);
+	CHECK_EQ(batches.GetStats().Barriers, 3u);
+
+	RecordingCommandList list;
+	RecordingContext context(&list);
+	std::vector<size_t> callLayers;
+	for (size_t layer = 0; layer < batches.GetLayerCount(); layer++)
+	{
+		size_t calls = list.Barriers.size();
+		batches.Emit(context, layer);
+		if (list.Barriers.size() > calls)
+			callLayers.push_back(layer);
+	}
+
+	REQUIRE(callLayers == std::vector<size_t>({ 1, 2, 3 }));
+	REQUIRE(list.Barriers[0].size() == 1 && list.Barriers[1].size() == 1 && list.Barriers[2].size() == 1);
+
+	const auto& begin = list.Barriers[0][0];
+	CHECK_EQ(begin.Flags, D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY);
+	CHECK_EQ(begin.Transition.StateBefore, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	CHECK_EQ(begin.Transition.StateAfter, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	// A transition with no idle layers before its use stays whole
+	const auto& whole = list.Barriers[1][0];
+	CHECK_EQ(whole.Flags, D3D12_RESOURCE_BARRIER_FLAG_NONE);
+	CHECK_EQ(whole.Transition.StateBefore, D3D12_RESOURCE_STATE_COPY_DEST);
+
+	// The end half repeats the states of the begin half
+	const auto& end = list.Barriers[2][0];
+	CHECK_EQ(end.Flags, D3D12_RESOURCE_BARRIER_FLAG_END_ONLY);
+	CHECK_EQ(end.Transition.StateBefore, begin.Transition.StateBefore);
+	CHECK_EQ(end.Transition.StateAfter, begin.Transition.StateAfter);
+}
+
+TEST_CASE(SplitHalvesAreNotMergedIntoChains)
+{
+	ID3D12ResourcePtr A;
+
+	// The end half of A and a following whole transition of A share layer 2
+	std::vector<std::vector<BarrierDesc>> layers(3);
+	BarrierBatches::AddTransition(layers, Transition(A, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE), 0, 2);
+	layers[2].push_back(Transition(A, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+
+	BarrierBatches batches;
+	batches.Build(layers);
+
+	// Folding the whole transition into the end half would leave the begin half without a matching end
+	CHECK_EQ(batches.GetStats().Merged, 0u);
+	REQUIRE(batches.GetLayerSize(2) == 2);
+	CHECK_EQ(batches.GetLayer(2)[0].Flags, D3D12_RESOURCE_BARRIER_FLAG_END_ONLY);
+	CHECK_EQ(batches.GetLayer(2)[1].Flags, D3D12_RESOURCE_BARRIER_FLAG_NONE);
+}
@@ -1,5 +1,30 @@
 #include "Buffer.h"
+#include "Resources.h"
+#include "GpuAllocator.h"
+#include "UploadService.h"
 
+#include <algorithm>
+
+ID3D12ResourcePtr CreateStaticBuffer(const void* data, uint64_t size)
+{
+	auto buffer = Globals.Allocator->CreateBuffer(size, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON).Resource;
+
+	// A quarter of the ring leaves room for the copies queued around this one
+	constexpr uint64_t piece = UploadService::DefaultRingCapacity / 4;
+	for (uint64_t offset = 0; offset < size; offset += piece)
+		Globals.Uploads->UploadBuffer(buffer, offset, static_cast<const uint8_t*>(data) + offset, std::min(piece, size - offset));
+	return buffer;
+}
+
+ID3D12ResourcePtr CreateUploadBuffer(uint64_t size)
+{
+	return Globals.Allocator->CreateBuffer(size, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ).Resource;
+}
+
+FrameAllocation AllocateFrameConstants(uint64_t size)
+{
+	return Globals.FrameUploads->Allocate(size);
+}
 
 LayoutElement::LayoutElement(const std::string& name, DataType type)
 	:Name(name), Type(type), Size(CalcSize(type))
@@ -22,6 +47,9 @@ DXGI_FORMAT LayoutElement::DataTypeToDXGI(DataType type)
 	case DataType::int2: return DXGI_FORMAT_R32G32_SINT;
 	case DataType::int3: return DXGI_FORMAT_R32G32B32_SINT;
 	case DataType::int4: return DXGI_FORMAT_R32G32B32A32_SINT;
+	case DataType::unorm16x4: return DXGI_FORMAT_R16G16B16A16_UNORM;
+	case DataType::snorm16x2: return DXGI_FORMAT_R16G16_SNORM;
+	case DataType::half2: return DXGI_FORMAT_R16G16_FLOAT;
 	default:
 		assert(false && "Unsupported data type");
 		return DXGI_FORMAT_UNKNOWN;
@@ -40,6 +68,9 @@ uint32_t LayoutElement::CalcSize(DataType type)
 	case DataType::int2: return sizeof(int) * 2;
 	case DataType::int3: return sizeof(int) * 3;
 	case DataType::int4: return sizeof(int) * 4;
+	case DataType::unorm16x4: return sizeof(uint16_t) * 4;
+	case DataType::snorm16x2: return sizeof(int16_t) * 2;
+	case DataType::half2: return sizeof(uint16_t) * 2;
 	default:
 		assert(false && "Unsupported data type");
 		return DXGI_FORMAT_UNKNOWN;
@@ -76,27 +107,3 @@ BufferLayout::operator D3D12_INPUT_LAYOUT_DESC() const
 
 	return { InputElementDesc.data(), (uint32_t)InputElementDesc.size() };
 }
-
-void IndexBuffer::Init(ID3D12Device5Ptr device, const std::vector<uint32_t>& indices)
-{
-	assert(!Buffer && "Constant Buffer already initialized");
-	InitImpl(device, indices);
-}
-
-void IndexBuffer::InitImpl(ID3D12Device5Ptr device, const std::vector<uint32_t>& indices)
-{
-	IndexCount = indices.size();
-	const UINT bufferSize = static_cast<UINT>(sizeof(uint32_t) * IndexCount);
-
-	Buffer = D3D::CreateBuffer(device, bufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_HEAP_TYPE_UPLOAD);
-
-	uint32_t* pBufferDataBegin = nullptr;
-	CD3DX12_RANGE readRange(0, 0);  // We do not intend to read from this resource on the CPU.
-	Buffer->Map(0, &readRange, reinterpret_cast<void**>(&pBufferDataBegin));
-	std::memcpy(pBufferDataBegin, indices.data(), bufferSize);
-	Buffer->Unmap(0, nullptr);
-
-	BufferView.BufferLocation = Buffer->GetGPUVirtualAddress();
-	BufferView.SizeInBytes = bufferSize;
-	BufferView.Format = DXGI_FORMAT_R32_UINT;
-}
@@ -2,6 +2,7 @@
 #include "Core/Core.h"
 #include "Core/Exception.h"
 #include "Utils.h"
+#include "FrameUploadAllocator.h"
 
 struct VertexElement
 {
@@ -11,7 +12,8 @@ struct VertexElement
 enum class DataType
 {
 	float1, float2, float3, float4,
-	int1, int2, int3, int4
+	int1, int2, int3, int4,
+	unorm16x4, snorm16x2, half2		// Read as floats by the shader
 };
 
 struct LayoutElement
@@ -49,118 +51,131 @@ private:
 	uint32_t Stride = 0;
 };
 
+// Default heap buffer placed by Globals.Allocator and filled through Globals.Uploads.
+// Left in COMMON, the first read promotes it. Data larger than the staging ring goes up in pieces
+ID3D12ResourcePtr CreateStaticBuffer(const void* data, uint64_t size);
+// Upload heap buffer placed by Globals.Allocator, for data the CPU rewrites
+ID3D12ResourcePtr CreateUploadBuffer(uint64_t size);
+// Memory for constants of the frame being recorded, from Globals.FrameUploads
+FrameAllocation AllocateFrameConstants(uint64_t size);
+
+// Keeps one copy of the data per frame in flight so the CPU can write frame N+1
+// while the GPU still reads frame N. For data that rarely changes - constants rewritten
+// every frame use FrameConstantBuffer
 template<typename T>
-concept IsVertexElement = std::is_base_of_v<VertexElement, T>;
-
-struct VertexBuffer
+struct ConstantBuffer
 {
-	VertexBuffer() = default;
+	static constexpr UINT SliceSize = align_to(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, sizeof(T));
+
+	ConstantBuffer() = default;
 
-	template<IsVertexElement Vertex>
-	void Init(ID3D12Device5Ptr device, const std::vector<Vertex>& vertices, const BufferLayout& layout)
+	// For buffers bound as root descriptors - no CBVs are created
+	void Init(ID3D12Device5Ptr device)
 	{
 		ASSERT(!Buffer, "Constant Buffer already initialized");
-		Layout = layout;
-		InitImpl(device, vertices);
+		InitImpl(device);
 	}
-	
-	template<IsVertexElement Vertex>
-	void Init(ID3D12Device5Ptr device, const std::vector<Vertex>& vertices, std::initializer_list<LayoutElement> layoutElements)
+
+	// Creates one CBV per frame copy, in consecutive descriptors starting at destDescriptor
+	void Init(ID3D12Device5Ptr device, D3D12_CPU_DESCRIPTOR_HANDLE destDescriptor)
 	{
 		ASSERT(!Buffer, "Constant Buffer already initialized");
-		Layout = { layoutElements };
-		InitImpl(device, vertices);
+		InitImpl(device);
+
+		for (UINT i = 0; i < DefaultSwapChainBuffers; i++)
+		{
+			D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
+			cbvDesc.BufferLocation = Buffer->GetGPUVirtualAddress() + i * SliceSize;
+			cbvDesc.SizeInBytes = SliceSize;
+			device->CreateConstantBufferView(&cbvDesc, destDescriptor);
+			destDescriptor.ptr += device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		}
 	}
 
-	inline const BufferLayout& GetLayout() const { return Layout; }
-	inline const D3D12_VERTEX_BUFFER_VIEW& GetView() const { return BufferView; }
-	inline uint32_t GetCountPerInstance() const { return CountPerInstance; }
-
-private:
-	template<IsVertexElement Vertex>
-	void InitImpl(ID3D12Device5Ptr device, const std::vector<Vertex>& vertices)
+	// Writes CPUData to the copy of frameIndex - copies of frames still in flight are left untouched
+	void Tick(uint32_t frameIndex)
 	{
-		CountPerInstance = vertices.size();
-		const UINT bufferSize = sizeof(Vertex) * CountPerInstance;
-
-		Buffer = D3D::CreateBuffer(device, bufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_HEAP_TYPE_UPLOAD);
+		CurrentFrame = frameIndex;
+		std::memcpy(CPUDataBridgePtr + CurrentFrame * SliceSize, &CPUData, sizeof(CPUData));
+	}
 
-		UINT8* pBufferDataBegin;
-		CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
-		GRAPHICS_ASSERT(Buffer->Map(0, &readRange, reinterpret_cast<void**>(&pBufferDataBegin)));
-		std::memcpy(pBufferDataBegin, vertices.data(), bufferSize);
-		Buffer->Unmap(0, nullptr);
+	// For data that doesn't change from frame to frame
+	void UploadAll()
+	{
+		for (UINT i = 0; i < DefaultSwapChainBuffers; i++)
+			std::memcpy(CPUDataBridgePtr + i * SliceSize, &CPUData, sizeof(CPUData));
+	}
 
-		BufferView.BufferLocation = Buffer->GetGPUVirtualAddress();
-		BufferView.StrideInBytes = sizeof(Vertex);
-		BufferView.SizeInBytes = bufferSize;
+	// Address of the copy written by the last Tick
+	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const
+	{
+		return Buffer->GetGPUVirtualAddress() + CurrentFrame * SliceSize;
 	}
 
 private:
-	BufferLayout Layout;
-	ID3D12ResourcePtr Buffer;
-	D3D12_VERTEX_BUFFER_VIEW BufferView;
-
-	uint32_t CountPerInstance;
-};
-
-struct IndexBuffer
-{
-    IndexBuffer() = default;
-	void Init(ID3D12Device5Ptr device, const std::vector<uint32_t>& indices);
+	void InitImpl(ID3D12Device5Ptr device)
+	{
+		Buffer = CreateUploadBuffer(SliceSize * DefaultSwapChainBuffers);
 
-    inline const D3D12_INDEX_BUFFER_VIEW& GetView() const { return BufferView; }
-	inline uint32_t GetIndexCount() const { return IndexCount; }
+		GRAPHICS_ASSERT(Buffer->Map(0, nullptr, reinterpret_cast<void**>(&CPUDataBridgePtr)));
+		UploadAll();
+	}
 
-private:
-	void InitImpl(ID3D12Device5Ptr device, const std::vector<uint32_t>& indices);
+public:
+	T CPUData;
 
 private:
-    ID3D12ResourcePtr Buffer;
-    D3D12_INDEX_BUFFER_VIEW BufferView;
-	uint32_t IndexCount;
+	ID3D12ResourcePtr Buffer;
+	uint8_t* CPUDataBridgePtr;
+	uint32_t CurrentFrame = 0;
 };
 
+// Constants rewritten every frame. Owns no memory - every Tick copies CPUData into a fresh
+// allocation of the current frame, so frames in flight never share a copy
 template<typename T>
-struct ConstantBuffer
+struct FrameConstantBuffer
 {
-	ConstantBuffer() = default;
-	void Init(ID3D12Device5Ptr device, D3D12_CPU_DESCRIPTOR_HANDLE destDescriptor)
-	{
-		ASSERT(!Buffer, "Constant Buffer already initialized");
-		InitImpl(device, destDescriptor);
-	}
+	static constexpr UINT SliceSize = align_to(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, sizeof(T));
 
-	void Tick()
+	FrameConstantBuffer() = default;
+
+	// For buffers bound as root descriptors - no CBVs are written
+	void Init(ID3D12Device5Ptr device)
 	{
-		std::memcpy(CPUDataBridgePtr, &CPUData, sizeof(CPUData));
+		Device = device;
 	}
 
-	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const
+	// For buffers read through descriptor tables - every Tick rewrites the CBV at destDescriptor + frame index
+	void Init(ID3D12Device5Ptr device, D3D12_CPU_DESCRIPTOR_HANDLE destDescriptor)
 	{
-		return Buffer->GetGPUVirtualAddress();
+		Device = device;
+		Descriptor = destDescriptor;
+		DescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 	}
 
-private:
-	void InitImpl(ID3D12Device5Ptr device, D3D12_CPU_DESCRIPTOR_HANDLE destDescriptor)
+	void Tick(uint32_t frameIndex)
 	{
-		const UINT bufferSize = align_to(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, sizeof(CPUData));
-
-		Buffer = D3D::CreateBuffer(device, bufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_HEAP_TYPE_UPLOAD);
-		
-		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
-		cbvDesc.BufferLocation = Buffer->GetGPUVirtualAddress();
-		cbvDesc.SizeInBytes = bufferSize;
-		device->CreateConstantBufferView(&cbvDesc, destDescriptor);
-
-		GRAPHICS_ASSERT(Buffer->Map(0, nullptr, reinterpret_cast<void**>(&CPUDataBridgePtr)));
-		std::memcpy(CPUDataBridgePtr, &CPUData, sizeof(CPUData));
+		auto allocation = AllocateFrameConstants(SliceSize);
+		std::memcpy(allocation.CPUAddress, &CPUData, sizeof(CPUData));
+		GPUAddress = allocation.GPUAddress;
+
+		// The descriptor of this frame slot was last read by the frame the slot just finished
+		if (Descriptor.ptr)
+		{
+			D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc{ GPUAddress, SliceSize };
+			Device->CreateConstantBufferView(&cbvDesc, { Descriptor.ptr + frameIndex * DescriptorSize });
+		}
 	}
 
+	// Address of the copy written by the last Tick
+	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const { return GPUAddress; }
+
 public:
 	T CPUData;
 
 private:
-	ID3D12ResourcePtr Buffer;
-	uint8_t* CPUDataBridgePtr;
+	ID3D12Device5Ptr Device;
+	D3D12_CPU_DESCRIPTOR_HANDLE Descriptor{};
+	UINT DescriptorSize = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS GPUAddress = 0;
 };
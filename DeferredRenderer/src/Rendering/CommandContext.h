@@ -0,0 +1,290 @@
+#pragma once
+#include "Core/Core.h"
+#include "Core/Exception.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+// State sets recorded through a context - Issued reached the list, Elided were dropped because
+// the list already had that state. Draws, clears and barriers are not counted
+struct RecordingStats
+{
+	uint32_t Issued = 0;
+	uint32_t Elided = 0;
+
+	RecordingStats& operator+=(const RecordingStats& other)
+	{
+		Issued += other.Issued;
+		Elided += other.Elided;
+		return *this;
+	}
+};
+
+// Non-owning view of the command list a pass records into. Passes, actors and resources take it
+// by reference, so recording a draw never touches the list's reference count - the smart pointer
+// stays with whoever owns the list for the frame.
+// Remembers the state set through it - pipeline, root signatures, descriptor heaps, input assembler,
+// viewports, scissors, render targets and root arguments - and drops sets that would not change
+// anything. Setting a different root signature forgets its root arguments, like the list does.
+// List is ID3D12GraphicsCommandList4 for rendering. Any type with the same methods works, so the
+// filtering can be checked against a list that only records the calls it receives.
+// One context per list, used by one recording thread at a time
+template<typename List>
+class BasicCommandContext
+{
+public:
+	// pipeline: the PSO the list was reset with, if any
+	explicit BasicCommandContext(List* cmdList, ID3D12PipelineState* pipeline = nullptr)
+		:CmdList(cmdList)
+	{
+		Current.PipelineState = pipeline;
+	}
+
+	BasicCommandContext(const BasicCommandContext&) = delete;
+	BasicCommandContext& operator=(const BasicCommandContext&) = delete;
+
+	// Commands the context does not track go straight to the list. Tracked state set this way
+	// bypasses the cache - call Invalidate afterwards
+	inline List* operator->() const { return CmdList; }
+	inline List* Get() const { return CmdList; }
+
+	// The Set methods return true when the call reached the list, false when the state was already set
+	bool SetPipelineState(ID3D12PipelineState* pipeline)
+	{
+		if (!Track(pipeline == Current.PipelineState)) return false;
+
+		CmdList->SetPipelineState(pipeline);
+		Current.PipelineState = pipeline;
+		return true;
+	}
+
+	// Setting the bound signature again would keep the root arguments anyway
+	bool SetGraphicsRootSignature(ID3D12RootSignature* signature)
+	{
+		if (!Track(signature == Current.GraphicsRootSignature)) return false;
+
+		CmdList->SetGraphicsRootSignature(signature);
+		Current.GraphicsRootSignature = signature;
+		Current.GraphicsArguments = {};
+		return true;
+	}
+
+	bool SetComputeRootSignature(ID3D12RootSignature* signature)
+	{
+		if (!Track(signature == Current.ComputeRootSignature)) return false;
+
+		CmdList->SetComputeRootSignature(signature);
+		Current.ComputeRootSignature = signature;
+		Current.ComputeArguments = {};
+		return true;
+	}
+
+	bool SetDescriptorHeaps(ID3D12DescriptorHeap* resources, ID3D12DescriptorHeap* samplers)
+	{
+		std::array<ID3D12DescriptorHeap*, 2> heaps = { resources, samplers };
+		if (!Track(heaps == Current.DescriptorHeaps)) return false;
+
+		CmdList->SetDescriptorHeaps(static_cast<UINT>(heaps.size()), heaps.data());
+		Current.DescriptorHeaps = heaps;
+		return true;
+	}
+
+	bool IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+	{
+		if (!Track(topology == Current.Topology)) return false;
+
+		CmdList->IASetPrimitiveTopology(topology);
+		Current.Topology = topology;
+		return true;
+	}
+
+	// views may be nullptr to unbind the slots
+	bool IASetVertexBuffers(UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views)
+	{
+		ASSERT(startSlot + count <= Current.VertexBuffers.size(), "Vertex buffer slot out of range");
+
+		bool same = true;
+		for (UINT i = 0; i < count && same; i++)
+			same = IsSame(Current.VertexBuffers[startSlot + i], views ? views[i] : D3D12_VERTEX_BUFFER_VIEW{});
+		if (!Track(same)) return false;
+
+		CmdList->IASetVertexBuffers(startSlot, count, views);
+		for (UINT i = 0; i < count; i++)
+			Current.VertexBuffers[startSlot + i] = views ? views[i] : D3D12_VERTEX_BUFFER_VIEW{};
+		return true;
+	}
+
+	bool IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view)
+	{
+		D3D12_INDEX_BUFFER_VIEW next = view ? *view : D3D12_INDEX_BUFFER_VIEW{};
+		if (!Track(IsSame(next, Current.IndexBuffer))) return false;
+
+		CmdList->IASetIndexBuffer(view);
+		Current.IndexBuffer = next;
+		return true;
+	}
+
+	bool RSSetViewports(UINT count, const D3D12_VIEWPORT* viewports)
+	{
+		ASSERT(count <= Current.Viewports.size(), "Too many viewports");
+		if (!Track(count == Current.ViewportCount && IsSame(viewports, Current.Viewports.data(), count))) return false;
+
+		CmdList->RSSetViewports(count, viewports);
+		std::copy_n(viewports, count, Current.Viewports.begin());
+		Current.ViewportCount = count;
+		return true;
+	}
+
+	bool RSSetScissorRects(UINT count, const D3D12_RECT* rects)
+	{
+		ASSERT(count <= Current.ScissorRects.size(), "Too many scissor rects");
+		if (!Track(count == Current.ScissorCount && IsSame(rects, Current.ScissorRects.data(), count))) return false;
+
+		CmdList->RSSetScissorRects(count, rects);
+		std::copy_n(rects, count, Current.ScissorRects.begin());
+		Current.ScissorCount = count;
+		return true;
+	}
+
+	// singleHandle: rtvs points to count consecutive descriptors, only the first handle is read
+	bool OMSetRenderTargets(UINT count, const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, BOOL singleHandle, const D3D12_CPU_DESCRIPTOR_HANDLE* dsv)
+	{
+		ASSERT(count <= Current.RenderTargets.size(), "Too many render targets");
+		UINT handles = singleHandle ? std::min(count, 1u) : count;
+		D3D12_CPU_DESCRIPTOR_HANDLE depth = dsv ? *dsv : D3D12_CPU_DESCRIPTOR_HANDLE{};
+
+		bool same = count == Current.RenderTargetCount && (singleHandle != FALSE) == Current.SingleHandle
+			&& depth.ptr == Current.DepthStencil.ptr && IsSame(rtvs, Current.RenderTargets.data(), handles);
+		if (!Track(same)) return false;
+
+		CmdList->OMSetRenderTargets(count, rtvs, singleHandle, dsv);
+		std::copy_n(rtvs, handles, Current.RenderTargets.begin());
+		Current.RenderTargetCount = count;
+		Current.SingleHandle = singleHandle != FALSE;
+		Current.DepthStencil = depth;
+		return true;
+	}
+
+	bool SetGraphicsRootDescriptorTable(UINT slot, D3D12_GPU_DESCRIPTOR_HANDLE table)
+	{
+		if (!Track(Current.GraphicsArguments.Set(slot, RootArgument::Table, table.ptr))) return false;
+		CmdList->SetGraphicsRootDescriptorTable(slot, table);
+		return true;
+	}
+
+	bool SetComputeRootDescriptorTable(UINT slot, D3D12_GPU_DESCRIPTOR_HANDLE table)
+	{
+		if (!Track(Current.ComputeArguments.Set(slot, RootArgument::Table, table.ptr))) return false;
+		CmdList->SetComputeRootDescriptorTable(slot, table);
+		return true;
+	}
+
+	bool SetGraphicsRootConstantBufferView(UINT slot, D3D12_GPU_VIRTUAL_ADDRESS address)
+	{
+		if (!Track(Current.GraphicsArguments.Set(slot, RootArgument::ConstantBuffer, address))) return false;
+		CmdList->SetGraphicsRootConstantBufferView(slot, address);
+		return true;
+	}
+
+	bool SetComputeRootConstantBufferView(UINT slot, D3D12_GPU_VIRTUAL_ADDRESS address)
+	{
+		if (!Track(Current.ComputeArguments.Set(slot, RootArgument::ConstantBuffer, address))) return false;
+		CmdList->SetComputeRootConstantBufferView(slot, address);
+		return true;
+	}
+
+	bool SetGraphicsRootShaderResourceView(UINT slot, D3D12_GPU_VIRTUAL_ADDRESS address)
+	{
+		if (!Track(Current.GraphicsArguments.Set(slot, RootArgument::ShaderResource, address))) return false;
+		CmdList->SetGraphicsRootShaderResourceView(slot, address);
+		return true;
+	}
+
+	// Only the last value written to a slot is remembered, whatever its offset
+	bool SetGraphicsRoot32BitConstant(UINT slot, UINT value, UINT offset)
+	{
+		uint64_t argument = static_cast<uint64_t>(offset) << 32 | value;
+		if (!Track(Current.GraphicsArguments.Set(slot, RootArgument::Constant, argument))) return false;
+		CmdList->SetGraphicsRoot32BitConstant(slot, value, offset);
+		return true;
+	}
+
+	// For code that set state on the list directly (ImGui) - the next sets go through again
+	inline void Invalidate() { Current = {}; }
+
+	inline const RecordingStats& GetStats() const { return Stats; }
+
+private:
+	enum class RootArgument : uint8_t { Unset, Table, ConstantBuffer, ShaderResource, Constant };
+
+	// Root arguments of one signature, by slot. A signature has at most 64 parameters
+	struct RootArguments
+	{
+		std::array<uint64_t, 64> Values{};
+		std::array<RootArgument, 64> Kinds{};
+
+		// Returns true when the slot already held the argument, stores it otherwise
+		bool Set(UINT slot, RootArgument kind, uint64_t value)
+		{
+			ASSERT(slot < Values.size(), "Root parameter slot out of range");
+			if (Kinds[slot] == kind && Values[slot] == value)
+				return true;
+
+			Kinds[slot] = kind;
+			Values[slot] = value;
+			return false;
+		}
+	};
+
+	inline bool Track(bool redundant)
+	{
+		redundant ? Stats.Elided++ : Stats.Issued++;
+		return !redundant;
+	}
+
+	template<typename T>
+	static bool IsSame(const T& a, const T& b)
+	{
+		return std::memcmp(&a, &b, sizeof(T)) == 0;
+	}
+
+	template<typename T>
+	static bool IsSame(const T* a, const T* b, UINT count)
+	{
+		return count == 0 || std::memcmp(a, b, sizeof(T) * count) == 0;
+	}
+
+	// What the list has set, as far as the context knows. The defaults are those of a freshly reset list
+	struct State
+	{
+		ID3D12PipelineState* PipelineState = nullptr;
+		ID3D12RootSignature* GraphicsRootSignature = nullptr;
+		ID3D12RootSignature* ComputeRootSignature = nullptr;
+		std::array<ID3D12DescriptorHeap*, 2> DescriptorHeaps{};
+
+		D3D12_PRIMITIVE_TOPOLOGY Topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+		std::array<D3D12_VERTEX_BUFFER_VIEW, D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> VertexBuffers{};
+		D3D12_INDEX_BUFFER_VIEW IndexBuffer{};
+
+		std::array<D3D12_VIEWPORT, D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE> Viewports{};
+		std::array<D3D12_RECT, D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE> ScissorRects{};
+		UINT ViewportCount = 0;
+		UINT ScissorCount = 0;
+
+		std::array<D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT> RenderTargets{};
+		D3D12_CPU_DESCRIPTOR_HANDLE DepthStencil{};
+		UINT RenderTargetCount = 0;
+		bool SingleHandle = false;
+
+		RootArguments GraphicsArguments;
+		RootArguments ComputeArguments;
+	};
+
+private:
+	List* CmdList = nullptr;
+	RecordingStats Stats;
+	State Current;
+};
+
+using CommandContext = BasicCommandContext<ID3D12GraphicsCommandList4>;
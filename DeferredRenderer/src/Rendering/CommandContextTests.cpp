@@ -0,0 +1,272 @@
+#include "Test.h"
+#include "RecordingCommandList.h"
+
+#include <chrono>
+#include <iomanip>
+#include <memory>
+
+namespace
+{
+	// The context only compares these and hands them on, they are never dereferenced
+	template<typename T>
+	T* FakeObject(uintptr_t id)
+	{
+		return reinterpret_cast<T*>(id * 0x100);
+	}
+
+	constexpr UINT ActorIndexSlot = 0;
+	constexpr UINT MaterialSlot = 1;
+	constexpr UINT ActorsSlot = 2;
+
+	// What a geometry pass binds: shared buffers and, per actor, its scene index and material
+	struct GeometryBindings
+	{
+		D3D12_VERTEX_BUFFER_VIEW Vertices{ 0x10000, 20 * 100000, 20 };
+		D3D12_INDEX_BUFFER_VIEW Indices{ 0x20000, 2 * 300000, DXGI_FORMAT_R16_UINT };
+		D3D12_GPU_VIRTUAL_ADDRESS Actors = 0x30000;
+	};
+
+	// Actors of one model follow each other and share its material
+	struct SceneShape
+	{
+		uint32_t Actors = 0;
+		uint32_t DrawsPerActor = 0;
+		uint32_t ActorsPerMaterial = 0;
+
+		inline uint64_t GetMaterial(uint32_t actor) const { return 0x40000 + (actor / ActorsPerMaterial) * 64; }
+		inline uint64_t GetDraws() const { return uint64_t(Actors) * DrawsPerActor; }
+	};
+
+	// Recording before the context: every bind took the list by smart pointer - one AddRef and Release
+	// per call, a shared_ptr copy stands in for them - and set the whole state again for every actor
+	void BindActorByPointer(std::shared_ptr<RecordingCommandList> list, const GeometryBindings& bindings, const SceneShape& scene, uint32_t actor)
+	{
+		list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		list->IASetVertexBuffers(0, 1, &bindings.Vertices);
+		list->IASetIndexBuffer(&bindings.Indices);
+		list->SetGraphicsRootShaderResourceView(ActorsSlot, bindings.Actors);
+		list->SetGraphicsRoot32BitConstant(ActorIndexSlot, actor, 0);
+		list->SetGraphicsRootDescriptorTable(MaterialSlot, { scene.GetMaterial(actor) });
+		for (uint32_t draw = 0; draw < scene.DrawsPerActor; draw++)
+			list->DrawIndexedInstanced(96, 1, draw * 96, 0, 0);
+	}
+
+	// The same calls through the context, which drops what the list already has
+	void BindActor(RecordingContext& context, const GeometryBindings& bindings, const SceneShape& scene, uint32_t actor)
+	{
+		context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		context.IASetVertexBuffers(0, 1, &bindings.Vertices);
+		context.IASetIndexBuffer(&bindings.Indices);
+		context.SetGraphicsRootShaderResourceView(ActorsSlot, bindings.Actors);
+		context.SetGraphicsRoot32BitConstant(ActorIndexSlot, actor, 0);
+		context.SetGraphicsRootDescriptorTable(MaterialSlot, { scene.GetMaterial(actor) });
+		for (uint32_t draw = 0; draw < scene.DrawsPerActor; draw++)
+			context->DrawIndexedInstanced(96, 1, draw * 96, 0, 0);
+	}
+
+	template<typename F>
+	double NanosecondsPerDraw(const SceneShape& scene, uint32_t frames, F&& recordFrame)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < frames; frame++)
+			recordFrame();
+		std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+		return time.count() / (double(frames) * scene.GetDraws());
+	}
+}
+
+TEST_CASE(ContextDropsRedundantSetsPerDraw)
+{
+	constexpr uint32_t Frames = 20;
+	const GeometryBindings bindings;
+
+	for (SceneShape scene : { SceneShape{ 10000, 1, 1 }, SceneShape{ 10000, 2, 20 }, SceneShape{ 50000, 3, 100 } })
+	{
+		auto list = std::make_shared<RecordingCommandList>();
+		double byPointer = NanosecondsPerDraw(scene, Frames, [&]()
+			{
+				list->Clear();
+				for (uint32_t actor = 0; actor < scene.Actors; actor++)
+					BindActorByPointer(list, bindings, scene, actor);
+			});
+		size_t pointerCalls = list->Calls.size();
+
+		RecordingStats stats;
+		double byContext = NanosecondsPerDraw(scene, Frames, [&]()
+			{
+				// A context per list and frame, like the render graph makes them
+				list->Clear();
+				RecordingContext context(list.get());
+				for (uint32_t actor = 0; actor < scene.Actors; actor++)
+					BindActor(context, bindings, scene, actor);
+				stats = context.GetStats();
+			});
+		size_t contextCalls = list->Calls.size();
+
+		const double draws = static_cast<double>(scene.GetDraws());
+		std::cout << "    " << std::setw(6) << scene.Actors << " actors, " << scene.DrawsPerActor << " draws each, "
+				  << std::setw(3) << scene.ActorsPerMaterial << " per material: " << std::fixed << std::setprecision(2)
+				  << pointerCalls / draws << " -> " << contextCalls / draws << " list calls per draw ("
+				  << stats.Issued / draws << " issued, " << stats.Elided / draws << " elided), "
+				  << byPointer << " -> " << byContext << " ns per draw\n";
+
+		// Shared state reaches the list once, then only the actor index, material changes and the draws
+		const uint64_t materials = (scene.Actors + scene.ActorsPerMaterial - 1) / scene.ActorsPerMaterial;
+		CHECK_EQ(pointerCalls, scene.Actors * 6ull + scene.GetDraws());
+		CHECK_EQ(stats.Issued, 4 + scene.Actors + materials);
+		CHECK_EQ(stats.Elided, scene.Actors * 6ull - stats.Issued);
+		CHECK_EQ(contextCalls, stats.Issued + scene.GetDraws());
+		CHECK_EQ(list->Count("IASetVertexBuffers"), 1u);
+		CHECK_EQ(list->Count("SetGraphicsRootDescriptorTable"), materials);
+	}
+}
+
+TEST_CASE(RootArgumentsAreForgottenWithTheirSignature)
+{
+	RecordingCommandList list;
+	RecordingContext context(&list);
+	auto* first = FakeObject<ID3D12RootSignature>(1);
+	auto* second = FakeObject<ID3D12RootSignature>(2);
+
+	CHECK(context.SetGraphicsRootSignature(first));
+	CHECK(context.SetGraphicsRootDescriptorTable(0, { 0x1000 }));
+	CHECK(!context.SetGraphicsRootDescriptorTable(0, { 0x1000 }));
+
+	// Setting the bound signature again keeps its arguments
+	CHECK(!context.SetGraphicsRootSignature(first));
+	CHECK(!context.SetGraphicsRootDescriptorTable(0, { 0x1000 }));
+
+	// A compute signature leaves the graphics arguments alone
+	CHECK(context.SetComputeRootSignature(first));
+	CHECK(!context.SetGraphicsRootDescriptorTable(0, { 0x1000 }));
+	CHECK(context.SetComputeRootDescriptorTable(0, { 0x1000 }));
+
+	// Another signature starts with no arguments set
+	CHECK(context.SetGraphicsRootSignature(second));
+	CHECK(context.SetGraphicsRootDescriptorTable(0, { 0x1000 }));
+	CHECK_EQ(list.RootArgument, 0x1000u);
+	CHECK(!context.SetComputeRootDescriptorTable(0, { 0x1000 }));
+
+	// Same slot and value as another kind of argument, or a constant at another offset, is a change
+	CHECK(context.SetGraphicsRootConstantBufferView(1, 0x2000));
+	CHECK(context.SetGraphicsRootShaderResourceView(1, 0x2000));
+	CHECK(context.SetGraphicsRoot32BitConstant(2, 7, 0));
+	CHECK(!context.SetGraphicsRoot32BitConstant(2, 7, 0));
+	CHECK(context.SetGraphicsRoot32BitConstant(2, 7, 1));
+	CHECK_EQ(list.RootArgument, 7u);
+
+	CHECK_THROWS(context.SetGraphicsRootDescriptorTable(64, { 0x1000 }));
+
+	CHECK_EQ(list.Count("SetGraphicsRootSignature"), 2u);
+	CHECK_EQ(list.Count("SetGraphicsRootDescriptorTable"), 2u);
+	CHECK_EQ(context.GetStats().Issued + context.GetStats().Elided, 16u);
+}
+
+TEST_CASE(SingleHandleRenderTargetsCompareOnlyTheFirstHandle)
+{
+	RecordingCommandList list;
+	RecordingContext context(&list);
+	D3D12_CPU_DESCRIPTOR_HANDLE targets[] = { { 0x100 }, { 0x200 }, { 0x300 } };
+	D3D12_CPU_DESCRIPTOR_HANDLE depth{ 0x900 };
+
+	// Three consecutive descriptors from the first handle - the array behind it is not read
+	CHECK(context.OMSetRenderTargets(3, targets, TRUE, &depth));
+	CHECK_EQ(list.SingleHandle, TRUE);
+	targets[1].ptr = 0x250;
+	CHECK(!context.OMSetRenderTargets(3, targets, TRUE, &depth));
+
+	// The same handles as separate descriptors are a change, then every handle counts
+	CHECK(context.OMSetRenderTargets(3, targets, FALSE, &depth));
+	CHECK_EQ(list.SingleHandle, FALSE);
+	CHECK(!context.OMSetRenderTargets(3, targets, FALSE, &depth));
+	targets[2].ptr = 0x350;
+	CHECK(context.OMSetRenderTargets(3, targets, FALSE, &depth));
+
+	// ... and so do the target count and the depth buffer
+	CHECK(context.OMSetRenderTargets(2, targets, FALSE, &depth));
+	CHECK(context.OMSetRenderTargets(2, targets, FALSE, nullptr));
+	CHECK(!context.OMSetRenderTargets(2, targets, FALSE, nullptr));
+
+	// Depth only
+	CHECK(context.OMSetRenderTargets(0, nullptr, FALSE, &depth));
+	CHECK(!context.OMSetRenderTargets(0, nullptr, FALSE, &depth));
+
+	CHECK_EQ(list.Count("OMSetRenderTargets"), 6u);
+	CHECK_EQ(context.GetStats().Elided, 4u);
+	CHECK_THROWS(context.OMSetRenderTargets(D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT + 1, targets, TRUE, nullptr));
+}
+
+TEST_CASE(NullVertexBuffersUnbindTheirSlots)
+{
+	RecordingCommandList list;
+	RecordingContext context(&list);
+	D3D12_VERTEX_BUFFER_VIEW views[] = { { 0x1000, 256, 16 }, { 0x2000, 512, 8 } };
+
+	// A fresh list has nothing bound
+	CHECK(!context.IASetVertexBuffers(0, 2, nullptr));
+
+	CHECK(context.IASetVertexBuffers(0, 2, views));
+	CHECK_EQ(list.VertexBuffers.size(), 2u);
+	CHECK(!context.IASetVertexBuffers(1, 1, &views[1]));
+
+	CHECK(context.IASetVertexBuffers(0, 2, nullptr));
+	CHECK(list.NullVertexBuffers);
+	CHECK(list.VertexBuffers.empty());
+	CHECK(!context.IASetVertexBuffers(0, 1, nullptr));
+
+	// Only the slot set again is bound
+	CHECK(context.IASetVertexBuffers(1, 1, &views[1]));
+	CHECK(!list.NullVertexBuffers);
+	CHECK(!context.IASetVertexBuffers(1, 1, &views[1]));
+	CHECK(context.IASetVertexBuffers(0, 1, &views[1]));
+
+	CHECK_EQ(list.Count("IASetVertexBuffers"), 4u);
+	CHECK_THROWS(context.IASetVertexBuffers(D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT, 1, views));
+}
+
+TEST_CASE(InvalidateSendsEverythingAgain)
+{
+	RecordingCommandList list;
+	auto* pipeline = FakeObject<ID3D12PipelineState>(1);
+	auto* signature = FakeObject<ID3D12RootSignature>(2);
+	auto* resources = FakeObject<ID3D12DescriptorHeap>(3);
+	auto* samplers = FakeObject<ID3D12DescriptorHeap>(4);
+	D3D12_VERTEX_BUFFER_VIEW vertices{ 0x1000, 256, 16 };
+	D3D12_INDEX_BUFFER_VIEW indices{ 0x2000, 128, DXGI_FORMAT_R16_UINT };
+	D3D12_VIEWPORT viewport{ 0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 1.0f };
+	D3D12_RECT scissor{ 0, 0, 1920, 1080 };
+	D3D12_CPU_DESCRIPTOR_HANDLE target{ 0x100 };
+
+	// The list was reset with the pipeline, setting it is redundant right away
+	RecordingContext context(&list, pipeline);
+	CHECK(!context.SetPipelineState(pipeline));
+
+	auto setAll = [&]()
+		{
+			size_t issued = 0;
+			issued += context.SetPipelineState(FakeObject<ID3D12PipelineState>(5));
+			issued += context.SetGraphicsRootSignature(signature);
+			issued += context.SetDescriptorHeaps(resources, samplers);
+			issued += context.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			issued += context.IASetVertexBuffers(0, 1, &vertices);
+			issued += context.IASetIndexBuffer(&indices);
+			issued += context.RSSetViewports(1, &viewport);
+			issued += context.RSSetScissorRects(1, &scissor);
+			issued += context.OMSetRenderTargets(1, &target, FALSE, nullptr);
+			issued += context.SetGraphicsRoot32BitConstant(0, 1, 0);
+			return issued;
+		};
+
+	CHECK_EQ(setAll(), 10u);
+	CHECK_EQ(setAll(), 0u);
+
+	// State set on the list behind the context's back, e.g. by ImGui
+	list.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	context.Invalidate();
+	CHECK_EQ(setAll(), 10u);
+
+	// Counters survive the invalidation
+	CHECK_EQ(context.GetStats().Issued, 20u);
+	CHECK_EQ(context.GetStats().Elided, 11u);
+	CHECK_EQ(list.Calls.size(), 21u);
+}
@@ -0,0 +1,28 @@
+#include "CommandListPool.h"
+#include "Core/Exception.h"
+
+CommandListPool::CommandListPool(ID3D12Device5Ptr device, D3D12_COMMAND_LIST_TYPE type)
+	:Device(device), Type(type)
+{}
+
+void CommandListPool::BeginFrame(uint32_t frameIndex, size_t count)
+{
+	while (Entries.size() < count)
+	{
+		auto& entry = Entries.emplace_back();
+		for (auto& allocator : entry.Allocators)
+			GRAPHICS_ASSERT(Device->CreateCommandAllocator(Type, IID_PPV_ARGS(&allocator)));
+
+		// Created closed, every frame starts with a Reset
+		GRAPHICS_ASSERT(Device->CreateCommandList1(0, Type, D3D12_COMMAND_LIST_FLAG_NONE, IID_PPV_ARGS(&entry.CmdList)));
+	}
+
+	ActiveLists.clear();
+	for (size_t i = 0; i < count; i++)
+	{
+		auto& entry = Entries[i];
+		GRAPHICS_ASSERT(entry.Allocators[frameIndex]->Reset());
+		GRAPHICS_ASSERT(entry.CmdList->Reset(entry.Allocators[frameIndex], nullptr));
+		ActiveLists.push_back(entry.CmdList);
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "Core/Core.h"
+
+// Command lists for parallel recording. Every list owns one allocator per frame slot, which is only
+// reset once the GPU finished the frame that last recorded into that slot
+class CommandListPool
+{
+public:
+	CommandListPool(ID3D12Device5Ptr device, D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+	// Grows the pool to count lists and resets them against the allocators of frameIndex.
+	// Called from a single thread before recording starts
+	void BeginFrame(uint32_t frameIndex, size_t count);
+
+	// Each list is recorded by one thread at a time
+	inline const ID3D12GraphicsCommandList4Ptr& Get(size_t index) const { return ActiveLists[index]; }
+	// Lists reset by the last BeginFrame, in index order
+	inline const std::vector<ID3D12GraphicsCommandList4Ptr>& GetActiveLists() const { return ActiveLists; }
+
+private:
+	struct Entry
+	{
+		std::array<ID3D12CommandAllocatorPtr, DefaultSwapChainBuffers> Allocators;
+		ID3D12GraphicsCommandList4Ptr CmdList;
+	};
+
+	ID3D12Device5Ptr Device;
+	D3D12_COMMAND_LIST_TYPE Type;
+	std::vector<Entry> Entries;
+	std::vector<ID3D12GraphicsCommandList4Ptr> ActiveLists;
+};
@@ -0,0 +1,72 @@
+#include "CommandSubmitter.h"
+#include "Core/Exception.h"
+#include "Rendering/Resources.h"
+#include "Rendering/Utils.h"
+
+uint64_t QueueSubmitter::Submit(ID3D12GraphicsCommandList4Ptr cmdList)
+{
+	Stats.Submits++;
+	Stats.Signals++;
+	Globals.FenceValue = D3D::SubmitCommandList(cmdList, Globals.CmdQueue, Globals.Fence, Globals.FenceValue);
+	return Globals.FenceValue;
+}
+
+uint64_t QueueSubmitter::Submit(QueueType queue, const std::vector<ID3D12GraphicsCommandList4Ptr>& cmdLists)
+{
+	Stats.Submits++;
+	Stats.Signals++;
+	if (queue == QueueType::Compute)
+	{
+		Globals.ComputeFenceValue = D3D::SubmitCommandLists(cmdLists, Globals.ComputeQueue, Globals.ComputeFence, Globals.ComputeFenceValue);
+		return Globals.ComputeFenceValue;
+	}
+
+	Globals.FenceValue = D3D::SubmitCommandLists(cmdLists, Globals.CmdQueue, Globals.Fence, Globals.FenceValue);
+	return Globals.FenceValue;
+}
+
+void QueueSubmitter::QueueWait(QueueType queue, QueueType other, uint64_t value)
+{
+	Stats.QueueWaits++;
+	auto waiting = queue == QueueType::Compute ? Globals.ComputeQueue : Globals.CmdQueue;
+	auto fence = other == QueueType::Compute ? Globals.ComputeFence : Globals.Fence;
+	GRAPHICS_ASSERT(waiting->Wait(fence, value));
+}
+
+void QueueSubmitter::Wait(uint64_t value)
+{
+	if (Globals.Fence->GetCompletedValue() >= value) return;
+
+	Stats.Waits++;
+	D3D::WaitForFence(Globals.Fence, value, Globals.FenceEvent);
+}
+
+void SubmitFrame(CommandSubmitter& submitter, SubmissionMode mode, size_t passCount,
+				 const std::function<ID3D12GraphicsCommandList4Ptr(size_t first, size_t count)>& record)
+{
+	ASSERT(mode != SubmissionMode::Parallel, "Parallel frames are submitted along their queue timeline");
+
+	if (mode == SubmissionMode::SingleList)
+	{
+		// Frame completion is tracked by the caller through the returned fence value
+		submitter.Submit(record(0, passCount));
+		return;
+	}
+
+	// Synchronize before the list and its allocator are reset for the next pass
+	for (size_t pass = 0; pass < passCount; pass++)
+		submitter.Wait(submitter.Submit(record(pass, 1)));
+}
+
+void SubmitTimeline(CommandSubmitter& submitter, const QueueTimeline& timeline, std::vector<uint64_t>& fences,
+					const std::function<const std::vector<ID3D12GraphicsCommandList4Ptr>&(size_t submission)>& lists)
+{
+	fences.resize(timeline.Submissions.size());
+	for (size_t i = 0; i < timeline.Submissions.size(); i++)
+	{
+		const auto& submission = timeline.Submissions[i];
+		if (submission.WaitFor)
+			submitter.QueueWait(submission.Queue, timeline.Submissions[*submission.WaitFor].Queue, fences[*submission.WaitFor]);
+		fences[i] = submitter.Submit(submission.Queue, lists(i));
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "Core/Core.h"
+#include "QueueSchedule.h"
+
+enum class SubmissionMode
+{
+	PerPass,	// Submit and wait for the GPU after every pass - isolates GPU faults to a single pass
+	SingleList,	// Record the whole frame into one command list and signal the fence once
+	Parallel	// Record runs of passes, and chunks of large passes, on worker threads into separate command lists
+				// submitted in execution order. Compute passes run on the compute queue. Barriers are only split
+				// within a list
+};
+
+struct SubmissionStats
+{
+	uint32_t Submits = 0;
+	uint32_t Signals = 0;		// Fence signals - every submission signals its queue's fence once
+	uint32_t Waits = 0;			// CPU waits that blocked on the GPU
+	uint32_t QueueWaits = 0;	// GPU-side waits between the graphics and compute queues
+};
+
+// Boundary between command recording and queue execution.
+// The render graph only talks to the queue through this interface, so the
+// frame loop can be driven by a recording stand-in that just counts calls
+class CommandSubmitter
+{
+public:
+	virtual ~CommandSubmitter() = default;
+
+	// Closes and executes cmdList - returns the fence value signaled after it
+	virtual uint64_t Submit(ID3D12GraphicsCommandList4Ptr cmdList) = 0;
+	// Closes and executes cmdLists in order on queue with a single ExecuteCommandLists call -
+	// returns the value signaled on that queue's fence
+	virtual uint64_t Submit(QueueType queue, const std::vector<ID3D12GraphicsCommandList4Ptr>& cmdLists) = 0;
+	// Makes queue wait on the GPU until the fence of the other queue reached value
+	virtual void QueueWait(QueueType queue, QueueType other, uint64_t value) = 0;
+	// Blocks the CPU until the fence has reached value
+	virtual void Wait(uint64_t value) = 0;
+
+	inline const SubmissionStats& GetStats() const { return Stats; }
+	inline void ResetStats() { Stats = {}; }
+
+protected:
+	SubmissionStats Stats;
+};
+
+// Submits to Globals.CmdQueue and synchronizes through Globals.Fence.
+// Compute work goes to Globals.ComputeQueue and Globals.ComputeFence
+class QueueSubmitter : public CommandSubmitter
+{
+public:
+	uint64_t Submit(ID3D12GraphicsCommandList4Ptr cmdList) override;
+	uint64_t Submit(QueueType queue, const std::vector<ID3D12GraphicsCommandList4Ptr>& cmdLists) override;
+	void QueueWait(QueueType queue, QueueType other, uint64_t value) override;
+	void Wait(uint64_t value) override;
+};
+
+// Fence values of the frames in flight, one per swap chain buffer. A frame only waits for the frame
+// that last recorded into its slot, so the CPU records frame N + 1 while the GPU executes frame N
+class FrameFences
+{
+public:
+	// Blocks until the GPU finished the frame that last used slot
+	inline void WaitForSlot(CommandSubmitter& submitter, uint32_t slot) const { submitter.Wait(Values[slot]); }
+	// fenceValue: signaled once the GPU is done with the frame recorded into slot
+	inline void EndFrame(uint32_t slot, uint64_t fenceValue) { Values[slot] = fenceValue; }
+
+private:
+	std::array<uint64_t, DefaultSwapChainBuffers> Values{};
+};
+
+// Stand-in for the queues that executes nothing - a submission counts as complete once it was waited for.
+// Drives the frame loop and the submission patterns without a device
+class RecordingSubmitter : public CommandSubmitter
+{
+public:
+	inline uint64_t Submit(ID3D12GraphicsCommandList4Ptr) override { return Signal(QueueType::Graphics); }
+	inline uint64_t Submit(QueueType queue, const std::vector<ID3D12GraphicsCommandList4Ptr>&) override { return Signal(queue); }
+	inline void QueueWait(QueueType, QueueType, uint64_t) override { Stats.QueueWaits++; }
+
+	inline void Wait(uint64_t value) override
+	{
+		if (Completed >= value) return;
+
+		Stats.Waits++;
+		Completed = value;
+	}
+
+	// Last value signaled on the fence of queue
+	inline uint64_t GetSignaled(QueueType queue) const { return Signaled[static_cast<size_t>(queue)]; }
+
+private:
+	inline uint64_t Signal(QueueType queue)
+	{
+		Stats.Submits++;
+		Stats.Signals++;
+		return ++Signaled[static_cast<size_t>(queue)];
+	}
+
+private:
+	std::array<uint64_t, 2> Signaled{};
+	// Of the graphics fence, the one Wait blocks on
+	uint64_t Completed = 0;
+};
+
+// Submission pattern of the PerPass and SingleList modes, apart from the recording so it can run against
+// a RecordingSubmitter. record(first, count) records the passes [first, first + count) into a freshly reset
+// list and returns it - the final barrier layer goes with the last pass.
+// PerPass submits every pass on its own and waits for it, SingleList submits the frame once without waiting
+void SubmitFrame(CommandSubmitter& submitter, SubmissionMode mode, size_t passCount,
+				 const std::function<ID3D12GraphicsCommandList4Ptr(size_t first, size_t count)>& record);
+
+// Submission pattern of the Parallel mode - every submission of the timeline in order, each after the GPU wait
+// the schedule asks for. lists(i) returns the recorded lists of submission i, fences receives the value
+// every submission signaled on its queue
+void SubmitTimeline(CommandSubmitter& submitter, const QueueTimeline& timeline, std::vector<uint64_t>& fences,
+					const std::function<const std::vector<ID3D12GraphicsCommandList4Ptr>&(size_t submission)>& lists);
@@ -0,0 +1,202 @@
+#include "Test.h"
+#include "Rendering/CommandSubmitter.h"
+
+#include <algorithm>
+
+namespace
+{
+	constexpr size_t PassCount = 9;
+	constexpr size_t FrameCount = 3;
+
+	struct FrameRun
+	{
+		std::vector<SubmissionStats> Frames;
+		// Passes recorded into each list, as (first, count)
+		std::vector<std::pair<size_t, size_t>> Lists;
+	};
+
+	// The frame loop of RenderGraph::Execute without the recording
+	FrameRun RunFrames(SubmissionMode mode)
+	{
+		RecordingSubmitter submitter;
+		FrameRun run;
+		for (size_t frame = 0; frame < FrameCount; frame++)
+		{
+			submitter.ResetStats();
+			SubmitFrame(submitter, mode, PassCount, [&run](size_t first, size_t count)
+						{
+							run.Lists.emplace_back(first, count);
+							return ID3D12GraphicsCommandList4Ptr();
+						});
+			run.Frames.push_back(submitter.GetStats());
+		}
+		return run;
+	}
+}
+
+TEST_CASE(PerPassSubmitsAndWaitsForEveryPass)
+{
+	auto run = RunFrames(SubmissionMode::PerPass);
+
+	for (const auto& stats : run.Frames)
+	{
+		CHECK_EQ(stats.Submits, PassCount);
+		CHECK_EQ(stats.Signals, PassCount);
+		CHECK_EQ(stats.Waits, PassCount);
+		CHECK_EQ(stats.QueueWaits, 0u);
+	}
+
+	REQUIRE(run.Lists.size() == PassCount * FrameCount);
+	for (size_t i = 0; i < run.Lists.size(); i++)
+		CHECK(run.Lists[i] == std::make_pair(i % PassCount, size_t(1)));
+}
+
+TEST_CASE(SingleListSubmitsOncePerFrameWithoutWaiting)
+{
+	auto run = RunFrames(SubmissionMode::SingleList);
+
+	for (const auto& stats : run.Frames)
+	{
+		CHECK_EQ(stats.Submits, 1u);
+		CHECK_EQ(stats.Signals, 1u);
+		// The frame loop waits for the frame slot, never the graph
+		CHECK_EQ(stats.Waits, 0u);
+	}
+
+	REQUIRE(run.Lists.size() == FrameCount);
+	for (const auto& list : run.Lists)
+		CHECK(list == std::make_pair(size_t(0), PassCount));
+}
+
+TEST_CASE(RecordingSubmitterOnlyWaitsForIncompleteValues)
+{
+	RecordingSubmitter submitter;
+	uint64_t first = submitter.Submit(nullptr);
+	uint64_t second = submitter.Submit(nullptr);
+	CHECK_EQ(second, first + 1);
+
+	submitter.Wait(second);
+	submitter.Wait(first);
+	submitter.Wait(second);
+	CHECK_EQ(submitter.GetStats().Waits, 1u);
+
+	// Compute submissions signal their own fence
+	CHECK_EQ(submitter.Submit(QueueType::Compute, {}), 1u);
+	CHECK_EQ(submitter.GetSignaled(QueueType::Graphics), second);
+	CHECK_EQ(submitter.GetStats().Signals, 3u);
+}
+
+namespace
+{
+	// A queue executing one frame at a time in simulated milliseconds. Submit queues the frame behind the
+	// previous one, Wait moves the CPU clock to the completion of the frame it waits for
+	class SimulatedQueue : public CommandSubmitter
+	{
+	public:
+		explicit SimulatedQueue(float gpuFrameMs) :GpuFrameMs(gpuFrameMs) {}
+
+		uint64_t Submit(ID3D12GraphicsCommandList4Ptr) override
+		{
+			Stats.Submits++;
+			Stats.Signals++;
+			float start = std::max(Now, GpuIdle);
+			GpuIdle = start + GpuFrameMs;
+			Starts.push_back(start);
+			Completions.push_back(GpuIdle);
+			return Completions.size();
+		}
+
+		uint64_t Submit(QueueType, const std::vector<ID3D12GraphicsCommandList4Ptr>& cmdLists) override
+		{
+			return Submit(cmdLists.empty() ? nullptr : cmdLists.front());
+		}
+
+		void QueueWait(QueueType, QueueType, uint64_t) override { Stats.QueueWaits++; }
+
+		void Wait(uint64_t value) override
+		{
+			if (value == 0 || Completions[value - 1] <= Now) return;
+
+			Stats.Waits++;
+			Now = Completions[value - 1];
+		}
+
+		float Now = 0.0f;	// CPU clock
+		std::vector<float> Starts;		// GPU start of every submitted frame
+		std::vector<float> Completions;	// GPU end of every submitted frame
+
+	private:
+		float GpuFrameMs = 0.0f;
+		float GpuIdle = 0.0f;
+	};
+
+	struct FrameTimeline
+	{
+		std::vector<float> RecordStarts;	// CPU
+		std::vector<float> GpuStarts;
+		std::vector<float> GpuEnds;
+		uint32_t Waits = 0;
+
+		// Between the ends of the last two frames on the GPU
+		float GetFrameMs() const { return GpuEnds.back() - GpuEnds[GpuEnds.size() - 2]; }
+	};
+
+	// The loop of Graphics::Tick - wait for the slot, record, submit. slots = 1 is the old lockstep loop
+	FrameTimeline SimulateFrames(uint32_t slots, float cpuFrameMs, float gpuFrameMs, size_t frames = 12)
+	{
+		SimulatedQueue queue(gpuFrameMs);
+		FrameFences fences;
+		FrameTimeline timeline;
+		for (size_t frame = 0; frame < frames; frame++)
+		{
+			uint32_t slot = static_cast<uint32_t>(frame % slots);
+			fences.WaitForSlot(queue, slot);
+
+			timeline.RecordStarts.push_back(queue.Now);
+			queue.Now += cpuFrameMs;
+			fences.EndFrame(slot, queue.Submit(nullptr));
+		}
+
+		timeline.GpuStarts = queue.Starts;
+		timeline.GpuEnds = queue.Completions;
+		timeline.Waits = queue.GetStats().Waits;
+		return timeline;
+	}
+}
+
+TEST_CASE(FramesInFlightOverlapRecordingWithExecution)
+{
+	auto timeline = SimulateFrames(DefaultSwapChainBuffers, 4.0f, 6.0f);
+
+	// The CPU starts frame N + 1 before the GPU finished frame N, and the GPU never idles between frames
+	for (size_t frame = 0; frame + 1 < timeline.GpuEnds.size(); frame++)
+	{
+		CHECK(timeline.RecordStarts[frame + 1] < timeline.GpuEnds[frame]);
+		CHECK_NEAR(timeline.GpuStarts[frame + 1], timeline.GpuEnds[frame], 1e-3f);
+	}
+	// GPU bound - a frame costs the GPU time, the CPU waits for the oldest slot
+	CHECK_NEAR(timeline.GetFrameMs(), 6.0f, 1e-3f);
+	CHECK(timeline.Waits > 0);
+
+	for (size_t frame = 0; frame < timeline.GpuEnds.size(); frame++)
+		std::cout << "    frame " << frame << ": cpu " << timeline.RecordStarts[frame] << "-" << timeline.RecordStarts[frame] + 4.0f
+				  << " gpu " << timeline.GpuStarts[frame] << "-" << timeline.GpuEnds[frame] << "\n";
+}
+
+TEST_CASE(FramesInFlightHideTheGpuWhenCpuBound)
+{
+	auto timeline = SimulateFrames(DefaultSwapChainBuffers, 6.0f, 4.0f);
+
+	CHECK_NEAR(timeline.GetFrameMs(), 6.0f, 1e-3f);
+	CHECK_EQ(timeline.Waits, 0u);
+}
+
+TEST_CASE(SingleSlotRunsInLockstep)
+{
+	auto timeline = SimulateFrames(1, 4.0f, 6.0f);
+
+	// Every frame waits for the previous one - CPU and GPU time add up
+	for (size_t frame = 0; frame + 1 < timeline.GpuEnds.size(); frame++)
+		CHECK(timeline.RecordStarts[frame + 1] >= timeline.GpuEnds[frame]);
+	CHECK_NEAR(timeline.GetFrameMs(), 10.0f, 1e-3f);
+}
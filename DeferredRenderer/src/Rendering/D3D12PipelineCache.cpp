@@ -0,0 +1,295 @@
+#include "D3D12PipelineCache.h"
+#include "Core/Exception.h"
+
+namespace
+{
+	// The handle owns one reference of the pipeline
+	PipelineHandle ToHandle(ID3D12PipelineStatePtr pipeline)
+	{
+		if (!pipeline) return nullptr;
+		return PipelineHandle(pipeline.Detach(), [](void* state) { static_cast<ID3D12PipelineState*>(state)->Release(); });
+	}
+
+	ID3D12PipelineStatePtr ToPipelineState(const PipelineHandle& pipeline)
+	{
+		// Takes a reference of its own
+		return ID3D12PipelineStatePtr(static_cast<ID3D12PipelineState*>(pipeline.get()));
+	}
+}
+
+void PipelineHasher::Add(const D3D12_SHADER_BYTECODE& bytecode)
+{
+	Add(bytecode.BytecodeLength);
+	Add(bytecode.pShaderBytecode, bytecode.pShaderBytecode ? bytecode.BytecodeLength : 0);
+}
+
+void PipelineHasher::Add(const D3D12_ROOT_SIGNATURE_DESC& desc)
+{
+	Add(desc.Flags);
+	Add(desc.NumParameters);
+	for (UINT i = 0; i < desc.NumParameters; i++)
+	{
+		const auto& param = desc.pParameters[i];
+		Add(param.ParameterType);
+		Add(param.ShaderVisibility);
+
+		switch (param.ParameterType)
+		{
+		case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+			Add(param.DescriptorTable.NumDescriptorRanges);
+			for (UINT r = 0; r < param.DescriptorTable.NumDescriptorRanges; r++)
+			{
+				const auto& range = param.DescriptorTable.pDescriptorRanges[r];
+				Add(range.RangeType);
+				Add(range.NumDescriptors);
+				Add(range.BaseShaderRegister);
+				Add(range.RegisterSpace);
+				Add(range.OffsetInDescriptorsFromTableStart);
+			}
+			break;
+		case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+			Add(param.Constants.Num32BitValues);
+			Add(param.Constants.ShaderRegister);
+			Add(param.Constants.RegisterSpace);
+			break;
+		default:
+			Add(param.Descriptor.ShaderRegister);
+			Add(param.Descriptor.RegisterSpace);
+			break;
+		}
+	}
+
+	Add(desc.NumStaticSamplers);
+	for (UINT i = 0; i < desc.NumStaticSamplers; i++)
+	{
+		const auto& sampler = desc.pStaticSamplers[i];
+		Add(sampler.Filter);
+		Add(sampler.AddressU);
+		Add(sampler.AddressV);
+		Add(sampler.AddressW);
+		Add(sampler.MipLODBias);
+		Add(sampler.MaxAnisotropy);
+		Add(sampler.ComparisonFunc);
+		Add(sampler.BorderColor);
+		Add(sampler.MinLOD);
+		Add(sampler.MaxLOD);
+		Add(sampler.ShaderRegister);
+		Add(sampler.RegisterSpace);
+		Add(sampler.ShaderVisibility);
+	}
+}
+
+void PipelineHasher::Add(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+	Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_VS);
+	Add(rootSignatureHash);
+	Add(desc.VS);
+	Add(desc.PS);
+	Add(desc.DS);
+	Add(desc.HS);
+	Add(desc.GS);
+
+	Add(desc.StreamOutput.NumEntries);
+	for (UINT i = 0; i < desc.StreamOutput.NumEntries; i++)
+	{
+		const auto& entry = desc.StreamOutput.pSODeclaration[i];
+		Add(entry.Stream);
+		Add(entry.SemanticName);
+		Add(entry.SemanticIndex);
+		Add(entry.StartComponent);
+		Add(entry.ComponentCount);
+		Add(entry.OutputSlot);
+	}
+	Add(desc.StreamOutput.NumStrides);
+	Add(desc.StreamOutput.pBufferStrides, sizeof(UINT) * desc.StreamOutput.NumStrides);
+	Add(desc.StreamOutput.RasterizedStream);
+
+	Add(desc.BlendState.AlphaToCoverageEnable);
+	Add(desc.BlendState.IndependentBlendEnable);
+	for (const auto& target : desc.BlendState.RenderTarget)
+	{
+		Add(target.BlendEnable);
+		Add(target.LogicOpEnable);
+		Add(target.SrcBlend);
+		Add(target.DestBlend);
+		Add(target.BlendOp);
+		Add(target.SrcBlendAlpha);
+		Add(target.DestBlendAlpha);
+		Add(target.BlendOpAlpha);
+		Add(target.LogicOp);
+		Add(target.RenderTargetWriteMask);
+	}
+	Add(desc.SampleMask);
+
+	const auto& raster = desc.RasterizerState;
+	Add(raster.FillMode);
+	Add(raster.CullMode);
+	Add(raster.FrontCounterClockwise);
+	Add(raster.DepthBias);
+	Add(raster.DepthBiasClamp);
+	Add(raster.SlopeScaledDepthBias);
+	Add(raster.DepthClipEnable);
+	Add(raster.MultisampleEnable);
+	Add(raster.AntialiasedLineEnable);
+	Add(raster.ForcedSampleCount);
+	Add(raster.ConservativeRaster);
+
+	const auto& depth = desc.DepthStencilState;
+	Add(depth.DepthEnable);
+	Add(depth.DepthWriteMask);
+	Add(depth.DepthFunc);
+	Add(depth.StencilEnable);
+	Add(depth.StencilReadMask);
+	Add(depth.StencilWriteMask);
+	for (const auto& face : { depth.FrontFace, depth.BackFace })
+	{
+		Add(face.StencilFailOp);
+		Add(face.StencilDepthFailOp);
+		Add(face.StencilPassOp);
+		Add(face.StencilFunc);
+	}
+
+	Add(desc.InputLayout.NumElements);
+	for (UINT i = 0; i < desc.InputLayout.NumElements; i++)
+	{
+		const auto& element = desc.InputLayout.pInputElementDescs[i];
+		Add(element.SemanticName);
+		Add(element.SemanticIndex);
+		Add(element.Format);
+		Add(element.InputSlot);
+		Add(element.AlignedByteOffset);
+		Add(element.InputSlotClass);
+		Add(element.InstanceDataStepRate);
+	}
+
+	Add(desc.IBStripCutValue);
+	Add(desc.PrimitiveTopologyType);
+	Add(desc.NumRenderTargets);
+	for (UINT i = 0; i < desc.NumRenderTargets; i++)
+		Add(desc.RTVFormats[i]);
+	Add(desc.DSVFormat);
+	Add(desc.SampleDesc.Count);
+	Add(desc.SampleDesc.Quality);
+	Add(desc.NodeMask);
+	Add(desc.Flags);
+}
+
+void PipelineHasher::Add(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+	Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_CS);
+	Add(rootSignatureHash);
+	Add(desc.CS);
+	Add(desc.NodeMask);
+	Add(desc.Flags);
+}
+
+D3D12PipelineBackend::D3D12PipelineBackend(ID3D12Device5Ptr device)
+	:Device(device)
+{
+	IDXGIFactory4Ptr factory;
+	IDXGIAdapter1Ptr adapter;
+	GRAPHICS_ASSERT(CreateDXGIFactory1(IID_PPV_ARGS(&factory)));
+	GRAPHICS_ASSERT(factory->EnumAdapterByLuid(Device->GetAdapterLuid(), IID_PPV_ARGS(&adapter)));
+
+	DXGI_ADAPTER_DESC1 desc{};
+	GRAPHICS_ASSERT(adapter->GetDesc1(&desc));
+	Identity.VendorId = desc.VendorId;
+	Identity.DeviceId = desc.DeviceId;
+
+	// Only answered for IDXGIDevice, with the version of the user mode driver
+	LARGE_INTEGER driverVersion{};
+	if (SUCCEEDED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion)))
+		Identity.DriverVersion = static_cast<uint64_t>(driverVersion.QuadPart);
+
+	HRESULT hr = CreateLibrary();
+	if (hr == DXGI_ERROR_UNSUPPORTED)
+		Library = nullptr;
+	else
+		GRAPHICS_ASSERT(hr);
+}
+
+HRESULT D3D12PipelineBackend::CreateLibrary()
+{
+	Library = nullptr;
+	return Device->CreatePipelineLibrary(Blob.data(), Blob.size(), IID_PPV_ARGS(&Library));
+}
+
+bool D3D12PipelineBackend::Deserialize(std::vector<uint8_t> blob)
+{
+	// Without library support there is nothing to read into
+	if (!Library) return false;
+
+	Blob = std::move(blob);
+	HRESULT hr = CreateLibrary();
+
+	// The identity in the file header catches other adapters and drivers, but the driver has the last word
+	if (hr == D3D12_ERROR_DRIVER_VERSION_MISMATCH || hr == D3D12_ERROR_ADAPTER_NOT_FOUND || hr == E_INVALIDARG)
+	{
+		Blob.clear();
+		GRAPHICS_ASSERT(CreateLibrary());
+		return false;
+	}
+
+	GRAPHICS_ASSERT(hr);
+	return true;
+}
+
+PipelineHandle D3D12PipelineBackend::Load(const std::wstring& name, const PipelineRequest& request)
+{
+	if (!Library) return nullptr;
+
+	ID3D12PipelineStatePtr pipeline;
+	// E_INVALIDARG when the name is unknown or the stored pipeline was made from another description
+	HRESULT hr = request.Type == PipelineType::Graphics
+		? Library->LoadGraphicsPipeline(name.c_str(), static_cast<const D3D12_GRAPHICS_PIPELINE_STATE_DESC*>(request.Desc), IID_PPV_ARGS(&pipeline))
+		: Library->LoadComputePipeline(name.c_str(), static_cast<const D3D12_COMPUTE_PIPELINE_STATE_DESC*>(request.Desc), IID_PPV_ARGS(&pipeline));
+	if (FAILED(hr)) return nullptr;
+	return ToHandle(pipeline);
+}
+
+PipelineHandle D3D12PipelineBackend::Create(const PipelineRequest& request)
+{
+	ID3D12PipelineStatePtr pipeline;
+	if (request.Type == PipelineType::Graphics)
+		GRAPHICS_ASSERT(Device->CreateGraphicsPipelineState(static_cast<const D3D12_GRAPHICS_PIPELINE_STATE_DESC*>(request.Desc), IID_PPV_ARGS(&pipeline)));
+	else
+		GRAPHICS_ASSERT(Device->CreateComputePipelineState(static_cast<const D3D12_COMPUTE_PIPELINE_STATE_DESC*>(request.Desc), IID_PPV_ARGS(&pipeline)));
+	return ToHandle(pipeline);
+}
+
+void D3D12PipelineBackend::Store(const std::wstring& name, const PipelineHandle& pipeline)
+{
+	// Fails if the name is taken by a stale pipeline - it is compiled again on the next start
+	if (Library)
+		Library->StorePipeline(name.c_str(), ToPipelineState(pipeline));
+}
+
+std::vector<uint8_t> D3D12PipelineBackend::Serialize()
+{
+	if (!Library) return {};
+
+	std::vector<uint8_t> data(Library->GetSerializedSize());
+	GRAPHICS_ASSERT(Library->Serialize(data.data(), data.size()));
+	return data;
+}
+
+UniquePtr<D3D12PipelineCache> D3D12PipelineCache::Open(ID3D12Device5Ptr device, const std::filesystem::path& file)
+{
+	auto cache = MakeUnique<D3D12PipelineCache>(MakeUnique<D3D12PipelineBackend>(device), file);
+	cache->LoadFile();
+	return cache;
+}
+
+ID3D12PipelineStatePtr D3D12PipelineCache::GetGraphics(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+	PipelineHasher hasher;
+	hasher.Add(desc, rootSignatureHash);
+	return ToPipelineState(Get({ PipelineType::Graphics, &desc, hasher.Get() }));
+}
+
+ID3D12PipelineStatePtr D3D12PipelineCache::GetCompute(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+	PipelineHasher hasher;
+	hasher.Add(desc, rootSignatureHash);
+	return ToPipelineState(Get({ PipelineType::Compute, &desc, hasher.Get() }));
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Core/Core.h"
+#include "Core/Hash.h"
+#include "PipelineCache.h"
+
+// Hasher over the fields of D3D12 descriptions, member by member
+class PipelineHasher : public Hasher
+{
+public:
+	using Hasher::Add;
+	void Add(const D3D12_SHADER_BYTECODE& bytecode);
+	void Add(const D3D12_ROOT_SIGNATURE_DESC& desc);
+	// The root signature is only a pointer in the description - its hash is passed alongside
+	void Add(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
+	void Add(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
+};
+
+// Keeps the pipelines in an ID3D12PipelineLibrary, handles are ID3D12PipelineState
+class D3D12PipelineBackend : public PipelineBackend
+{
+public:
+	D3D12PipelineBackend(ID3D12Device5Ptr device);
+
+	PipelineHandle Load(const std::wstring& name, const PipelineRequest& request) override;
+	PipelineHandle Create(const PipelineRequest& request) override;
+	void Store(const std::wstring& name, const PipelineHandle& pipeline) override;
+
+	inline PipelineLibraryIdentity GetIdentity() const override { return Identity; }
+	bool Deserialize(std::vector<uint8_t> blob) override;
+	std::vector<uint8_t> Serialize() override;
+
+private:
+	HRESULT CreateLibrary();
+
+private:
+	ID3D12Device5Ptr Device;
+	PipelineLibraryIdentity Identity;
+	// The library reads from the blob for its whole lifetime
+	std::vector<uint8_t> Blob;
+	// Null when the driver has no pipeline library support - every pipeline is compiled then
+	ID3D12PipelineLibraryPtr Library;
+};
+
+// The pipeline cache of the device, keyed by PipelineHasher
+class D3D12PipelineCache : public PipelineCache
+{
+public:
+	using PipelineCache::PipelineCache;
+	// Reads the library from file, a missing or unreadable file starts an empty one
+	static UniquePtr<D3D12PipelineCache> Open(ID3D12Device5Ptr device, const std::filesystem::path& file);
+
+	ID3D12PipelineStatePtr GetGraphics(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
+	ID3D12PipelineStatePtr GetCompute(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
+};
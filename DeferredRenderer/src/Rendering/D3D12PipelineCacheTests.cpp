@@ -0,0 +1,50 @@
+#include "Test.h"
+#include "Rendering/D3D12PipelineCache.h"
+
+namespace
+{
+	const uint8_t VertexShader[] = { 'D', 'X', 'B', 'C', 1, 2, 3, 4 };
+	const uint8_t PixelShader[] = { 'D', 'X', 'B', 'C', 5, 6, 7, 8 };
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC Graphics(DXGI_FORMAT format)
+	{
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC desc{};
+		desc.VS = { VertexShader, sizeof(VertexShader) };
+		desc.PS = { PixelShader, sizeof(PixelShader) };
+		desc.SampleMask = UINT_MAX;
+		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		desc.NumRenderTargets = 1;
+		desc.RTVFormats[0] = format;
+		desc.SampleDesc.Count = 1;
+		return desc;
+	}
+
+	uint64_t GetKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+	{
+		PipelineHasher hasher;
+		hasher.Add(desc, rootSignatureHash);
+		return hasher.Get();
+	}
+}
+
+TEST_CASE(PipelineKeysCoverTheDescriptionNotItsAddresses)
+{
+	auto desc = Graphics(DXGI_FORMAT_R8G8B8A8_UNORM);
+
+	// Same bytecode from another buffer
+	std::vector<uint8_t> copy(std::begin(PixelShader), std::end(PixelShader));
+	auto moved = desc;
+	moved.PS = { copy.data(), copy.size() };
+	CHECK_EQ(GetKey(moved, 1), GetKey(desc, 1));
+
+	auto otherFormat = Graphics(DXGI_FORMAT_R16G16B16A16_FLOAT);
+	CHECK(GetKey(otherFormat, 1) != GetKey(desc, 1));
+	CHECK(GetKey(desc, 2) != GetKey(desc, 1));
+
+	copy.back()++;
+	CHECK(GetKey(moved, 1) != GetKey(desc, 1));
+
+	auto blended = desc;
+	blended.BlendState.RenderTarget[0].BlendEnable = TRUE;
+	CHECK(GetKey(blended, 1) != GetKey(desc, 1));
+}
@@ -0,0 +1,129 @@
+#include "DescriptorHeaps.h"
+#include "Core/Exception.h"
+#include "Utils.h"
+
+#include <algorithm>
+
+DescriptorRangeAllocator::DescriptorRangeAllocator(uint32_t capacity)
+	:Capacity(capacity)
+{
+	if (capacity)
+		FreeRanges[0] = capacity;
+}
+
+std::optional<uint32_t> DescriptorRangeAllocator::Allocate(uint32_t count)
+{
+	ASSERT(count > 0, "Allocating an empty descriptor range");
+
+	for (auto it = FreeRanges.begin(); it != FreeRanges.end(); ++it)
+	{
+		auto [start, length] = *it;
+		if (length < count) continue;
+
+		FreeRanges.erase(it);
+		if (length > count)
+			FreeRanges[start + count] = length - count;
+
+		Used += count;
+		return start;
+	}
+	return std::nullopt;
+}
+
+void DescriptorRangeAllocator::Free(uint32_t start, uint32_t count)
+{
+	ASSERT(count > 0 && start + count <= Capacity, "Freeing a range outside the allocator");
+
+	// Both neighbours are checked before anything changes, so a rejected free leaves the allocator as it was
+	auto next = FreeRanges.lower_bound(start);
+	auto prev = next != FreeRanges.begin() ? std::prev(next) : FreeRanges.end();
+	ASSERT(next == FreeRanges.end() || start + count <= next->first, "Freeing a range that is already free");
+	ASSERT(prev == FreeRanges.end() || prev->first + prev->second <= start, "Freeing a range that is already free");
+	Used -= count;
+
+	// Merge with the free ranges before and after
+	if (prev != FreeRanges.end() && prev->first + prev->second == start)
+	{
+		start = prev->first;
+		count += prev->second;
+		FreeRanges.erase(prev);
+	}
+
+	if (next != FreeRanges.end() && start + count == next->first)
+	{
+		count += next->second;
+		FreeRanges.erase(next);
+	}
+	FreeRanges[start] = count;
+}
+
+uint32_t DescriptorRangeAllocator::GetLargestFreeRange() const
+{
+	uint32_t largest = 0;
+	for (const auto& [start, length] : FreeRanges)
+		largest = std::max(largest, length);
+	return largest;
+}
+
+DescriptorHeap::DescriptorHeap(ID3D12Device5Ptr device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity)
+	:Type(type), DescriptorSize(device->GetDescriptorHandleIncrementSize(type)), Ranges(capacity)
+{
+	Heap = D3D::CreateDescriptorHeap(device, capacity, type, true);
+}
+
+DescriptorTable DescriptorHeap::Allocate(uint32_t count)
+{
+	auto start = Ranges.Allocate(count);
+	ASSERT(start.has_value(), "Global descriptor heap full - raise its capacity");
+
+	DescriptorTable table;
+	table.Type = Type;
+	table.Index = *start;
+	table.Count = count;
+	table.DescriptorSize = DescriptorSize;
+	table.CPUStart.ptr = Heap->GetCPUDescriptorHandleForHeapStart().ptr + SIZE_T(*start) * DescriptorSize;
+	table.GPUStart.ptr = Heap->GetGPUDescriptorHandleForHeapStart().ptr + UINT64(*start) * DescriptorSize;
+	return table;
+}
+
+void DescriptorHeap::Free(DescriptorTable& table)
+{
+	ASSERT(table.Type == Type, "Freeing a table of another heap");
+
+	Ranges.Free(table.Index, table.Count);
+	table = {};
+}
+
+GlobalDescriptorHeaps::GlobalDescriptorHeaps(ID3D12Device5Ptr device, uint32_t resourceCapacity, uint32_t samplerCapacity)
+	:Resources(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, resourceCapacity),
+	Samplers(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, samplerCapacity)
+{}
+
+void GlobalDescriptorHeaps::Free(DescriptorTable& table)
+{
+	if (table.Type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER)
+		Samplers.Free(table);
+	else
+		Resources.Free(table);
+}
+
+void GlobalDescriptorHeaps::Bind(CommandContext& cmdList)
+{
+	if (cmdList.SetDescriptorHeaps(Resources.GetHeap(), Samplers.GetHeap()))
+		SetHeapsCalls.fetch_add(1, std::memory_order_relaxed);
+}
+
+void GlobalDescriptorHeaps::ResetStats()
+{
+	SetHeapsCalls.store(0, std::memory_order_relaxed);
+}
+
+DescriptorStats GlobalDescriptorHeaps::GetStats() const
+{
+	DescriptorStats stats;
+	stats.SetHeapsCalls = SetHeapsCalls.load(std::memory_order_relaxed);
+	stats.ResourceDescriptors = Resources.GetRanges().GetUsed();
+	stats.LargestFreeRange = Resources.GetRanges().GetLargestFreeRange();
+	stats.Samplers = Samplers.GetRanges().GetUsed();
+	return stats;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "Core/Core.h"
+#include "CommandContext.h"
+
+#include <atomic>
+#include <map>
+#include <optional>
+
+// Contiguous descriptors inside one of the global shader-visible heaps.
+// Index is stable for the table's lifetime, so it can be handed to shaders as is
+struct DescriptorTable
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE CPUStart{};
+	D3D12_GPU_DESCRIPTOR_HANDLE GPUStart{};
+	D3D12_DESCRIPTOR_HEAP_TYPE Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	uint32_t Index = 0;
+	uint32_t Count = 0;
+	uint32_t DescriptorSize = 0;
+
+	inline D3D12_CPU_DESCRIPTOR_HANDLE GetCPUHandle(uint32_t offset = 0) const { return { CPUStart.ptr + SIZE_T(offset) * DescriptorSize }; }
+	inline D3D12_GPU_DESCRIPTOR_HANDLE GetGPUHandle(uint32_t offset = 0) const { return { GPUStart.ptr + UINT64(offset) * DescriptorSize }; }
+};
+
+// First-fit free list over [0, capacity). Freed ranges merge with their free neighbours.
+// Indices only, DescriptorHeap turns them into handles
+class DescriptorRangeAllocator
+{
+public:
+	explicit DescriptorRangeAllocator(uint32_t capacity);
+
+	// Start of the range - nullopt when no free range is large enough
+	std::optional<uint32_t> Allocate(uint32_t count);
+	void Free(uint32_t start, uint32_t count);
+
+	inline uint32_t GetCapacity() const { return Capacity; }
+	inline uint32_t GetUsed() const { return Used; }
+	uint32_t GetLargestFreeRange() const;
+
+private:
+	uint32_t Capacity = 0;
+	uint32_t Used = 0;
+	// Free range start -> length, never adjacent to each other
+	std::map<uint32_t, uint32_t> FreeRanges;
+};
+
+// A single shader-visible heap handing out tables
+class DescriptorHeap
+{
+public:
+	DescriptorHeap(ID3D12Device5Ptr device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity);
+
+	DescriptorTable Allocate(uint32_t count);
+	// The GPU must be done with the descriptors
+	void Free(DescriptorTable& table);
+
+	inline ID3D12DescriptorHeap* GetHeap() const { return Heap.GetInterfacePtr(); }
+	inline const DescriptorRangeAllocator& GetRanges() const { return Ranges; }
+
+private:
+	ID3D12DescriptorHeapPtr Heap;
+	D3D12_DESCRIPTOR_HEAP_TYPE Type;
+	uint32_t DescriptorSize = 0;
+	DescriptorRangeAllocator Ranges;
+};
+
+struct DescriptorStats
+{
+	uint32_t SetHeapsCalls = 0;			// SetDescriptorHeaps calls since the last reset
+	uint32_t ResourceDescriptors = 0;	// CBV/SRV/UAV descriptors in use
+	uint32_t LargestFreeRange = 0;
+	uint32_t Samplers = 0;				// Sampler descriptors in use
+};
+
+// The one CBV/SRV/UAV heap and the one sampler heap every pass binds its tables from.
+// They are set once per command list, switching heaps mid-list can flush the GPU.
+// Allocation is not thread safe - tables are made while loading, Bind may be called from workers
+class GlobalDescriptorHeaps
+{
+public:
+	static constexpr uint32_t DefaultResourceCapacity = 4096;
+	static constexpr uint32_t DefaultSamplerCapacity = 64;
+
+	GlobalDescriptorHeaps(ID3D12Device5Ptr device,
+						  uint32_t resourceCapacity = DefaultResourceCapacity,
+						  uint32_t samplerCapacity = DefaultSamplerCapacity);
+
+	inline DescriptorTable Allocate(uint32_t count) { return Resources.Allocate(count); }
+	inline DescriptorTable AllocateSamplers(uint32_t count) { return Samplers.Allocate(count); }
+	void Free(DescriptorTable& table);
+
+	void Bind(CommandContext& cmdList);
+
+	inline ID3D12DescriptorHeap* GetResourceHeap() const { return Resources.GetHeap(); }
+
+	void ResetStats();
+	DescriptorStats GetStats() const;
+
+private:
+	DescriptorHeap Resources;
+	DescriptorHeap Samplers;
+	std::atomic<uint32_t> SetHeapsCalls = 0;
+};
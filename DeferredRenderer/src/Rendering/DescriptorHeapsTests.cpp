@@ -0,0 +1,150 @@
+#include "Test.h"
+#include "Rendering/DescriptorHeaps.h"
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	// Longest run of false in used
+	uint32_t LargestFreeRun(const std::vector<bool>& used)
+	{
+		uint32_t largest = 0;
+		uint32_t run = 0;
+		for (bool slot : used)
+		{
+			run = slot ? 0 : run + 1;
+			largest = std::max(largest, run);
+		}
+		return largest;
+	}
+}
+
+TEST_CASE(DescriptorRangesAreHandedOutFirstFit)
+{
+	DescriptorRangeAllocator allocator(100);
+	CHECK_EQ(allocator.GetLargestFreeRange(), 100u);
+
+	CHECK(allocator.Allocate(10) == 0u);
+	CHECK(allocator.Allocate(30) == 10u);
+	CHECK(allocator.Allocate(60) == 40u);
+	CHECK_EQ(allocator.GetUsed(), 100u);
+	CHECK_EQ(allocator.GetLargestFreeRange(), 0u);
+	CHECK(!allocator.Allocate(1));
+
+	// A hole only takes requests that fit it, the first hole that fits wins
+	allocator.Free(0, 10);
+	allocator.Free(40, 60);
+	CHECK(!allocator.Allocate(61));
+	CHECK(allocator.Allocate(20) == 40u);
+	CHECK(allocator.Allocate(5) == 0u);
+	CHECK_EQ(allocator.GetUsed(), 55u);
+	CHECK_EQ(allocator.GetLargestFreeRange(), 40u);
+}
+
+TEST_CASE(FreedDescriptorRangesMergeWithTheirNeighbours)
+{
+	DescriptorRangeAllocator allocator(40);
+	uint32_t a = *allocator.Allocate(10);
+	uint32_t b = *allocator.Allocate(10);
+	uint32_t c = *allocator.Allocate(10);
+	uint32_t d = *allocator.Allocate(10);
+
+	// Merges with the free range after it
+	allocator.Free(c, 10);
+	allocator.Free(b, 10);
+	CHECK_EQ(allocator.GetLargestFreeRange(), 20u);
+
+	// ... before it
+	allocator.Free(d, 10);
+	CHECK_EQ(allocator.GetLargestFreeRange(), 30u);
+
+	// ... and on both sides at once
+	CHECK(allocator.Allocate(30) == b);
+	allocator.Free(b + 10, 10);
+	CHECK_EQ(allocator.GetLargestFreeRange(), 10u);
+	allocator.Free(b, 10);
+	allocator.Free(b + 20, 10);
+	CHECK_EQ(allocator.GetLargestFreeRange(), 30u);
+
+	allocator.Free(a, 10);
+	CHECK_EQ(allocator.GetUsed(), 0u);
+	CHECK_EQ(allocator.GetLargestFreeRange(), 40u);
+	CHECK(allocator.Allocate(40) == 0u);
+}
+
+TEST_CASE(FreeingWhatIsNotAllocatedAsserts)
+{
+	DescriptorRangeAllocator allocator(32);
+	uint32_t start = *allocator.Allocate(8);
+	allocator.Allocate(8);
+	allocator.Free(start, 8);
+
+	CHECK_THROWS(allocator.Free(start, 8));		// Double free
+	CHECK_THROWS(allocator.Free(start + 4, 8));	// Overlaps the free range before it
+	CHECK_THROWS(allocator.Free(12, 8));			// Overlaps the free range after it
+	CHECK_THROWS(allocator.Free(30, 4));			// Past the end
+	CHECK_THROWS(allocator.Allocate(0));
+	CHECK_EQ(allocator.GetUsed(), 8u);
+
+	DescriptorRangeAllocator empty(0);
+	CHECK(!empty.Allocate(1));
+}
+
+TEST_CASE(RandomDescriptorRangesNeverOverlap)
+{
+	constexpr uint32_t Capacity = 4096;
+	DescriptorRangeAllocator allocator(Capacity);
+	std::vector<bool> used(Capacity, false);
+	std::vector<std::pair<uint32_t, uint32_t>> live;
+
+	std::mt19937 random(12);
+	std::uniform_int_distribution<uint32_t> counts(1, 64);
+	size_t failed = 0;
+
+	for (int step = 0; step < 10000; step++)
+	{
+		if (!live.empty() && random() % 3 == 0)
+		{
+			size_t index = random() % live.size();
+			auto [start, count] = live[index];
+			allocator.Free(start, count);
+			std::fill_n(used.begin() + start, count, false);
+			live[index] = live.back();
+			live.pop_back();
+		}
+		else
+		{
+			uint32_t count = counts(random);
+			auto start = allocator.Allocate(count);
+			if (!start)
+			{
+				// First fit only fails when no hole is large enough
+				CHECK(LargestFreeRun(used) < count);
+				failed++;
+				continue;
+			}
+
+			REQUIRE(*start + count <= Capacity);
+			for (uint32_t i = *start; i < *start + count; i++)
+			{
+				CHECK(!used[i]);
+				used[i] = true;
+			}
+			live.emplace_back(*start, count);
+		}
+
+		// Adjacent free ranges are always merged, so the largest range is the longest run of free slots
+		if (step % 100 == 0)
+		{
+			CHECK_EQ(allocator.GetUsed(), static_cast<uint32_t>(std::ranges::count(used, true)));
+			CHECK_EQ(allocator.GetLargestFreeRange(), LargestFreeRun(used));
+		}
+	}
+	CHECK(failed > 0);	// The heap was full at times
+
+	for (auto [start, count] : live)
+		allocator.Free(start, count);
+	CHECK_EQ(allocator.GetUsed(), 0u);
+	CHECK_EQ(allocator.GetLargestFreeRange(), Capacity);
+}
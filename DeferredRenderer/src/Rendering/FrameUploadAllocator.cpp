@@ -0,0 +1,42 @@
+#include "FrameUploadAllocator.h"
+#include "Core/Exception.h"
+#include "GpuAllocator.h"
+#include "Utils.h"
+
+FrameUploadAllocator::FrameUploadAllocator(GpuAllocator& allocator, uint64_t bytesPerFrame)
+	:BytesPerFrame(align_to(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, bytesPerFrame))
+{
+	Buffer = allocator.CreateBuffer(BytesPerFrame * DefaultSwapChainBuffers, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ).Resource;
+
+	// Stays mapped for the lifetime of the allocator
+	CD3DX12_RANGE readRange(0, 0);
+	GRAPHICS_ASSERT(Buffer->Map(0, &readRange, reinterpret_cast<void**>(&CPUData)));
+}
+
+FrameUploadAllocator::~FrameUploadAllocator()
+{
+	Buffer->Unmap(0, nullptr);
+}
+
+void FrameUploadAllocator::BeginFrame(uint32_t frameIndex, uint64_t completedValue)
+{
+	ASSERT(SegmentFenceValues[frameIndex] <= completedValue, "Frame upload segment reset while the GPU still reads it");
+
+	FrameIndex = frameIndex;
+	Offset = 0;
+}
+
+void FrameUploadAllocator::EndFrame(uint64_t fenceValue)
+{
+	SegmentFenceValues[FrameIndex] = fenceValue;
+}
+
+FrameAllocation FrameUploadAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	uint64_t offset = align_to(alignment, Offset);
+	ASSERT(offset + size <= BytesPerFrame, "Frame upload segment full - raise the bytes per frame");
+	Offset = offset + size;
+
+	uint64_t bufferOffset = FrameIndex * BytesPerFrame + offset;
+	return { CPUData + bufferOffset, Buffer->GetGPUVirtualAddress() + bufferOffset, Buffer.GetInterfacePtr(), bufferOffset };
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Core/Core.h"
+
+class GpuAllocator;
+
+struct FrameAllocation
+{
+	uint8_t* CPUAddress = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS GPUAddress = 0;
+	// Source of copies out of the allocation
+	ID3D12Resource* Resource = nullptr;
+	uint64_t Offset = 0;
+};
+
+// Linear allocator over one persistently mapped upload buffer, split into a segment per frame slot.
+// Data written for a frame lives in its slot's segment, which is only reset once the GPU finished
+// the frame that last used it - so the CPU never overwrites constants still being read.
+// Allocations are made from the main thread while the frame's data is ticked
+class FrameUploadAllocator
+{
+public:
+	// Room for the frame's constants. The segment Graphics creates adds GpuSceneBuffer::GetMaxStagingBytes
+	// for the actors of the scene
+	static constexpr uint64_t DefaultBytesPerFrame = 4 * 1024 * 1024;
+
+	FrameUploadAllocator(GpuAllocator& allocator, uint64_t bytesPerFrame = DefaultBytesPerFrame);
+	~FrameUploadAllocator();
+
+	FrameUploadAllocator(const FrameUploadAllocator&) = delete;
+	FrameUploadAllocator& operator=(const FrameUploadAllocator&) = delete;
+
+	// Starts handing out the segment of frameIndex. completedValue is the last fence value the GPU reached
+	void BeginFrame(uint32_t frameIndex, uint64_t completedValue);
+	// Tags the current segment with the fence value signaled after the frame's work
+	void EndFrame(uint64_t fenceValue);
+
+	// Aligned to constant buffer placement by default
+	FrameAllocation Allocate(uint64_t size, uint64_t alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+	// Bytes handed out for the current frame, alignment padding included
+	inline uint64_t GetUsed() const { return Offset; }
+	inline uint64_t GetBytesPerFrame() const { return BytesPerFrame; }
+
+private:
+	ID3D12ResourcePtr Buffer;
+	uint8_t* CPUData = nullptr;
+	uint64_t BytesPerFrame = 0;
+
+	uint32_t FrameIndex = 0;
+	uint64_t Offset = 0;
+	// Fence value signaled after the last frame that wrote into each segment
+	std::array<uint64_t, DefaultSwapChainBuffers> SegmentFenceValues{};
+};
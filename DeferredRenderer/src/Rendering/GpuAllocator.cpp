@@ -0,0 +1,232 @@
+#include "GpuAllocator.h"
+#include "Core/Exception.h"
+
+#include <algorithm>
+#include <bit>
+
+MemoryStats& MemoryStats::operator+=(const MemoryStats& other)
+{
+	Capacity += other.Capacity;
+	Requested += other.Requested;
+	Reserved += other.Reserved;
+	LargestFreeBlock = std::max(LargestFreeBlock, other.LargestFreeBlock);
+	Allocations += other.Allocations;
+	return *this;
+}
+
+BuddyAllocator::BuddyAllocator(uint64_t capacity, uint64_t minBlockSize)
+	:Capacity(capacity), MinBlockSize(minBlockSize)
+{
+	ASSERT(std::has_single_bit(capacity) && std::has_single_bit(minBlockSize) && minBlockSize <= capacity,
+		   "Buddy allocator sizes must be powers of two");
+
+	MaxOrder = static_cast<uint32_t>(std::countr_zero(capacity) - std::countr_zero(minBlockSize));
+	FreeBlocks.resize(MaxOrder + 1);
+	FreeBlocks[MaxOrder].insert(0);
+}
+
+std::optional<uint32_t> BuddyAllocator::GetOrder(uint64_t size) const
+{
+	if (size > Capacity) return std::nullopt;
+
+	uint64_t blockSize = std::max(std::bit_ceil(size), MinBlockSize);
+	return static_cast<uint32_t>(std::countr_zero(blockSize) - std::countr_zero(MinBlockSize));
+}
+
+std::optional<uint64_t> BuddyAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	auto order = GetOrder(std::max(size, alignment));
+	if (!order) return std::nullopt;
+
+	// Smallest free block that fits
+	uint32_t found = *order;
+	while (found <= MaxOrder && FreeBlocks[found].empty())
+		found++;
+	if (found > MaxOrder) return std::nullopt;
+
+	uint64_t offset = *FreeBlocks[found].begin();
+	FreeBlocks[found].erase(FreeBlocks[found].begin());
+
+	// Split it down, the upper halves stay free
+	while (found > *order)
+	{
+		found--;
+		FreeBlocks[found].insert(offset + GetBlockSize(found));
+	}
+
+	Allocated[offset] = { *order, size };
+	Requested += size;
+	Reserved += GetBlockSize(*order);
+	return offset;
+}
+
+void BuddyAllocator::Free(uint64_t offset)
+{
+	auto it = Allocated.find(offset);
+	ASSERT(it != Allocated.end(), "Freeing a block that wasn't allocated");
+
+	uint32_t order = it->second.Order;
+	Requested -= it->second.Requested;
+	Reserved -= GetBlockSize(order);
+	Allocated.erase(it);
+
+	// Merge with the buddy as long as it is free as well
+	while (order < MaxOrder && FreeBlocks[order].erase(offset ^ GetBlockSize(order)))
+	{
+		offset &= ~GetBlockSize(order);
+		order++;
+	}
+	FreeBlocks[order].insert(offset);
+}
+
+MemoryStats BuddyAllocator::GetStats() const
+{
+	MemoryStats stats;
+	stats.Capacity = Capacity;
+	stats.Requested = Requested;
+	stats.Reserved = Reserved;
+	stats.Allocations = static_cast<uint32_t>(Allocated.size());
+
+	for (uint32_t order = MaxOrder + 1; order-- > 0;)
+	{
+		if (FreeBlocks[order].empty()) continue;
+		stats.LargestFreeBlock = GetBlockSize(order);
+		break;
+	}
+	return stats;
+}
+
+GpuAllocator::GpuAllocator(ID3D12Device5Ptr device, uint64_t heapSize)
+	:Device(device), HeapSize(heapSize)
+{}
+
+HeapCategory GpuAllocator::GetCategory(const D3D12_RESOURCE_DESC& desc)
+{
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+		return HeapCategory::Buffers;
+	if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+		return HeapCategory::RenderTargets;
+	return HeapCategory::Textures;
+}
+
+GpuAllocation GpuAllocator::CreateResource(const D3D12_RESOURCE_DESC& desc,
+										   D3D12_HEAP_TYPE heapType,
+										   D3D12_RESOURCE_STATES initialState,
+										   const D3D12_CLEAR_VALUE* clearValue)
+{
+	GpuAllocation allocation;
+	allocation.HeapType = heapType;
+	allocation.Category = GetCategory(desc);
+	ASSERT(heapType == D3D12_HEAP_TYPE_DEFAULT || allocation.Category == HeapCategory::Buffers,
+		   "Upload and readback heaps only hold buffers");
+
+	auto info = Device->GetResourceAllocationInfo(0, 1, &desc);
+
+	PoolKey key{ heapType, allocation.Category };
+	auto& pool = Pools[key];
+
+	// First heap with a large enough block, a new heap when all are full
+	std::optional<uint64_t> offset;
+	for (size_t i = 0; i < pool.size() && !offset; i++)
+	{
+		offset = pool[i].Blocks.Allocate(info.SizeInBytes, info.Alignment);
+		allocation.Heap = i;
+	}
+
+	if (!offset)
+	{
+		offset = AddHeap(pool, key, std::max(info.SizeInBytes, info.Alignment)).Blocks.Allocate(info.SizeInBytes, info.Alignment);
+		allocation.Heap = pool.size() - 1;
+	}
+	allocation.Offset = *offset;
+
+	GRAPHICS_ASSERT(Device->CreatePlacedResource(pool[allocation.Heap].HeapPtr,
+												 allocation.Offset,
+												 &desc,
+												 initialState,
+												 clearValue,
+												 IID_PPV_ARGS(&allocation.Resource)));
+	return allocation;
+}
+
+GpuAllocation GpuAllocator::CreateBuffer(uint64_t size,
+										 D3D12_HEAP_TYPE heapType,
+										 D3D12_RESOURCE_STATES initialState,
+										 D3D12_RESOURCE_FLAGS flags)
+{
+	return CreateResource(CD3DX12_RESOURCE_DESC::Buffer(size, flags), heapType, initialState);
+}
+
+void GpuAllocator::Free(GpuAllocation& allocation)
+{
+	ASSERT(allocation.Resource, "Freeing an empty allocation");
+
+	allocation.Resource = nullptr;
+	Pools.at({ allocation.HeapType, allocation.Category })[allocation.Heap].Blocks.Free(allocation.Offset);
+}
+
+GpuAllocator::Heap& GpuAllocator::AddHeap(std::vector<Heap>& pool, const PoolKey& key, uint64_t minSize)
+{
+	// Resources larger than the default size get a heap of their own size
+	uint64_t size = std::max(HeapSize, std::bit_ceil(minSize));
+
+	D3D12_HEAP_DESC heapDesc{};
+	heapDesc.SizeInBytes = size;
+	heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(key.first);
+	switch (key.second)
+	{
+	case HeapCategory::Buffers:
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+		break;
+	case HeapCategory::Textures:
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+		break;
+	case HeapCategory::RenderTargets:
+		heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+		break;
+	}
+
+	ID3D12HeapPtr heap;
+	GRAPHICS_ASSERT(Device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)));
+	return pool.emplace_back(Heap{ heap, BuddyAllocator(size, MinBlockSize) });
+}
+
+MemoryStats GpuAllocator::GetStats() const
+{
+	MemoryStats stats;
+	for (const auto& [key, pool] : Pools)
+		for (const auto& heap : pool)
+			stats += heap.Blocks.GetStats();
+	return stats;
+}
+
+size_t GpuAllocator::GetHeapCount() const
+{
+	size_t count = 0;
+	for (const auto& [key, pool] : Pools)
+		count += pool.size();
+	return count;
+}
+
+void GpuAllocator::Dump(std::ostream& os) const
+{
+	static const char* heapTypes[] = { "", "default", "upload", "readback" };
+	static const char* categories[] = { "buffers", "textures", "render targets" };
+	constexpr uint64_t KB = 1024;
+
+	for (const auto& [key, pool] : Pools)
+	{
+		for (size_t i = 0; i < pool.size(); i++)
+		{
+			auto stats = pool[i].Blocks.GetStats();
+			os << heapTypes[key.first] << " " << categories[static_cast<size_t>(key.second)] << " [" << i << "]: "
+				<< stats.Allocations << " allocations, "
+				<< stats.Reserved / KB << "/" << stats.Capacity / KB << " KB reserved, "
+				<< stats.GetWaste() / KB << " KB waste, "
+				<< int(stats.GetFragmentation() * 100.0f) << "% fragmented\n";
+		}
+	}
+}
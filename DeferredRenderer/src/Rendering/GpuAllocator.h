@@ -0,0 +1,127 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <map>
+#include <optional>
+#include <ostream>
+#include <set>
+#include <unordered_map>
+
+struct MemoryStats
+{
+	uint64_t Capacity = 0;
+	uint64_t Requested = 0;			// Bytes asked for
+	uint64_t Reserved = 0;			// Bytes handed out - requests rounded up to whole blocks
+	uint64_t LargestFreeBlock = 0;
+	uint32_t Allocations = 0;
+
+	inline uint64_t GetFree() const { return Capacity - Reserved; }
+	// Internal fragmentation - lost to rounding up to block sizes
+	inline uint64_t GetWaste() const { return Reserved - Requested; }
+	// External fragmentation - share of the free memory not usable by the largest possible request
+	inline float GetFragmentation() const { return GetFree() ? 1.0f - float(LargestFreeBlock) / float(GetFree()) : 0.0f; }
+
+	MemoryStats& operator+=(const MemoryStats& other);
+};
+
+// Power-of-two blocks split and merged with their buddies. Blocks are aligned to their size,
+// so a request is aligned by asking for a block at least as large as the alignment.
+// Offsets only, GpuAllocator keeps one per heap
+class BuddyAllocator
+{
+public:
+	// capacity and minBlockSize are powers of two
+	BuddyAllocator(uint64_t capacity, uint64_t minBlockSize);
+
+	// Offset of the block - nullopt when no free block is large enough
+	std::optional<uint64_t> Allocate(uint64_t size, uint64_t alignment);
+	void Free(uint64_t offset);
+
+	inline bool IsEmpty() const { return Allocated.empty(); }
+	MemoryStats GetStats() const;
+
+private:
+	inline uint64_t GetBlockSize(uint32_t order) const { return MinBlockSize << order; }
+	std::optional<uint32_t> GetOrder(uint64_t size) const;
+
+private:
+	struct Block
+	{
+		uint32_t Order = 0;
+		uint64_t Requested = 0;
+	};
+
+	uint64_t Capacity = 0;
+	uint64_t MinBlockSize = 0;
+	uint32_t MaxOrder = 0;
+
+	// Free block offsets per order - lowest offset first keeps the heap packed at the start
+	std::vector<std::set<uint64_t>> FreeBlocks;
+	std::unordered_map<uint64_t, Block> Allocated;
+	uint64_t Requested = 0;
+	uint64_t Reserved = 0;
+};
+
+// Resource heap tier 1 keeps buffers, textures and render targets in separate heaps
+enum class HeapCategory : uint8_t
+{
+	Buffers,
+	Textures,
+	RenderTargets
+};
+
+struct GpuAllocation
+{
+	ID3D12ResourcePtr Resource;
+	D3D12_HEAP_TYPE HeapType = D3D12_HEAP_TYPE_DEFAULT;
+	HeapCategory Category = HeapCategory::Buffers;
+	size_t Heap = 0;
+	uint64_t Offset = 0;
+};
+
+// Places resources in large heaps shared by every resource of one heap type and category instead
+// of giving each resource a committed heap of its own. Placed resources are 64KB aligned, so that
+// is the smallest block a resource takes. Not thread safe - resources are created while loading
+class GpuAllocator
+{
+public:
+	static constexpr uint64_t DefaultHeapSize = 64ull * 1024 * 1024;
+	static constexpr uint64_t MinBlockSize = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+	GpuAllocator(ID3D12Device5Ptr device, uint64_t heapSize = DefaultHeapSize);
+
+	GpuAllocation CreateResource(const D3D12_RESOURCE_DESC& desc,
+								 D3D12_HEAP_TYPE heapType,
+								 D3D12_RESOURCE_STATES initialState,
+								 const D3D12_CLEAR_VALUE* clearValue = nullptr);
+
+	GpuAllocation CreateBuffer(uint64_t size,
+							   D3D12_HEAP_TYPE heapType,
+							   D3D12_RESOURCE_STATES initialState,
+							   D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE);
+
+	// Releases the resource and gives its block back. The GPU must be done with it
+	void Free(GpuAllocation& allocation);
+
+	MemoryStats GetStats() const;
+	size_t GetHeapCount() const;
+	void Dump(std::ostream& os) const;
+
+	static HeapCategory GetCategory(const D3D12_RESOURCE_DESC& desc);
+
+private:
+	struct Heap
+	{
+		ID3D12HeapPtr HeapPtr;
+		BuddyAllocator Blocks;
+	};
+
+	using PoolKey = std::pair<D3D12_HEAP_TYPE, HeapCategory>;
+
+	Heap& AddHeap(std::vector<Heap>& pool, const PoolKey& key, uint64_t minSize);
+
+private:
+	ID3D12Device5Ptr Device;
+	uint64_t HeapSize = 0;
+	std::map<PoolKey, std::vector<Heap>> Pools;
+};
@@ -0,0 +1,184 @@
+#include "Test.h"
+#include "Rendering/GpuAllocator.h"
+
+#include <bit>
+#include <map>
+#include <random>
+
+namespace
+{
+	constexpr uint64_t KB = 1024;
+
+	// Live blocks of an allocator, offset to requested size and alignment, checked against its stats
+	struct LiveBlocks
+	{
+		struct Block
+		{
+			uint64_t Size = 0;
+			uint64_t Alignment = 0;
+		};
+		std::map<uint64_t, Block> Blocks;
+
+		void Check(const BuddyAllocator& allocator, uint64_t minBlockSize) const
+		{
+			auto stats = allocator.GetStats();
+			uint64_t requested = 0;
+			uint64_t reserved = 0;
+			uint64_t end = 0;
+			for (const auto& [offset, block] : Blocks)
+			{
+				uint64_t blockSize = std::max(std::bit_ceil(std::max(block.Size, block.Alignment)), minBlockSize);
+				CHECK_EQ(offset % block.Alignment, 0u);
+				// Blocks are aligned to their size and never overlap
+				CHECK_EQ(offset % blockSize, 0u);
+				CHECK(offset >= end);
+				CHECK(offset + blockSize <= stats.Capacity);
+				end = offset + blockSize;
+				requested += block.Size;
+				reserved += blockSize;
+			}
+
+			CHECK_EQ(stats.Allocations, Blocks.size());
+			CHECK_EQ(stats.Requested, requested);
+			CHECK_EQ(stats.Reserved, reserved);
+			CHECK(stats.LargestFreeBlock <= stats.GetFree());
+			CHECK_EQ(allocator.IsEmpty(), Blocks.empty());
+		}
+	};
+}
+
+TEST_CASE(BuddyBlocksRoundUpToPowersOfTwo)
+{
+	BuddyAllocator allocator(64 * KB, KB);
+
+	auto small = allocator.Allocate(100, 4);
+	auto odd = allocator.Allocate(3 * KB, 4);
+	REQUIRE(small && odd);
+
+	// 100 bytes take a whole minimum block, 3 KB a 4 KB block aligned to its size
+	CHECK_EQ(*odd % (4 * KB), 0u);
+	auto stats = allocator.GetStats();
+	CHECK_EQ(stats.Requested, 100 + 3 * KB);
+	CHECK_EQ(stats.Reserved, 5 * KB);
+	CHECK_EQ(stats.GetWaste(), 5 * KB - 100 - 3 * KB);
+	CHECK_EQ(stats.Allocations, 2u);
+}
+
+TEST_CASE(BuddyAlignmentPicksALargerBlock)
+{
+	BuddyAllocator allocator(1024 * KB, KB);
+
+	// Something small first, so the aligned request cannot land at offset 0
+	REQUIRE(allocator.Allocate(KB, KB));
+	auto aligned = allocator.Allocate(KB, 64 * KB);
+	REQUIRE(aligned);
+	CHECK_EQ(*aligned % (64 * KB), 0u);
+	CHECK(*aligned != 0);
+	CHECK_EQ(allocator.GetStats().Reserved, 65 * KB);
+}
+
+TEST_CASE(BuddyRejectsWhatDoesNotFit)
+{
+	BuddyAllocator allocator(16 * KB, KB);
+
+	CHECK(!allocator.Allocate(32 * KB, 4));
+	CHECK(!allocator.Allocate(KB, 32 * KB));
+
+	// Fill it with minimum blocks - the next request fails and the allocator is left as it was
+	for (uint64_t i = 0; i < 16; i++)
+		REQUIRE(allocator.Allocate(KB, 4) == i * KB);
+	CHECK(!allocator.Allocate(1, 1));
+	CHECK_EQ(allocator.GetStats().GetFree(), 0u);
+	CHECK_EQ(allocator.GetStats().LargestFreeBlock, 0u);
+
+	// Freeing an offset that is not allocated is a bug in the caller
+	bool threw = false;
+	try
+	{
+		allocator.Free(KB / 2);
+	}
+	catch (const std::exception&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+}
+
+TEST_CASE(BuddiesMergeBackIntoTheWholeHeap)
+{
+	BuddyAllocator allocator(16 * KB, KB);
+
+	std::vector<uint64_t> offsets;
+	for (int i = 0; i < 16; i++)
+		offsets.push_back(*allocator.Allocate(KB, 4));
+
+	// Every other block free - half the heap is free, none of it usable for 2 KB
+	for (size_t i = 0; i < offsets.size(); i += 2)
+		allocator.Free(offsets[i]);
+
+	auto stats = allocator.GetStats();
+	CHECK_EQ(stats.GetFree(), 8 * KB);
+	CHECK_EQ(stats.LargestFreeBlock, KB);
+	CHECK_NEAR(stats.GetFragmentation(), 1.0f - 1.0f / 8.0f, 1e-6f);
+	CHECK(!allocator.Allocate(2 * KB, 4));
+
+	// Freeing the rest in reverse merges buddy after buddy up to the whole heap
+	for (size_t i = offsets.size() - 1; i < offsets.size(); i -= 2)
+		allocator.Free(offsets[i]);
+
+	stats = allocator.GetStats();
+	CHECK(allocator.IsEmpty());
+	CHECK_EQ(stats.LargestFreeBlock, 16 * KB);
+	CHECK_NEAR(stats.GetFragmentation(), 0.0f, 1e-6f);
+	CHECK(allocator.Allocate(16 * KB, 4) == 0u);
+}
+
+TEST_CASE(BuddyRandomAllocationsKeepTheirInvariants)
+{
+	constexpr uint64_t Capacity = 4096 * KB;
+	constexpr uint64_t MinBlock = 4 * KB;
+	BuddyAllocator allocator(Capacity, MinBlock);
+	LiveBlocks live;
+
+	std::mt19937 random(7);
+	std::uniform_int_distribution<uint64_t> sizes(1, 256 * KB);
+	std::uniform_int_distribution<int> alignments(0, 4);
+	std::uniform_int_distribution<int> action(0, 2);
+
+	size_t failed = 0;
+	for (int step = 0; step < 4000; step++)
+	{
+		if (!live.Blocks.empty() && action(random) == 0)
+		{
+			auto it = std::next(live.Blocks.begin(), random() % live.Blocks.size());
+			allocator.Free(it->first);
+			live.Blocks.erase(it);
+		}
+		else
+		{
+			uint64_t size = sizes(random);
+			uint64_t alignment = 256ull << (2 * alignments(random));	// 256 B to 64 KB
+			if (auto offset = allocator.Allocate(size, alignment))
+			{
+				CHECK(!live.Blocks.contains(*offset));
+				live.Blocks[*offset] = { size, alignment };
+			}
+			else
+			{
+				// Only fails when no free block of the rounded size is left
+				CHECK(allocator.GetStats().LargestFreeBlock < std::bit_ceil(std::max(size, alignment)));
+				failed++;
+			}
+		}
+
+		if (step % 100 == 0)
+			live.Check(allocator, MinBlock);
+	}
+	live.Check(allocator, MinBlock);
+	CHECK(failed > 0);	// The heap was full at times
+
+	for (const auto& [offset, block] : live.Blocks)
+		allocator.Free(offset);
+	CHECK(allocator.IsEmpty());
+	CHECK_EQ(allocator.GetStats().LargestFreeBlock, Capacity);
+}
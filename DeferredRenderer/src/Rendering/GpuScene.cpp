@@ -0,0 +1,98 @@
+#include "GpuScene.h"
+#include "Core/Exception.h"
+#include "Resources.h"
+#include "UploadService.h"
+
+#include <algorithm>
+
+void DirtyRangeTracker::Resize(uint32_t count)
+{
+	Marked.assign(count, false);
+	Indices.clear();
+}
+
+void DirtyRangeTracker::Mark(uint32_t index)
+{
+	ASSERT(index < Marked.size(), "Marking an element outside the tracker");
+
+	if (Marked[index]) return;
+	Marked[index] = true;
+	Indices.push_back(index);
+}
+
+const std::vector<IndexRange>& DirtyRangeTracker::Collect(uint32_t mergeGap)
+{
+	Ranges.clear();
+	std::sort(Indices.begin(), Indices.end());
+
+	for (uint32_t index : Indices)
+	{
+		Marked[index] = false;
+
+		if (!Ranges.empty() && index - (Ranges.back().First + Ranges.back().Count) <= mergeGap)
+			Ranges.back().Count = index - Ranges.back().First + 1;
+		else
+			Ranges.push_back({ index, 1 });
+	}
+
+	Indices.clear();
+	return Ranges;
+}
+
+void GpuSceneBuffer::Init(ID3D12Device5Ptr device, UploadService& uploads, const std::vector<ActorData>& actors)
+{
+	CPUData = actors;
+	Dirty.Resize(static_cast<uint32_t>(actors.size()));
+
+	// Stays in COMMON - buffers are promoted to copy destination and shader resource implicitly
+	// and decay back after every ExecuteCommandLists, so updates need no barriers
+	uint64_t size = std::max<size_t>(actors.size(), 1) * sizeof(ActorData);
+	Buffer = Globals.Allocator->CreateBuffer(size, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON).Resource;
+	if (!actors.empty())
+		uploads.UploadBuffer(Buffer, 0, actors.data(), size);
+
+	for (auto& allocator : CmdAllocators)
+		GRAPHICS_ASSERT(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator)));
+	GRAPHICS_ASSERT(device->CreateCommandList1(0, D3D12_COMMAND_LIST_TYPE_DIRECT, D3D12_COMMAND_LIST_FLAG_NONE, IID_PPV_ARGS(&CmdList)));
+}
+
+void GpuSceneBuffer::Write(uint32_t index, const ActorData& data)
+{
+	CPUData[index] = data;
+	Dirty.Mark(index);
+}
+
+void GpuSceneBuffer::Upload(ID3D12CommandQueuePtr queue)
+{
+	Stats = {};
+	Stats.Actors = static_cast<uint32_t>(CPUData.size());
+	if (Dirty.IsEmpty()) return;
+
+	Stats.DirtyActors = Dirty.GetMarkedCount();
+	const auto& ranges = Dirty.Collect(MergeGap);
+	for (const auto& range : ranges)
+		Stats.UploadedBytes += uint64_t(range.Count) * sizeof(ActorData);
+	Stats.Copies = static_cast<uint32_t>(ranges.size());
+
+	// All ranges share one staging allocation, packed back to back. The ranges are disjoint, so it is
+	// never more than the whole buffer - see GetMaxStagingBytes
+	auto staging = Globals.FrameUploads->Allocate(Stats.UploadedBytes);
+
+	// The allocator of this frame slot is free - the caller waited for the frame that last used it
+	auto& allocator = CmdAllocators[Globals.FrameIndex];
+	GRAPHICS_ASSERT(allocator->Reset());
+	GRAPHICS_ASSERT(CmdList->Reset(allocator, nullptr));
+
+	uint64_t offset = 0;
+	for (const auto& range : ranges)
+	{
+		uint64_t size = uint64_t(range.Count) * sizeof(ActorData);
+		std::memcpy(staging.CPUAddress + offset, &CPUData[range.First], size);
+		CmdList->CopyBufferRegion(Buffer, uint64_t(range.First) * sizeof(ActorData), staging.Resource, staging.Offset + offset, size);
+		offset += size;
+	}
+
+	GRAPHICS_ASSERT(CmdList->Close());
+	std::array<ID3D12CommandList*, 1> lists = { CmdList.GetInterfacePtr() };
+	queue->ExecuteCommandLists(static_cast<UINT>(lists.size()), lists.data());
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "Core/Core.h"
+#include "Shaders/HLSLCompat.h"
+
+class UploadService;
+
+// Read as a tightly packed StructuredBuffer element - the explicit padding in HLSLCompat.h keeps both sides equal
+static_assert(sizeof(ActorData) == 144, "ActorData layout differs from the HLSL structured buffer");
+
+struct IndexRange
+{
+	uint32_t First = 0;
+	uint32_t Count = 0;
+};
+
+// Collects written element indices and turns them into sorted, merged ranges.
+// Marking an element again is a flag test, an actor written several times in a frame is copied once
+class DirtyRangeTracker
+{
+public:
+	void Resize(uint32_t count);
+	void Mark(uint32_t index);
+	inline bool IsEmpty() const { return Indices.empty(); }
+	inline uint32_t GetMarkedCount() const { return static_cast<uint32_t>(Indices.size()); }
+
+	// Ranges at most mergeGap clean elements apart are joined - one larger copy beats many tiny ones.
+	// Clears the marks
+	const std::vector<IndexRange>& Collect(uint32_t mergeGap = 0);
+
+private:
+	std::vector<bool> Marked;
+	std::vector<uint32_t> Indices;
+	std::vector<IndexRange> Ranges;
+};
+
+struct GpuSceneStats
+{
+	uint32_t Actors = 0;
+	uint32_t DirtyActors = 0;		// Actors written since the previous upload
+	uint32_t Copies = 0;			// CopyBufferRegion calls, one per merged range
+	uint64_t UploadedBytes = 0;		// Merged ranges include the clean actors between dirty ones
+};
+
+// The ActorData of every actor in one structured buffer, read in shaders through a root SRV and
+// indexed by a per-draw root constant. A CPU copy keeps the current data, only ranges written since
+// the last upload go to the GPU - a static scene uploads nothing per frame
+class GpuSceneBuffer
+{
+public:
+	// Clean actors between two dirty ones that are still copied instead of splitting the copy
+	static constexpr uint32_t MergeGap = 4;
+
+	// Staging of an Upload where every actor moved, alignment of the allocation included. The frame
+	// upload segment is sized to hold it next to the frame's constants
+	static constexpr uint64_t GetMaxStagingBytes(size_t actors)
+	{
+		return uint64_t(actors) * sizeof(ActorData) + D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	}
+
+	void Init(ID3D12Device5Ptr device, UploadService& uploads, const std::vector<ActorData>& actors);
+
+	void Write(uint32_t index, const ActorData& data);
+	// Copies the dirty ranges through the frame upload allocator on a list submitted ahead of the frame's passes
+	void Upload(ID3D12CommandQueuePtr queue);
+
+	inline D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const { return Buffer->GetGPUVirtualAddress(); }
+	// Stats of the last Upload call
+	inline const GpuSceneStats& GetStats() const { return Stats; }
+
+private:
+	ID3D12ResourcePtr Buffer;
+	std::vector<ActorData> CPUData;
+	DirtyRangeTracker Dirty;
+
+	std::array<ID3D12CommandAllocatorPtr, DefaultSwapChainBuffers> CmdAllocators;
+	ID3D12GraphicsCommandList4Ptr CmdList;
+
+	GpuSceneStats Stats;
+};
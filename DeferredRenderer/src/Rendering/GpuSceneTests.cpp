@@ -0,0 +1,162 @@
+#include "Test.h"
+#include "Rendering/GpuScene.h"
+#include "Rendering/FrameUploadAllocator.h"
+
+#include <chrono>
+#include <iomanip>
+#include <numeric>
+#include <random>
+
+namespace
+{
+	// Per-actor CBVs uploaded every frame, as before the scene buffer - one 256 byte aligned constant buffer each
+	constexpr uint64_t ConstantBufferBytes = 256;
+
+	struct UploadResult
+	{
+		uint32_t Dirty = 0;
+		uint32_t Copies = 0;
+		uint64_t Bytes = 0;		// Per frame, averaged over the frames
+		uint64_t MaxBytes = 0;	// Staging of the largest frame
+		float CollectMs = 0.0f;
+	};
+
+	// GpuSceneBuffer::Upload without the device - moving actors are marked every frame, the tracker merges
+	// them with the buffer's gap and the merged ranges are what would be copied
+	UploadResult SimulateFrames(uint32_t actors, const std::vector<uint32_t>& moving, uint32_t frames = 60)
+	{
+		DirtyRangeTracker tracker;
+		tracker.Resize(actors);
+
+		UploadResult result;
+		uint64_t bytes = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < frames; frame++)
+		{
+			for (uint32_t index : moving)
+				tracker.Mark(index);
+			result.Dirty = tracker.GetMarkedCount();
+
+			const auto& ranges = tracker.Collect(GpuSceneBuffer::MergeGap);
+			result.Copies = static_cast<uint32_t>(ranges.size());
+			uint64_t frameBytes = 0;
+			for (const auto& range : ranges)
+				frameBytes += uint64_t(range.Count) * sizeof(ActorData);
+			bytes += frameBytes;
+			result.MaxBytes = std::max(result.MaxBytes, frameBytes);
+		}
+		result.CollectMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+		result.Bytes = bytes / frames;
+		return result;
+	}
+
+	std::vector<uint32_t> Scattered(uint32_t actors, uint32_t count, uint32_t seed)
+	{
+		std::vector<uint32_t> all(actors);
+		std::iota(all.begin(), all.end(), 0u);
+		std::shuffle(all.begin(), all.end(), std::mt19937(seed));
+		all.resize(count);
+		return all;
+	}
+
+	std::vector<uint32_t> Block(uint32_t first, uint32_t count)
+	{
+		std::vector<uint32_t> block(count);
+		std::iota(block.begin(), block.end(), first);
+		return block;
+	}
+
+	// Upload's staging allocation in the segment Graphics sizes for the scene, behind constants that used all
+	// of their share and the worst alignment padding - what FrameUploadAllocator::Allocate asserts on
+	bool FitsFrameUploadSegment(uint32_t actors, uint64_t staging)
+	{
+		const uint64_t segment = FrameUploadAllocator::DefaultBytesPerFrame + GpuSceneBuffer::GetMaxStagingBytes(actors);
+		const uint64_t offset = FrameUploadAllocator::DefaultBytesPerFrame + D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1;
+		return offset + staging <= segment;
+	}
+
+	void Print(const char* scene, uint32_t actors, const UploadResult& result)
+	{
+		std::cout << "    " << std::left << std::setw(22) << scene << std::right
+				  << std::setw(7) << actors << " actors " << std::setw(7) << result.Dirty << " dirty "
+				  << std::setw(6) << result.Copies << " copies " << std::setw(10) << result.Bytes << " B/frame ("
+				  << std::setw(9) << uint64_t(actors) * ConstantBufferBytes << " B as CBVs) "
+				  << std::fixed << std::setprecision(3) << result.CollectMs << " ms\n";
+	}
+}
+
+TEST_CASE(SceneBufferUploadBytesPerFrame)
+{
+	for (uint32_t actors : { 10000u, 50000u })
+	{
+		// Nothing moves - nothing is uploaded
+		auto still = SimulateFrames(actors, {});
+		Print("static", actors, still);
+		CHECK_EQ(still.Bytes, 0u);
+		CHECK_EQ(still.Copies, 0u);
+
+		// A few animated actors spread over the scene - one copy each, the gap rarely joins them
+		auto scattered = SimulateFrames(actors, Scattered(actors, actors / 100, 3));
+		Print("1% animated, scattered", actors, scattered);
+		CHECK_EQ(scattered.Dirty, actors / 100);
+		CHECK(scattered.Bytes >= uint64_t(scattered.Dirty) * sizeof(ActorData));
+		CHECK(scattered.Bytes <= uint64_t(scattered.Dirty) * (GpuSceneBuffer::MergeGap + 1) * sizeof(ActorData));
+		CHECK(scattered.Copies <= scattered.Dirty);
+
+		// Every other actor of a crowd loaded together - the gaps are merged into a single copy
+		std::vector<uint32_t> crowd;
+		for (uint32_t i = 0; i < actors / 10; i += 2)
+			crowd.push_back(actors / 2 + i);
+		auto interleaved = SimulateFrames(actors, crowd);
+		Print("5% animated, crowd", actors, interleaved);
+		CHECK_EQ(interleaved.Copies, 1u);
+		CHECK_EQ(interleaved.Bytes, uint64_t(actors / 10 - 1) * sizeof(ActorData));
+
+		// A tenth of the scene in one block
+		auto block = SimulateFrames(actors, Block(actors / 4, actors / 10));
+		Print("10% animated, block", actors, block);
+		CHECK_EQ(block.Copies, 1u);
+		CHECK_EQ(block.Bytes, uint64_t(actors / 10) * sizeof(ActorData));
+
+		// Everything moves - one copy of the whole buffer, still below the per-actor constant buffers
+		auto all = SimulateFrames(actors, Scattered(actors, actors, 5));
+		Print("all animated", actors, all);
+		CHECK_EQ(all.Copies, 1u);
+		CHECK_EQ(all.Bytes, uint64_t(actors) * sizeof(ActorData));
+		CHECK(all.Bytes < uint64_t(actors) * ConstantBufferBytes);
+
+		// 7.2 MB at 50k actors, more than the constants' share of the segment - it is sized for the actors on top
+		CHECK_EQ(all.MaxBytes, uint64_t(actors) * sizeof(ActorData));
+		for (const auto* result : { &still, &scattered, &interleaved, &block, &all })
+			CHECK(FitsFrameUploadSegment(actors, result->MaxBytes));
+	}
+}
+
+TEST_CASE(DirtyRangesMergeAcrossTheGapOnly)
+{
+	DirtyRangeTracker tracker;
+	tracker.Resize(64);
+
+	// Marked twice, out of order
+	for (uint32_t index : { 10u, 3u, 4u, 3u, 20u, 14u })
+		tracker.Mark(index);
+	CHECK_EQ(tracker.GetMarkedCount(), 5u);
+
+	// 3-4, then 10 and 14 are 3 clean elements apart, 20 is 5 away from 14
+	const auto& ranges = tracker.Collect(4);
+	REQUIRE(ranges.size() == 3);
+	CHECK(ranges[0].First == 3 && ranges[0].Count == 2);
+	CHECK(ranges[1].First == 10 && ranges[1].Count == 5);
+	CHECK(ranges[2].First == 20 && ranges[2].Count == 1);
+
+	// Collecting clears the marks
+	CHECK(tracker.IsEmpty());
+	CHECK(tracker.Collect(4).empty());
+	tracker.Mark(3);
+	CHECK_EQ(tracker.GetMarkedCount(), 1u);
+
+	// Without a gap only neighbours merge
+	tracker.Mark(4);
+	tracker.Mark(6);
+	CHECK_EQ(tracker.Collect().size(), 2u);
+}
@@ -5,13 +5,18 @@
 
 #include "Shader.h"
 
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
 namespace
 {
-	auto& SRVHeap = Globals.SRVHeap;
-	auto& UAVHeap = Globals.UAVHeap;
-	auto& CBVHeap = Globals.CBVHeap;
-	auto& SamplerHeap = Globals.SamplerHeap;
-	auto& LightsHeap = Globals.LightsHeap;
+	auto& SRVTable = Globals.SRVTable;
+	auto& UAVTable = Globals.UAVTable;
+	auto& CBVTable = Globals.CBVTable;
+	auto& SamplerTable = Globals.SamplerTable;
+	auto& LightsTable = Globals.LightsTable;
 
 	auto& CBGlobalConstants = Globals.CBGlobalConstants;
 
@@ -21,16 +26,66 @@ namespace
 
 	auto& CmdQueue = Globals.CmdQueue;
 	auto& CmdList = Globals.CmdList;
+
+	std::filesystem::path ShaderDirectory()
+	{
+		return std::filesystem::current_path().parent_path() / "Content" / "Shaders-bin";
+	}
+
+	// Points the permutation builds at HLSL sources outside the project tree
+	constexpr const char* ShaderSourceVariable = "DEFERRED_RENDERER_SHADER_SOURCE";
+
+	// HLSL sources for the permutation builds - searched from the executable in bin/, then from the working directory
+	std::optional<std::filesystem::path> ShaderSourceDirectory()
+	{
+		wchar_t executable[MAX_PATH]{};
+		GetModuleFileNameW(nullptr, executable, MAX_PATH);
+
+		char variable[MAX_PATH]{};
+		DWORD length = GetEnvironmentVariableA(ShaderSourceVariable, variable, MAX_PATH);
+		const char* overrideDirectory = length > 0 && length < MAX_PATH ? variable : nullptr;
+
+		return FindShaderSourceDirectory({ std::filesystem::path(executable).parent_path(), std::filesystem::current_path() }, overrideDirectory);
+	}
+
+	// Next to the compiled shaders - the library only holds pipelines built from them
+	std::filesystem::path PipelineCachePath()
+	{
+		return ShaderDirectory() / "Pipelines.bin";
+	}
+
+	std::filesystem::path CameraPathReportPath()
+	{
+		return std::filesystem::current_path().parent_path() / "Content" / "cameraPathTriangles.csv";
+	}
 }
 
-Graphics::Graphics(Window& window)
+GraphicsOptions GraphicsOptions::Parse(const char* commandLine)
+{
+	GraphicsOptions options;
+	std::istringstream arguments(commandLine ? commandLine : "");
+	for (std::string argument; arguments >> argument;)
+	{
+		if (argument == "-report")
+			options.Reports = true;
+		else if (argument == "-no-report")
+			options.Reports = false;
+	}
+	return options;
+}
+
+Graphics::Graphics(Window& window, const GraphicsOptions& options)
 	:WinHandle(window.GetHandle()), SwapChainSize(window.GetWidth(), window.GetHeight()), 
-	SceneCamera()
+	Options(options), SceneCamera()
 {
 	Init();
 	InitGlobals();
 
 	Graph = MakeUnique<RenderGraph>(Device);
+	// The geometry pass records one draw per actor - spread it over the cores
+	Graph->SetSubmissionMode(SubmissionMode::Parallel);
+	if (Options.Reports)
+		Graph->DumpInitTimings(std::cout);
 	InitScene();
 }
 
@@ -43,16 +98,37 @@ void Graphics::Tick(float delta)
 {
 	uint32_t frameIndex = SwapChain->GetCurrentBackBufferIndex();
 
-	// Update Pipeline Constants
-	CmdQueue->Signal(Fence, ++FenceValue);
-	Fence->SetEventOnCompletion(FenceValue, FenceEvent);
-	WaitForSingleObject(FenceEvent, INFINITE);
-
+	// Only the frame that last used this slot has to be finished, the others may still be in flight
+	WaitForFrame(frameIndex);
+	ReloadShaders();
+	Globals.FrameUploads->BeginFrame(frameIndex, Fence->GetCompletedValue());
 	UpdateGlobals(frameIndex, delta);
 	
 	Graph->Tick();
 	MainScene->Tick();
 	Graph->Execute(CmdList, *MainScene);
+	Frames.EndFrame(frameIndex, FenceValue);
+	Globals.FrameUploads->EndFrame(FenceValue);
+	Globals.RootSignatures->EndFrame();
+	if (Options.Reports)
+	{
+		// Sizes and binds per frame of the shared root signatures, once every pass recorded, and what the
+		// first view culled
+		if (FrameCount == 0)
+		{
+			Globals.RootSignatures->Dump(std::cout);
+			const auto& meshlets = MainScene->GetMeshletStats();
+			std::cout << "Meshlets: " << meshlets.Meshlets << ", " << meshlets.OutsideFrustum << " outside the frustum, "
+					  << meshlets.BackFacing << " back facing, " << meshlets.Draws << " draws\n";
+		}
+
+		// Triangles the camera path draws, reported once it hands over to the mouse
+		if (SceneCamera.IsFollowingPath())
+			PathFrames.push_back(MainScene->GetMeshletStats());
+		else if (!PathFrames.empty())
+			ReportCameraPath(std::cout);
+	}
+	FrameCount++;
 
 	EndFrame(frameIndex);
 }
@@ -68,6 +144,24 @@ void Graphics::Init()
 
 	CreateDevice();
 	CmdQueue = D3D::CreateCommandQueue(Device);
+	Globals.Allocator = MakeUnique<GpuAllocator>(Device);
+	Globals.ComputeQueue = D3D::CreateCommandQueue(Device, D3D12_COMMAND_LIST_TYPE_COMPUTE);
+	Globals.Uploads = MakeUnique<UploadService>(Device);
+	Globals.Pipelines = D3D12PipelineCache::Open(Device, PipelineCachePath());
+	Globals.Shaders = MakeUnique<ShaderCache>(MakeUnique<DiskShaderSource>(ShaderDirectory()));
+#ifndef NDEBUG
+	Globals.Shaders->StartWatching();
+#endif
+	// Without dxcompiler or the sources the variants fall back to the precompiled uber-shaders and their runtime switches
+	auto shaderSources = ShaderSourceDirectory();
+	UniquePtr<DxcShaderCompiler> compiler = shaderSources ? DxcShaderCompiler::Create() : nullptr;
+	if (!shaderSources)
+		std::cerr << "Shader sources not found, set " << ShaderSourceVariable << " to compile variants - using the precompiled uber-shaders" << std::endl;
+	else if (!compiler)
+		std::cerr << "dxcompiler not found - using the precompiled uber-shaders" << std::endl;
+	Globals.ShaderVariants = MakeUnique<ShaderVariantCache>(std::move(compiler), shaderSources.value_or(std::filesystem::path()), *Globals.Shaders);
+	// Passes reflecting their shaders need dxcompiler, the others only share their signatures
+	Globals.RootSignatures = MakeUnique<RootSignatureCache>(DxcShaderReflector::Create());
 	CreateSwapChain();
 	RTVHeap.Heap = D3D::CreateDescriptorHeap(Device, RTVHeapSize, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, false);
 	DSVHeap.Heap = D3D::CreateDescriptorHeap(Device, DSVHeapSize, D3D12_DESCRIPTOR_HEAP_TYPE_DSV, false);
@@ -97,14 +191,11 @@ void Graphics::Init()
 		depthOptimizedClearValue.DepthStencil.Depth = 1.0f;
 		depthOptimizedClearValue.DepthStencil.Stencil = 0;
 
-		GRAPHICS_ASSERT(Device->CreateCommittedResource(
-			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-			D3D12_HEAP_FLAG_NONE,
-			&CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_D32_FLOAT, SwapChainSize.x, SwapChainSize.y, 1, 0, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL),
+		FrameObjects[i].DepthStencilBuffer = Globals.Allocator->CreateResource(
+			CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_D32_FLOAT, SwapChainSize.x, SwapChainSize.y, 1, 0, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL),
+			D3D12_HEAP_TYPE_DEFAULT,
 			D3D12_RESOURCE_STATE_DEPTH_WRITE,
-			&depthOptimizedClearValue,
-			IID_PPV_ARGS(&FrameObjects[i].DepthStencilBuffer)
-		));
+			&depthOptimizedClearValue).Resource;
 
 		// DSV Handles
 		FrameObjects[i].DSVHandle = D3D::CreateDSV(Device,
@@ -117,42 +208,54 @@ void Graphics::Init()
 	GRAPHICS_ASSERT(Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
 											  FrameObjects[0].CmdAllocator, nullptr, IID_PPV_ARGS(&CmdList)));
 	GRAPHICS_ASSERT(Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&Fence)));
+	GRAPHICS_ASSERT(Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&Globals.ComputeFence)));
 	FenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
 }
 
 void Graphics::InitGlobals()
 {
-	SRVHeap = D3D::CreateDescriptorHeap(Device, 100, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	UAVHeap = D3D::CreateDescriptorHeap(Device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	CBVHeap = D3D::CreateDescriptorHeap(Device, 400, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	SamplerHeap = D3D::CreateDescriptorHeap(Device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, true);
-	LightsHeap = D3D::CreateDescriptorHeap(Device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+	Globals.Descriptors = MakeUnique<GlobalDescriptorHeaps>(Device);
+	SRVTable = Globals.Descriptors->Allocate(100);
+	UAVTable = Globals.Descriptors->Allocate(1);
+	CBVTable = Globals.Descriptors->Allocate(DefaultSwapChainBuffers);
+	SamplerTable = Globals.Descriptors->AllocateSamplers(1);
+	LightsTable = Globals.Descriptors->Allocate(DefaultSwapChainBuffers);
 
 	GlobalResManager::SetRTV(FrameObjects[0].SwapChainBuffer, FrameObjects[0].RTVHandle);
 	GlobalResManager::SetDSV(FrameObjects[0].DepthStencilBuffer, FrameObjects[0].DSVHandle);
 	GlobalResManager::SetCmdAllocator(FrameObjects[0].CmdAllocator);
 
-	CBGlobalConstants.Init(Device, CBVHeap->GetCPUDescriptorHandleForHeapStart());
+	// Slots [0, DefaultSwapChainBuffers) hold the per-frame CBVs of the global constants
+	CBGlobalConstants.Init(Device, CBVTable.GetCPUHandle());
 }
 
 void Graphics::InitScene()
 {
-	MainScene = MakeUnique<Scene>(Device, SceneCamera);
+	MainScene = MakeUnique<Scene>(Device, SceneCamera, Options.Reports);
+	// Sized once the actors are known - a frame where all of them move stages the whole scene buffer
+	Globals.FrameUploads = MakeUnique<FrameUploadAllocator>(*Globals.Allocator,
+		FrameUploadAllocator::DefaultBytesPerFrame + GpuSceneBuffer::GetMaxStagingBytes(MainScene->GetActorCount()));
 
 	CmdList->Close();
 
 	CmdQueue->Signal(Fence, ++FenceValue);
-	Fence->SetEventOnCompletion(FenceValue, FenceEvent);
-	WaitForSingleObject(FenceEvent, INFINITE);
+	D3D::WaitForFence(Fence, FenceValue, FenceEvent);
 
 	CreateShaderResources();
+	// The sizes are only known once the geometry is uploaded
+	if (Options.Reports)
+		MainScene->GetGeometry().Dump(std::cout);
 }
 
 void Graphics::Shutdown()
 {
 	CmdQueue->Signal(Fence, ++FenceValue);
-	Fence->SetEventOnCompletion(FenceValue, FenceEvent);
-	WaitForSingleObject(FenceEvent, INFINITE);
+	D3D::WaitForFence(Fence, FenceValue, FenceEvent);
+	Globals.Uploads.reset();
+	Globals.Shaders->StopWatching();
+	// Queued variant builds reference the passes
+	Globals.ShaderVariants->StopBackground();
+	Globals.Pipelines->Save();
 }
 
 void Graphics::CreateDevice()
@@ -191,11 +294,33 @@ void Graphics::CreateSwapChain()
 
 void Graphics::CreateShaderResources()
 {
-	MainScene->CreateShaderResources(Device, CmdQueue);
+	MainScene->CreateShaderResources(Device, *Globals.Uploads);
+
+	// One submission for everything queued while loading - frames only wait on the GPU
+	Globals.Uploads->QueueWait(CmdQueue, Globals.Uploads->Flush());
+}
+
+void Graphics::WaitForFrame(UINT frameIndex)
+{
+	Frames.WaitForSlot(Graph->GetSubmitter(), frameIndex);
+}
+
+void Graphics::ReloadShaders()
+{
+	auto changed = Globals.Shaders->TakeChanged();
+	if (changed.empty()) return;
+
+	// Frames in flight may still use the PSOs about to be replaced
+	CmdQueue->Signal(Fence, ++FenceValue);
+	D3D::WaitForFence(Fence, FenceValue, FenceEvent);
+
+	Graph->ReloadShaders(changed);
 }
 
 inline void Graphics::UpdateGlobals(UINT frameIndex, float delta)
 {
+	Globals.FrameIndex = frameIndex;
+
 	SceneCamera.Tick(delta);
 	CBGlobalConstants.CPUData.CameraPosition = SceneCamera.GetPosition();
 	CBGlobalConstants.CPUData.View = SceneCamera.GetView();
@@ -205,16 +330,34 @@ inline void Graphics::UpdateGlobals(UINT frameIndex, float delta)
 	GlobalResManager::SetRTV(FrameObjects[frameIndex].SwapChainBuffer, FrameObjects[frameIndex].RTVHandle);
 	GlobalResManager::SetDSV(FrameObjects[frameIndex].DepthStencilBuffer, FrameObjects[frameIndex].DSVHandle);
 	GlobalResManager::SetCmdAllocator(FrameObjects[frameIndex].CmdAllocator);
-	CBGlobalConstants.Tick();
+	CBGlobalConstants.Tick(frameIndex);
 }
 
-void Graphics::EndFrame(UINT frameIndex)
+void Graphics::ReportCameraPath(std::ostream& os)
 {
-	SwapChain->Present(1, 0);
+	uint64_t total = 0;
+	uint32_t least = std::numeric_limits<uint32_t>::max();
+	uint32_t most = 0;
 
-	if (FenceValue > DefaultSwapChainBuffers)
+	std::ofstream file(CameraPathReportPath());
+	file << "frame,triangles,draws,meshlets,outside frustum,back facing\n";
+	for (size_t i = 0; i < PathFrames.size(); i++)
 	{
-		Fence->SetEventOnCompletion(FenceValue - DefaultSwapChainBuffers + 1, FenceEvent);
-		WaitForSingleObject(FenceEvent, INFINITE);
+		const auto& frame = PathFrames[i];
+		file << i << "," << frame.Triangles << "," << frame.Draws << "," << frame.Meshlets << ","
+			 << frame.OutsideFrustum << "," << frame.BackFacing << "\n";
+		total += frame.Triangles;
+		least = std::min(least, frame.Triangles);
+		most = std::max(most, frame.Triangles);
 	}
+
+	os << "Camera path: " << PathFrames.size() << " frames, " << least << " / " << total / PathFrames.size() << " / " << most
+	   << " triangles per frame (min / average / max), " << MainScene->GetGeometry().GetStats().LodTriangles[0]
+	   << " at full detail. Per frame in " << CameraPathReportPath().string() << "\n";
+	PathFrames.clear();
+}
+
+void Graphics::EndFrame(UINT frameIndex)
+{
+	SwapChain->Present(1, 0);
 }
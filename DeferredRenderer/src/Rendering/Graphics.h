@@ -12,11 +12,27 @@
 #include "Rendering/Resources.h"
 #include "Rendering/RenderGraph.h"
 
+#include <ostream>
+
 struct ImGuiLayer;
 
+// Startup switches of the renderer, read from the command line
+struct GraphicsOptions
+{
+#ifndef NDEBUG
+	bool Reports = true;
+#else
+	bool Reports = false;
+#endif
+
+	// "-report" prints the geometry, mesh reordering, init timing, root signature and camera path reports
+	// to stdout, "-no-report" turns them off. Other arguments are left alone
+	static GraphicsOptions Parse(const char* commandLine);
+};
+
 struct Graphics
 {
-	Graphics(Window& window);
+	Graphics(Window& window, const GraphicsOptions& options = {});
 	~Graphics();
 
 	void Tick(float delta);
@@ -35,8 +51,13 @@ private:
 
     void CreateShaderResources();
 
+    void WaitForFrame(UINT frameIndex);
+    // Rebuilds the PSOs of the shaders the watcher saw change
+    void ReloadShaders();
     void UpdateGlobals(UINT frameIndex, float delta);
     void EndFrame(UINT frameIndex);
+    // Triangles drawn in every frame of the camera path - per frame to a file next to the path, a summary to os
+    void ReportCameraPath(std::ostream& os);
 
 private:
     HWND WinHandle{ nullptr };
@@ -61,6 +82,7 @@ private:
         D3D12_CPU_DESCRIPTOR_HANDLE RTVHandle;
         D3D12_CPU_DESCRIPTOR_HANDLE DSVHandle;
     } FrameObjects[DefaultSwapChainBuffers];
+    FrameFences Frames;
 
     struct HeapData
     {
@@ -73,6 +95,9 @@ private:
     static const uint32_t RTVHeapSize = 3;
     static const uint32_t DSVHeapSize = 3;
 
+    GraphicsOptions Options;
     Camera SceneCamera;
+    uint64_t FrameCount = 0;
+    std::vector<MeshletCullStats> PathFrames;
 };
 
@@ -0,0 +1,386 @@
+#include "MeshOptimization.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+	// Triangles using each vertex, in compressed rows: Triangles[Offsets[v]..Offsets[v + 1])
+	struct Adjacency
+	{
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Triangles;
+
+		Adjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+			:Offsets(vertexCount + 1, 0), Triangles(indices.size())
+		{
+			for (uint32_t index : indices)
+				Offsets[index + 1]++;
+			std::partial_sum(Offsets.begin(), Offsets.end(), Offsets.begin());
+
+			std::vector<uint32_t> fill(Offsets.begin(), Offsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i++)
+				Triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	};
+
+	// FIFO cache simulation with timestamps - a vertex is cached while fewer than cacheSize misses happened since its own
+	class FifoCache
+	{
+	public:
+		FifoCache(size_t vertexCount, uint32_t cacheSize)
+			:Stamps(vertexCount, 0), Size(cacheSize), Time(cacheSize + 1)
+		{}
+
+		// True on a miss
+		bool Access(uint32_t vertex)
+		{
+			if (Time - Stamps[vertex] <= Size) return false;
+			Stamps[vertex] = Time++;
+			return true;
+		}
+
+		// Makes every vertex miss again
+		void Flush() { Time += Size + 1; }
+
+	private:
+		std::vector<uint32_t> Stamps;
+		uint32_t Size;
+		uint32_t Time;
+	};
+
+	constexpr int OverdrawGrid = 256;
+
+	struct ProjectedVertex
+	{
+		float X, Y, Z;
+	};
+
+	// Counts the depth test passes of one view, in draw order
+	class OverdrawRasterizer
+	{
+	public:
+		OverdrawRasterizer()
+			:Depth(OverdrawGrid * OverdrawGrid, std::numeric_limits<float>::max())
+		{}
+
+		void Draw(const ProjectedVertex& a, const ProjectedVertex& b, const ProjectedVertex& c)
+		{
+			float area = Edge(a, b, c.X, c.Y);
+			if (area == 0.0f) return;
+
+			int minX = std::max(static_cast<int>(std::min({ a.X, b.X, c.X })), 0);
+			int minY = std::max(static_cast<int>(std::min({ a.Y, b.Y, c.Y })), 0);
+			int maxX = std::min(static_cast<int>(std::max({ a.X, b.X, c.X })), OverdrawGrid - 1);
+			int maxY = std::min(static_cast<int>(std::max({ a.Y, b.Y, c.Y })), OverdrawGrid - 1);
+
+			// Both windings are drawn - the passes draw static meshes without culling
+			for (int y = minY; y <= maxY; y++)
+				for (int x = minX; x <= maxX; x++)
+				{
+					float px = x + 0.5f, py = y + 0.5f;
+					float w0 = Edge(b, c, px, py) / area;
+					float w1 = Edge(c, a, px, py) / area;
+					float w2 = Edge(a, b, px, py) / area;
+					if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+					float z = w0 * a.Z + w1 * b.Z + w2 * c.Z;
+					float& stored = Depth[y * OverdrawGrid + x];
+					if (z >= stored) continue;
+
+					if (stored == std::numeric_limits<float>::max()) Covered++;
+					stored = z;
+					Shaded++;
+				}
+		}
+
+		uint64_t Covered = 0;
+		uint64_t Shaded = 0;
+
+	private:
+		static float Edge(const ProjectedVertex& a, const ProjectedVertex& b, float x, float y)
+		{
+			return (b.X - a.X) * (y - a.Y) - (b.Y - a.Y) * (x - a.X);
+		}
+
+		std::vector<float> Depth;
+	};
+
+	uint32_t GetNextVertex(const std::vector<uint32_t>& candidates, const std::vector<uint32_t>& liveTriangles,
+						   const std::vector<uint32_t>& stamps, uint32_t time, uint32_t cacheSize)
+	{
+		// Prefer the candidate that stays cached longest while its remaining triangles are fanned
+		uint32_t best = std::numeric_limits<uint32_t>::max();
+		int bestPriority = -1;
+		for (uint32_t vertex : candidates)
+		{
+			if (liveTriangles[vertex] == 0) continue;
+
+			int priority = 0;
+			if (time - stamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+				priority = static_cast<int>(time - stamps[vertex]);
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				best = vertex;
+			}
+		}
+		return best;
+	}
+}
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+	if (indices.empty() || vertexCount == 0) return {};
+
+	FifoCache cache(vertexCount, cacheSize);
+	uint32_t misses = 0;
+	for (uint32_t index : indices)
+		misses += cache.Access(index);
+
+	return { static_cast<float>(misses) / (indices.size() / 3), static_cast<float>(misses) / vertexCount };
+}
+
+float AnalyzeOverdraw(const std::vector<uint32_t>& indices, const std::vector<StaticVertex>& vertices)
+{
+	if (indices.empty()) return 0.0f;
+
+	glm::float3 min = vertices[indices.front()].Position;
+	glm::float3 max = min;
+	for (uint32_t index : indices)
+	{
+		min = glm::min(min, vertices[index].Position);
+		max = glm::max(max, vertices[index].Position);
+	}
+	glm::float3 extent = max - min;
+	float scale = static_cast<float>(OverdrawGrid) / std::max({ extent.x, extent.y, extent.z, std::numeric_limits<float>::min() });
+
+	uint64_t covered = 0;
+	uint64_t shaded = 0;
+	std::vector<ProjectedVertex> projected(vertices.size());
+	for (int axis = 0; axis < 3; axis++)
+		for (float direction : { 1.0f, -1.0f })
+		{
+			int u = (axis + 1) % 3, v = (axis + 2) % 3;
+			for (size_t i = 0; i < vertices.size(); i++)
+			{
+				glm::float3 p = (vertices[i].Position - min) * scale;
+				projected[i] = { p[u], p[v], p[axis] * direction };
+			}
+
+			OverdrawRasterizer rasterizer;
+			for (size_t i = 0; i + 2 < indices.size(); i += 3)
+				rasterizer.Draw(projected[indices[i]], projected[indices[i + 1]], projected[indices[i + 2]]);
+			covered += rasterizer.Covered;
+			shaded += rasterizer.Shaded;
+		}
+
+	return covered ? static_cast<float>(shaded) / covered : 0.0f;
+}
+
+std::vector<uint32_t> OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+	std::vector<uint32_t> clusters;
+	if (indices.empty()) return clusters;
+
+	Adjacency adjacency(indices, vertexCount);
+	std::vector<uint32_t> liveTriangles(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		liveTriangles[v] = adjacency.Offsets[v + 1] - adjacency.Offsets[v];
+
+	std::vector<uint32_t> stamps(vertexCount, 0);
+	std::vector<bool> emitted(indices.size() / 3, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+
+	uint32_t time = cacheSize + 1;
+	uint32_t cursor = 0;
+	const uint32_t none = std::numeric_limits<uint32_t>::max();
+
+	// Vertices are visited in order when the recent ones have nothing left to fan
+	auto skipDeadEnd = [&]()
+		{
+			while (!deadEnds.empty())
+			{
+				uint32_t vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[vertex] > 0) return vertex;
+			}
+			for (; cursor < vertexCount; cursor++)
+				if (liveTriangles[cursor] > 0) return cursor;
+			return none;
+		};
+
+	uint32_t fan = skipDeadEnd();
+	clusters.push_back(0);
+	while (fan != none)
+	{
+		candidates.clear();
+		for (uint32_t i = adjacency.Offsets[fan]; i < adjacency.Offsets[fan + 1]; i++)
+		{
+			uint32_t triangle = adjacency.Triangles[i];
+			if (emitted[triangle]) continue;
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = indices[triangle * 3 + corner];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if (time - stamps[vertex] > cacheSize)
+					stamps[vertex] = time++;
+			}
+			emitted[triangle] = true;
+		}
+
+		fan = GetNextVertex(candidates, liveTriangles, stamps, time, cacheSize);
+		if (fan == none)
+		{
+			fan = skipDeadEnd();
+			if (fan != none)
+				clusters.push_back(static_cast<uint32_t>(output.size() / 3));
+		}
+	}
+
+	indices = std::move(output);
+	return clusters;
+}
+
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<StaticVertex>& vertices, const std::vector<uint32_t>& clusters,
+					  float threshold, uint32_t cacheSize)
+{
+	const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+	if (triangleCount == 0) return;
+
+	// Split the dead-end clusters where the part so far is at most threshold times worse than the whole cluster
+	std::vector<uint32_t> starts;
+	FifoCache cache(vertices.size(), cacheSize);
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		uint32_t first = clusters[c];
+		uint32_t last = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+		cache.Flush();
+		uint32_t clusterMisses = 0;
+		for (uint32_t i = first * 3; i < last * 3; i++)
+			clusterMisses += cache.Access(indices[i]);
+		float clusterACMR = static_cast<float>(clusterMisses) / (last - first);
+
+		cache.Flush();
+		starts.push_back(first);
+		uint32_t misses = 0, triangles = 0;
+		for (uint32_t t = first; t < last; t++)
+		{
+			for (int corner = 0; corner < 3; corner++)
+				misses += cache.Access(indices[t * 3 + corner]);
+			triangles++;
+
+			if (t + 1 < last && static_cast<float>(misses) / triangles <= clusterACMR * threshold)
+			{
+				starts.push_back(t + 1);
+				cache.Flush();
+				misses = triangles = 0;
+			}
+		}
+	}
+
+	// Area weighted centroid and normal of every cluster and of the whole mesh
+	struct Cluster
+	{
+		uint32_t First = 0;
+		uint32_t Last = 0;
+		float Sort = 0.0f;
+	};
+	std::vector<Cluster> sorted(starts.size());
+	std::vector<glm::float3> centroids(starts.size());
+	std::vector<glm::float3> normals(starts.size());
+	glm::float3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < starts.size(); c++)
+	{
+		uint32_t first = starts[c];
+		uint32_t last = c + 1 < starts.size() ? starts[c + 1] : triangleCount;
+
+		glm::float3 centroid(0.0f), normal(0.0f);
+		float area = 0.0f;
+		for (uint32_t t = first; t < last; t++)
+		{
+			const auto& a = vertices[indices[t * 3]].Position;
+			const auto& b = vertices[indices[t * 3 + 1]].Position;
+			const auto& d = vertices[indices[t * 3 + 2]].Position;
+			glm::float3 cross = glm::cross(b - a, d - a);
+			float triangleArea = glm::length(cross);
+			centroid += (a + b + d) * (triangleArea / 3.0f);
+
+			// The vertex normals decide which side is the front, so the winding convention does not matter
+			const auto& na = vertices[indices[t * 3]].Normal;
+			const auto& nb = vertices[indices[t * 3 + 1]].Normal;
+			const auto& nd = vertices[indices[t * 3 + 2]].Normal;
+			normal += glm::dot(cross, na + nb + nd) < 0.0f ? -cross : cross;
+			area += triangleArea;
+		}
+
+		sorted[c] = { first, last };
+		centroids[c] = area > 0.0f ? centroid / area : vertices[indices[first * 3]].Position;
+		normals[c] = glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::float3(0.0f);
+		meshCentroid += centroid;
+		meshArea += area;
+	}
+	if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+	// Clusters facing away from the centre are on the outside and occlude the rest
+	for (size_t c = 0; c < sorted.size(); c++)
+		sorted[c].Sort = glm::dot(centroids[c] - meshCentroid, normals[c]);
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.Sort > b.Sort; });
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (const auto& cluster : sorted)
+		output.insert(output.end(), indices.begin() + cluster.First * 3, indices.begin() + cluster.Last * 3);
+	indices = std::move(output);
+}
+
+void OptimizeVertexFetch(std::vector<StaticVertex>& vertices, std::vector<uint32_t>& indices)
+{
+	const uint32_t unused = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> remap(vertices.size(), unused);
+	uint32_t next = 0;
+	for (auto& index : indices)
+	{
+		if (remap[index] == unused)
+			remap[index] = next++;
+		index = remap[index];
+	}
+
+	std::vector<StaticVertex> reordered(next);
+	for (size_t v = 0; v < vertices.size(); v++)
+		if (remap[v] != unused)
+			reordered[remap[v]] = vertices[v];
+	vertices = std::move(reordered);
+}
+
+MeshOptimizationReport OptimizeMesh(std::vector<StaticVertex>& vertices, std::vector<uint32_t>& indices, bool analyze)
+{
+	MeshOptimizationReport report;
+	if (analyze)
+	{
+		report.CacheBefore = AnalyzeVertexCache(indices, vertices.size());
+		report.OverdrawBefore = AnalyzeOverdraw(indices, vertices);
+	}
+
+	auto clusters = OptimizeVertexCache(indices, vertices.size());
+	OptimizeOverdraw(indices, vertices, clusters);
+	OptimizeVertexFetch(vertices, indices);
+
+	if (analyze)
+	{
+		report.CacheAfter = AnalyzeVertexCache(indices, vertices.size());
+		report.OverdrawAfter = AnalyzeOverdraw(indices, vertices);
+	}
+	return report;
+}
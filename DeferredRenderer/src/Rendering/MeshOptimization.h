@@ -0,0 +1,46 @@
+#pragma once
+#include "Core/Core.h"
+#include "VertexPacking.h"
+
+// Import-time reordering of static meshes and the simulators that measure it. StaticGeometry runs
+// the reordering on every mesh it uploads, the simulators only for -report. Indices are triangle lists
+
+// Post-transform cache the reordering targets and the simulator models - FIFO, like most hardware
+constexpr uint32_t DefaultVertexCacheSize = 16;
+
+struct VertexCacheStats
+{
+	float ACMR = 0.0f;	// Average cache miss ratio - transformed vertices per triangle, 0.5 at best
+	float ATVR = 0.0f;	// Average transformed to vertex ratio - 1.0 at best
+};
+
+// Vertices transformed when the indices run through a FIFO cache of cacheSize entries
+VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = DefaultVertexCacheSize);
+
+// Rasterizes the mesh in index order from the six axis directions into a small depth buffer.
+// Overdraw is shaded pixels over covered pixels - 1.0 when no pixel is shaded twice
+float AnalyzeOverdraw(const std::vector<uint32_t>& indices, const std::vector<StaticVertex>& vertices);
+
+// Tipsify (Sander, Nehab, Barczak 2007) - fans around recently used vertices so they are still
+// cached. Returns the first triangle of every cluster - a new one starts wherever the walk hit a dead end
+std::vector<uint32_t> OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = DefaultVertexCacheSize);
+
+// Reorders the clusters of OptimizeVertexCache so outward facing ones draw first and hide what is
+// behind them. Clusters are split further where that costs at most threshold times their ACMR
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<StaticVertex>& vertices, const std::vector<uint32_t>& clusters,
+					  float threshold = 1.05f, uint32_t cacheSize = DefaultVertexCacheSize);
+
+// Renumbers the vertices in the order the indices first use them, unused ones are dropped
+void OptimizeVertexFetch(std::vector<StaticVertex>& vertices, std::vector<uint32_t>& indices);
+
+struct MeshOptimizationReport
+{
+	VertexCacheStats CacheBefore;
+	VertexCacheStats CacheAfter;
+	float OverdrawBefore = 0.0f;
+	float OverdrawAfter = 0.0f;
+};
+
+// Cache, overdraw and fetch order in that order. The report is only filled when analyze is set,
+// the overdraw simulation costs more than the optimization
+MeshOptimizationReport OptimizeMesh(std::vector<StaticVertex>& vertices, std::vector<uint32_t>& indices, bool analyze);
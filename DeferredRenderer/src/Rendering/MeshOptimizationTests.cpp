@@ -0,0 +1,171 @@
+#include "Test.h"
+#include "Rendering/MeshOptimization.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+namespace
+{
+	using Triangle = std::array<uint32_t, 3>;
+
+	// A flat grid of rows x columns cells in the xy plane, two triangles per cell. TexCoords.x keeps the
+	// original vertex index, so triangles can be compared after the fetch remap
+	struct Grid
+	{
+		std::vector<StaticVertex> Vertices;
+		std::vector<uint32_t> Indices;
+
+		Grid(uint32_t rows, uint32_t columns)
+		{
+			for (uint32_t row = 0; row <= rows; row++)
+				for (uint32_t column = 0; column <= columns; column++)
+				{
+					StaticVertex vertex{};
+					vertex.Position = { static_cast<float>(column), static_cast<float>(row), 0.0f };
+					vertex.Normal = { 0, 0, 1 };
+					vertex.TexCoords = { static_cast<float>(Vertices.size()), 0.0f };
+					Vertices.push_back(vertex);
+				}
+			for (uint32_t row = 0; row < rows; row++)
+				for (uint32_t column = 0; column < columns; column++)
+				{
+					uint32_t a = row * (columns + 1) + column;
+					uint32_t b = a + 1;
+					uint32_t c = a + columns + 1;
+					uint32_t d = c + 1;
+					Indices.insert(Indices.end(), { a, c, b, b, c, d });
+				}
+		}
+
+		// Triangles in random order, each rotated by a random amount - keeps the winding
+		void Shuffle(uint32_t seed)
+		{
+			std::mt19937 random(seed);
+			std::vector<Triangle> triangles = GetTriangles(Indices);
+			std::shuffle(triangles.begin(), triangles.end(), random);
+			Indices.clear();
+			for (auto triangle : triangles)
+			{
+				std::rotate(triangle.begin(), triangle.begin() + random() % 3, triangle.end());
+				Indices.insert(Indices.end(), triangle.begin(), triangle.end());
+			}
+		}
+
+		static std::vector<Triangle> GetTriangles(const std::vector<uint32_t>& indices)
+		{
+			std::vector<Triangle> triangles;
+			for (size_t i = 0; i + 2 < indices.size(); i += 3)
+				triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+			return triangles;
+		}
+	};
+
+	// Every triangle rotated to start at its smallest index, sorted - equal for equal triangle sets of equal winding
+	std::vector<Triangle> Canonical(const std::vector<uint32_t>& indices)
+	{
+		auto triangles = Grid::GetTriangles(indices);
+		for (auto& triangle : triangles)
+			std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+		std::ranges::sort(triangles);
+		return triangles;
+	}
+
+	// Indices back to the vertices they had before the fetch remap
+	std::vector<uint32_t> OriginalIndices(const std::vector<StaticVertex>& vertices, const std::vector<uint32_t>& indices)
+	{
+		std::vector<uint32_t> original;
+		for (uint32_t index : indices)
+			original.push_back(static_cast<uint32_t>(vertices[index].TexCoords.x));
+		return original;
+	}
+}
+
+TEST_CASE(ReorderingKeepsTrianglesAndWinding)
+{
+	Grid grid(16, 16);
+	grid.Shuffle(1);
+	const auto expected = Canonical(grid.Indices);
+
+	auto clusters = OptimizeVertexCache(grid.Indices, grid.Vertices.size());
+	CHECK(Canonical(grid.Indices) == expected);
+	REQUIRE(!clusters.empty());
+	CHECK_EQ(clusters.front(), 0u);
+	CHECK(std::ranges::is_sorted(clusters));
+
+	OptimizeOverdraw(grid.Indices, grid.Vertices, clusters);
+	CHECK(Canonical(grid.Indices) == expected);
+
+	OptimizeVertexFetch(grid.Vertices, grid.Indices);
+	CHECK(Canonical(OriginalIndices(grid.Vertices, grid.Indices)) == expected);
+}
+
+TEST_CASE(VertexCacheOrderLowersACMROfAShuffledGrid)
+{
+	Grid grid(32, 32);
+	grid.Shuffle(2);
+	auto before = AnalyzeVertexCache(grid.Indices, grid.Vertices.size());
+
+	OptimizeVertexCache(grid.Indices, grid.Vertices.size());
+	auto after = AnalyzeVertexCache(grid.Indices, grid.Vertices.size());
+
+	// A shuffled grid misses nearly every vertex, the walk gets close to one per triangle or better
+	CHECK(before.ACMR > 2.0f);
+	CHECK(after.ACMR < 1.0f);
+	CHECK(after.ATVR < before.ATVR);
+	std::cout << "Shuffled 32x32 grid: ACMR " << before.ACMR << " -> " << after.ACMR << ", ATVR " << before.ATVR << " -> " << after.ATVR << "\n";
+}
+
+TEST_CASE(FetchOrderDropsUnusedVertices)
+{
+	Grid grid(4, 4);
+	// Only the upper half of the cells is drawn
+	grid.Indices.erase(grid.Indices.begin(), grid.Indices.begin() + grid.Indices.size() / 2);
+	std::ranges::reverse(grid.Indices);
+	const auto expected = Canonical(grid.Indices);
+
+	OptimizeVertexFetch(grid.Vertices, grid.Indices);
+
+	// Rows 2 to 4 of five vertices each, numbered in the order the indices first use them
+	CHECK_EQ(grid.Vertices.size(), 15u);
+	uint32_t next = 0;
+	for (uint32_t index : grid.Indices)
+	{
+		CHECK(index <= next);
+		next = std::max(next, index + 1);
+	}
+	CHECK_EQ(next, 15u);
+	CHECK(Canonical(OriginalIndices(grid.Vertices, grid.Indices)) == expected);
+}
+
+TEST_CASE(EmptyAndDegenerateMeshesSurviveTheReordering)
+{
+	std::vector<StaticVertex> vertices;
+	std::vector<uint32_t> indices;
+	auto report = OptimizeMesh(vertices, indices, true);
+	CHECK(vertices.empty());
+	CHECK(indices.empty());
+	CHECK_EQ(report.CacheAfter.ACMR, 0.0f);
+	CHECK_EQ(report.OverdrawAfter, 0.0f);
+
+	// Triangles with a repeated corner, one without any area, and a vertex nothing uses
+	Grid grid(1, 2);
+	grid.Vertices.push_back(grid.Vertices.back());
+	grid.Indices.insert(grid.Indices.end(), { 0, 0, 1, 2, 2, 2, 0, 1, 2 });
+	const auto expected = Canonical(grid.Indices);
+
+	auto clusters = OptimizeVertexCache(grid.Indices, grid.Vertices.size());
+	CHECK(Canonical(grid.Indices) == expected);
+	OptimizeOverdraw(grid.Indices, grid.Vertices, clusters);
+	CHECK(Canonical(grid.Indices) == expected);
+	OptimizeVertexFetch(grid.Vertices, grid.Indices);
+	CHECK(Canonical(OriginalIndices(grid.Vertices, grid.Indices)) == expected);
+	CHECK_EQ(grid.Vertices.size(), 6u);
+
+	// Only degenerate triangles
+	vertices = std::vector<StaticVertex>(3);
+	indices = { 0, 0, 0, 1, 1, 2 };
+	report = OptimizeMesh(vertices, indices, true);
+	CHECK_EQ(indices.size(), 6u);
+	CHECK_EQ(vertices.size(), 3u);
+}
@@ -0,0 +1,290 @@
+#include "MeshSimplification.h"
+#include "Core/Exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace
+{
+	// Sum of squared distances to a set of planes, in double - the terms cancel out near zero
+	struct Quadric
+	{
+		double A00 = 0, A01 = 0, A02 = 0, A11 = 0, A12 = 0, A22 = 0;
+		double B0 = 0, B1 = 0, B2 = 0;
+		double C = 0;
+
+		// normal has unit length
+		static Quadric FromPlane(const glm::vec3& normal, float distance, float weight)
+		{
+			double a = normal.x, b = normal.y, c = normal.z, d = distance;
+			return { a * a * weight, a * b * weight, a * c * weight, b * b * weight, b * c * weight, c * c * weight,
+					 a * d * weight, b * d * weight, c * d * weight, d * d * weight };
+		}
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			A00 += other.A00; A01 += other.A01; A02 += other.A02;
+			A11 += other.A11; A12 += other.A12; A22 += other.A22;
+			B0 += other.B0; B1 += other.B1; B2 += other.B2;
+			C += other.C;
+			return *this;
+		}
+
+		double Evaluate(const glm::vec3& p) const
+		{
+			double x = p.x, y = p.y, z = p.z;
+			double result = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z)
+				+ 2.0 * (B0 * x + B1 * y + B2 * z) + C;
+			return std::max(result, 0.0);
+		}
+	};
+
+	enum class VertexKind : uint8_t { Manifold, Border, Locked };
+
+	// Borders are held by planes through the border edge perpendicular to its triangle, weighted up
+	// so sliding a border inwards costs more than flattening the inside. The weight only orders the
+	// collapses, distances are measured with every plane at weight 1
+	constexpr float BorderWeight = 10.0f;
+
+	struct Edge
+	{
+		uint32_t A, B;
+		bool operator<(const Edge& other) const { return std::tie(A, B) < std::tie(other.A, other.B); }
+		bool operator==(const Edge& other) const { return A == other.A && B == other.B; }
+	};
+
+	// Undirected edges with the number of triangles using them, sorted
+	std::vector<std::pair<Edge, uint32_t>> CountEdges(const std::vector<uint32_t>& indices)
+	{
+		std::vector<Edge> edges;
+		edges.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+			for (size_t e = 0; e < 3; e++)
+			{
+				uint32_t a = indices[i + e], b = indices[i + (e + 1) % 3];
+				edges.push_back({ std::min(a, b), std::max(a, b) });
+			}
+		std::sort(edges.begin(), edges.end());
+
+		std::vector<std::pair<Edge, uint32_t>> counted;
+		for (const auto& edge : edges)
+		{
+			if (!counted.empty() && counted.back().first == edge)
+				counted.back().second++;
+			else
+				counted.emplace_back(edge, 1);
+		}
+		return counted;
+	}
+
+	bool IsBorderEdge(const std::vector<std::pair<Edge, uint32_t>>& edges, uint32_t a, uint32_t b)
+	{
+		Edge edge{ std::min(a, b), std::max(a, b) };
+		auto it = std::lower_bound(edges.begin(), edges.end(), edge, [](const auto& entry, const Edge& e) { return entry.first < e; });
+		return it != edges.end() && it->first == edge && it->second == 1;
+	}
+
+	std::vector<VertexKind> ClassifyVertices(const std::vector<StaticVertex>& vertices, const std::vector<std::pair<Edge, uint32_t>>& edges)
+	{
+		std::vector<VertexKind> kinds(vertices.size(), VertexKind::Manifold);
+
+		// Vertices sharing a position split an attribute - moving one of them would tear the seam
+		std::vector<uint32_t> order(vertices.size());
+		std::iota(order.begin(), order.end(), 0);
+		auto position = [&vertices](uint32_t v) { const auto& p = vertices[v].Position; return std::tie(p.x, p.y, p.z); };
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return position(a) < position(b); });
+		for (size_t i = 1; i < order.size(); i++)
+			if (position(order[i]) == position(order[i - 1]))
+				kinds[order[i]] = kinds[order[i - 1]] = VertexKind::Locked;
+
+		std::vector<uint8_t> borderEdges(vertices.size(), 0);
+		for (const auto& [edge, count] : edges)
+		{
+			if (count > 2)
+				kinds[edge.A] = kinds[edge.B] = VertexKind::Locked;
+			else if (count == 1)
+			{
+				borderEdges[edge.A] = static_cast<uint8_t>(std::min(borderEdges[edge.A] + 1, 255));
+				borderEdges[edge.B] = static_cast<uint8_t>(std::min(borderEdges[edge.B] + 1, 255));
+			}
+		}
+
+		// A border through a vertex more than once pinches the surface there
+		for (size_t v = 0; v < vertices.size(); v++)
+			if (kinds[v] == VertexKind::Manifold && borderEdges[v])
+				kinds[v] = borderEdges[v] == 2 ? VertexKind::Border : VertexKind::Locked;
+		return kinds;
+	}
+
+	struct Collapse
+	{
+		uint32_t From;
+		uint32_t To;
+		double Cost;
+	};
+
+	glm::vec3 TriangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+	{
+		return glm::cross(b - a, c - a);
+	}
+}
+
+std::vector<uint32_t> SimplifyMesh(const std::vector<StaticVertex>& vertices, const std::vector<uint32_t>& indices,
+								   size_t targetIndexCount, float maxError, float& error)
+{
+	ASSERT(indices.size() % 3 == 0, "Meshes are simplified as triangle lists");
+
+	error = 0.0f;
+	std::vector<uint32_t> result = indices;
+	if (result.size() <= targetIndexCount) return result;
+
+	auto edges = CountEdges(indices);
+	auto kinds = ClassifyVertices(vertices, edges);
+
+	// quadrics rank the collapses, distances holds the same planes unweighted for the error in mesh units
+	std::vector<Quadric> quadrics(vertices.size());
+	std::vector<Quadric> distances(vertices.size());
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const auto& a = vertices[indices[i]].Position;
+		const auto& b = vertices[indices[i + 1]].Position;
+		const auto& c = vertices[indices[i + 2]].Position;
+		glm::vec3 normal = TriangleNormal(a, b, c);
+		float length = glm::length(normal);
+		if (length <= std::numeric_limits<float>::min()) continue;
+		normal /= length;
+
+		auto plane = Quadric::FromPlane(normal, -glm::dot(normal, a), 1.0f);
+		for (size_t e = 0; e < 3; e++)
+		{
+			uint32_t from = indices[i + e], to = indices[i + (e + 1) % 3];
+			quadrics[from] += plane;
+			distances[from] += plane;
+
+			if (!IsBorderEdge(edges, from, to)) continue;
+			glm::vec3 edgeVector = vertices[to].Position - vertices[from].Position;
+			glm::vec3 borderNormal = glm::cross(edgeVector, normal);
+			float borderLength = glm::length(borderNormal);
+			if (borderLength <= std::numeric_limits<float>::min()) continue;
+			borderNormal /= borderLength;
+			float borderDistance = -glm::dot(borderNormal, vertices[from].Position);
+			auto border = Quadric::FromPlane(borderNormal, borderDistance, BorderWeight);
+			quadrics[from] += border;
+			quadrics[to] += border;
+			auto unweighted = Quadric::FromPlane(borderNormal, borderDistance, 1.0f);
+			distances[from] += unweighted;
+			distances[to] += unweighted;
+		}
+	}
+
+	const double maxCost = double(maxError) * maxError;
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> remap(vertices.size());
+	std::vector<bool> touched(vertices.size());
+	std::vector<uint32_t> offsets(vertices.size() + 1);
+	std::vector<uint32_t> triangles;
+
+	// Every pass collapses the cheapest edges whose neighbourhoods do not overlap, then rebuilds the indices
+	while (result.size() > targetIndexCount)
+	{
+		// Collapses along the border leave new border edges behind
+		edges = CountEdges(result);
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3)
+			for (size_t e = 0; e < 3; e++)
+			{
+				uint32_t a = result[i + e], b = result[i + (e + 1) % 3];
+				bool border = IsBorderEdge(edges, a, b);
+				for (auto [from, to] : { std::pair{ a, b }, std::pair{ b, a } })
+				{
+					if (kinds[from] == VertexKind::Locked) continue;
+					if (kinds[from] == VertexKind::Border && (!border || kinds[to] == VertexKind::Manifold)) continue;
+
+					Quadric merged = quadrics[from];
+					merged += quadrics[to];
+					collapses.push_back({ from, to, merged.Evaluate(vertices[to].Position) });
+				}
+			}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b)
+			{
+				return std::tie(a.Cost, a.From, a.To) < std::tie(b.Cost, b.From, b.To);
+			});
+
+		// Triangles around every vertex, in compressed rows
+		std::fill(offsets.begin(), offsets.end(), 0);
+		for (uint32_t index : result)
+			offsets[index + 1]++;
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		triangles.resize(result.size());
+		{
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < result.size(); i++)
+				triangles[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::iota(remap.begin(), remap.end(), 0);
+		std::fill(touched.begin(), touched.end(), false);
+		size_t remaining = result.size() / 3;
+		size_t collapsed = 0;
+
+		for (const auto& [from, to, cost] : collapses)
+		{
+			// No plane weighs more than BorderWeight, every later collapse moves further than maxError
+			if (cost > maxCost * BorderWeight || remaining * 3 <= targetIndexCount) break;
+			if (touched[from] || touched[to]) continue;
+
+			Quadric merged = distances[from];
+			merged += distances[to];
+			double distance = merged.Evaluate(vertices[to].Position);
+			if (distance > maxCost) continue;
+
+			// Moving from onto to must not turn any remaining triangle over
+			bool flips = false;
+			uint32_t removed = 0;
+			for (uint32_t i = offsets[from]; i < offsets[from + 1] && !flips; i++)
+			{
+				const uint32_t* triangle = &result[triangles[i] * 3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				{
+					removed++;
+					continue;
+				}
+
+				glm::vec3 before = TriangleNormal(vertices[triangle[0]].Position, vertices[triangle[1]].Position, vertices[triangle[2]].Position);
+				auto moved = [&](uint32_t v) { return v == from ? vertices[to].Position : vertices[v].Position; };
+				glm::vec3 after = TriangleNormal(moved(triangle[0]), moved(triangle[1]), moved(triangle[2]));
+				flips = glm::dot(before, after) <= 0.0f;
+			}
+			if (flips) continue;
+
+			remap[from] = to;
+			quadrics[to] += quadrics[from];
+			distances[to] += distances[from];
+			for (uint32_t i = offsets[from]; i < offsets[from + 1]; i++)
+				for (uint32_t k = 0; k < 3; k++)
+					touched[result[triangles[i] * 3 + k]] = true;
+
+			error = std::max(error, static_cast<float>(std::sqrt(distance)));
+			remaining -= removed;
+			collapsed++;
+		}
+		if (collapsed == 0) break;
+
+		// Neither end of a collapse moves again in the same pass, so one lookup resolves every vertex
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+			if (a == b || b == c || a == c) continue;
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	return result;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "Core/Core.h"
+#include "VertexPacking.h"
+
+// Import-time simplification of static meshes into lower levels of detail. StaticGeometry builds the
+// chain on upload, SelectLod picks a level per actor every frame
+
+// Quadric error metric simplification (Garland, Heckbert 1997). Edges collapse onto one of their
+// vertices instead of a new position, so every level indexes the vertex buffer of the full mesh.
+// Vertices on texture or normal seams and non-manifold edges never move, border vertices only
+// slide along the border.
+// Stops at targetIndexCount indices or when the next collapse would move a vertex further than maxError
+// off the planes it stands for. error receives the largest such distance of the result, in mesh units
+std::vector<uint32_t> SimplifyMesh(const std::vector<StaticVertex>& vertices, const std::vector<uint32_t>& indices,
+								   size_t targetIndexCount, float maxError, float& error);
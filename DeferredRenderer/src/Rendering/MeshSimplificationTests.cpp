@@ -0,0 +1,102 @@
+#include "Test.h"
+#include "Rendering/MeshSimplification.h"
+
+#include <numbers>
+
+namespace
+{
+	constexpr uint32_t RingVertices = 64;
+	constexpr float RingRadius = 2.0f;
+
+	// A flat regular polygon in the xy plane, fanned from its first vertex - every vertex is on the border
+	struct Disc
+	{
+		std::vector<StaticVertex> Vertices;
+		std::vector<uint32_t> Indices;
+
+		Disc()
+		{
+			for (uint32_t i = 0; i < RingVertices; i++)
+			{
+				float angle = 2.0f * std::numbers::pi_v<float> * i / RingVertices;
+				StaticVertex vertex{};
+				vertex.Position = { RingRadius * std::cos(angle), RingRadius * std::sin(angle), 0.0f };
+				vertex.Normal = { 0, 0, 1 };
+				Vertices.push_back(vertex);
+			}
+			for (uint32_t i = 1; i + 1 < RingVertices; i++)
+				Indices.insert(Indices.end(), { 0, i, i + 1 });
+		}
+	};
+
+	// Sliding a vertex of the polygon onto its neighbour leaves that neighbour this far off the
+	// border edge on the other side: a chord turned by the angle between neighbouring edges
+	float BorderCollapseDistance()
+	{
+		float angle = 2.0f * std::numbers::pi_v<float> / RingVertices;
+		float chord = 2.0f * RingRadius * std::sin(angle * 0.5f);
+		return chord * std::sin(angle);
+	}
+}
+
+TEST_CASE(SimplificationErrorIsADistanceInMeshUnits)
+{
+	Disc disc;
+	const float distance = BorderCollapseDistance();
+	const size_t triangles = disc.Indices.size() / 3;
+
+	// One collapse along the border. The weight that keeps borders in place does not scale the error
+	float error = -1.0f;
+	auto level = SimplifyMesh(disc.Vertices, disc.Indices, (triangles - 1) * 3, distance * 2.0f, error);
+	CHECK_EQ(level.size(), (triangles - 1) * 3);
+	CHECK_NEAR(error, distance, distance * 1e-3f);
+
+	// The limit is in the same units: just below the distance nothing moves, just above it does
+	level = SimplifyMesh(disc.Vertices, disc.Indices, 0, distance * 0.99f, error);
+	CHECK(level == disc.Indices);
+	CHECK_EQ(error, 0.0f);
+
+	level = SimplifyMesh(disc.Vertices, disc.Indices, 0, distance * 1.01f, error);
+	CHECK(level.size() < disc.Indices.size());
+	CHECK(error > 0.0f && error <= distance * 1.01f);
+}
+
+TEST_CASE(SimplificationErrorStaysWithinTheLimit)
+{
+	Disc disc;
+	const float distance = BorderCollapseDistance();
+
+	// Errors add up as collapses pile onto each other, none past the limit
+	for (float maxError : { 2.0f, 5.0f, 20.0f, 100.0f })
+	{
+		float error = -1.0f;
+		auto level = SimplifyMesh(disc.Vertices, disc.Indices, 0, distance * maxError, error);
+		CHECK(level.size() < disc.Indices.size());
+		CHECK(error >= distance * 0.999f);
+		CHECK(error <= distance * maxError);
+	}
+
+	// A flat square with straight borders folds down to its corners for free
+	std::vector<StaticVertex> vertices;
+	std::vector<uint32_t> indices;
+	constexpr uint32_t Cells = 8;
+	for (uint32_t y = 0; y <= Cells; y++)
+		for (uint32_t x = 0; x <= Cells; x++)
+		{
+			StaticVertex vertex{};
+			vertex.Position = { float(x), float(y), 0.0f };
+			vertex.Normal = { 0, 0, 1 };
+			vertices.push_back(vertex);
+		}
+	for (uint32_t y = 0; y < Cells; y++)
+		for (uint32_t x = 0; x < Cells; x++)
+		{
+			uint32_t a = y * (Cells + 1) + x, b = a + 1, c = a + Cells + 1, d = c + 1;
+			indices.insert(indices.end(), { a, b, c, b, d, c });
+		}
+
+	float error = -1.0f;
+	auto level = SimplifyMesh(vertices, indices, 6, 1e-3f, error);
+	CHECK(level.size() <= indices.size() / 8);
+	CHECK(error < 1e-5f);
+}
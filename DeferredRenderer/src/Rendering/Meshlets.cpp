@@ -0,0 +1,285 @@
+#include "Meshlets.h"
+#include "Core/Exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// Face normal of a triangle turned to the side its vertex normals point to, zero when it has no area
+	glm::vec3 FrontNormal(const std::vector<StaticVertex>& vertices, const uint32_t* triangle)
+	{
+		const auto& a = vertices[triangle[0]];
+		const auto& b = vertices[triangle[1]];
+		const auto& c = vertices[triangle[2]];
+
+		glm::vec3 normal = glm::cross(b.Position - a.Position, c.Position - a.Position);
+		float length = glm::length(normal);
+		if (length <= std::numeric_limits<float>::min()) return glm::vec3(0.0f);
+
+		normal /= length;
+		return glm::dot(normal, a.Normal + b.Normal + c.Normal) < 0.0f ? -normal : normal;
+	}
+
+	MeshletData ComputeBounds(const std::vector<StaticVertex>& vertices, const std::vector<uint32_t>& indices,
+							  uint32_t firstTriangle, uint32_t lastTriangle, uint32_t vertexCount)
+	{
+		MeshletData meshlet{};
+		meshlet.FirstIndex = firstTriangle * 3;
+		meshlet.TriangleCount = lastTriangle - firstTriangle;
+		meshlet.VertexCount = vertexCount;
+
+		glm::vec3 low(std::numeric_limits<float>::max()), high(std::numeric_limits<float>::lowest());
+		for (uint32_t i = firstTriangle * 3; i < lastTriangle * 3; i++)
+		{
+			low = glm::min(low, vertices[indices[i]].Position);
+			high = glm::max(high, vertices[indices[i]].Position);
+		}
+		meshlet.BoundsMin = low;
+		meshlet.BoundsMax = high;
+		meshlet.Center = (low + high) * 0.5f;
+		for (uint32_t i = firstTriangle * 3; i < lastTriangle * 3; i++)
+			meshlet.Radius = std::max(meshlet.Radius, glm::length(vertices[indices[i]].Position - meshlet.Center));
+
+		// The cone holds every face normal. Its apex sits behind all triangle planes, so a camera that
+		// sees the apex from within the cone sees the back of every triangle
+		meshlet.ConeApex = meshlet.Center;
+		meshlet.ConeCutoff = 1.0f;
+
+		std::vector<glm::vec3> normals;
+		normals.reserve(meshlet.TriangleCount);
+		glm::vec3 axis(0.0f);
+		for (uint32_t t = firstTriangle; t < lastTriangle; t++)
+		{
+			glm::vec3 normal = FrontNormal(vertices, &indices[t * 3]);
+			normals.push_back(normal);
+			axis += normal;
+		}
+		if (glm::length(axis) <= std::numeric_limits<float>::min()) return meshlet;
+		axis = glm::normalize(axis);
+
+		float minDot = 1.0f;
+		for (const auto& normal : normals)
+			if (normal != glm::vec3(0.0f))
+				minDot = std::min(minDot, glm::dot(axis, normal));
+		// Normals spread over a hemisphere or more - no camera sees only back faces
+		if (minDot <= 0.0f) return meshlet;
+
+		float apexDistance = 0.0f;
+		for (uint32_t t = firstTriangle; t < lastTriangle; t++)
+		{
+			const auto& normal = normals[t - firstTriangle];
+			if (normal == glm::vec3(0.0f)) continue;
+			const auto& corner = vertices[indices[t * 3]].Position;
+			apexDistance = std::max(apexDistance, glm::dot(meshlet.Center - corner, normal) / glm::dot(axis, normal));
+		}
+
+		meshlet.ConeAxis = axis;
+		meshlet.ConeApex = meshlet.Center - axis * apexDistance;
+		meshlet.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+		return meshlet;
+	}
+
+	float PlaneDistance(const glm::vec4& plane, const glm::vec3& point)
+	{
+		return glm::dot(glm::vec3(plane), point) + plane.w;
+	}
+}
+
+std::vector<MeshletData> BuildMeshlets(const std::vector<StaticVertex>& vertices, const std::vector<uint32_t>& indices,
+									   uint32_t maxVertices, uint32_t maxTriangles)
+{
+	ASSERT(indices.size() % 3 == 0, "Meshlets are built from triangle lists");
+	ASSERT(maxVertices >= 3 && maxTriangles >= 1, "A meshlet has to hold at least one triangle");
+
+	std::vector<MeshletData> meshlets;
+	// Last meshlet each vertex was added to
+	std::vector<uint32_t> owner(vertices.size(), std::numeric_limits<uint32_t>::max());
+	uint32_t current = 0;
+	uint32_t first = 0;
+	uint32_t vertexCount = 0;
+
+	uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+	for (uint32_t t = 0; t < triangleCount; t++)
+	{
+		const uint32_t* triangle = &indices[t * 3];
+		auto newVertices = [&]()
+			{
+				uint32_t a = triangle[0], b = triangle[1], c = triangle[2];
+				return uint32_t(owner[a] != current) + uint32_t(owner[b] != current && b != a)
+					+ uint32_t(owner[c] != current && c != a && c != b);
+			};
+
+		if (vertexCount + newVertices() > maxVertices || t - first >= maxTriangles)
+		{
+			meshlets.push_back(ComputeBounds(vertices, indices, first, t, vertexCount));
+			current++;
+			first = t;
+			vertexCount = 0;
+		}
+
+		vertexCount += newVertices();
+		for (uint32_t i = 0; i < 3; i++)
+			owner[triangle[i]] = current;
+	}
+	if (triangleCount > first)
+		meshlets.push_back(ComputeBounds(vertices, indices, first, triangleCount, vertexCount));
+
+	return meshlets;
+}
+
+MeshletCullView MeshletCullView::Create(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const glm::mat4& model, bool cones)
+{
+	// Planes of the clip volume 0 <= z <= w, read from the rows of the mesh to clip transform
+	glm::mat4 clip = viewProjection * model;
+	auto row = [&clip](int r) { return glm::vec4(clip[0][r], clip[1][r], clip[2][r], clip[3][r]); };
+
+	MeshletCullView view;
+	view.Planes = { row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2) };
+	for (auto& plane : view.Planes)
+		plane /= glm::length(glm::vec3(plane));
+
+	view.CameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+	view.Cones = cones;
+	return view;
+}
+
+MeshletVisibility CullMeshlet(const MeshletData& meshlet, const MeshletCullView& view)
+{
+	for (const auto& plane : view.Planes)
+		if (PlaneDistance(plane, meshlet.Center) < -meshlet.Radius)
+			return MeshletVisibility::OutsideFrustum;
+
+	// The corner furthest along the plane normal is outside, so is the box
+	for (const auto& plane : view.Planes)
+	{
+		glm::vec3 corner = glm::mix(meshlet.BoundsMin, meshlet.BoundsMax, glm::greaterThanEqual(glm::vec3(plane), glm::vec3(0.0f)));
+		if (PlaneDistance(plane, corner) < 0.0f)
+			return MeshletVisibility::OutsideFrustum;
+	}
+
+	// A camera on the apex gives a NaN direction, which compares false and keeps the cluster
+	if (view.Cones && glm::dot(glm::normalize(meshlet.ConeApex - view.CameraPosition), meshlet.ConeAxis) >= meshlet.ConeCutoff)
+		return MeshletVisibility::BackFacing;
+
+	return MeshletVisibility::Visible;
+}
+
+MeshletCullStats& MeshletCullStats::operator+=(const MeshletCullStats& other)
+{
+	Meshlets += other.Meshlets;
+	OutsideFrustum += other.OutsideFrustum;
+	BackFacing += other.BackFacing;
+	Draws += other.Draws;
+	Triangles += other.Triangles;
+	return *this;
+}
+
+MeshletCullStats CullMeshlets(const MeshletData* meshlets, uint32_t count, const MeshletCullView& view, std::vector<IndexRange>& draws)
+{
+	MeshletCullStats stats;
+	stats.Meshlets = count;
+	draws.clear();
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const auto& meshlet = meshlets[i];
+		switch (CullMeshlet(meshlet, view))
+		{
+		case MeshletVisibility::OutsideFrustum:
+			stats.OutsideFrustum++;
+			continue;
+		case MeshletVisibility::BackFacing:
+			stats.BackFacing++;
+			continue;
+		default:
+			break;
+		}
+
+		uint32_t indexCount = meshlet.TriangleCount * 3;
+		stats.Triangles += meshlet.TriangleCount;
+		if (!draws.empty() && draws.back().First + draws.back().Count == meshlet.FirstIndex)
+			draws.back().Count += indexCount;
+		else
+			draws.push_back({ meshlet.FirstIndex, indexCount });
+	}
+
+	stats.Draws = static_cast<uint32_t>(draws.size());
+	return stats;
+}
+
+uint32_t VerifyMeshletCulling(const std::vector<MeshletData>& meshlets, const std::vector<StaticVertex>& vertices,
+							  const std::vector<uint32_t>& indices, const MeshletCullView& view)
+{
+	uint32_t failures = 0;
+	for (const auto& meshlet : meshlets)
+	{
+		auto visibility = CullMeshlet(meshlet, view);
+		if (visibility == MeshletVisibility::Visible) continue;
+
+		// Rounding of the bounds and the cone, not a visible triangle
+		float tolerance = 1e-4f * meshlet.Radius;
+		bool wrong = false;
+		for (uint32_t i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.TriangleCount * 3 && !wrong; i += 3)
+		{
+			if (visibility == MeshletVisibility::OutsideFrustum)
+			{
+				bool outside = std::any_of(view.Planes.begin(), view.Planes.end(), [&](const glm::vec4& plane)
+					{
+						return PlaneDistance(plane, vertices[indices[i]].Position) < tolerance
+							&& PlaneDistance(plane, vertices[indices[i + 1]].Position) < tolerance
+							&& PlaneDistance(plane, vertices[indices[i + 2]].Position) < tolerance;
+					});
+				wrong = !outside;
+			}
+			else
+			{
+				glm::vec3 normal = FrontNormal(vertices, &indices[i]);
+				wrong = glm::dot(vertices[indices[i]].Position - view.CameraPosition, normal) < -tolerance;
+			}
+		}
+		failures += wrong;
+	}
+	return failures;
+}
+
+uint32_t VerifyMeshletCulling(const std::vector<MeshletData>& meshlets, const std::vector<StaticVertex>& vertices,
+							  const std::vector<uint32_t>& indices)
+{
+	if (vertices.empty()) return 0;
+
+	glm::vec3 low(std::numeric_limits<float>::max()), high(std::numeric_limits<float>::lowest());
+	for (const auto& vertex : vertices)
+	{
+		low = glm::min(low, vertex.Position);
+		high = glm::max(high, vertex.Position);
+	}
+	glm::vec3 center = (low + high) * 0.5f;
+	float radius = std::max(glm::length(high - center), 1e-3f);
+
+	// Outside on the axes and the diagonals looking at the mesh, and from its centre looking along the axes
+	std::vector<std::pair<glm::vec3, glm::vec3>> cameras;
+	const glm::vec3 axes[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	for (const auto& axis : axes)
+	{
+		cameras.emplace_back(center + axis * radius * 2.0f, center);
+		cameras.emplace_back(center, center + axis);
+	}
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 direction((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+		cameras.emplace_back(center + glm::normalize(direction) * radius * 2.0f, center);
+	}
+
+	glm::mat4 projection = glm::perspectiveLH_ZO(glm::radians(60.0f), 1.0f, radius * 0.01f, radius * 10.0f);
+	uint32_t failures = 0;
+	for (const auto& [eye, target] : cameras)
+	{
+		glm::vec3 forward = glm::normalize(target - eye);
+		glm::vec3 up = std::abs(forward.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+		glm::mat4 viewProjection = projection * glm::lookAtLH(eye, target, up);
+		failures += VerifyMeshletCulling(meshlets, vertices, indices, MeshletCullView::Create(viewProjection, eye, glm::mat4(1.0f), true));
+	}
+	return failures;
+}
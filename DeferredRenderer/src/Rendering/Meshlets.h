@@ -0,0 +1,64 @@
+#pragma once
+#include "Core/Core.h"
+#include "VertexPacking.h"
+#include "GpuScene.h"
+#include "Shaders/HLSLCompat.h"
+
+#include <array>
+
+// Import-time clustering of static meshes and the per-cluster culling that decides what an actor draws.
+// The clusters are built once per level of detail, the culling runs on the CPU every frame for each actor
+
+// Sizes of the clusters - what a mesh shader group would output, so the same clusters fit that path
+constexpr uint32_t MaxMeshletVertices = 64;
+constexpr uint32_t MaxMeshletTriangles = 124;
+
+// Read as a tightly packed StructuredBuffer element
+static_assert(sizeof(MeshletData) == 80, "MeshletData layout differs from the HLSL structured buffer");
+
+// Splits the triangles in index order, a cluster ends when the next triangle would exceed either limit.
+// Run it on cache optimized indices - their order is already local. FirstIndex is relative to indices.
+// vertices: the positions the GPU reconstructs, so the bounds hold for what is rasterized
+std::vector<MeshletData> BuildMeshlets(const std::vector<StaticVertex>& vertices, const std::vector<uint32_t>& indices,
+									   uint32_t maxVertices = MaxMeshletVertices, uint32_t maxTriangles = MaxMeshletTriangles);
+
+// The camera as seen from the mesh space of one actor. Facing and plane distances survive any
+// invertible affine transform, so the clusters are tested without transforming their bounds
+struct MeshletCullView
+{
+	std::array<glm::vec4, 6> Planes{};	// Normalized, points with dot(plane, (p, 1)) >= 0 are inside
+	glm::vec3 CameraPosition{ 0.0f };
+	bool Cones = true;					// Off for meshes seen from both sides
+
+	static MeshletCullView Create(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const glm::mat4& model, bool cones);
+};
+
+enum class MeshletVisibility { Visible, OutsideFrustum, BackFacing };
+
+// The sphere rejects most clusters, the box catches long thin ones the sphere overestimates
+MeshletVisibility CullMeshlet(const MeshletData& meshlet, const MeshletCullView& view);
+
+struct MeshletCullStats
+{
+	uint32_t Meshlets = 0;
+	uint32_t OutsideFrustum = 0;
+	uint32_t BackFacing = 0;
+	uint32_t Draws = 0;			// Runs of visible clusters, each one indexed draw
+	uint32_t Triangles = 0;		// In the visible clusters
+
+	MeshletCullStats& operator+=(const MeshletCullStats& other);
+};
+
+// Culls meshlets and merges the visible ones that follow each other in the index buffer into index
+// ranges, one draw each. Returns the ranges in draws, which is cleared first
+MeshletCullStats CullMeshlets(const MeshletData* meshlets, uint32_t count, const MeshletCullView& view, std::vector<IndexRange>& draws);
+
+// Checks the culling against the triangles: a cluster outside the frustum needs all its triangles outside
+// one plane, a back facing one needs every triangle facing away. Front is the side the vertex normals
+// point to. Returns the clusters culled although one of their triangles could be seen
+uint32_t VerifyMeshletCulling(const std::vector<MeshletData>& meshlets, const std::vector<StaticVertex>& vertices,
+							  const std::vector<uint32_t>& indices, const MeshletCullView& view);
+
+// Runs VerifyMeshletCulling from cameras around and inside the mesh bounds, returns the failures of all of them
+uint32_t VerifyMeshletCulling(const std::vector<MeshletData>& meshlets, const std::vector<StaticVertex>& vertices,
+							  const std::vector<uint32_t>& indices);
@@ -0,0 +1,200 @@
+#include "Test.h"
+#include "Rendering/Meshlets.h"
+
+#include <numbers>
+
+namespace
+{
+	struct Mesh
+	{
+		std::vector<StaticVertex> Vertices;
+		std::vector<uint32_t> Indices;
+
+		uint32_t AddVertex(const glm::vec3& position, const glm::vec3& normal)
+		{
+			StaticVertex vertex{};
+			vertex.Position = position;
+			vertex.Normal = normal;
+			Vertices.push_back(vertex);
+			return static_cast<uint32_t>(Vertices.size() - 1);
+		}
+
+		// Rows of columns + 1 vertices, two triangles per cell
+		void AddGrid(uint32_t first, uint32_t rows, uint32_t columns)
+		{
+			for (uint32_t row = 0; row < rows; row++)
+				for (uint32_t column = 0; column < columns; column++)
+				{
+					uint32_t a = first + row * (columns + 1) + column;
+					uint32_t b = a + 1;
+					uint32_t c = a + columns + 1;
+					uint32_t d = c + 1;
+					Indices.insert(Indices.end(), { a, c, b, b, c, d });
+				}
+		}
+	};
+
+	// Hard edges - every face has its own vertices
+	Mesh Cube(uint32_t cells)
+	{
+		Mesh mesh;
+		const glm::vec3 axes[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+		for (const auto& normal : axes)
+		{
+			glm::vec3 u = std::abs(normal.y) > 0.5f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+			glm::vec3 v = glm::cross(normal, u);
+			uint32_t first = static_cast<uint32_t>(mesh.Vertices.size());
+			for (uint32_t i = 0; i <= cells; i++)
+				for (uint32_t j = 0; j <= cells; j++)
+					mesh.AddVertex(normal + u * (2.0f * i / cells - 1.0f) + v * (2.0f * j / cells - 1.0f), normal);
+			mesh.AddGrid(first, cells, cells);
+		}
+		return mesh;
+	}
+
+	// Latitude and longitude, the rows at the poles collapse into triangles without area
+	Mesh Sphere(uint32_t stacks, uint32_t slices)
+	{
+		Mesh mesh;
+		for (uint32_t stack = 0; stack <= stacks; stack++)
+		{
+			float theta = std::numbers::pi_v<float> * stack / stacks;
+			for (uint32_t slice = 0; slice <= slices; slice++)
+			{
+				float phi = 2.0f * std::numbers::pi_v<float> * slice / slices;
+				glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+				mesh.AddVertex(normal * 3.0f, normal);
+			}
+		}
+		mesh.AddGrid(0, stacks, slices);
+		return mesh;
+	}
+
+	// In the xz plane facing +y
+	Mesh FlatPatch(uint32_t cells)
+	{
+		Mesh mesh;
+		for (uint32_t i = 0; i <= cells; i++)
+			for (uint32_t j = 0; j <= cells; j++)
+				mesh.AddVertex({ float(i), 0.0f, float(j) }, { 0, 1, 0 });
+		mesh.AddGrid(0, cells, cells);
+		return mesh;
+	}
+
+	MeshletCullView LookAt(const glm::vec3& eye, const glm::vec3& target)
+	{
+		glm::mat4 projection = glm::perspectiveLH_ZO(glm::radians(60.0f), 1.0f, 0.1f, 1000.0f);
+		glm::vec3 forward = glm::normalize(target - eye);
+		glm::vec3 up = std::abs(forward.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+		return MeshletCullView::Create(projection * glm::lookAtLH(eye, target, up), eye, glm::mat4(1.0f), true);
+	}
+
+	MeshletCullStats Cull(const std::vector<MeshletData>& meshlets, const MeshletCullView& view)
+	{
+		std::vector<IndexRange> draws;
+		return CullMeshlets(meshlets.data(), static_cast<uint32_t>(meshlets.size()), view, draws);
+	}
+
+	// The clusters follow each other and cover every triangle once, within the limits
+	void CheckPartition(const Mesh& mesh, const std::vector<MeshletData>& meshlets, uint32_t maxVertices, uint32_t maxTriangles)
+	{
+		uint32_t next = 0;
+		for (const auto& meshlet : meshlets)
+		{
+			CHECK_EQ(meshlet.FirstIndex, next);
+			CHECK(meshlet.TriangleCount > 0 && meshlet.TriangleCount <= maxTriangles);
+			CHECK(meshlet.VertexCount > 0 && meshlet.VertexCount <= maxVertices);
+			next += meshlet.TriangleCount * 3;
+		}
+		CHECK_EQ(next, static_cast<uint32_t>(mesh.Indices.size()));
+	}
+}
+
+TEST_CASE(MeshletCullingKeepsTheVisibleTrianglesOfACube)
+{
+	Mesh cube = Cube(8);
+	auto meshlets = BuildMeshlets(cube.Vertices, cube.Indices);
+	CheckPartition(cube, meshlets, MaxMeshletVertices, MaxMeshletTriangles);
+	CHECK_EQ(VerifyMeshletCulling(meshlets, cube.Vertices, cube.Indices), 0u);
+
+	// Clusters spanning an edge bend by 90 degrees and still have a cone
+	auto stats = Cull(meshlets, LookAt({ 0, 0, -10 }, { 0, 0, 0 }));
+	CHECK_EQ(stats.OutsideFrustum, 0u);
+	CHECK(stats.BackFacing > 0);
+	CHECK(stats.Triangles < static_cast<uint32_t>(cube.Indices.size() / 3));
+
+	// A face is 4 clusters of 32 triangles. Flat, their cones hide them from anywhere behind their face,
+	// so looking straight at one face only its clusters are left
+	meshlets = BuildMeshlets(cube.Vertices, cube.Indices, MaxMeshletVertices, 32);
+	CheckPartition(cube, meshlets, MaxMeshletVertices, 32);
+	CHECK_EQ(VerifyMeshletCulling(meshlets, cube.Vertices, cube.Indices), 0u);
+	stats = Cull(meshlets, LookAt({ 0, 0, -10 }, { 0, 0, 0 }));
+	CHECK_EQ(stats.BackFacing, 20u);
+	CHECK_EQ(stats.Triangles, 2u * 8 * 8);
+}
+
+TEST_CASE(MeshletCullingKeepsTheVisibleTrianglesOfASphere)
+{
+	Mesh sphere = Sphere(24, 48);
+	for (uint32_t maxTriangles : { MaxMeshletTriangles, 32u, 8u })
+	{
+		auto meshlets = BuildMeshlets(sphere.Vertices, sphere.Indices, MaxMeshletVertices, maxTriangles);
+		CheckPartition(sphere, meshlets, MaxMeshletVertices, maxTriangles);
+		CHECK_EQ(VerifyMeshletCulling(meshlets, sphere.Vertices, sphere.Indices), 0u);
+
+		// Also close by, where the visible cap is small and grazing clusters sit at the silhouette
+		for (const auto& eye : { glm::vec3(0, 0, -20), glm::vec3(0, 3.2f, 0), glm::vec3(2.5f, 0, 2.5f) })
+			CHECK_EQ(VerifyMeshletCulling(meshlets, sphere.Vertices, sphere.Indices, LookAt(eye, glm::vec3(0.0f))), 0u);
+	}
+
+	// Small clusters bend little, the far side is culled by their cones
+	auto meshlets = BuildMeshlets(sphere.Vertices, sphere.Indices, MaxMeshletVertices, 8);
+	auto stats = Cull(meshlets, LookAt({ 0, 0, -20 }, { 0, 0, 0 }));
+	CHECK(stats.BackFacing > stats.Meshlets / 4);
+}
+
+TEST_CASE(FlatPatchHasAZeroCone)
+{
+	Mesh patch = FlatPatch(16);
+	auto meshlets = BuildMeshlets(patch.Vertices, patch.Indices);
+	REQUIRE(meshlets.size() > 1);
+	for (const auto& meshlet : meshlets)
+	{
+		// Every normal on the axis - back facing from anywhere below the plane
+		CHECK_NEAR(meshlet.ConeCutoff, 0.0f, 1e-3f);
+		CHECK_NEAR(meshlet.ConeAxis.y, 1.0f, 1e-6f);
+		CHECK_NEAR(meshlet.ConeApex.y, 0.0f, 1e-6f);
+	}
+	CHECK_EQ(VerifyMeshletCulling(meshlets, patch.Vertices, patch.Indices), 0u);
+
+	const glm::vec3 center(8, 0, 8);
+	auto above = Cull(meshlets, LookAt(center + glm::vec3(0, 10, -10), center));
+	CHECK_EQ(above.BackFacing, 0u);
+	auto below = Cull(meshlets, LookAt(center + glm::vec3(0, -10, -10), center));
+	CHECK_EQ(below.BackFacing, below.Meshlets);
+	CHECK_EQ(below.Draws, 0u);
+
+	// Just above the plane the triangles are seen edge on, but seen
+	auto grazing = LookAt(center + glm::vec3(0, 0.01f, -20), center);
+	CHECK_EQ(Cull(meshlets, grazing).BackFacing, 0u);
+	CHECK_EQ(VerifyMeshletCulling(meshlets, patch.Vertices, patch.Indices, grazing), 0u);
+
+	// The winding does not matter, the vertex normals say where the front is
+	Mesh flipped = patch;
+	for (size_t i = 0; i < flipped.Indices.size(); i += 3)
+		std::swap(flipped.Indices[i + 1], flipped.Indices[i + 2]);
+	auto flippedMeshlets = BuildMeshlets(flipped.Vertices, flipped.Indices);
+	CHECK_EQ(Cull(flippedMeshlets, LookAt(center + glm::vec3(0, -10, -10), center)).BackFacing, below.Meshlets);
+	CHECK_EQ(VerifyMeshletCulling(flippedMeshlets, flipped.Vertices, flipped.Indices), 0u);
+
+	// A patch whose triangles have no area has no cone and is never back facing
+	Mesh collapsed = patch;
+	for (auto& vertex : collapsed.Vertices)
+		vertex.Position = center;
+	for (const auto& meshlet : BuildMeshlets(collapsed.Vertices, collapsed.Indices))
+	{
+		CHECK_EQ(meshlet.ConeCutoff, 1.0f);
+		CHECK(meshlet.ConeAxis == glm::vec3(0.0f));
+		CHECK(CullMeshlet(meshlet, LookAt(center + glm::vec3(0, -10, -10), center)) != MeshletVisibility::BackFacing);
+	}
+}
@@ -0,0 +1,159 @@
+#include "PipelineCache.h"
+#include "Core/Hash.h"
+
+#include <fstream>
+
+namespace
+{
+	struct FileHeader
+	{
+		uint32_t Magic = 0;
+		uint32_t Version = 0;
+		PipelineLibraryIdentity Identity;
+		uint64_t Size = 0;
+		uint64_t Checksum = 0;
+	};
+
+	uint64_t Checksum(const std::vector<uint8_t>& blob)
+	{
+		Hasher hasher;
+		hasher.Add(blob.data(), blob.size());
+		return hasher.Get();
+	}
+
+	std::streamoff Remaining(std::istream& stream)
+	{
+		auto position = stream.tellg();
+		stream.seekg(0, std::ios::end);
+		auto end = stream.tellg();
+		stream.seekg(position);
+		return end - position;
+	}
+}
+
+PipelineLibraryStatus PipelineCacheFile::Read(std::istream& stream, const PipelineLibraryIdentity& identity, std::vector<uint8_t>& blob)
+{
+	blob.clear();
+
+	FileHeader header;
+	if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) return PipelineLibraryStatus::Corrupt;
+	if (header.Magic != Magic || header.Version != Version) return PipelineLibraryStatus::Corrupt;
+	if (header.Identity != identity) return PipelineLibraryStatus::OtherDriver;
+	// A damaged size must not turn into a huge allocation
+	if (header.Size > static_cast<uint64_t>(Remaining(stream))) return PipelineLibraryStatus::Corrupt;
+
+	std::vector<uint8_t> data(header.Size);
+	if (!stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()))) return PipelineLibraryStatus::Corrupt;
+	if (Checksum(data) != header.Checksum) return PipelineLibraryStatus::Corrupt;
+
+	blob = std::move(data);
+	return PipelineLibraryStatus::Loaded;
+}
+
+void PipelineCacheFile::Write(std::ostream& stream, const PipelineLibraryIdentity& identity, const std::vector<uint8_t>& blob)
+{
+	FileHeader header;
+	header.Magic = Magic;
+	header.Version = Version;
+	header.Identity = identity;
+	header.Size = blob.size();
+	header.Checksum = Checksum(blob);
+
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+}
+
+PipelineCache::PipelineCache(UniquePtr<PipelineBackend> backend, std::filesystem::path file)
+	:Backend(std::move(backend)), File(std::move(file))
+{}
+
+void PipelineCache::LoadFile()
+{
+	std::ifstream stream(File, std::ios::binary);
+	if (stream)
+		Load(stream);
+}
+
+PipelineLibraryStatus PipelineCache::Load(std::istream& stream)
+{
+	std::lock_guard lock(Mutex);
+
+	std::vector<uint8_t> blob;
+	auto status = PipelineCacheFile::Read(stream, Backend->GetIdentity(), blob);
+	if (status == PipelineLibraryStatus::Loaded && !Backend->Deserialize(std::move(blob)))
+		status = PipelineLibraryStatus::Rejected;
+	return status;
+}
+
+PipelineHandle PipelineCache::Get(const PipelineRequest& request)
+{
+	{
+		std::lock_guard lock(Mutex);
+		Stats.Requests++;
+		if (auto it = Pipelines.find(request.Key); it != Pipelines.end())
+		{
+			Stats.Deduplicated++;
+			return it->second;
+		}
+	}
+
+	// Compiled outside the lock so pipelines of different passes build concurrently
+	std::wstring name = GetEntryName(request.Key);
+	PipelineHandle pipeline = Backend->Load(name, request);
+	bool loaded = pipeline != nullptr;
+	if (!loaded)
+	{
+		pipeline = Backend->Create(request);
+		Backend->Store(name, pipeline);
+	}
+
+	std::lock_guard lock(Mutex);
+	// Another thread may have built the same description meanwhile - everyone keeps the first
+	auto [it, inserted] = Pipelines.emplace(request.Key, pipeline);
+	if (!inserted)
+	{
+		Stats.Deduplicated++;
+		return it->second;
+	}
+
+	if (loaded)
+		Stats.Loaded++;
+	else
+	{
+		Stats.Compiled++;
+		Modified = true;
+	}
+	return pipeline;
+}
+
+void PipelineCache::Save()
+{
+	if (!Modified || File.empty()) return;
+
+	std::ofstream stream(File, std::ios::binary | std::ios::trunc);
+	// A read-only content folder only costs the warm start
+	if (stream)
+		Save(stream);
+}
+
+void PipelineCache::Save(std::ostream& stream)
+{
+	std::lock_guard lock(Mutex);
+	PipelineCacheFile::Write(stream, Backend->GetIdentity(), Backend->Serialize());
+	Modified = false;
+}
+
+PipelineCacheStats PipelineCache::GetStats()
+{
+	std::lock_guard lock(Mutex);
+	return Stats;
+}
+
+std::wstring PipelineCache::GetEntryName(uint64_t key)
+{
+	// 16 lower case hex digits
+	std::wstring name(16, L'0');
+	for (size_t i = name.size(); i-- > 0; key >>= 4)
+		name[i] = L"0123456789abcdef"[key & 0xF];
+	return name;
+}
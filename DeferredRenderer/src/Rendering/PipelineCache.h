@@ -0,0 +1,124 @@
+#pragma once
+#include "Core/Memory.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Adapter and driver a pipeline library was serialized by - drivers reject the blobs of any other
+struct PipelineLibraryIdentity
+{
+	uint32_t VendorId = 0;
+	uint32_t DeviceId = 0;
+	uint64_t DriverVersion = 0;
+
+	bool operator==(const PipelineLibraryIdentity&) const = default;
+};
+
+// How reading a pipeline library ended - anything but Loaded leaves the library empty
+enum class PipelineLibraryStatus
+{
+	Loaded,
+	Corrupt,		// Truncated, foreign or damaged file
+	OtherDriver,	// Written on another adapter or driver version, never handed to the driver
+	Rejected,		// The driver refused the blob
+};
+
+// On-disk container of the pipeline library - a header with the identity, size and checksum in front
+// of the driver's blob
+namespace PipelineCacheFile
+{
+	constexpr uint32_t Magic = 0x43505350; // "PSPC"
+	constexpr uint32_t Version = 2;
+
+	// The blob is only filled when Loaded is returned
+	PipelineLibraryStatus Read(std::istream& stream, const PipelineLibraryIdentity& identity, std::vector<uint8_t>& blob);
+	void Write(std::ostream& stream, const PipelineLibraryIdentity& identity, const std::vector<uint8_t>& blob);
+};
+
+// A pipeline object of the backend, e.g. an ID3D12PipelineState. The cache only shares and compares it
+using PipelineHandle = SharedPtr<void>;
+
+enum class PipelineType
+{
+	Graphics,
+	Compute,
+};
+
+// A description on its way to the backend. Desc points at the API's description of Type and is only
+// read by the backend, Key is the hash of it - equal descriptions have equal keys in every run
+struct PipelineRequest
+{
+	PipelineType Type = PipelineType::Graphics;
+	const void* Desc = nullptr;
+	uint64_t Key = 0;
+};
+
+// Where pipelines are looked up, compiled and stored. D3D12PipelineBackend keeps them in an
+// ID3D12PipelineLibrary, a stand-in can record the calls so the cache runs without a device
+class PipelineBackend
+{
+public:
+	virtual ~PipelineBackend() = default;
+
+	// Empty when the library holds no pipeline of that name matching the description
+	virtual PipelineHandle Load(const std::wstring& name, const PipelineRequest& request) = 0;
+	virtual PipelineHandle Create(const PipelineRequest& request) = 0;
+	virtual void Store(const std::wstring& name, const PipelineHandle& pipeline) = 0;
+
+	// Serialized libraries are only handed back to a backend of the same identity
+	virtual PipelineLibraryIdentity GetIdentity() const = 0;
+	// Replaces the library with one read from disk, before any pipeline is requested.
+	// False when the blob is refused, the library is empty then
+	virtual bool Deserialize(std::vector<uint8_t> blob) = 0;
+	// Library contents to be written to disk
+	virtual std::vector<uint8_t> Serialize() = 0;
+};
+
+struct PipelineCacheStats
+{
+	uint32_t Requests = 0;
+	uint32_t Deduplicated = 0;	// Served from memory - an identical description was requested before
+	uint32_t Loaded = 0;		// Read from the pipeline library, no driver compilation
+	uint32_t Compiled = 0;
+};
+
+// Every PSO of the renderer comes from here, keyed by the hash of its full description.
+// Identical descriptions share one PSO, new ones are added to the library and saved on shutdown.
+// Thread safe, passes may create their pipelines from workers. D3D12PipelineCache takes and returns
+// the D3D12 types
+class PipelineCache
+{
+public:
+	PipelineCache(UniquePtr<PipelineBackend> backend, std::filesystem::path file = {});
+
+	// Reads the library from the file, a missing or unreadable file starts an empty one
+	void LoadFile();
+	// Hands a library written by Save to the backend
+	PipelineLibraryStatus Load(std::istream& stream);
+
+	PipelineHandle Get(const PipelineRequest& request);
+
+	// Writes the library to the file when pipelines were added since it was read
+	void Save();
+	// Same as Save, into a stream
+	void Save(std::ostream& stream);
+
+	inline bool IsModified() const { return Modified; }
+	PipelineCacheStats GetStats();
+
+	static std::wstring GetEntryName(uint64_t key);
+
+private:
+	UniquePtr<PipelineBackend> Backend;
+	std::filesystem::path File;
+
+	std::mutex Mutex;
+	std::unordered_map<uint64_t, PipelineHandle> Pipelines;
+	bool Modified = false;
+	PipelineCacheStats Stats;
+};
@@ -0,0 +1,225 @@
+#include "Test.h"
+#include "Rendering/PipelineCache.h"
+
+#include <set>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+	// Keeps the names of stored pipelines, serialized one per line. Counts what the driver would do
+	class FakePipelineBackend : public PipelineBackend
+	{
+	public:
+		PipelineLibraryIdentity Identity{ 0x10DE, 0x2684, 0x001F000E000A1234 };
+		// Plays a driver refusing every blob
+		bool RejectBlobs = false;
+
+		std::set<std::wstring> Library;
+		uint32_t Compiled = 0;
+		uint32_t Deserialized = 0;
+
+		PipelineHandle Load(const std::wstring& name, const PipelineRequest&) override { return Library.contains(name) ? MakePipeline() : nullptr; }
+		PipelineHandle Create(const PipelineRequest&) override
+		{
+			Compiled++;
+			return MakePipeline();
+		}
+		void Store(const std::wstring& name, const PipelineHandle&) override { Library.insert(name); }
+
+		PipelineLibraryIdentity GetIdentity() const override { return Identity; }
+
+		bool Deserialize(std::vector<uint8_t> blob) override
+		{
+			Deserialized++;
+			Library.clear();
+			if (RejectBlobs) return false;
+
+			std::wstring name;
+			for (uint8_t c : blob)
+			{
+				if (c != '\n')
+					name.push_back(c);
+				else
+					Library.insert(std::exchange(name, {}));
+			}
+			return name.empty();
+		}
+
+		std::vector<uint8_t> Serialize() override
+		{
+			std::vector<uint8_t> blob;
+			for (const auto& name : Library)
+			{
+				// Entry names are hex digits
+				for (wchar_t c : name)
+					blob.push_back(static_cast<uint8_t>(c));
+				blob.push_back('\n');
+			}
+			return blob;
+		}
+
+	private:
+		// Never bound, only compared
+		static PipelineHandle MakePipeline() { return MakeShared<int>(0); }
+	};
+
+	// Keys stand for hashed descriptions, the backend never reads one
+	PipelineRequest Graphics(uint64_t key) { return { PipelineType::Graphics, nullptr, key }; }
+	PipelineRequest Compute(uint64_t key) { return { PipelineType::Compute, nullptr, key }; }
+
+	// The pipelines of a small frame
+	void RequestFrame(PipelineCache& cache)
+	{
+		cache.Get(Graphics(0x1001));
+		cache.Get(Graphics(0x1002));
+		cache.Get(Compute(0x2001));
+	}
+
+	std::string SavedFrame(const PipelineLibraryIdentity& identity)
+	{
+		auto backend = MakeUnique<FakePipelineBackend>();
+		backend->Identity = identity;
+		PipelineCache cache(std::move(backend));
+		RequestFrame(cache);
+
+		std::stringstream file;
+		cache.Save(file);
+		return file.str();
+	}
+}
+
+TEST_CASE(PipelineLibraryRoundTrips)
+{
+	std::stringstream file;
+	{
+		auto backend = MakeUnique<FakePipelineBackend>();
+		auto& driver = *backend;
+		PipelineCache cache(std::move(backend));
+
+		auto target = cache.Get(Graphics(0x1001));
+		CHECK(cache.Get(Graphics(0x1001)) == target);
+		RequestFrame(cache);
+
+		auto stats = cache.GetStats();
+		CHECK_EQ(stats.Requests, 5u);
+		CHECK_EQ(stats.Deduplicated, 2u);
+		CHECK_EQ(stats.Compiled, 3u);
+		CHECK_EQ(driver.Compiled, 3u);
+		CHECK(cache.IsModified());
+
+		cache.Save(file);
+		CHECK(!cache.IsModified());
+	}
+
+	// A warm start loads everything and has nothing to save
+	auto backend = MakeUnique<FakePipelineBackend>();
+	auto& driver = *backend;
+	PipelineCache cache(std::move(backend));
+	CHECK(cache.Load(file) == PipelineLibraryStatus::Loaded);
+	CHECK_EQ(driver.Library.size(), 3u);
+
+	RequestFrame(cache);
+	auto stats = cache.GetStats();
+	CHECK_EQ(stats.Loaded, 3u);
+	CHECK_EQ(stats.Compiled, 0u);
+	CHECK_EQ(driver.Compiled, 0u);
+	CHECK(!cache.IsModified());
+
+	// A new pipeline is compiled next to the loaded ones
+	cache.Get(Graphics(0x1003));
+	CHECK_EQ(driver.Compiled, 1u);
+	CHECK(cache.IsModified());
+}
+
+TEST_CASE(CorruptPipelineLibraryStartsEmpty)
+{
+	const PipelineLibraryIdentity identity = FakePipelineBackend().Identity;
+	const std::string saved = SavedFrame(identity);
+
+	// Offset of the blob size - after magic, version and identity
+	constexpr size_t SizeOffset = 24;
+	REQUIRE(saved.size() > SizeOffset + sizeof(uint64_t));
+
+	std::vector<std::string> damaged;
+	damaged.push_back({});
+	damaged.push_back(saved.substr(0, 10));
+	damaged.push_back(saved.substr(0, saved.size() - 1));
+	damaged.push_back(saved);
+	damaged.back()[0] ^= 0xFF;					// Magic
+	damaged.push_back(saved);
+	damaged.back()[saved.size() - 2] ^= 0x01;	// Blob, caught by the checksum
+	damaged.push_back(saved);
+	std::fill_n(damaged.back().begin() + SizeOffset, sizeof(uint64_t), '\xFF');	// Must not be allocated
+
+	for (const auto& contents : damaged)
+	{
+		auto backend = MakeUnique<FakePipelineBackend>();
+		auto& driver = *backend;
+		PipelineCache cache(std::move(backend));
+
+		std::stringstream file(contents);
+		CHECK(cache.Load(file) == PipelineLibraryStatus::Corrupt);
+		// The driver never sees a damaged blob
+		CHECK_EQ(driver.Deserialized, 0u);
+
+		RequestFrame(cache);
+		CHECK_EQ(driver.Compiled, 3u);
+		CHECK(cache.IsModified());
+	}
+}
+
+TEST_CASE(PipelineLibraryOfAnotherDriverIsNotLoaded)
+{
+	const PipelineLibraryIdentity identity = FakePipelineBackend().Identity;
+	const std::string saved = SavedFrame(identity);
+
+	PipelineLibraryIdentity updated = identity;
+	updated.DriverVersion++;
+	PipelineLibraryIdentity otherAdapter = identity;
+	otherAdapter.DeviceId++;
+
+	for (const auto& other : { updated, otherAdapter })
+	{
+		auto backend = MakeUnique<FakePipelineBackend>();
+		backend->Identity = other;
+		auto& driver = *backend;
+		PipelineCache cache(std::move(backend));
+
+		std::stringstream file(saved);
+		CHECK(cache.Load(file) == PipelineLibraryStatus::OtherDriver);
+		CHECK_EQ(driver.Deserialized, 0u);
+
+		RequestFrame(cache);
+		CHECK_EQ(driver.Compiled, 3u);
+
+		// Saved again under the new identity, which the next start reads
+		std::stringstream resaved;
+		cache.Save(resaved);
+
+		auto next = MakeUnique<FakePipelineBackend>();
+		next->Identity = other;
+		PipelineCache warm(std::move(next));
+		CHECK(warm.Load(resaved) == PipelineLibraryStatus::Loaded);
+	}
+
+	// Matching identity, but the driver refuses the blob anyway
+	auto backend = MakeUnique<FakePipelineBackend>();
+	backend->RejectBlobs = true;
+	auto& driver = *backend;
+	PipelineCache cache(std::move(backend));
+
+	std::stringstream file(saved);
+	CHECK(cache.Load(file) == PipelineLibraryStatus::Rejected);
+	CHECK_EQ(driver.Deserialized, 1u);
+	RequestFrame(cache);
+	CHECK_EQ(cache.GetStats().Loaded, 0u);
+	CHECK_EQ(driver.Compiled, 3u);
+}
+
+TEST_CASE(PipelineEntryNamesAreTheKeyInHex)
+{
+	CHECK(PipelineCache::GetEntryName(0x0123456789ABCDEFull) == L"0123456789abcdef");
+	CHECK(PipelineCache::GetEntryName(0x2A) == L"000000000000002a");
+	CHECK(PipelineCache::GetEntryName(~0ull) == L"ffffffffffffffff");
+}
@@ -0,0 +1,126 @@
+#include "QueueSchedule.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Resources an entry accesses on its queue
+	std::vector<const void*> EntryResources(const TimelineEntry& entry, const std::vector<ScheduledPass>& passes)
+	{
+		const auto& pass = passes[entry.Position];
+		if (entry.BarriersOnly)
+			return pass.BarrierResources;
+
+		auto resources = pass.Resources;
+		if (pass.Queue == QueueType::Graphics)
+			resources.insert(resources.end(), pass.BarrierResources.begin(), pass.BarrierResources.end());
+		return resources;
+	}
+
+	bool Conflicts(const TimelineEntry& entry, const TimelineEntry& other, const std::vector<ScheduledPass>& passes)
+	{
+		// The final layer brings every resource back to its frame start state
+		if (entry.Position == passes.size()) return true;
+
+		const auto& producers = passes[entry.Position].Producers;
+		if (!other.BarriersOnly && std::ranges::find(producers, other.Position) != producers.end()) return true;
+
+		auto resources = EntryResources(entry, passes);
+		auto otherResources = EntryResources(other, passes);
+		if (std::ranges::find(resources, nullptr) != resources.end() ||
+			std::ranges::find(otherResources, nullptr) != otherResources.end())
+			return true;
+
+		return std::ranges::any_of(resources, [&otherResources](const void* resource)
+								   {
+									   return std::ranges::find(otherResources, resource) != otherResources.end();
+								   });
+	}
+
+	// Later chunks of a pass follow in lists of their own, the next entry cannot share the list of the first
+	bool EndsList(const TimelineEntry& entry, const std::vector<ScheduledPass>& passes)
+	{
+		return !entry.BarriersOnly && passes[entry.Position].RecordsInChunks;
+	}
+}
+
+std::vector<size_t> QueueTimeline::GetLayerLists() const
+{
+	std::vector<size_t> lists(Entries.empty() ? 0 : Entries.back().Position + 1, NoList);
+	for (const auto& entry : Entries)
+		if (entry.Queue == QueueType::Graphics)
+			lists[entry.Position] = entry.List;
+	return lists;
+}
+
+QueueTimeline QueueScheduler::Schedule(const std::vector<ScheduledPass>& passes)
+{
+	std::vector<TimelineEntry> entries;
+	for (size_t position = 0; position < passes.size(); position++)
+	{
+		const auto& pass = passes[position];
+		if (pass.Queue == QueueType::Compute && !pass.BarrierResources.empty())
+			entries.push_back({ QueueType::Graphics, position, true });
+		entries.push_back({ pass.Queue, position, false });
+	}
+	entries.push_back({ QueueType::Graphics, passes.size(), true });
+
+	QueueTimeline timeline;
+	std::vector<size_t> submissionOf;
+	// Latest submission of the other queue each queue already waits for
+	std::array<std::optional<size_t>, 2> waited;
+	size_t lists = 0;
+
+	for (const auto& entry : entries)
+	{
+		std::optional<size_t> wait;
+		for (size_t other = 0; other < timeline.Entries.size(); other++)
+		{
+			if (timeline.Entries[other].Queue == entry.Queue) continue;
+			if (Conflicts(entry, timeline.Entries[other], passes))
+				wait = std::max(wait.value_or(0), submissionOf[other]);
+		}
+
+		auto& queueWaited = waited[static_cast<size_t>(entry.Queue)];
+		if (wait && queueWaited && *queueWaited >= *wait)
+			wait.reset();
+
+		// A wait starts a new submission so earlier entries on this queue are not held back
+		bool newList = !timeline.Entries.empty() && EndsList(timeline.Entries.back(), passes);
+		if (timeline.Submissions.empty() || timeline.Submissions.back().Queue != entry.Queue || wait)
+		{
+			timeline.Submissions.push_back({ entry.Queue, timeline.Entries.size(), 0, wait });
+			if (wait) queueWaited = wait;
+			newList = !timeline.Entries.empty();
+		}
+
+		timeline.Submissions.back().EntryCount++;
+		submissionOf.push_back(timeline.Submissions.size() - 1);
+		timeline.Entries.push_back(entry);
+		timeline.Entries.back().List = newList ? lists + 1 : lists;
+		lists = timeline.Entries.back().List;
+	}
+
+	return timeline;
+}
+
+void QueueTimeline::Dump(std::ostream& os, const std::function<std::string(size_t)>& positionName) const
+{
+	for (size_t i = 0; i < Submissions.size(); i++)
+	{
+		const auto& submission = Submissions[i];
+		os << "[" << i << "] " << (submission.Queue == QueueType::Graphics ? "graphics" : "compute");
+		if (submission.WaitFor)
+			os << " (waits for [" << *submission.WaitFor << "])";
+		os << ":";
+
+		for (size_t e = submission.FirstEntry; e < submission.FirstEntry + submission.EntryCount; e++)
+		{
+			os << (e == submission.FirstEntry ? " " : Entries[e].List == Entries[e - 1].List ? ", " : " | ")
+			   << positionName(Entries[e].Position);
+			if (Entries[e].BarriersOnly)
+				os << " (barriers)";
+		}
+		os << "\n";
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <limits>
+#include <optional>
+#include <ostream>
+
+enum class QueueType : uint8_t
+{
+	Graphics,
+	Compute
+};
+
+// What the scheduler needs to know about an executed pass
+struct ScheduledPass
+{
+	QueueType Queue = QueueType::Graphics;
+	// Positions in the execution order of the passes producing its inputs
+	std::vector<size_t> Producers;
+	// Resources the pass reads or writes
+	std::vector<const void*> Resources;
+	// Resources its barrier layer touches - nullptr stands for any resource (aliasing without a known predecessor)
+	std::vector<const void*> BarrierResources;
+	// The pass may spread its commands over several lists, so nothing is recorded after it in its list
+	bool RecordsInChunks = false;
+};
+
+struct TimelineEntry
+{
+	QueueType Queue = QueueType::Graphics;
+	// Position in the execution order - the execution order size for the final barrier layer
+	size_t Position = 0;
+	// Barrier layer of a compute pass. Barriers are recorded on the graphics queue, which can reach every state
+	bool BarriersOnly = false;
+	// Command list the entry is recorded into. Consecutive entries of a submission share one,
+	// up to and including a pass recording in chunks
+	size_t List = 0;
+};
+
+// Consecutive entries executed on one queue with a single ExecuteCommandLists call, followed by a signal
+struct QueueSubmission
+{
+	QueueType Queue = QueueType::Graphics;
+	size_t FirstEntry = 0;
+	size_t EntryCount = 0;
+	// Earlier submission on the other queue this one waits for on the GPU
+	std::optional<size_t> WaitFor;
+};
+
+struct QueueTimeline
+{
+	static constexpr size_t NoList = std::numeric_limits<size_t>::max();
+
+	std::vector<TimelineEntry> Entries;
+	std::vector<QueueSubmission> Submissions;
+
+	// Command list recording each barrier layer, indexed by position. NoList for the layers of compute
+	// passes without barriers
+	std::vector<size_t> GetLayerLists() const;
+
+	// One line per submission - entries sharing a command list are separated by commas, lists by bars
+	void Dump(std::ostream& os, const std::function<std::string(size_t)>& positionName) const;
+};
+
+// Orders the executed passes into per-queue submissions. A submission waits for the other queue only
+// when one of its entries shares a producer, a resource or a barrier with work queued there.
+// Sees positions and dependencies only, the render graph records and submits the lists it yields
+namespace QueueScheduler
+{
+	QueueTimeline Schedule(const std::vector<ScheduledPass>& passes);
+}
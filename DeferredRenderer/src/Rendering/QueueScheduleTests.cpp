@@ -0,0 +1,277 @@
+#include "Test.h"
+#include "Rendering/QueueSchedule.h"
+#include "Rendering/CommandSubmitter.h"
+
+namespace
+{
+	ScheduledPass Pass(QueueType queue, std::vector<size_t> producers, std::vector<const void*> resources)
+	{
+		ScheduledPass pass;
+		pass.Queue = queue;
+		pass.Producers = std::move(producers);
+		pass.Resources = std::move(resources);
+		return pass;
+	}
+
+	std::vector<size_t> EntryLists(const QueueTimeline& timeline)
+	{
+		std::vector<size_t> lists;
+		for (const auto& entry : timeline.Entries)
+			lists.push_back(entry.List);
+		return lists;
+	}
+}
+
+TEST_CASE(GraphicsPassesOfOneSubmissionShareAList)
+{
+	int a, b, c;
+	std::vector<ScheduledPass> passes = {
+		Pass(QueueType::Graphics, {}, { &a }),
+		Pass(QueueType::Graphics, { 0 }, { &a, &b }),
+		Pass(QueueType::Graphics, { 1 }, { &b, &c }),
+	};
+
+	auto timeline = QueueScheduler::Schedule(passes);
+
+	// The three passes and the final layer
+	REQUIRE(timeline.Submissions.size() == 1);
+	CHECK(EntryLists(timeline) == std::vector<size_t>({ 0, 0, 0, 0 }));
+	CHECK(timeline.GetLayerLists() == std::vector<size_t>({ 0, 0, 0, 0 }));
+}
+
+TEST_CASE(PassRecordingInChunksEndsItsList)
+{
+	int a, b;
+	std::vector<ScheduledPass> passes = {
+		Pass(QueueType::Graphics, {}, { &a }),
+		Pass(QueueType::Graphics, { 0 }, { &a, &b }),
+		Pass(QueueType::Graphics, { 1 }, { &b }),
+	};
+	passes[1].RecordsInChunks = true;
+
+	auto timeline = QueueScheduler::Schedule(passes);
+
+	// The chunked pass records its first chunk after pass 0, pass 2 starts a list after its last chunk
+	CHECK(EntryLists(timeline) == std::vector<size_t>({ 0, 0, 1, 1 }));
+}
+
+TEST_CASE(ComputeLayersWithoutBarriersHaveNoList)
+{
+	int a, b, c;
+	std::vector<ScheduledPass> passes = {
+		Pass(QueueType::Graphics, {}, { &a }),
+		Pass(QueueType::Compute, {}, { &b }),
+		Pass(QueueType::Compute, { 0 }, { &a, &c }),
+		Pass(QueueType::Graphics, { 2 }, { &c }),
+	};
+	passes[2].BarrierResources = { &a };
+
+	auto timeline = QueueScheduler::Schedule(passes);
+
+	// Lists never span submissions - the compute passes and the graphics work around them record apart
+	for (size_t e = 1; e < timeline.Entries.size(); e++)
+	{
+		bool sameSubmission = false;
+		for (const auto& submission : timeline.Submissions)
+			if (e > submission.FirstEntry && e < submission.FirstEntry + submission.EntryCount)
+				sameSubmission = true;
+		CHECK_EQ(timeline.Entries[e].List == timeline.Entries[e - 1].List, sameSubmission);
+	}
+
+	// Layer 1 has no barriers and no entry of its own, layer 2 is recorded on the graphics queue
+	auto layers = timeline.GetLayerLists();
+	REQUIRE(layers.size() == passes.size() + 1);
+	CHECK_EQ(layers[1], QueueTimeline::NoList);
+	CHECK(layers[2] != QueueTimeline::NoList);
+	CHECK(layers[0] != layers[2]);
+}
+
+namespace
+{
+	// Positions of the frame the graph builds with SSAO and reflections on
+	enum FramePass : size_t { Clear, Geometry, AmbientOcclusion, Blur, Lighting, Reflection, ReflectionBlur, Blend, GUI, FramePassCount };
+
+	struct FrameResources
+	{
+		int Target, Depth, Positions, Normals, Diffuse, Specular, Occlusion, BlurredOcclusion, Lit, Reflected, BlurredReflection;
+	};
+
+	// Blur and ReflectionBlur are compute passes. Their barrier layers hand the blurred inputs to the compute queue
+	std::vector<ScheduledPass> FramePasses(FrameResources& r)
+	{
+		std::vector<ScheduledPass> passes(FramePassCount);
+		passes[Clear] = Pass(QueueType::Graphics, {}, { &r.Target, &r.Depth });
+		passes[Geometry] = Pass(QueueType::Graphics, { Clear }, { &r.Depth, &r.Positions, &r.Normals, &r.Diffuse, &r.Specular });
+		passes[AmbientOcclusion] = Pass(QueueType::Graphics, { Geometry }, { &r.Positions, &r.Normals, &r.Occlusion });
+		passes[Blur] = Pass(QueueType::Compute, { AmbientOcclusion }, { &r.Occlusion, &r.BlurredOcclusion });
+		passes[Blur].BarrierResources = { &r.Occlusion };
+		passes[Lighting] = Pass(QueueType::Graphics, { Geometry, AmbientOcclusion, Blur },
+								{ &r.Positions, &r.Normals, &r.Diffuse, &r.Specular, &r.BlurredOcclusion, &r.Lit });
+		passes[Reflection] = Pass(QueueType::Graphics, { Lighting }, { &r.Positions, &r.Normals, &r.Lit, &r.Reflected });
+		passes[ReflectionBlur] = Pass(QueueType::Compute, { Reflection }, { &r.Reflected, &r.BlurredReflection });
+		passes[ReflectionBlur].BarrierResources = { &r.Reflected };
+		passes[Blend] = Pass(QueueType::Graphics, { Clear, Reflection, ReflectionBlur }, { &r.Target, &r.Lit, &r.BlurredReflection });
+		passes[GUI] = Pass(QueueType::Graphics, { Blend }, { &r.Target });
+		return passes;
+	}
+
+	// Submission holding the entry of position, on queue
+	size_t SubmissionOf(const QueueTimeline& timeline, size_t position, QueueType queue, bool barriersOnly = false)
+	{
+		for (size_t i = 0; i < timeline.Submissions.size(); i++)
+		{
+			const auto& submission = timeline.Submissions[i];
+			for (size_t e = submission.FirstEntry; e < submission.FirstEntry + submission.EntryCount; e++)
+			{
+				const auto& entry = timeline.Entries[e];
+				if (entry.Position == position && entry.Queue == queue && entry.BarriersOnly == barriersOnly)
+					return i;
+			}
+		}
+		throw std::runtime_error("Position not in the timeline");
+	}
+
+	// Records every GPU wait with the value it waits for
+	class WaitRecorder : public RecordingSubmitter
+	{
+	public:
+		struct QueueWaitCall
+		{
+			QueueType Queue;
+			QueueType Other;
+			uint64_t Value;
+		};
+
+		void QueueWait(QueueType queue, QueueType other, uint64_t value) override
+		{
+			RecordingSubmitter::QueueWait(queue, other, value);
+			Calls.push_back({ queue, other, value });
+		}
+
+		std::vector<QueueWaitCall> Calls;
+	};
+}
+
+TEST_CASE(FrameTimelineWaitsOnlyForRealDependencies)
+{
+	FrameResources r;
+	auto passes = FramePasses(r);
+	auto timeline = QueueScheduler::Schedule(passes);
+	timeline.Dump(std::cout, [](size_t position)
+				  {
+					  const char* names[] = { "clear", "geometry", "ambientOcclusion", "blur", "lighting", "reflection",
+											  "reflectionBlur", "blend", "GUI", "end of frame" };
+					  return std::string(names[position]);
+				  });
+
+	// Every position is in the timeline once, the compute passes after their barrier layers
+	CHECK_EQ(timeline.Entries.size(), passes.size() + 3);
+	CHECK(SubmissionOf(timeline, Blur, QueueType::Graphics, true) < SubmissionOf(timeline, Blur, QueueType::Compute));
+
+	// The blurs wait for the graphics work producing their input
+	size_t blur = SubmissionOf(timeline, Blur, QueueType::Compute);
+	REQUIRE(timeline.Submissions[blur].WaitFor);
+	CHECK_EQ(*timeline.Submissions[blur].WaitFor, SubmissionOf(timeline, Blur, QueueType::Graphics, true));
+
+	size_t reflectionBlur = SubmissionOf(timeline, ReflectionBlur, QueueType::Compute);
+	REQUIRE(timeline.Submissions[reflectionBlur].WaitFor);
+	CHECK_EQ(*timeline.Submissions[reflectionBlur].WaitFor, SubmissionOf(timeline, ReflectionBlur, QueueType::Graphics, true));
+
+	// ... and their consumers wait for them
+	size_t lighting = SubmissionOf(timeline, Lighting, QueueType::Graphics);
+	REQUIRE(timeline.Submissions[lighting].WaitFor);
+	CHECK_EQ(*timeline.Submissions[lighting].WaitFor, blur);
+
+	size_t blend = SubmissionOf(timeline, Blend, QueueType::Graphics);
+	REQUIRE(timeline.Submissions[blend].WaitFor);
+	CHECK_EQ(*timeline.Submissions[blend].WaitFor, reflectionBlur);
+
+	// Nothing else waits - one wait per direction of every dependency on a compute pass
+	size_t waits = 0;
+	for (const auto& submission : timeline.Submissions)
+		waits += submission.WaitFor.has_value();
+	CHECK_EQ(waits, 4u);
+}
+
+TEST_CASE(IndependentComputeOverlapsGraphicsWork)
+{
+	int a, b, c, d;
+	std::vector<ScheduledPass> passes = {
+		Pass(QueueType::Graphics, {}, { &a }),
+		Pass(QueueType::Compute, {}, { &b }),		// Touches nothing the graphics passes use
+		Pass(QueueType::Graphics, { 0 }, { &a, &c }),
+		Pass(QueueType::Graphics, { 2 }, { &c, &d }),
+	};
+
+	auto timeline = QueueScheduler::Schedule(passes);
+
+	// Neither queue waits for the other until the final layer, which returns every resource to its frame start state
+	for (size_t i = 0; i + 1 < timeline.Submissions.size(); i++)
+		CHECK(!timeline.Submissions[i].WaitFor);
+
+	const auto& last = timeline.Submissions.back();
+	REQUIRE(last.WaitFor);
+	CHECK(timeline.Entries[last.FirstEntry + last.EntryCount - 1].Position == passes.size());
+	CHECK_EQ(*last.WaitFor, SubmissionOf(timeline, 1, QueueType::Compute));
+}
+
+TEST_CASE(QueueDoesNotWaitTwiceForOneSubmission)
+{
+	int a, b, c;
+	std::vector<ScheduledPass> passes = {
+		Pass(QueueType::Compute, {}, { &a, &b }),
+		Pass(QueueType::Graphics, { 0 }, { &a }),
+		Pass(QueueType::Graphics, { 0 }, { &b, &c }),
+	};
+
+	auto timeline = QueueScheduler::Schedule(passes);
+
+	// Both graphics passes depend on the compute pass, the first wait covers the second
+	size_t first = SubmissionOf(timeline, 1, QueueType::Graphics);
+	CHECK_EQ(first, SubmissionOf(timeline, 2, QueueType::Graphics));
+	REQUIRE(timeline.Submissions[first].WaitFor);
+	CHECK_EQ(*timeline.Submissions[first].WaitFor, SubmissionOf(timeline, 0, QueueType::Compute));
+}
+
+TEST_CASE(SubmitTimelineWaitsForTheFenceOfTheWaitedSubmission)
+{
+	FrameResources r;
+	auto timeline = QueueScheduler::Schedule(FramePasses(r));
+
+	WaitRecorder submitter;
+	std::vector<uint64_t> fences;
+	std::vector<size_t> submitted;
+	const std::vector<ID3D12GraphicsCommandList4Ptr> lists;
+	SubmitTimeline(submitter, timeline, fences, [&submitted, &lists](size_t i) -> const std::vector<ID3D12GraphicsCommandList4Ptr>&
+				   {
+					   submitted.push_back(i);
+					   return lists;
+				   });
+
+	// Submissions go out in timeline order, one signal each
+	REQUIRE(submitted.size() == timeline.Submissions.size());
+	for (size_t i = 0; i < submitted.size(); i++)
+		CHECK_EQ(submitted[i], i);
+	CHECK_EQ(submitter.GetStats().Submits, timeline.Submissions.size());
+	CHECK_EQ(submitter.GetStats().Signals, timeline.Submissions.size());
+
+	// Every wait of the schedule is a GPU wait for the value the waited submission signaled on the other queue
+	size_t call = 0;
+	for (const auto& submission : timeline.Submissions)
+	{
+		if (!submission.WaitFor) continue;
+
+		REQUIRE(call < submitter.Calls.size());
+		const auto& wait = submitter.Calls[call++];
+		const auto& waited = timeline.Submissions[*submission.WaitFor];
+		CHECK(wait.Queue == submission.Queue);
+		CHECK(wait.Other == waited.Queue);
+		CHECK(wait.Other != wait.Queue);
+		CHECK_EQ(wait.Value, fences[*submission.WaitFor]);
+	}
+	CHECK_EQ(call, submitter.Calls.size());
+	CHECK_EQ(submitter.GetStats().QueueWaits, call);
+
+	// The last submission of each queue signaled the value its fence ends the frame at
+	CHECK_EQ(fences.back(), submitter.GetSignaled(timeline.Submissions.back().Queue));
+}
@@ -3,19 +3,16 @@
 #include "Rendering/Utils.h"
 #include "Scene.h"
 
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <optional>
-
-auto createResourceTransition = [](const PassInputBase& input, const PassOutputBase& output)
--> std::optional<UniquePtr<TransitionBase>>
-	{
-		if (input.GetResourceState() != output.GetResourceState())
-			return input.GetResourceTransition(output.GetResourceState());
-
-		return std::nullopt;
-	};
+#include <set>
 
 RenderGraph::RenderGraph(ID3D12Device5Ptr device)
-	:Device(device)
+	:Device(device), Submitter(MakeUnique<QueueSubmitter>()),
+	Workers(MakeUnique<ThreadPool>()), GraphicsLists(MakeUnique<CommandListPool>(device)),
+	ComputeLists(MakeUnique<CommandListPool>(device, D3D12_COMMAND_LIST_TYPE_COMPUTE))
 {
 	RTVBuffer = MakeShared<ID3D12ResourcePtr>(Globals.RTVBuffer);
 	DSVBuffer = MakeShared<ID3D12ResourcePtr>(Globals.DSVBuffer);
@@ -24,6 +21,9 @@ RenderGraph::RenderGraph(ID3D12Device5Ptr device)
 	Globals.CBGlobalConstants.CPUData.RadiusSSAO = 0.5f;
 	Globals.CBGlobalConstants.CPUData.IntensitySSAO = 2.0f;
 
+	auto ssaoEnabled = []() { return Globals.CBGlobalConstants.CPUData.SSAOEnabled != 0; };
+	auto ssrEnabled = []() { return Globals.CBGlobalConstants.CPUData.SSREnabled != 0; };
+
 	GraphInputs.emplace_back(MakeUnique<PassOutput<ID3D12ResourcePtr>>("renderTarget", RTVBuffer, D3D12_RESOURCE_STATE_PRESENT));
 	GraphInputs.emplace_back(MakeUnique<PassOutput<ID3D12ResourcePtr>>("depthBuffer", DSVBuffer, D3D12_RESOURCE_STATE_DEPTH_WRITE));
 	GraphOutputs.emplace_back(MakeUnique<PassInput<ID3D12ResourcePtr>>("renderTarget", RTVBuffer, D3D12_RESOURCE_STATE_PRESENT));
@@ -45,6 +45,7 @@ RenderGraph::RenderGraph(ID3D12Device5Ptr device)
 	// Ambient Occlusion Pass
 	{
 		auto pass = MakeUnique<AmbientOcclusionPass>("ambientOcclusion");
+		pass->SetCondition(ssaoEnabled);
 		pass->SetInput("normals", "geometryPass.normals");
 		pass->SetInput("positions", "geometryPass.positions");
 		Add(pass);
@@ -64,6 +65,7 @@ RenderGraph::RenderGraph(ID3D12Device5Ptr device)
 	// Combined Blur Pass
 	{
 		auto pass = MakeUnique<CombinedBlurPassGlobal>("blur");
+		pass->SetCondition(ssaoEnabled);
 		pass->SetInput("processedResource", "ambientOcclusion.renderTarget");
 		Add(pass);
 	}
@@ -76,12 +78,13 @@ RenderGraph::RenderGraph(ID3D12Device5Ptr device)
 		pass->SetInput("diffuse", "geometryPass.diffuse");
 		pass->SetInput("specular", "geometryPass.specular");
 		pass->SetInput("ambientOcclusion", "blur.renderTarget");
-		pass->SetInput("srvHeap", "geometryPass.srvHeap");
+		pass->SetInput("srvTable", "geometryPass.srvTable");
 		Add(pass);
 	}
 	// Reflections Pass
 	{
 		auto pass = MakeUnique<ReflectionPass>("reflectionPass");
+		pass->SetCondition(ssrEnabled);
 		//pass->SetInput("renderTarget", "clear.renderTarget");
 		pass->SetInput("positions", "lightingPass.positions");
 		pass->SetInput("normals", "lightingPass.normals");
@@ -91,6 +94,7 @@ RenderGraph::RenderGraph(ID3D12Device5Ptr device)
 	// Blur reflections pass
 	{
 		auto pass = MakeUnique<CombinedBlurPassGlobal>("reflectionBlur", true, 7);
+		pass->SetCondition(ssrEnabled);
 		pass->SetInput("processedResource", "reflectionPass.renderTarget");
 		Add(pass);
 	}
@@ -105,6 +109,7 @@ RenderGraph::RenderGraph(ID3D12Device5Ptr device)
 	// GUI layer
 	{
 		auto pass = MakeUnique<GUIPass>("GUI");
+		pass->SetInput("renderTarget", "blend.renderTarget");
 		pass->SetInput("positions", "reflectionPass.positions");
 		pass->SetInput("normals", "reflectionPass.normals");
 		pass->SetInput("diffuse", "lightingPass.diffuse");
@@ -113,15 +118,21 @@ RenderGraph::RenderGraph(ID3D12Device5Ptr device)
 		Add(pass);
 	}
 
-	SetInputTarget("renderTarget", "blend.renderTarget");
+	SetInputTarget("renderTarget", "GUI.renderTarget");
 	Validate();
-	TransitionUnpropagatedResources();
+	AllocateTransientResources();
+	InitPasses();
+	Compile();
 }
 
 void RenderGraph::Tick()
 {
 	*RTVBuffer = Globals.RTVBuffer;
 	*DSVBuffer = Globals.DSVBuffer;
+
+	// Feature toggles only change the live set - passes and their links are left as they are
+	if (EvaluateConditions() != CompiledConditions)
+		Compile();
 }
 
 void RenderGraph::SetInputTarget(const std::string & name, const std::string & target)
@@ -140,34 +151,168 @@ void RenderGraph::SetInputTarget(const std::string & name, const std::string & t
 	(*it)->SetTarget(split[0], split[1]);
 }
 
-void RenderGraph::Execute(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene)
+void RenderGraph::SetSubmissionMode(SubmissionMode mode)
+{
+	if (Mode == mode) return;
+
+	// Barrier splitting depends on the mode
+	Mode = mode;
+	if (IsValidated)
+		Compile();
+}
+
+void RenderGraph::Execute(const ID3D12GraphicsCommandList4Ptr& cmdList, const Scene& scene)
 {
 	ASSERT(IsValidated, "Validation hasn't happened");
 
-	auto i = 0;
-	for (const auto& pass : Passes)
+	Submitter->ResetStats();
+	Globals.Descriptors->ResetStats();
+	Recording = {};
+	if (Mode == SubmissionMode::Parallel)
+		ExecuteParallel(scene);
+	else
+		ExecuteSerial(cmdList, scene);
+}
+
+void RenderGraph::ExecuteSerial(const ID3D12GraphicsCommandList4Ptr& cmdList, const Scene& scene)
+{
+	SubmitFrame(*Submitter, Mode, ExecutionOrder.size(), [this, &cmdList, &scene](size_t first, size_t count)
+		{
+			// A per-pass list starts with the pass's PSO. In a whole-frame list passes sharing a root
+			// signature or PSO do not set it again
+			auto pso = count == 1 ? Passes[ExecutionOrder[first]]->GetPSO() : nullptr;
+			Globals.CmdAllocator->Reset();
+			cmdList->Reset(Globals.CmdAllocator, pso);
+			CommandContext context(cmdList, pso);
+			Globals.Descriptors->Bind(context);
+
+			for (size_t i = first; i < first + count; i++)
+				RecordPass(context, scene, i);
+			if (first + count == ExecutionOrder.size())
+				Barriers.Emit(context, ExecutionOrder.size()); // Final layer of barriers
+			Recording += context.GetStats();
+			return cmdList;
+		});
+}
+
+void RenderGraph::ExecuteParallel(const Scene& scene)
+{
+	Tasks.clear();
+	std::array<size_t, 2> listCounts{};
+	for (size_t entry = 0; entry < Timeline.Entries.size(); entry++)
 	{
-		Globals.CmdAllocator->Reset();
-		cmdList->Reset(Globals.CmdAllocator, pass->GetPSO());
-
-		for (auto& t : Transitions[i]) t->Apply(cmdList);// Barriers
-		
-		pass->Submit(cmdList, scene);
-		
-		if (++i == Passes.size())
-			for (auto& t : Transitions[i]) t->Apply(cmdList); // Final layer of transitions (Transitions.size() = Passes.size() + 1)
-
-		// Submit Render Pass for execution and synchronize before calling Reset() for next iteration
-		Globals.FenceValue = D3D::SubmitCommandList(cmdList, Globals.CmdQueue, Globals.Fence, Globals.FenceValue);
-		Globals.Fence->SetEventOnCompletion(Globals.FenceValue, Globals.FenceEvent);
-		WaitForSingleObject(Globals.FenceEvent, INFINITE);
+		const auto& [queue, position, barriersOnly, list] = Timeline.Entries[entry];
+		auto& listCount = listCounts[static_cast<size_t>(queue)];
+
+		// Entries the timeline puts into one list share a task, chunks after the first get their own
+		if (entry > 0 && Timeline.Entries[entry - 1].List == list)
+			Tasks.back().EntryCount++;
+		else
+			Tasks.push_back({ entry, 1, 0, 1, listCount++ });
+
+		if (barriersOnly) continue;
+
+		const auto& pass = *Passes[ExecutionOrder[position]];
+		size_t chunks = pass.GetRecordingChunks(scene, Workers->GetThreadCount());
+		ASSERT(chunks == 1 || pass.RecordsInChunks(), "Pass records in chunks without saying so");
+		Tasks.back().ChunkCount = chunks;
+		for (size_t chunk = 1; chunk < chunks; chunk++)
+			Tasks.push_back({ entry, 1, chunk, chunks, listCount++ });
 	}
+
+	// Allocators of this frame slot are free - the caller waited for the frame that last used it
+	GraphicsLists->BeginFrame(Globals.FrameIndex, listCounts[static_cast<size_t>(QueueType::Graphics)]);
+	ComputeLists->BeginFrame(Globals.FrameIndex, listCounts[static_cast<size_t>(QueueType::Compute)]);
+
+	TaskRecording.assign(Tasks.size(), {});
+
+	auto getList = [this](const RecordingTask& task) -> const ID3D12GraphicsCommandList4Ptr&
+		{
+			auto queue = Timeline.Entries[task.Entry].Queue;
+			return queue == QueueType::Compute ? ComputeLists->Get(task.List) : GraphicsLists->Get(task.List);
+		};
+
+	auto record = [this, &scene, &getList](size_t index)
+		{
+			const auto& task = Tasks[index];
+			CommandContext context(getList(task));
+			bool heapsBound = false;
+
+			for (size_t e = task.Entry; e < task.Entry + task.EntryCount; e++)
+			{
+				const auto& entry = Timeline.Entries[e];
+
+				// Barrier layers of compute passes and the final layer are recorded on the graphics queue
+				if (entry.BarriersOnly)
+				{
+					Barriers.Emit(context, entry.Position);
+					continue;
+				}
+
+				auto& pass = Passes[ExecutionOrder[entry.Position]];
+				if (auto pso = pass->GetPSO())
+					context.SetPipelineState(pso);
+				// Every task records into a fresh list, the heaps are set once before its first pass
+				if (!heapsBound)
+					Globals.Descriptors->Bind(context);
+				heapsBound = true;
+
+				if (task.Chunk == 0 && entry.Queue == QueueType::Graphics)
+					Barriers.Emit(context, entry.Position);
+				bool last = e + 1 == task.Entry + task.EntryCount;
+				pass->SubmitChunk(context, scene, task.Chunk, last ? task.ChunkCount : 1);
+			}
+			TaskRecording[index] = context.GetStats();
+		};
+
+	auto onMainThread = [this](size_t index)
+		{
+			const auto& task = Tasks[index];
+			for (size_t e = task.Entry; e < task.Entry + task.EntryCount; e++)
+			{
+				const auto& entry = Timeline.Entries[e];
+				if (!entry.BarriersOnly && Passes[ExecutionOrder[entry.Position]]->RequiresMainThread())
+					return true;
+			}
+			return false;
+		};
+
+	Workers->ParallelFor(Tasks.size(), [&record, &onMainThread](size_t index)
+						 {
+							 if (!onMainThread(index)) record(index);
+						 });
+
+	for (size_t index = 0; index < Tasks.size(); index++)
+		if (onMainThread(index)) record(index);
+	for (const auto& stats : TaskRecording)
+		Recording += stats;
+
+	// Submissions follow the timeline, the queues only wait for each other where the schedule says so
+	size_t index = 0;
+	SubmitTimeline(*Submitter, Timeline, SubmissionFences, [this, &index, &getList](size_t i) -> const std::vector<ID3D12GraphicsCommandList4Ptr>&
+		{
+			const auto& submission = Timeline.Submissions[i];
+			SubmissionLists.clear();
+			for (; index < Tasks.size() && Tasks[index].Entry < submission.FirstEntry + submission.EntryCount; index++)
+				SubmissionLists.push_back(getList(Tasks[index]));
+			return SubmissionLists;
+		});
 }
 
-void RenderGraph::LinkInputs(RenderPass& renderPass)
+void RenderGraph::RecordPass(CommandContext& cmdList, const Scene& scene, size_t index)
 {
-	std::vector<UniquePtr<TransitionBase>> passTransitions;
+	auto& pass = Passes[ExecutionOrder[index]];
+
+	// Passes without a PSO (clear, GUI) set their own state
+	if (auto pso = pass->GetPSO())
+		cmdList.SetPipelineState(pso);
 
+	Barriers.Emit(cmdList, index);
+	pass->Submit(cmdList, scene);
+}
+
+void RenderGraph::LinkInputs(RenderPass& renderPass)
+{
 	for (auto& in : renderPass.GetInputs())
 	{
 		const std::string& name = in->GetPassName();
@@ -181,11 +326,6 @@ void RenderGraph::LinkInputs(RenderPass& renderPass)
 				{
 					in->Bind(*out);
 					bound = true;
-
-					// TRANSITION
-					if (auto transition = createResourceTransition(*in, *out))
-						passTransitions.emplace_back(std::move(*transition));
-
 					break;
 				}
 			}
@@ -205,40 +345,17 @@ void RenderGraph::LinkInputs(RenderPass& renderPass)
 
 			auto& out = (*it)->GetOutput(in->GetOutputName());
 			in->Bind(out);
-
-			// TRANSITION
-			if (auto transition = createResourceTransition(*in, out))
-				passTransitions.emplace_back(std::move(*transition));
 		}
 	}
-
-	Transitions.emplace_back(std::move(passTransitions));
 }
 
 void RenderGraph::LinkGlobalInputs()
 {
-	std::vector<UniquePtr<TransitionBase>> passTransitions;
-
 	for (auto& in : GraphOutputs)
 	{
-		const std::string& name = in->GetPassName();
-		auto it = std::find_if(Passes.begin(), Passes.end(),
-							   [&name](const auto& ptr)
-							   {
-								   return name == ptr->GetName();
-							   });
-
-		if (it == Passes.end()) throw std::runtime_error("Pass input not found among existing Passes");
-
-		auto& out = (*it)->GetOutput(in->GetOutputName());
+		auto& out = Passes[FindPass(in->GetPassName())]->GetOutput(in->GetOutputName());
 		in->Bind(out);
-
-		// TRANSITIONS
-		if (auto transition = createResourceTransition(*in, out))
-			passTransitions.emplace_back(std::move(*transition));
 	}
-
-	Transitions.emplace_back(std::move(passTransitions));
 }
 
 void RenderGraph::Validate()
@@ -248,17 +365,453 @@ void RenderGraph::Validate()
 		pass->Validate();
 
 	LinkGlobalInputs();
+	SortPasses();
 	IsValidated = true;
 }
 
-void RenderGraph::TransitionUnpropagatedResources()
+void RenderGraph::AllocateTransientResources()
 {
-	UINT i = 0;
 	for (const auto& pass : Passes)
+		for (const auto& transient : pass->GetTransients())
+		{
+			TransientIndices.emplace(transient.Resource.get(), Transients.size());
+			Transients.push_back(transient);
+		}
+
+	if (Transients.empty()) return;
+
+	// Lifetimes span positions in the sorted order of the whole graph. Culling only ever shortens them,
+	// so the placement holds under any combination of pass conditions
+	std::vector<TransientLifetime> lifetimes(Transients.size());
+	std::vector<bool> used(Transients.size(), false);
+	for (uint32_t position = 0; position < SortedPasses.size(); position++)
+	{
+		auto touch = [&](const void* resource)
+			{
+				auto it = TransientIndices.find(resource);
+				if (it == TransientIndices.end()) return;
+
+				auto& lifetime = lifetimes[it->second];
+				if (!used[it->second]) lifetime.FirstUse = position;
+				lifetime.LastUse = position;
+				used[it->second] = true;
+			};
+
+		const auto& pass = *Passes[SortedPasses[position]];
+		for (const auto& in : pass.GetInputs())
+			touch(in->GetRscPtr());
+		for (const auto& out : pass.GetOutputs())
+			touch(out->GetRscPtr());
+	}
+
+	for (size_t i = 0; i < Transients.size(); i++)
+	{
+		auto info = Device->GetResourceAllocationInfo(0, 1, &Transients[i].Desc);
+		lifetimes[i].Size = info.SizeInBytes;
+		lifetimes[i].Alignment = info.Alignment;
+	}
+
+	TransientPlan = TransientPlanner::Plan(lifetimes);
+
+	D3D12_HEAP_DESC heapDesc{};
+	heapDesc.SizeInBytes = TransientPlan.HeapSize;
+	heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+	GRAPHICS_ASSERT(Device->CreateHeap(&heapDesc, IID_PPV_ARGS(&TransientHeap)));
+
+	for (size_t i = 0; i < Transients.size(); i++)
+	{
+		auto& transient = Transients[i];
+		const D3D12_CLEAR_VALUE* clearValue = transient.ClearValue ? &*transient.ClearValue : nullptr;
+
+		GRAPHICS_ASSERT(Device->CreatePlacedResource(TransientHeap,
+													 TransientPlan.Offsets[i],
+													 &transient.Desc,
+													 transient.InitialState,
+													 clearValue,
+													 IID_PPV_ARGS(&*transient.Resource)));
+	}
+}
+
+void RenderGraph::InitPasses()
+{
+	using Clock = std::chrono::steady_clock;
+	auto elapsedMs = [](Clock::time_point start)
+		{
+			return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+		};
+
+	InitTimings = {};
+	InitTimings.Passes.resize(Passes.size());
+
+	// Producers first - consumers create views of the resources they receive
+	auto phaseStart = Clock::now();
+	for (size_t pass : SortedPasses)
+	{
+		auto start = Clock::now();
+		Passes[pass]->LinkResources(Device);
+		InitTimings.Passes[pass].ResourcesMs = elapsedMs(start);
+	}
+	InitTimings.ResourcesMs = elapsedMs(phaseStart);
+
+	// Shader loading and PSO compilation only touch the pass itself. Returns once every pass is built,
+	// so the graph is never compiled or executed with a missing pipeline
+	phaseStart = Clock::now();
+	Workers->ParallelFor(Passes.size(), [this, &elapsedMs](size_t pass)
+		{
+			auto start = Clock::now();
+			Passes[pass]->BuildPipeline();
+			InitTimings.Passes[pass].PipelineMs = elapsedMs(start);
+		});
+	InitTimings.PipelineMs = elapsedMs(phaseStart);
+
+	for (const auto& timing : InitTimings.Passes)
+		InitTimings.PipelineWorkMs += timing.PipelineMs;
+}
+
+size_t RenderGraph::ReloadShaders(const std::vector<std::string>& changedFiles)
+{
+	std::vector<size_t> affected;
+	for (size_t pass = 0; pass < Passes.size(); pass++)
+	{
+		const auto& files = Passes[pass]->GetShaderFiles();
+		if (std::ranges::any_of(files, [&changedFiles](const std::string& file) { return std::ranges::find(changedFiles, file) != changedFiles.end(); }))
+			affected.push_back(pass);
+	}
+
+	std::vector<uint8_t> rebuilt(affected.size());
+	Workers->ParallelFor(affected.size(), [this, &affected, &rebuilt](size_t i)
+		{
+			rebuilt[i] = Passes[affected[i]]->RebuildPipelineState();
+		});
+	return std::ranges::count(rebuilt, uint8_t(1));
+}
+
+void RenderGraph::SortPasses()
+{
+	Dependencies.assign(Passes.size(), {});
+	std::vector<std::vector<size_t>> dependents(Passes.size());
+
+	for (size_t i = 0; i < Passes.size(); i++)
+	{
+		for (const auto& in : Passes[i]->GetInputs())
+		{
+			if (in->GetPassName() == "$") continue;
+
+			size_t producer = FindPass(in->GetPassName());
+			if (std::ranges::find(Dependencies[i], producer) != Dependencies[i].end()) continue;
+
+			Dependencies[i].push_back(producer);
+			dependents[producer].push_back(i);
+		}
+	}
+
+	// Kahn's algorithm - ties are broken by insertion order so the plan is stable
+	std::vector<size_t> inDegree(Passes.size());
+	std::set<size_t> ready;
+	for (size_t i = 0; i < Passes.size(); i++)
+	{
+		inDegree[i] = Dependencies[i].size();
+		if (inDegree[i] == 0) ready.insert(i);
+	}
+
+	SortedPasses.clear();
+	while (!ready.empty())
+	{
+		size_t pass = *ready.begin();
+		ready.erase(ready.begin());
+		SortedPasses.push_back(pass);
+
+		for (size_t dependent : dependents[pass])
+			if (--inDegree[dependent] == 0) ready.insert(dependent);
+	}
+
+	if (SortedPasses.size() != Passes.size())
+		throw std::runtime_error("Render graph contains a dependency cycle");
+}
+
+void RenderGraph::Compile()
+{
+	CompiledConditions = EvaluateConditions();
+
+	// Walk back from the graph outputs. Disabled passes are walked through but not kept,
+	// the resources they forward still come from their producers
+	std::vector<bool> reachesOutput(Passes.size(), false);
+	std::vector<size_t> stack;
+	for (const auto& in : GraphOutputs)
+		stack.push_back(FindPass(in->GetPassName()));
+
+	while (!stack.empty())
+	{
+		size_t pass = stack.back();
+		stack.pop_back();
+		if (reachesOutput[pass]) continue;
+
+		reachesOutput[pass] = true;
+		stack.insert(stack.end(), Dependencies[pass].begin(), Dependencies[pass].end());
+	}
+
+	ExecutionOrder.clear();
+	for (size_t pass : SortedPasses)
+		if (reachesOutput[pass] && CompiledConditions[pass])
+			ExecutionOrder.push_back(pass);
+
+	if (Mode == SubmissionMode::Parallel)
+	{
+		// Parallel lists follow the queue timeline, which depends on the barriers. Schedule whole transitions
+		// first - splitting one inside a submission adds no wait, so the rebuilt timeline keeps its lists
+		BuildTransitions({});
+		BuildTimeline();
+	}
+
+	auto layerLists = GetLayerLists();
+	BuildTransitions(layerLists);
+	BuildTimeline();
+	ASSERT(GetLayerLists() == layerLists, "Split barriers changed the command lists of the timeline");
+}
+
+std::vector<size_t> RenderGraph::GetLayerLists() const
+{
+	if (Mode == SubmissionMode::Parallel)
+		return Timeline.GetLayerLists();
+
+	// A per-pass list also records the final layer after the last pass
+	std::vector<size_t> lists(ExecutionOrder.size() + 1, 0);
+	if (Mode == SubmissionMode::PerPass)
+		for (size_t i = 0; i < lists.size(); i++)
+			lists[i] = std::min(i, ExecutionOrder.size() - 1);
+	return lists;
+}
+
+// Tracks the state of every resource through the executed passes, so culled passes
+// leave no gaps in the barrier chain. A pass leaves its resources in the state it used them in -
+// the next consumer transitions from there and everything is reconciled once at the frame boundary
+void RenderGraph::BuildTransitions(const std::vector<size_t>& layerLists)
+{
+	// A resource starts the frame in the state declared by the output introducing it
+	ResourceStates initialStates;
+	std::unordered_map<const void*, ID3D12ResourcePtr*> resources;
+
+	auto addResource = [&resources](const PassInputBase& in)
+		{
+			if (auto* resource = in.GetBarrierResource())
+				resources.try_emplace(in.GetRscPtr(), resource);
+		};
+
+	for (const auto& out : GraphInputs)
+		initialStates.try_emplace(out->GetRscPtr(), out->GetResourceState());
+	for (const auto& in : GraphOutputs)
+		addResource(*in);
+	for (size_t pass : SortedPasses)
+	{
+		for (const auto& in : Passes[pass]->GetInputs())
+			addResource(*in);
+		for (const auto& out : Passes[pass]->GetOutputs())
+			initialStates.try_emplace(out->GetRscPtr(), out->GetResourceState());
+	}
+
+	std::vector<std::vector<BarrierDesc>> layers(ExecutionOrder.size() + 1);
+
+	// First layer after the last executed pass using a resource - a transition may begin there
+	// when that layer is recorded into the same command list. Split barriers cannot span lists
+	std::unordered_map<const void*, size_t> idleFrom;
+	auto inOneList = [&layerLists](size_t begin, size_t end)
+		{
+			return end < layerLists.size() && layerLists[begin] != QueueTimeline::NoList && layerLists[begin] == layerLists[end];
+		};
+
+	ResourceStates states = initialStates;
+	auto transitionTo = [&](const void* key, D3D12_RESOURCE_STATES next, size_t layer)
+		{
+			auto it = resources.find(key);
+			if (it == resources.end()) return;
+
+			auto& current = states[key];
+			if (current == next) return;
+
+			size_t begin = inOneList(idleFrom[key], layer) ? idleFrom[key] : layer;
+			BarrierBatches::AddTransition(layers, { BarrierDesc::Type::Transition, it->second, nullptr, current, next }, begin, layer);
+			current = next;
+			idleFrom[key] = layer;
+		};
+
+	auto lifetimes = GetExecutedLifetimes();
+	for (size_t i = 0; i < ExecutionOrder.size(); i++)
+	{
+		// Aliased transients take over their memory right before their first use
+		for (size_t t = 0; t < Transients.size(); t++)
+		{
+			if (!lifetimes[t] || lifetimes[t]->first != i || !TransientPlan.IsAliased[t]) continue;
+
+			auto predecessor = TransientPlan.Predecessors[t];
+			auto* before = predecessor ? Transients[*predecessor].Resource.get() : nullptr;
+			layers[i].push_back({ BarrierDesc::Type::Aliasing, Transients[t].Resource.get(), before,
+								  Transients[t].InitialState, Transients[t].InitialState });
+			idleFrom[Transients[t].Resource.get()] = i;
+		}
+
+		auto& pass = *Passes[ExecutionOrder[i]];
+		for (const auto& in : pass.GetInputs())
+			transitionTo(in->GetRscPtr(), in->GetResourceState(), i);
+
+		for (const auto& in : pass.GetInputs())
+			idleFrom[in->GetRscPtr()] = i + 1;
+		for (const auto& out : pass.GetOutputs())
+			idleFrom[out->GetRscPtr()] = i + 1;
+
+		// ... and are returned to their initial state once their lifetime ends, before the memory is handed over
+		for (size_t t = 0; t < Transients.size(); t++)
+			if (lifetimes[t] && lifetimes[t]->second == i && TransientPlan.IsAliased[t])
+				transitionTo(Transients[t].Resource.get(), Transients[t].InitialState, i + 1);
+	}
+
+	// Final layer - graph outputs first, then every resource back to its frame start state
+	for (const auto& in : GraphOutputs)
+		transitionTo(in->GetRscPtr(), in->GetResourceState(), ExecutionOrder.size());
+
+	for (const auto& [resource, state] : initialStates)
+		transitionTo(resource, state, ExecutionOrder.size());
+
+	Barriers.Build(layers);
+}
+
+void RenderGraph::BuildTimeline()
+{
+	// Compute passes share the graphics queue unless the frame is recorded into separate lists
+	const bool asyncCompute = Mode == SubmissionMode::Parallel && Globals.ComputeQueue;
+
+	std::vector<std::optional<size_t>> positions(Passes.size());
+	for (size_t i = 0; i < ExecutionOrder.size(); i++)
+		positions[ExecutionOrder[i]] = i;
+
+	std::vector<ScheduledPass> scheduled(ExecutionOrder.size());
+	for (size_t i = 0; i < ExecutionOrder.size(); i++)
+	{
+		const auto& pass = *Passes[ExecutionOrder[i]];
+		auto& entry = scheduled[i];
+
+		entry.Queue = asyncCompute ? pass.GetQueueAffinity() : QueueType::Graphics;
+		for (size_t producer : Dependencies[ExecutionOrder[i]])
+			if (positions[producer])
+				entry.Producers.push_back(*positions[producer]);
+
+		for (const auto& in : pass.GetInputs())
+			entry.Resources.push_back(in->GetRscPtr());
+		for (const auto& out : pass.GetOutputs())
+			entry.Resources.push_back(out->GetRscPtr());
+		entry.RecordsInChunks = pass.RecordsInChunks();
+
+		const BarrierDesc* barriers = Barriers.GetLayer(i);
+		for (size_t b = 0; b < Barriers.GetLayerSize(i); b++)
+		{
+			entry.BarrierResources.push_back(barriers[b].Resource);
+			if (barriers[b].Kind == BarrierDesc::Type::Aliasing)
+				entry.BarrierResources.push_back(barriers[b].AliasBefore);
+		}
+	}
+
+	Timeline = QueueScheduler::Schedule(scheduled);
+}
+
+void RenderGraph::DumpTimeline(std::ostream& os) const
+{
+	Timeline.Dump(os, [this](size_t position)
+				  {
+					  return position < ExecutionOrder.size() ? Passes[ExecutionOrder[position]]->GetName() : std::string("end of frame");
+				  });
+}
+
+void RenderGraph::DumpInitTimings(std::ostream& os) const
+{
+	os << std::fixed << std::setprecision(2);
+	for (size_t pass : SortedPasses)
 	{
-		auto t = pass->GetInverseTransitions(Transitions[i]);
-		Transitions[++i].insert(Transitions[i].end(), std::make_move_iterator(t.begin()), std::make_move_iterator(t.end()));
+		const auto& timing = InitTimings.Passes[pass];
+		os << std::left << std::setw(20) << Passes[pass]->GetName() << std::right
+		   << " resources " << std::setw(8) << timing.ResourcesMs << " ms"
+		   << "  pipeline " << std::setw(8) << timing.PipelineMs << " ms"
+		   << "  root signature " << std::setw(2) << Passes[pass]->GetRootSignature().Size << "/64\n";
 	}
+
+	os << "resources: " << InitTimings.ResourcesMs << " ms\n"
+	   << "pipelines: " << InitTimings.PipelineMs << " ms on " << Workers->GetThreadCount() << " threads for "
+	   << InitTimings.PipelineWorkMs << " ms of work";
+	if (InitTimings.PipelineMs > 0.0f)
+		os << " (" << InitTimings.PipelineWorkMs / InitTimings.PipelineMs << "x)";
+	os << "\n";
+
+	auto cache = Globals.Pipelines->GetStats();
+	os << "pso cache: " << cache.Requests << " requests, " << cache.Deduplicated << " shared, "
+	   << cache.Loaded << " loaded, " << cache.Compiled << " compiled\n";
+}
+
+void RenderGraph::DumpBarriers(std::ostream& os) const
+{
+	std::unordered_map<const void*, std::string> names;
+	for (const auto& out : GraphInputs)
+		names.try_emplace(out->GetRscPtr(), "$." + out->GetName());
+	for (size_t pass : SortedPasses)
+		for (const auto& out : Passes[pass]->GetOutputs())
+			names.try_emplace(out->GetRscPtr(), Passes[pass]->GetName() + "." + out->GetName());
+
+	auto layerName = [this](size_t layer)
+		{
+			return layer < ExecutionOrder.size() ? "before " + Passes[ExecutionOrder[layer]]->GetName() : std::string("end of frame");
+		};
+	auto resourceName = [&names](const ID3D12ResourcePtr* resource)
+		{
+			auto it = names.find(resource);
+			return it != names.end() ? it->second : std::string("<unnamed>");
+		};
+
+	Barriers.Dump(os, layerName, resourceName);
+}
+
+std::vector<std::optional<std::pair<size_t, size_t>>> RenderGraph::GetExecutedLifetimes() const
+{
+	std::vector<std::optional<std::pair<size_t, size_t>>> lifetimes(Transients.size());
+	for (size_t i = 0; i < ExecutionOrder.size(); i++)
+	{
+		auto touch = [&lifetimes, i, this](const void* resource)
+			{
+				auto it = TransientIndices.find(resource);
+				if (it == TransientIndices.end()) return;
+
+				auto& lifetime = lifetimes[it->second];
+				if (!lifetime) lifetime.emplace(i, i);
+				lifetime->second = i;
+			};
+
+		const auto& pass = *Passes[ExecutionOrder[i]];
+		for (const auto& in : pass.GetInputs())
+			touch(in->GetRscPtr());
+		for (const auto& out : pass.GetOutputs())
+			touch(out->GetRscPtr());
+	}
+
+	return lifetimes;
+}
+
+std::vector<bool> RenderGraph::EvaluateConditions() const
+{
+	std::vector<bool> conditions(Passes.size());
+	for (size_t i = 0; i < Passes.size(); i++)
+		conditions[i] = Passes[i]->IsEnabled();
+
+	return conditions;
+}
+
+size_t RenderGraph::FindPass(const std::string& name) const
+{
+	auto it = std::find_if(Passes.begin(), Passes.end(),
+						   [&name](const auto& ptr)
+						   {
+							   return name == ptr->GetName();
+						   });
+
+	if (it == Passes.end()) throw std::runtime_error("Pass input not found among existing Passes");
+	return std::distance(Passes.begin(), it);
 }
 
 void RenderGraph::AddGlobalInputs(UniquePtr<PassInputBase> in)
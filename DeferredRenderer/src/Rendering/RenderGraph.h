@@ -1,6 +1,12 @@
 #pragma once
 #include "Core/Core.h"
 #include "Resources.h"
+#include "CommandSubmitter.h"
+#include "Barriers.h"
+#include "CommandListPool.h"
+#include "QueueSchedule.h"
+#include "Core/ThreadPool.h"
+#include "TransientResources.h"
 #include "RenderPasses/RenderPass.h"
 #include "RenderPasses/Blur.h"
 #include "RenderPasses/AmbientOcclusion.h"
@@ -12,13 +18,52 @@
 #include "RenderPasses/ReflectionPass.h"
 #include "RenderPasses/Blend.h"
 
+#include <unordered_map>
+
+struct PassInitTiming
+{
+	float ResourcesMs = 0.0f;	// LinkResources, in dependency order on the constructing thread
+	float PipelineMs = 0.0f;	// Root signature and PSO, on a worker
+};
+
+struct InitStats
+{
+	std::vector<PassInitTiming> Passes;	// Indexed like RenderGraph::Passes
+	float ResourcesMs = 0.0f;
+	float PipelineMs = 0.0f;			// Wall time of the parallel build phase
+	float PipelineWorkMs = 0.0f;		// Sum over the passes - the build phase on one thread
+};
+
 class RenderGraph
 {
 public:
 	RenderGraph(ID3D12Device5Ptr device);
 	~RenderGraph() = default;
 
-	void Execute(ID3D12GraphicsCommandList4Ptr cmdList, const class Scene& scene);
+	void Execute(const ID3D12GraphicsCommandList4Ptr& cmdList, const class Scene& scene);
+
+	void SetSubmissionMode(SubmissionMode mode);
+	inline void SetSubmitter(UniquePtr<CommandSubmitter> submitter) { Submitter = std::move(submitter); }
+	inline CommandSubmitter& GetSubmitter() { return *Submitter; }
+	// Submits and waits issued by the last Execute call
+	inline const SubmissionStats& GetSubmissionStats() const { return Submitter->GetStats(); }
+	// Barriers and ResourceBarrier calls recorded per frame by the compiled plan
+	inline const BarrierStats& GetBarrierStats() const { return Barriers.GetStats(); }
+	// SetDescriptorHeaps calls of the last Execute call - one per recorded command list
+	inline DescriptorStats GetDescriptorStats() const { return Globals.Descriptors->GetStats(); }
+	// State sets of the last Execute call that reached the lists and those dropped as redundant
+	inline const RecordingStats& GetRecordingStats() const { return Recording; }
+	// Barriers of the compiled plan per layer, split transitions name the layer of their other half
+	void DumpBarriers(std::ostream& os) const;
+	// Queue submissions of the compiled plan in parallel mode and the waits between the queues
+	inline const QueueTimeline& GetTimeline() const { return Timeline; }
+	void DumpTimeline(std::ostream& os) const;
+	// Startup cost of every pass, split into resource linking and pipeline building
+	inline const InitStats& GetInitStats() const { return InitTimings; }
+	void DumpInitTimings(std::ostream& os) const;
+	// Rebuilds, in parallel, the PSOs of the passes reading any of the changed shader files.
+	// The GPU must be idle - returns the number of rebuilt passes
+	size_t ReloadShaders(const std::vector<std::string>& changedFiles);
 
 	template <typename PassType>
 	requires std::is_base_of_v<RenderPass, PassType>
@@ -34,33 +79,97 @@ public:
 
 		if (it != Passes.end()) throw std::invalid_argument("Pass name already exists");
 
+		// Passes are initialized once the graph is validated and their transient resources are placed
 		LinkInputs(*renderPass);
-		renderPass->Init(Device);
 		Passes.emplace_back(std::move(renderPass));
 	}
 
+	// Recompiles the execution plan when a pass condition changed since the last compile
 	void Tick();
+	// Indices into Passes of the passes executed this frame, in dependency order
+	inline const std::vector<size_t>& GetExecutionOrder() const { return ExecutionOrder; }
+	// Placement of the transient targets - HeapSize is the peak memory, NaiveSize the memory without aliasing
+	inline const AliasingPlan& GetTransientPlan() const { return TransientPlan; }
+
 	std::vector<UniquePtr<RenderPass>> Passes;
 private:
+	using ResourceStates = std::unordered_map<const void*, D3D12_RESOURCE_STATES>;
+
+	// PerPass and SingleList - both record on the main thread into cmdList
+	void ExecuteSerial(const ID3D12GraphicsCommandList4Ptr& cmdList, const Scene& scene);
+	void ExecuteParallel(const Scene& scene);
+	void RecordPass(CommandContext& cmdList, const Scene& scene, size_t index);
+
 	void SetInputTarget(const std::string& name, const std::string& target);
 	void LinkInputs(RenderPass& renderPass);
 	void LinkGlobalInputs();
 	void Validate();
-	void TransitionUnpropagatedResources();
+	void AllocateTransientResources();
+	void InitPasses();
+
+	// Compilation
+	void SortPasses();
+	void Compile();
+	// layerLists: command list of every barrier layer - a transition is split only when both halves share one
+	void BuildTransitions(const std::vector<size_t>& layerLists);
+	void BuildTimeline();
+	// Command list each barrier layer is recorded into under the current mode
+	std::vector<size_t> GetLayerLists() const;
+	// Positions in ExecutionOrder of the first and last pass touching each transient resource
+	std::vector<std::optional<std::pair<size_t, size_t>>> GetExecutedLifetimes() const;
+	std::vector<bool> EvaluateConditions() const;
+	size_t FindPass(const std::string& name) const;
 
 	void AddGlobalInputs(UniquePtr<PassInputBase> in);
 	void AddGlobalOutputs(UniquePtr<PassOutputBase> out);
 
 private:
-	using Transitions2DArray = std::vector<std::vector<UniquePtr<TransitionBase>>>;
-
 	ID3D12Device5Ptr Device;
 	std::vector<UniquePtr<PassInputBase>> GraphOutputs;
 	std::vector<UniquePtr<PassOutputBase>> GraphInputs;
-	Transitions2DArray Transitions;
+
+	// Producers of every pass, indexed like Passes
+	std::vector<std::vector<size_t>> Dependencies;
+	// Topological order of the whole graph - computed once at validation
+	std::vector<size_t> SortedPasses;
+	// Live subset of SortedPasses under the conditions the plan was compiled with
+	std::vector<size_t> ExecutionOrder;
+	std::vector<bool> CompiledConditions;
+	// One layer per executed pass plus the final layer (GetLayerCount() = ExecutionOrder.size() + 1)
+	BarrierBatches Barriers;
+
+	// Pass-owned targets placed in TransientHeap, resources with disjoint lifetimes share memory
+	std::vector<TransientResourceDesc> Transients;
+	std::unordered_map<const void*, size_t> TransientIndices;
+	AliasingPlan TransientPlan;
+	ID3D12HeapPtr TransientHeap;
+
+	SubmissionMode Mode = SubmissionMode::SingleList;
+	UniquePtr<CommandSubmitter> Submitter;
+	RecordingStats Recording;
+
+	// Parallel recording - one task per command list, chunks of a pass are consecutive tasks
+	struct RecordingTask
+	{
+		size_t Entry = 0;	// Index into Timeline.Entries
+		size_t EntryCount = 1;	// Entries sharing the list - chunks apply to the last one
+		size_t Chunk = 0;
+		size_t ChunkCount = 1;
+		size_t List = 0;	// Index into the list pool of the entry's queue
+	};
+	QueueTimeline Timeline;
+	std::vector<RecordingTask> Tasks;
+	std::vector<RecordingStats> TaskRecording;	// Indexed like Tasks, summed into Recording
+	std::vector<uint64_t> SubmissionFences;
+	std::vector<ID3D12GraphicsCommandList4Ptr> SubmissionLists;
+	UniquePtr<ThreadPool> Workers;
+	UniquePtr<CommandListPool> GraphicsLists;
+	UniquePtr<CommandListPool> ComputeLists;
 
 	SharedPtr<ID3D12ResourcePtr> RTVBuffer{};
 	SharedPtr<ID3D12ResourcePtr> DSVBuffer{};
 
+	InitStats InitTimings;
+
 	bool IsValidated = false;
 };
\ No newline at end of file
@@ -9,35 +9,48 @@ AmbientOcclusionPass::AmbientOcclusionPass(std::string&& name)
 	Register<PassOutput<ID3D12ResourcePtr>>("positions", Positions, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassOutput<ID3D12ResourcePtr>>("normals", Normals, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassOutput<ID3D12ResourcePtr>>("renderTarget", RTVBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+	D3D12_CLEAR_VALUE clearValue = {};
+	clearValue.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	clearValue.Color[0] = 1.0f;
+	clearValue.Color[1] = 1.0f;
+	clearValue.Color[2] = 1.0f;
+	clearValue.Color[3] = 1.0f;
+
+	auto resDesc = CD3DX12_RESOURCE_DESC(
+		D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+		D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+		Globals.WindowDimensions.x, Globals.WindowDimensions.y, 1, 1,
+		DXGI_FORMAT_R8G8B8A8_UNORM,
+		1, 0,
+		D3D12_TEXTURE_LAYOUT_UNKNOWN, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+	RegisterTransient(RTVBuffer, resDesc, D3D12_RESOURCE_STATE_RENDER_TARGET, clearValue);
 }
 
-void AmbientOcclusionPass::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene)
+void AmbientOcclusionPass::Submit(CommandContext& cmdList, const Scene& scene)
 {
 	//RootSignatureData
-	cmdList->SetGraphicsRootSignature(RootSignatureData.RootSignaturePtr.GetInterfacePtr());
+	RootSignatureData.Bind(cmdList);
 
 	D3D12_VIEWPORT viewport = { 0.0f, 0.0f, (FLOAT)Globals.WindowDimensions.x, (FLOAT)Globals.WindowDimensions.y, 0.0f, 1.0f };
-	cmdList->RSSetViewports(1, &viewport);
+	cmdList.RSSetViewports(1, &viewport);
 
 	// Set scissor rect
 	D3D12_RECT scissorRect = { 0, 0, Globals.WindowDimensions.x, Globals.WindowDimensions.y };
-	cmdList->RSSetScissorRects(1, &scissorRect);
+	cmdList.RSSetScissorRects(1, &scissorRect);
 
 	const float clearColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
 	cmdList->ClearRenderTargetView(RTVHandle, clearColor, 0, nullptr);
-	cmdList->OMSetRenderTargets(1, &RTVHandle, FALSE, nullptr); // NEED CUSTOM RTV!
+	cmdList.OMSetRenderTargets(1, &RTVHandle, FALSE, nullptr); // NEED CUSTOM RTV!
 
-	Heaps.Bind(cmdList);
+	Tables.Bind(cmdList);
 
-	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	cmdList.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	cmdList->DrawInstanced(3, 1, 0, 0);
 }
 
 void AmbientOcclusionPass::InitResources(ID3D12Device5Ptr device)
 {
-	auto& cmdList = Globals.CmdList;
-	auto& cmdAllocator = Globals.CmdAllocator;
-
 	auto randRange = [](float min, float max)
 		{
 			return min + static_cast<float>(std::rand()) / (static_cast<float>(RAND_MAX) / (max - min));
@@ -62,32 +75,15 @@ void AmbientOcclusionPass::InitResources(ID3D12Device5Ptr device)
 		1, 0,
 		D3D12_TEXTURE_LAYOUT_UNKNOWN, D3D12_RESOURCE_FLAG_NONE);
 
-	ID3D12ResourcePtr randomTexture;
-	GRAPHICS_ASSERT(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-		D3D12_HEAP_FLAG_NONE,
-		&resDesc,
-		D3D12_RESOURCE_STATE_COPY_DEST,
-		nullptr,
-		IID_PPV_ARGS(&randomTexture)));
-	RandomTexture = MakeShared<ID3D12ResourcePtr>(randomTexture);
-
-	ID3D12ResourcePtr stagingBufferRandTex;
-	GRAPHICS_ASSERT(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-		D3D12_HEAP_FLAG_NONE,
-		&CD3DX12_RESOURCE_DESC::Buffer(GetRequiredIntermediateSize(*RandomTexture, 0, 1)),
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&stagingBufferRandTex)));
+	auto randomTexture = Globals.Allocator->CreateResource(resDesc, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON);
+	RandomTexture = MakeShared<ID3D12ResourcePtr>(randomTexture.Resource);
 
 	D3D12_SUBRESOURCE_DATA textureData{};
 	textureData.pData = noiseTextureFloats.data();
 	textureData.RowPitch = resDesc.Width * sizeof(glm::float3);
 	textureData.SlicePitch = textureData.RowPitch * resDesc.Height;
 
-	UpdateSubresources(cmdList, *RandomTexture, stagingBufferRandTex, 0, 0, 1, &textureData);
-	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(*RandomTexture, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ));
+	Globals.Uploads->UploadTexture(*RandomTexture, 0, &textureData, 1);
 	// Done Creating Random Texture
 
 	// Create SSAO Kernel
@@ -107,79 +103,11 @@ void AmbientOcclusionPass::InitResources(ID3D12Device5Ptr device)
 		ssaoKernelVals[i].z *= scaleMul;
 	}
 
-	resDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	resDesc.Alignment = 0;
-	resDesc.Width = sizeof(glm::float3) * ssaoKernelVals.size(); // Total buffer size
-	resDesc.Height = 1;
-	resDesc.DepthOrArraySize = 1;
-	resDesc.MipLevels = 1;
-	resDesc.Format = DXGI_FORMAT_UNKNOWN; // No specific format for structured buffers
-	resDesc.SampleDesc.Count = 1;
-	resDesc.SampleDesc.Quality = 0;
-	resDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-	resDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-	ID3D12ResourcePtr structuredBuffer;
-	device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-		D3D12_HEAP_FLAG_NONE,
-		&resDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&structuredBuffer));
-
-	void* mappedData = nullptr;
-	D3D12_RANGE readRange = { 0, 0 }; // We don't intend to read from this resource on the CPU
-	structuredBuffer->Map(0, &readRange, &mappedData);
-	memcpy(mappedData, ssaoKernelVals.data(), sizeof(glm::float3) * ssaoKernelVals.size());
-	structuredBuffer->Unmap(0, nullptr);
-
-	resDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	resDesc.Width = sizeof(glm::float3) * ssaoKernelVals.size(); // Total buffer size
-	resDesc.Format = DXGI_FORMAT_UNKNOWN;  // No specific format for structured buffers
-	resDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-	resDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-
-	ID3D12ResourcePtr gpuBuffer;
-	GRAPHICS_ASSERT(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-		D3D12_HEAP_FLAG_NONE,
-		&resDesc,
-		D3D12_RESOURCE_STATE_COPY_DEST,
-		nullptr,
-		IID_PPV_ARGS(&gpuBuffer)));
-
-	cmdList->CopyBufferRegion(gpuBuffer, 0, structuredBuffer, 0, sizeof(glm::float3) * ssaoKernelVals.size());
-
-	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(gpuBuffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
-	SSAOKernel = MakeShared<ID3D12ResourcePtr>(gpuBuffer);
+	auto kernelBuffer = CreateStaticBuffer(ssaoKernelVals.data(), sizeof(glm::float3) * ssaoKernelVals.size());
+	SSAOKernel = MakeShared<ID3D12ResourcePtr>(kernelBuffer);
 	// Done Creating SSAO Kernel
 
-	// Create Render Target
-	D3D12_CLEAR_VALUE clearValue = {};
-	clearValue.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	clearValue.Color[0] = 1.0f;
-	clearValue.Color[1] = 1.0f;
-	clearValue.Color[2] = 1.0f;
-	clearValue.Color[3] = 1.0f;
-
-	resDesc = CD3DX12_RESOURCE_DESC(
-		D3D12_RESOURCE_DIMENSION_TEXTURE2D,
-		D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
-		Globals.WindowDimensions.x, Globals.WindowDimensions.y, 1, 1,
-		DXGI_FORMAT_R8G8B8A8_UNORM,
-		1, 0,
-		D3D12_TEXTURE_LAYOUT_UNKNOWN, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
-
-	ID3D12ResourcePtr renderTarget;
-	GRAPHICS_ASSERT(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-		D3D12_HEAP_FLAG_NONE,
-		&resDesc,
-		D3D12_RESOURCE_STATE_RENDER_TARGET,
-		&clearValue,
-		IID_PPV_ARGS(&renderTarget)));
-	RTVBuffer = MakeShared<ID3D12ResourcePtr>(renderTarget);
+	// Render target is placed by the render graph
 
 	// RTV Heap
 	auto rtvHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, false);
@@ -188,7 +116,7 @@ void AmbientOcclusionPass::InitResources(ID3D12Device5Ptr device)
 	RTVHandle = rtvHeap->GetCPUDescriptorHandleForHeapStart();
 	device->CreateRenderTargetView(*RTVBuffer, nullptr, RTVHandle);
 
-	// SRV Heap
+	// SRV Table
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	srvDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
@@ -197,10 +125,9 @@ void AmbientOcclusionPass::InitResources(ID3D12Device5Ptr device)
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
-	auto srvHeap = D3D::CreateDescriptorHeap(device, 4, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	SRVHeap = MakeShared<ID3D12DescriptorHeapPtr>(srvHeap);
+	SRVTable = Globals.Descriptors->Allocate(4);
 
-	D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = SRVHeap->GetInterfacePtr()->GetCPUDescriptorHandleForHeapStart();
+	D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = SRVTable.GetCPUHandle();
 	UINT srvDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
 	device->CreateShaderResourceView(*Positions, &srvDesc, srvHandle);
@@ -223,16 +150,10 @@ void AmbientOcclusionPass::InitResources(ID3D12Device5Ptr device)
 	srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
 	device->CreateShaderResourceView(*SSAOKernel, &srvDesc, srvHandle);
 
-	// Set up heaps to bind
-	Heaps.PushBack(*SRVHeap);
-	Heaps.PushBack(Globals.SamplerHeap);
-	Heaps.PushBack(Globals.CBVHeap);
-
-	// Synchronization Point - Important because I copy data to GPU above
-	Globals.FenceValue = D3D::SubmitCommandList(cmdList, Globals.CmdQueue, Globals.Fence, Globals.FenceValue);
-	Globals.Fence->SetEventOnCompletion(Globals.FenceValue, Globals.FenceEvent);
-	WaitForSingleObject(Globals.FenceEvent, INFINITE);
-	cmdList->Reset(cmdAllocator, nullptr);
+	// Set up tables to bind
+	Tables.PushBack(SRVTable);
+	Tables.PushBack(Globals.SamplerTable);
+	Tables.PushBack(Globals.CBVTable, 1);
 }
 
 void AmbientOcclusionPass::InitRootSignature()
@@ -275,8 +196,8 @@ void AmbientOcclusionPass::InitPipelineState()
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
 	psoDesc.InputLayout = layoutDesc;
 	psoDesc.pRootSignature = RootSignatureData.RootSignaturePtr.GetInterfacePtr();
-	psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.GetBlob());
-	psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.GetBlob());
+	psoDesc.VS = vertexShader.GetBytecode();
+	psoDesc.PS = pixelShader.GetBytecode();
 	psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
 	psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
 	psoDesc.DepthStencilState = depthStencilDesc;
@@ -287,5 +208,5 @@ void AmbientOcclusionPass::InitPipelineState()
 	psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
 	psoDesc.SampleDesc.Count = 1;
 
-	GRAPHICS_ASSERT(Device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&PipelineState)));
+	CreatePipelineState(psoDesc);
 }
\ No newline at end of file
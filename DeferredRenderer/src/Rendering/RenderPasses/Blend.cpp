@@ -14,8 +14,8 @@ BlendPass::BlendPass(std::string&& name)
 
 void BlendPass::InitResources(ID3D12Device5Ptr device)
 {
-	SRVHeap = D3D::CreateDescriptorHeap(device, 2, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	auto srvHandle = SRVHeap->GetCPUDescriptorHandleForHeapStart();
+	SRVTable = Globals.Descriptors->Allocate(2);
+	auto srvHandle = SRVTable.GetCPUHandle();
 
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -30,27 +30,27 @@ void BlendPass::InitResources(ID3D12Device5Ptr device)
 
 	device->CreateShaderResourceView(*ReflectionColor, &srvDesc, srvHandle);
 
-	Heaps.PushBack(SRVHeap);
-	Heaps.PushBack(Globals.SamplerHeap);
-	Heaps.PushBack(Globals.CBVHeap);
+	Tables.PushBack(SRVTable);
+	Tables.PushBack(Globals.SamplerTable);
+	Tables.PushBack(Globals.CBVTable, 1);
 }
 
-void BlendPass::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene)
+void BlendPass::Submit(CommandContext& cmdList, const Scene& scene)
 {
 	//RootSignatureData
-	cmdList->SetGraphicsRootSignature(RootSignatureData.RootSignaturePtr.GetInterfacePtr());
+	RootSignatureData.Bind(cmdList);
 
 	D3D12_VIEWPORT viewport = { 0.0f, 0.0f, (FLOAT)Globals.WindowDimensions.x, (FLOAT)Globals.WindowDimensions.y, 0.0f, 1.0f };
-	cmdList->RSSetViewports(1, &viewport);
+	cmdList.RSSetViewports(1, &viewport);
 
 	// Set scissor rect
 	D3D12_RECT scissorRect = { 0, 0, Globals.WindowDimensions.x, Globals.WindowDimensions.y };
-	cmdList->RSSetScissorRects(1, &scissorRect);
-	cmdList->OMSetRenderTargets(1, &Globals.RTVHandle, FALSE, nullptr);
+	cmdList.RSSetScissorRects(1, &scissorRect);
+	cmdList.OMSetRenderTargets(1, &Globals.RTVHandle, FALSE, nullptr);
 
-	Heaps.Bind(cmdList);
+	Tables.Bind(cmdList);
 
-	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	cmdList.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	cmdList->DrawInstanced(3, 1, 0, 0);
 }
 
@@ -76,9 +76,24 @@ void BlendPass::InitRootSignature()
 }
 
 void BlendPass::InitPipelineState()
+{
+	Variants.Init([this](Features features) { return BuildPipelineState(features); }, GetFeatures());
+}
+
+ID3D12PipelineStatePtr BlendPass::GetPSO() const
+{
+	return Variants.Get(GetFeatures());
+}
+
+BlendPass::Features BlendPass::GetFeatures()
+{
+	return Features().Set<"SSR">(Globals.CBGlobalConstants.CPUData.SSREnabled != 0);
+}
+
+ID3D12PipelineStatePtr BlendPass::BuildPipelineState(Features features) const
 {
 	Shader<Vertex> vertexShader("FullScreenTriangle");
-	Shader<Pixel> pixelShader("BlendPass");
+	Shader<Pixel> pixelShader("BlendPass", features.GetDefines());
 
 	D3D12_INPUT_LAYOUT_DESC layoutDesc{};
 	layoutDesc.pInputElementDescs = nullptr;
@@ -94,8 +109,8 @@ void BlendPass::InitPipelineState()
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
 	psoDesc.InputLayout = layoutDesc;
 	psoDesc.pRootSignature = RootSignatureData.RootSignaturePtr.GetInterfacePtr();
-	psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.GetBlob());
-	psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.GetBlob());
+	psoDesc.VS = vertexShader.GetBytecode();
+	psoDesc.PS = pixelShader.GetBytecode();
 	psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
 	psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
 	psoDesc.DepthStencilState = depthStencilDesc;
@@ -106,5 +121,5 @@ void BlendPass::InitPipelineState()
 	psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
 	psoDesc.SampleDesc.Count = 1;
 
-	GRAPHICS_ASSERT(Device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&PipelineState)));
+	return Globals.Pipelines->GetGraphics(psoDesc, RootSignatureData.Hash);
 }
\ No newline at end of file
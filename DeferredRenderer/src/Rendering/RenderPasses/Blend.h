@@ -1,18 +1,27 @@
 #pragma once
 #include "RenderPass.h"
+#include "Rendering/ShaderPermutations.h"
 
 class BlendPass : public RenderPass
 {
 public:
 	BlendPass(std::string&& name);
-	void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) override;
+	void Submit(CommandContext& cmdList, const Scene& scene) override;
+	ID3D12PipelineStatePtr GetPSO() const override;
 protected:
 	void InitResources(ID3D12Device5Ptr device) override;
 	void InitRootSignature() override;
 	void InitPipelineState() override;
 private:
+	// SSR is compiled in instead of branching on SSREnabled per pixel
+	using Features = PermutationKey<"SSR">;
+	static Features GetFeatures();
+	ID3D12PipelineStatePtr BuildPipelineState(Features features) const;
+
+	PipelineVariants<Features> Variants;
+
 	SharedPtr<ID3D12ResourcePtr> OriginalColor;
 	SharedPtr<ID3D12ResourcePtr> ReflectionColor;
 
-	ID3D12DescriptorHeapPtr SRVHeap;
+	DescriptorTable SRVTable;
 };
@@ -2,7 +2,7 @@
 #include "Rendering/Shader.h"
 #include "Scene.h"
 
-ID3D12DescriptorHeapPtr CombinedBlurPassGlobal::FiltersHeap = nullptr;
+DescriptorTable CombinedBlurPassGlobal::FiltersTable{};
 ID3D12ResourcePtr CombinedBlurPassGlobal::Filters = nullptr;
 
 // Gaussian filter generation code
@@ -112,26 +112,26 @@ BlurPass::BlurPass(std::string&& name)
 	:RenderPass(std::move(name))
 {}
 
-void BlurPass::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene)
+void BlurPass::Submit(CommandContext& cmdList, const Scene& scene)
 {
 	//RootSignatureData
-	cmdList->SetGraphicsRootSignature(RootSignatureData.RootSignaturePtr.GetInterfacePtr());
+	RootSignatureData.Bind(cmdList);
 
 	D3D12_VIEWPORT viewport = { 0.0f, 0.0f, (FLOAT)Globals.WindowDimensions.x, (FLOAT)Globals.WindowDimensions.y, 0.0f, 1.0f };
-	cmdList->RSSetViewports(1, &viewport);
+	cmdList.RSSetViewports(1, &viewport);
 
 	// Set scissor rect
 	D3D12_RECT scissorRect = { 0, 0, Globals.WindowDimensions.x, Globals.WindowDimensions.y };
-	cmdList->RSSetScissorRects(1, &scissorRect);
+	cmdList.RSSetScissorRects(1, &scissorRect);
 
 	const float clearColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
 	cmdList->ClearRenderTargetView(RTVHandle, clearColor, 0, nullptr);
-	cmdList->OMSetRenderTargets(1, &RTVHandle, FALSE, nullptr); // NEED CUSTOM RTV!
+	cmdList.OMSetRenderTargets(1, &RTVHandle, FALSE, nullptr); // NEED CUSTOM RTV!
 
-	Heaps.Bind(cmdList);
+	Tables.Bind(cmdList);
 	Controls.Bind(cmdList, 2);
 
-	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	cmdList.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	cmdList->DrawInstanced(3, 1, 0, 0);
 }
 
@@ -145,13 +145,10 @@ void BlurPass::InitResources(ID3D12Device5Ptr device)
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
-	SRVHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = SRVHeap->GetCPUDescriptorHandleForHeapStart();
-	device->CreateShaderResourceView(*SRVToBlur, &srvDesc, srvHandle);
+	SRVTable = Globals.Descriptors->Allocate(1);
+	device->CreateShaderResourceView(*SRVToBlur, &srvDesc, SRVTable.GetCPUHandle());
 
-	CBVHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	D3D12_CPU_DESCRIPTOR_HANDLE cbvHandle = CBVHeap->GetCPUDescriptorHandleForHeapStart();
-	Controls.Resource.Init(device, cbvHandle);
+	Controls.Resource.Init(device);
 
 	// Create Render Target
 	D3D12_CLEAR_VALUE clearValue = {};
@@ -169,15 +166,8 @@ void BlurPass::InitResources(ID3D12Device5Ptr device)
 		1, 0,
 		D3D12_TEXTURE_LAYOUT_UNKNOWN, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
 
-	ID3D12ResourcePtr renderTarget;
-	GRAPHICS_ASSERT(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-		D3D12_HEAP_FLAG_NONE,
-		&resDesc,
-		D3D12_RESOURCE_STATE_RENDER_TARGET,
-		&clearValue,
-		IID_PPV_ARGS(&renderTarget)));
-	RTVBuffer = MakeShared<ID3D12ResourcePtr>(renderTarget);
+	auto renderTarget = Globals.Allocator->CreateResource(resDesc, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_RENDER_TARGET, &clearValue);
+	RTVBuffer = MakeShared<ID3D12ResourcePtr>(renderTarget.Resource);
 
 	// RTV Heap
 	auto rtvHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, false);
@@ -186,9 +176,8 @@ void BlurPass::InitResources(ID3D12Device5Ptr device)
 	RTVHandle = rtvHeap->GetCPUDescriptorHandleForHeapStart();
 	device->CreateRenderTargetView(*RTVBuffer, nullptr, RTVHandle);
 
-	Heaps.PushBack(Globals.SamplerHeap);
-	Heaps.PushBack(SRVHeap);
-	//Heaps.PushBack(CBVHeap);
+	Tables.PushBack(Globals.SamplerTable);
+	Tables.PushBack(SRVTable);
 }
 
 void BlurPass::InitRootSignature()
@@ -232,8 +221,8 @@ void BlurPass::InitPipelineState()
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
 	psoDesc.InputLayout = layoutDesc;
 	psoDesc.pRootSignature = RootSignatureData.RootSignaturePtr.GetInterfacePtr();
-	psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.GetBlob());
-	psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.GetBlob());
+	psoDesc.VS = vertexShader.GetBytecode();
+	psoDesc.PS = pixelShader.GetBytecode();
 	psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
 	psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
 	psoDesc.DepthStencilState = depthStencilDesc;
@@ -244,7 +233,7 @@ void BlurPass::InitPipelineState()
 	psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
 	psoDesc.SampleDesc.Count = 1;
 
-	GRAPHICS_ASSERT(Device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&PipelineState)));
+	CreatePipelineState(psoDesc);
 }
 
 
@@ -260,7 +249,7 @@ void HorizontalBlurPass::InitResources(ID3D12Device5Ptr device)
 {
 	BlurPass::InitResources(device);
 	Controls.Resource.CPUData.IsHorizontal = true;
-	Controls.Resource.Tick();
+	Controls.Resource.UploadAll();
 }
 
 VerticalBlurPass::VerticalBlurPass(std::string&& name)
@@ -276,21 +265,32 @@ void VerticalBlurPass::InitResources(ID3D12Device5Ptr device)
 	BlurPass::InitResources(device);
 
 	Controls.Resource.CPUData.IsHorizontal = false;
-	Controls.Resource.Tick();
+	Controls.Resource.UploadAll();
 }
 
 CombinedBlurPass::CombinedBlurPass(std::string&& name, bool flag)
 	:RenderPass(std::move(name))
 {
-	Register<PassInput<ID3D12ResourcePtr>>("processedResource", SRVToBlur, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	// Read by a compute shader, which on the compute queue cannot see PIXEL_SHADER_RESOURCE
+	Register<PassInput<ID3D12ResourcePtr>>("processedResource", SRVToBlur, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
 	Register<PassOutput<ID3D12ResourcePtr>>("processedResource", SRVToBlur, flag ? D3D12_RESOURCE_STATE_RENDER_TARGET : D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassOutput<ID3D12ResourcePtr>>("renderTarget", BlurOutput, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+	auto resDesc = CD3DX12_RESOURCE_DESC(
+		D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+		D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+		Globals.WindowDimensions.x, Globals.WindowDimensions.y, 1, 1,
+		DXGI_FORMAT_R8G8B8A8_UNORM,
+		1, 0,
+		D3D12_TEXTURE_LAYOUT_UNKNOWN, 
+		D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS | D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+	RegisterTransient(BlurOutput, resDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 }
 
-void CombinedBlurPass::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene)
+void CombinedBlurPass::Submit(CommandContext& cmdList, const Scene& scene)
 {
-	cmdList->SetComputeRootSignature(RootSignatureData.RootSignaturePtr.GetInterfacePtr());
-	Heaps.BindCompute(cmdList);
+	RootSignatureData.BindCompute(cmdList);
+	Tables.BindCompute(cmdList);
 	scene.Bind<CombinedBlurPass>(cmdList);
 }
 
@@ -305,40 +305,19 @@ void CombinedBlurPass::InitResources(ID3D12Device5Ptr device)
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
-	SRVHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = SRVHeap->GetCPUDescriptorHandleForHeapStart();
-	device->CreateShaderResourceView(*SRVToBlur, &srvDesc, srvHandle);
-
-	// UAV setup for output image
-	auto resDesc = CD3DX12_RESOURCE_DESC(
-		D3D12_RESOURCE_DIMENSION_TEXTURE2D,
-		D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
-		Globals.WindowDimensions.x, Globals.WindowDimensions.y, 1, 1,
-		DXGI_FORMAT_R8G8B8A8_UNORM,
-		1, 0,
-		D3D12_TEXTURE_LAYOUT_UNKNOWN, 
-		D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS | D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
-
-	ID3D12ResourcePtr uavResource;
-	GRAPHICS_ASSERT(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-		D3D12_HEAP_FLAG_NONE,
-		&resDesc,
-		D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-		NULL,
-		IID_PPV_ARGS(&uavResource)));
-	BlurOutput = MakeShared<ID3D12ResourcePtr>(uavResource);
+	SRVTable = Globals.Descriptors->Allocate(1);
+	device->CreateShaderResourceView(*SRVToBlur, &srvDesc, SRVTable.GetCPUHandle());
 
-	UAVHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	auto uavHandle = UAVHeap->GetCPUDescriptorHandleForHeapStart();
-	device->CreateShaderResourceView(*BlurOutput, &srvDesc, uavHandle);
+	// UAV setup for output image - the image itself is placed by the render graph
+	UAVTable = Globals.Descriptors->Allocate(1);
+	device->CreateShaderResourceView(*BlurOutput, &srvDesc, UAVTable.GetCPUHandle());
 
 	InitStaticResources(device);
 
 	//----------------------------------------------
-	Heaps.PushBack(SRVHeap);
-	Heaps.PushBack(UAVHeap);
-	Heaps.PushBack(FiltersHeap);
+	Tables.PushBack(SRVTable);
+	Tables.PushBack(UAVTable);
+	Tables.PushBack(FiltersTable);
 
 }
 
@@ -371,52 +350,23 @@ void CombinedBlurPass::InitPipelineState()
     // Describe and create the compute pipeline state object (PSO)
     D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.pRootSignature = RootSignatureData.RootSignaturePtr.GetInterfacePtr();
-    psoDesc.CS = CD3DX12_SHADER_BYTECODE(computeShader.GetBlob());
+    psoDesc.CS = computeShader.GetBytecode();
 
     // Create the compute pipeline state
-    GRAPHICS_ASSERT(Device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&PipelineState)));
+    CreatePipelineState(psoDesc);
 }
 
 void CombinedBlurPass::InitStaticResources(ID3D12Device5Ptr device)
 {
-	static bool initialized = false;
-	if (initialized) return;
+	// Shared by every blur pass - the first one to link creates them
+	if (Filters) return;
 
-	initialized = true;
 	//-----------------------------------------
 	// Descriptor Table with acceptable filters
-	auto& cmdList = Globals.CmdList;
-	auto& cmdAllocator = Globals.CmdAllocator;
-
-	// Descriptor Heap for SRV
-	FiltersHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
+	FiltersTable = Globals.Descriptors->Allocate(1);
 
 	constexpr uint32_t NumKernels = MaxRadius;
 
-	// Create the structured buffer
-	CD3DX12_RESOURCE_DESC resDesc{};
-	resDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	resDesc.Alignment = 0;
-	resDesc.Width = sizeof(Kernel) * NumKernels; // Holds all 15 Kernels
-	resDesc.Height = 1;
-	resDesc.DepthOrArraySize = 1;
-	resDesc.MipLevels = 1;
-	resDesc.Format = DXGI_FORMAT_UNKNOWN;
-	resDesc.SampleDesc.Count = 1;
-	resDesc.SampleDesc.Quality = 0;
-	resDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-	resDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-	// Create the buffer resource
-	GRAPHICS_ASSERT(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-		D3D12_HEAP_FLAG_NONE,
-		&resDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&Filters)));
-
-	// Map and write data
 	Kernel kernelData[NumKernels];
 	for (int i = 0; i < NumKernels; i++)
 	{
@@ -426,11 +376,9 @@ void CombinedBlurPass::InitStaticResources(ID3D12Device5Ptr device)
 		std::copy(weights.begin(), weights.end(), kernelData[i].Coeffs);
 	}
 
-	void* mappedData = nullptr;
-	D3D12_RANGE readRange = { 0, 0 };
-	Filters->Map(0, &readRange, &mappedData);
-	memcpy(mappedData, kernelData, sizeof(Kernel) * NumKernels);
-	Filters->Unmap(0, nullptr);
+	// Structured buffer holding all 15 kernels. The copy goes out with the other startup uploads,
+	// which the graphics queue waits for before the first frame
+	Filters = CreateStaticBuffer(kernelData, sizeof(Kernel) * NumKernels);
 
 	// Create SRV
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
@@ -442,14 +390,7 @@ void CombinedBlurPass::InitStaticResources(ID3D12Device5Ptr device)
 	srvDesc.Buffer.StructureByteStride = sizeof(Kernel);
 	srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
 
-	auto filtersHandle = FiltersHeap->GetCPUDescriptorHandleForHeapStart();
-	device->CreateShaderResourceView(Filters, &srvDesc, filtersHandle);
-
-	// Synchronization Point - Important because I copy data to GPU above
-	Globals.FenceValue = D3D::SubmitCommandList(cmdList, Globals.CmdQueue, Globals.Fence, Globals.FenceValue);
-	Globals.Fence->SetEventOnCompletion(Globals.FenceValue, Globals.FenceEvent);
-	WaitForSingleObject(Globals.FenceEvent, INFINITE);
-	cmdList->Reset(cmdAllocator, nullptr);
+	device->CreateShaderResourceView(Filters, &srvDesc, FiltersTable.GetCPUHandle());
 }
 
 CombinedBlurPassGlobal::CombinedBlurPassGlobal(std::string&& name, bool flag, uint radius)
@@ -458,10 +399,10 @@ CombinedBlurPassGlobal::CombinedBlurPassGlobal(std::string&& name, bool flag, ui
 	SetRadius(radius);
 }
 
-void CombinedBlurPassGlobal::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene & scene)
+void CombinedBlurPassGlobal::Submit(CommandContext& cmdList, const Scene & scene)
 {
-	cmdList->SetComputeRootSignature(RootSignatureData.RootSignaturePtr.GetInterfacePtr());
-	Heaps.BindCompute(cmdList);
+	RootSignatureData.BindCompute(cmdList);
+	Tables.BindCompute(cmdList);
 	FilterRadius.BindCompute(cmdList, 3);
 
 	UINT threadGroupX = (Globals.WindowDimensions.x + 127) / (GroupSize);  // Assuming 16x16 thread group size
@@ -471,7 +412,7 @@ void CombinedBlurPassGlobal::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const
 
 void CombinedBlurPassGlobal::SetRadius(uint radius) 
 { 
-	ASSERT(radius >=1 && radius <= 16, "Kernel radius value not within the supported range of [1, 16]")
+	ASSERT(radius >=1 && radius <= 16, "Kernel radius value not within the supported range of [1, 16]");
 	FilterRadius.Resource.CPUData = radius; 
 }
 
@@ -479,8 +420,5 @@ void CombinedBlurPassGlobal::InitResources(ID3D12Device5Ptr device)
 {
 	CombinedBlurPass::InitResources(device);
 
-	CBVHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	auto cbvHandle = CBVHeap->GetCPUDescriptorHandleForHeapStart();
-	FilterRadius.Resource.Init(device, cbvHandle);
-	FilterRadius.Resource.Tick();
+	FilterRadius.Resource.Init(device);
 }
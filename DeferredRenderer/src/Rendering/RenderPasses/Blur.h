@@ -5,7 +5,7 @@
 class BlurPass : public RenderPass
 {
 public:
-	virtual void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) override;
+	virtual void Submit(CommandContext& cmdList, const Scene& scene) override;
 	virtual ~BlurPass() = default;
 protected:
 	BlurPass(std::string&& name);
@@ -13,8 +13,7 @@ protected:
 	virtual void InitRootSignature() override;
 	virtual void InitPipelineState() override;
 protected:
-	ID3D12DescriptorHeapPtr SRVHeap;
-	ID3D12DescriptorHeapPtr CBVHeap;
+	DescriptorTable SRVTable;
 
 	SharedPtr<ID3D12DescriptorHeapPtr> RTVHeap{};
 	D3D12_CPU_DESCRIPTOR_HANDLE RTVHandle{};
@@ -43,7 +42,8 @@ class CombinedBlurPass : public RenderPass
 {
 public:
 	CombinedBlurPass(std::string&& name, bool flag = true);
-	virtual void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) override;
+	virtual void Submit(CommandContext& cmdList, const Scene& scene) override;
+	QueueType GetQueueAffinity() const override { return QueueType::Compute; }
 protected:
 	virtual void InitResources(ID3D12Device5Ptr device) override;
 	virtual void InitRootSignature() override;
@@ -51,13 +51,13 @@ protected:
 private:
 	void InitStaticResources(ID3D12Device5Ptr device);
 protected:
-	ID3D12DescriptorHeapPtr SRVHeap;
-	ID3D12DescriptorHeapPtr UAVHeap;
+	DescriptorTable SRVTable;
+	DescriptorTable UAVTable;
 
 	SharedPtr<ID3D12ResourcePtr> SRVToBlur;
 	SharedPtr<ID3D12ResourcePtr> BlurOutput;
 
-	static ID3D12DescriptorHeapPtr FiltersHeap;
+	static DescriptorTable FiltersTable;
 	static ID3D12ResourcePtr Filters;
 
 public:
@@ -68,11 +68,10 @@ class CombinedBlurPassGlobal : public CombinedBlurPass
 {
 public:
 	CombinedBlurPassGlobal(std::string&& name, bool flag = true, uint radius = 5);
-	void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) override;
+	void Submit(CommandContext& cmdList, const Scene& scene) override;
 	inline void SetRadius(uint radius);
 protected:
 	void InitResources(ID3D12Device5Ptr device) override;
 private:
 	ResourceGPU_CBV<uint> FilterRadius;
-	ID3D12DescriptorHeapPtr	CBVHeap;
 };
@@ -10,13 +10,13 @@ ClearPass::ClearPass(std::string&& name)
 	Register<PassOutput<ID3D12ResourcePtr>>("depthBuffer", DSVBuffer, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 }
 
-void ClearPass::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene)
+void ClearPass::Submit(CommandContext& cmdList, const Scene& scene)
 {
 	Bind(cmdList);
 	scene.Bind<ClearPass>(cmdList);
 }
 
-void ClearPass::Bind(ID3D12GraphicsCommandList4Ptr cmdList) const
+void ClearPass::Bind(CommandContext& cmdList) const
 {
 	RenderPass::Bind(cmdList);
 
@@ -6,9 +6,9 @@ class ClearPass final : public RenderPass
 {
 public:
 	ClearPass(std::string&& name);
-	void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) override;
+	void Submit(CommandContext& cmdList, const Scene& scene) override;
 protected:
-	void Bind(ID3D12GraphicsCommandList4Ptr cmdList) const override;
+	void Bind(CommandContext& cmdList) const override;
 	inline void InitResources(ID3D12Device5Ptr device) override {}
 	void InitRootSignature() override {}
 	void InitPipelineState() override {}
@@ -11,55 +11,34 @@ ForwardRenderPass::ForwardRenderPass(std::string&& name)
 	Register<PassOutput<ID3D12ResourcePtr>>("depthBuffer", DSVBuffer, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 }
 
-void ForwardRenderPass::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene)
+void ForwardRenderPass::Submit(CommandContext& cmdList, const Scene& scene)
 {
 	Bind(cmdList);
+	cmdList.SetGraphicsRootShaderResourceView(ActorsSlot, scene.GetActorBufferAddress());
+	scene.BindGeometry(cmdList);
 	scene.Bind<ForwardRenderPass>(cmdList);
 }
 
 void ForwardRenderPass::InitResources(ID3D12Device5Ptr device)
 {
-	Heaps.PushBack(Globals.SRVHeap);
-	Heaps.PushBack(Globals.UAVHeap);
-	Heaps.PushBack(Globals.CBVHeap);
-	Heaps.PushBack(Globals.SamplerHeap);
-	Heaps.PushBack(Globals.LightsHeap);
+	// In the order of the reflected layout - SRVs, CBVs by space, samplers
+	Tables.PushBack(Globals.SRVTable);
+	Tables.PushBack(Globals.CBVTable, 1);
+	Tables.PushBack(Globals.LightsTable, 1);
+	Tables.PushBack(Globals.SamplerTable);
 }
 
 void ForwardRenderPass::InitRootSignature()
 {
-	std::vector<D3D12_DESCRIPTOR_RANGE> srvRanges;
-	std::vector<D3D12_DESCRIPTOR_RANGE> cbvRanges;
+	RootSignatureLayout layout;
+	layout.Add(Globals.RootSignatures->Reflect(Shader<Vertex>("Shader").GetModule()), D3D12_SHADER_VISIBILITY_VERTEX);
+	layout.Add(Globals.RootSignatures->Reflect(Shader<Pixel>("Shader").GetModule()), D3D12_SHADER_VISIBILITY_PIXEL);
 
-	std::vector<D3D12_DESCRIPTOR_RANGE> uavRanges = {
-		DescriptorRangeBuilder::CreateRange(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 2, 0)
-	};
-
-	uint32_t userStart = NumGlobalSRVDescriptorRanges - NumUserDescriptorRanges;
-	for (uint32_t i = 0; i < NumGlobalSRVDescriptorRanges; ++i)
-	{
-		UINT registerSpace = (i >= userStart) ? (i - userStart) + 100 : i;
-		srvRanges.emplace_back(DescriptorRangeBuilder::CreateRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, registerSpace));
-	}
-
-	for (uint32_t i = 0; i < NumGlobalCBVDescriptorRanges; ++i)
-		cbvRanges.emplace_back(DescriptorRangeBuilder::CreateRange(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, UINT_MAX, 0, i));
-
-	std::vector<D3D12_DESCRIPTOR_RANGE> samplerRanges = {
-	DescriptorRangeBuilder::CreateRange(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, 1, 0)
-	};
-
-	std::vector<D3D12_DESCRIPTOR_RANGE> lightRanges = {
-	DescriptorRangeBuilder::CreateRange(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0, 100)
-	};
-
-	RootSignatureData.AddDescriptorTable(srvRanges);
-	RootSignatureData.AddDescriptorTable(uavRanges);
-	RootSignatureData.AddDescriptorTable(cbvRanges);
-	RootSignatureData.AddDescriptorTable(samplerRanges);
-	RootSignatureData.AddDescriptorTable(lightRanges);
-	RootSignatureData.AddDescriptor(D3D12_ROOT_PARAMETER_TYPE_CBV, D3D12_SHADER_VISIBILITY_ALL, 0, 200);
+	ASSERT(layout.GetTableCount() == Tables.GetCount(), "Forward pass binds a table the shaders do not use");
+	ASSERT(layout.GetSlot("actors") == ActorsSlot && layout.GetSlot("drawConstants") == ActorIndexSlot,
+		   "Actor bindings moved - update the root slots of the forward pass");
 
+	RootSignatureData.AddParameters(layout);
 	RootSignatureData.Build(Device);
 }
 
@@ -68,21 +47,15 @@ void ForwardRenderPass::InitPipelineState()
 	Shader<Vertex> vertexShader("Shader");
 	Shader<Pixel> pixelShader("Shader");
 
-	BufferLayout layout{ {"POSITION", DataType::float3},
-						{"NORMAL", DataType::float3},
-						{"TANGENT", DataType::float3},
-						{"BITANGENT", DataType::float3},
-						{"TEXCOORD", DataType::float2}, };
-
 	CD3DX12_RASTERIZER_DESC rasterizerDesc(D3D12_DEFAULT);
 	rasterizerDesc.CullMode = D3D12_CULL_MODE_NONE;  // No culling
 
 	// Describe and create the graphics pipeline state object (PSO).
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-	psoDesc.InputLayout = layout;
+	psoDesc.InputLayout = PackedVertex::GetLayout();
 	psoDesc.pRootSignature = RootSignatureData.RootSignaturePtr.GetInterfacePtr();
-	psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.GetBlob());
-	psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.GetBlob());
+	psoDesc.VS = vertexShader.GetBytecode();
+	psoDesc.PS = pixelShader.GetBytecode();
 	psoDesc.RasterizerState = rasterizerDesc;
 	psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
 	psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
@@ -93,5 +66,5 @@ void ForwardRenderPass::InitPipelineState()
 	psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
 	psoDesc.SampleDesc.Count = 1;
 
-	GRAPHICS_ASSERT(Device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&PipelineState)));
+	CreatePipelineState(psoDesc);
 }
\ No newline at end of file
@@ -5,7 +5,11 @@ class ForwardRenderPass final : public RenderPass
 {
 public:
 	ForwardRenderPass(std::string&& name);
-	void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) override;
+	void Submit(CommandContext& cmdList, const Scene& scene) override;
+
+	// Root SRV of the scene's actor buffer and the root constant indexing it per draw - after the four tables
+	static constexpr UINT ActorsSlot = 4;
+	static constexpr UINT ActorIndexSlot = 5;
 protected:
 	void InitResources(ID3D12Device5Ptr device) override;
 	void InitRootSignature() override;
@@ -4,12 +4,14 @@
 GUIPass::GUIPass(std::string&& name)
 	:RenderPass(std::move(name))
 {
+	Register<PassInput<ID3D12ResourcePtr>>("renderTarget", RTVBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
 	Register<PassInput<ID3D12ResourcePtr>>("positions", Positions, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassInput<ID3D12ResourcePtr>>("normals", Normals, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassInput<ID3D12ResourcePtr>>("diffuse", Diffuse, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassInput<ID3D12ResourcePtr>>("specular", Specular, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassInput<ID3D12ResourcePtr>>("ambientOcclusion", AmbientOcclusion, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 
+	Register<PassOutput<ID3D12ResourcePtr>>("renderTarget", RTVBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
 	Register<PassOutput<ID3D12ResourcePtr>>("positions", Positions, D3D12_RESOURCE_STATE_RENDER_TARGET);
 	Register<PassOutput<ID3D12ResourcePtr>>("normals", Normals, D3D12_RESOURCE_STATE_RENDER_TARGET);
 	Register<PassOutput<ID3D12ResourcePtr>>("diffuse", Diffuse, D3D12_RESOURCE_STATE_RENDER_TARGET);
@@ -22,7 +24,7 @@ GUIPass::~GUIPass()
 	Layer->OnDetach();
 }
 
-void GUIPass::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene)
+void GUIPass::Submit(CommandContext& cmdList, const Scene& scene)
 {
 	Layer->Begin();
 	Bind(cmdList);
@@ -43,8 +45,8 @@ void GUIPass::InitResources(ID3D12Device5Ptr device)
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
-	SRVHeap = D3D::CreateDescriptorHeap(device, 5, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, false);
-	auto srvHandle = SRVHeap->GetCPUDescriptorHandleForHeapStart();
+	SRVTable = Globals.Descriptors->Allocate(static_cast<uint32_t>(GPUHandlesGBuffers.size()));
+	auto srvHandle = SRVTable.GetCPUHandle();
 
 	auto desc = (*Positions)->GetDesc();
 	srvDesc.Format = desc.Format;
@@ -70,15 +72,11 @@ void GUIPass::InitResources(ID3D12Device5Ptr device)
 	srvDesc.Format = desc.Format;
 	device->CreateShaderResourceView(*AmbientOcclusion, &srvDesc, srvHandle);
 
-	Layer = MakeUnique<ImGuiLayer>(SRVHeap);
+	Layer = MakeUnique<ImGuiLayer>();
 	Layer->OnAttach(Device);
 
-	auto handle = Layer->DescriptorHeap->GetGPUDescriptorHandleForHeapStart();
 	for (UINT i = 0; i < GPUHandlesGBuffers.size(); i++)
-	{
-		handle.ptr += device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-		GPUHandlesGBuffers[i] = handle;
-	}
+		GPUHandlesGBuffers[i] = SRVTable.GetGPUHandle(i);
 }
 
 void GUIPass::GBuffersViewerWindow() const
@@ -7,7 +7,9 @@ class GUIPass final : public RenderPass
 public:
 	GUIPass(std::string&& name);
 	~GUIPass();
-	void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) override;
+	void Submit(CommandContext& cmdList, const Scene& scene) override;
+	// ImGui is not thread-safe and its widgets edit the settings other passes read
+	bool RequiresMainThread() const override { return true; }
 protected:
 	void InitResources(ID3D12Device5Ptr device) override;
 	void InitRootSignature() override {}
@@ -25,7 +27,7 @@ private:
 
 	SharedPtr<ID3D12ResourcePtr> AmbientOcclusion;
 
-	ID3D12DescriptorHeapPtr SRVHeap{};
+	DescriptorTable SRVTable{};
 	std::array<D3D12_GPU_DESCRIPTOR_HANDLE, 5> GPUHandlesGBuffers;
 };
 
@@ -6,7 +6,16 @@ class GeometryPass final : public RenderPass
 {
 public:
 	GeometryPass(std::string&& name);
-	void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) override;
+	void Submit(CommandContext& cmdList, const Scene& scene) override;
+	size_t GetRecordingChunks(const Scene& scene, size_t threadCount) const override;
+	void SubmitChunk(CommandContext& cmdList, const Scene& scene, size_t chunk, size_t chunkCount) override;
+	bool RecordsInChunks() const override { return true; }
+
+	// Below this many actors per chunk the cost of another command list outweighs the parallel recording
+	static constexpr size_t MinActorsPerChunk = 64;
+	// Root SRV of the scene's actor buffer and the root constant indexing it per draw
+	static constexpr UINT ActorsSlot = 3;
+	static constexpr UINT ActorIndexSlot = 4;
 protected:
 	void InitResources(ID3D12Device5Ptr device) override;
 	void InitRootSignature() override;
@@ -19,7 +28,6 @@ private:
 
 	// GBuffers
 	SharedPtr<ID3D12DescriptorHeapPtr> RTVHeap{}; // to be used in this pass as RTVs
-	SharedPtr<ID3D12DescriptorHeapPtr> SRVHeap{}; // to be used in lighting pass as SRVs
-	SharedPtr<ID3D12DescriptorHeapPtr> SRVHeapRO{}; // read only alternative of SRVHeap - to be used for GUI displaying
+	SharedPtr<DescriptorTable> SRVTable{}; // to be used in lighting pass as SRVs
 	std::array<D3D12_CPU_DESCRIPTOR_HANDLE, 4> RTVHandles{};
 };
\ No newline at end of file
@@ -10,41 +10,57 @@ LightingPass::LightingPass(std::string&& name)
 	Register<PassInput<ID3D12ResourcePtr>>("diffuse", Diffuse, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassInput<ID3D12ResourcePtr>>("specular", Specular, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassInput<ID3D12ResourcePtr>>("ambientOcclusion", AmbientOcclusion, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-	Register<PassInput<ID3D12DescriptorHeapPtr>>("srvHeap", GBufferHeap);
+	Register<PassInput<DescriptorTable>>("srvTable", GBufferTable);
 
-	Register<PassOutput<ID3D12ResourcePtr>>("renderTarget", RTVBuffer, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	Register<PassOutput<ID3D12ResourcePtr>>("renderTarget", RTVBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
 	Register<PassOutput<ID3D12ResourcePtr>>("positions", Positions, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassOutput<ID3D12ResourcePtr>>("normals", Normals, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassOutput<ID3D12ResourcePtr>>("diffuse", Diffuse, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassOutput<ID3D12ResourcePtr>>("specular", Specular, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	Register<PassOutput<ID3D12ResourcePtr>>("ambientOcclusion", AmbientOcclusion, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-	Register<PassOutput<ID3D12DescriptorHeapPtr>>("srvHeap", GBufferHeap);
+	Register<PassOutput<DescriptorTable>>("srvTable", GBufferTable);
+
+	D3D12_CLEAR_VALUE clearValue = {};
+	clearValue.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	clearValue.Color[0] = 1.0f;
+	clearValue.Color[1] = 1.0f;
+	clearValue.Color[2] = 1.0f;
+	clearValue.Color[3] = 1.0f;
+
+	auto resDesc = CD3DX12_RESOURCE_DESC(
+		D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+		D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+		Globals.WindowDimensions.x, Globals.WindowDimensions.y, 1, 1,
+		DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
+		1, 0,
+		D3D12_TEXTURE_LAYOUT_UNKNOWN, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+	RegisterTransient(RTVBuffer, resDesc, D3D12_RESOURCE_STATE_RENDER_TARGET, clearValue);
 }
 
-void LightingPass::Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene)
+void LightingPass::Submit(CommandContext& cmdList, const Scene& scene)
 {
 	Bind(cmdList);
 }
 
-void LightingPass::Bind(ID3D12GraphicsCommandList4Ptr cmdList) const
+void LightingPass::Bind(CommandContext& cmdList) const
 {
 	//RootSignatureData
-	cmdList->SetGraphicsRootSignature(RootSignatureData.RootSignaturePtr.GetInterfacePtr());
+	RootSignatureData.Bind(cmdList);
 
 	D3D12_VIEWPORT viewport = { 0.0f, 0.0f, (FLOAT)Globals.WindowDimensions.x, (FLOAT)Globals.WindowDimensions.y, 0.0f, 1.0f };
-	cmdList->RSSetViewports(1, &viewport);
+	cmdList.RSSetViewports(1, &viewport);
 
 	// Set scissor rect
 	D3D12_RECT scissorRect = { 0, 0, Globals.WindowDimensions.x, Globals.WindowDimensions.y };
-	cmdList->RSSetScissorRects(1, &scissorRect);
+	cmdList.RSSetScissorRects(1, &scissorRect);
 
 	const float clearColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
 	cmdList->ClearRenderTargetView(RTVHandle, clearColor, 0, nullptr);
-	cmdList->OMSetRenderTargets(1, &RTVHandle, FALSE, nullptr);
+	cmdList.OMSetRenderTargets(1, &RTVHandle, FALSE, nullptr);
 
-	Heaps.Bind(cmdList);
+	Tables.Bind(cmdList);
 
-	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	cmdList.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	cmdList->DrawInstanced(3, 1, 0, 0);
 }
 
@@ -58,35 +74,10 @@ void LightingPass::InitResources(ID3D12Device5Ptr device)
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
-	AOHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, true);
-	D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = AOHeap->GetCPUDescriptorHandleForHeapStart();
-	device->CreateShaderResourceView(*AmbientOcclusion, &srvDesc, srvHandle);
-
-	// Create Render Target
-	D3D12_CLEAR_VALUE clearValue = {};
-	clearValue.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-	clearValue.Color[0] = 1.0f;
-	clearValue.Color[1] = 1.0f;
-	clearValue.Color[2] = 1.0f;
-	clearValue.Color[3] = 1.0f;
-
-	auto resDesc = CD3DX12_RESOURCE_DESC(
-		D3D12_RESOURCE_DIMENSION_TEXTURE2D,
-		D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
-		Globals.WindowDimensions.x, Globals.WindowDimensions.y, 1, 1,
-		DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
-		1, 0,
-		D3D12_TEXTURE_LAYOUT_UNKNOWN, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+	AOTable = Globals.Descriptors->Allocate(1);
+	device->CreateShaderResourceView(*AmbientOcclusion, &srvDesc, AOTable.GetCPUHandle());
 
-	ID3D12ResourcePtr renderTarget;
-	GRAPHICS_ASSERT(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-		D3D12_HEAP_FLAG_NONE,
-		&resDesc,
-		D3D12_RESOURCE_STATE_RENDER_TARGET,
-		&clearValue,
-		IID_PPV_ARGS(&renderTarget)));
-	RTVBuffer = MakeShared<ID3D12ResourcePtr>(renderTarget);
+	// Render target is placed by the render graph
 
 	// RTV Heap
 	auto rtvHeap = D3D::CreateDescriptorHeap(device, 1, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, false);
@@ -95,11 +86,11 @@ void LightingPass::InitResources(ID3D12Device5Ptr device)
 	RTVHandle = rtvHeap->GetCPUDescriptorHandleForHeapStart();
 	device->CreateRenderTargetView(*RTVBuffer, nullptr, RTVHandle);
 
-	Heaps.PushBack(*GBufferHeap);
-	Heaps.PushBack(AOHeap);
-	Heaps.PushBack(Globals.SamplerHeap);
-	Heaps.PushBack(Globals.LightsHeap);
-	Heaps.PushBack(Globals.CBVHeap);
+	Tables.PushBack(*GBufferTable);
+	Tables.PushBack(AOTable);
+	Tables.PushBack(Globals.SamplerTable);
+	Tables.PushBack(Globals.LightsTable, 1);
+	Tables.PushBack(Globals.CBVTable, 1);
 }
 
 void LightingPass::InitRootSignature()
@@ -121,9 +112,10 @@ void LightingPass::InitRootSignature()
 	DescriptorRangeBuilder::CreateRange(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0, 100)
 	};
 
-	std::vector<D3D12_DESCRIPTOR_RANGE> cbvRanges;
-	for (uint32_t i = 0; i < NumGlobalCBVDescriptorRanges; ++i)
-		cbvRanges.emplace_back(DescriptorRangeBuilder::CreateRange(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, UINT_MAX, 0, i));
+	// glConstants[] is the only CBV array the shader declares
+	std::vector<D3D12_DESCRIPTOR_RANGE> cbvRanges = {
+		DescriptorRangeBuilder::CreateRange(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, UINT_MAX, 0, 0)
+	};
 
 	RootSignatureData.AddDescriptorTable(samplerRanges, D3D12_SHADER_VISIBILITY_PIXEL);
 	RootSignatureData.AddDescriptorTable(lightRanges, D3D12_SHADER_VISIBILITY_PIXEL);
@@ -133,9 +125,24 @@ void LightingPass::InitRootSignature()
 }
 
 void LightingPass::InitPipelineState()
+{
+	Variants.Init([this](Features features) { return BuildPipelineState(features); }, GetFeatures());
+}
+
+ID3D12PipelineStatePtr LightingPass::GetPSO() const
+{
+	return Variants.Get(GetFeatures());
+}
+
+LightingPass::Features LightingPass::GetFeatures()
+{
+	return Features().Set<"SSAO">(Globals.CBGlobalConstants.CPUData.SSAOEnabled != 0);
+}
+
+ID3D12PipelineStatePtr LightingPass::BuildPipelineState(Features features) const
 {
 	Shader<Vertex> vertexShader("FullScreenTriangle");
-	Shader<Pixel> pixelShader("LightingPass");
+	Shader<Pixel> pixelShader("LightingPass", features.GetDefines());
 
 	D3D12_INPUT_LAYOUT_DESC layoutDesc{};
 	layoutDesc.pInputElementDescs = nullptr;
@@ -151,8 +158,8 @@ void LightingPass::InitPipelineState()
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
 	psoDesc.InputLayout = layoutDesc;
 	psoDesc.pRootSignature = RootSignatureData.RootSignaturePtr.GetInterfacePtr();
-	psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.GetBlob());
-	psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.GetBlob());
+	psoDesc.VS = vertexShader.GetBytecode();
+	psoDesc.PS = pixelShader.GetBytecode();
 	psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
 	psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
 	psoDesc.DepthStencilState = depthStencilDesc;
@@ -163,5 +170,5 @@ void LightingPass::InitPipelineState()
 	psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
 	psoDesc.SampleDesc.Count = 1;
 
-	GRAPHICS_ASSERT(Device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&PipelineState)));
+	return Globals.Pipelines->GetGraphics(psoDesc, RootSignatureData.Hash);
 }
\ No newline at end of file
@@ -1,25 +1,34 @@
 #pragma once
 #include "RenderPass.h"
+#include "Rendering/ShaderPermutations.h"
 
 class LightingPass final : public RenderPass
 {
 public:
 	LightingPass(std::string&& name);
-	void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) override;
+	void Submit(CommandContext& cmdList, const Scene& scene) override;
+	ID3D12PipelineStatePtr GetPSO() const override;
 protected:
-	void Bind(ID3D12GraphicsCommandList4Ptr cmdList) const override;
+	void Bind(CommandContext& cmdList) const override;
 	void InitResources(ID3D12Device5Ptr device) override;
 	void InitRootSignature() override;
 	void InitPipelineState() override;
 private:
+	// SSAO is compiled in instead of branching on SSAOEnabled per pixel
+	using Features = PermutationKey<"SSAO">;
+	static Features GetFeatures();
+	ID3D12PipelineStatePtr BuildPipelineState(Features features) const;
+
+	PipelineVariants<Features> Variants;
+
 	SharedPtr<ID3D12ResourcePtr> Positions;
 	SharedPtr<ID3D12ResourcePtr> Normals;
 	SharedPtr<ID3D12ResourcePtr> Diffuse;
 	SharedPtr<ID3D12ResourcePtr> Specular;
 	SharedPtr<ID3D12ResourcePtr> AmbientOcclusion;
 
-	SharedPtr<ID3D12DescriptorHeapPtr> GBufferHeap{};
-	ID3D12DescriptorHeapPtr AOHeap;
+	SharedPtr<DescriptorTable> GBufferTable{};
+	DescriptorTable AOTable;
 
 	SharedPtr<ID3D12DescriptorHeapPtr> RTVHeap{};
 	D3D12_CPU_DESCRIPTOR_HANDLE RTVHandle{};
@@ -5,6 +5,7 @@
 #include "Rendering/Utils.h"
 
 #include <algorithm>
+#include <iostream>
 
 static auto isValidName = [](const std::string& name)
 	{
@@ -45,33 +46,67 @@ RenderPass::RenderPass(std::string&& name)
 	:Name(name), RTVBuffer(MakeShared<ID3D12ResourcePtr>()), DSVBuffer(MakeShared<ID3D12ResourcePtr>())
 {}
 
-void RenderPass::Init(ID3D12Device5Ptr device)
+void RenderPass::LinkResources(ID3D12Device5Ptr device)
 {
 	Device = device;
 	InitResources(device);
+}
+
+void RenderPass::BuildPipeline()
+{
 	InitRootSignature();
+
+	ShaderDependencyScope dependencies(ShaderFiles);
 	InitPipelineState();
 }
 
-void RenderPass::Bind(ID3D12GraphicsCommandList4Ptr cmdList) const
+bool RenderPass::RebuildPipelineState()
+{
+	auto files = ShaderFiles;
+	try
+	{
+		ShaderDependencyScope dependencies(ShaderFiles);
+		InitPipelineState();
+		return true;
+	}
+	catch (const std::exception& e)
+	{
+		// A shader that does not compile into a pipeline - keep rendering with the old one
+		std::cerr << "Reloading " << Name << " failed: " << e.what() << std::endl;
+		ShaderFiles = std::move(files);
+		return false;
+	}
+}
+
+void RenderPass::Bind(CommandContext& cmdList) const
 {
 	//RootSignatureData
-	cmdList->SetGraphicsRootSignature(RootSignatureData.RootSignaturePtr.GetInterfacePtr());
+	RootSignatureData.Bind(cmdList);
 
 	D3D12_VIEWPORT viewport = { 0.0f, 0.0f, (FLOAT)Globals.WindowDimensions.x, (FLOAT)Globals.WindowDimensions.y, 0.0f, 1.0f };
-	cmdList->RSSetViewports(1, &viewport);
+	cmdList.RSSetViewports(1, &viewport);
 
 	// Set scissor rect
 	D3D12_RECT scissorRect = { 0, 0, Globals.WindowDimensions.x, Globals.WindowDimensions.y };
-	cmdList->RSSetScissorRects(1, &scissorRect);
-	cmdList->OMSetRenderTargets(1, &Globals.RTVHandle, FALSE, &Globals.DSVHandle);
+	cmdList.RSSetScissorRects(1, &scissorRect);
+	cmdList.OMSetRenderTargets(1, &Globals.RTVHandle, FALSE, &Globals.DSVHandle);
 
-	Heaps.Bind(cmdList);
+	Tables.Bind(cmdList);
 }
 
 void RenderPass::InitResources(ID3D12Device5Ptr device) 
 {}
 
+void RenderPass::CreatePipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+	PipelineState = Globals.Pipelines->GetGraphics(desc, RootSignatureData.Hash);
+}
+
+void RenderPass::CreatePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc)
+{
+	PipelineState = Globals.Pipelines->GetCompute(desc, RootSignatureData.Hash);
+}
+
 PassInputBase& RenderPass::GetInput(const std::string& name) const
 {
 	for (auto& in : Inputs)
@@ -109,31 +144,6 @@ void RenderPass::Validate()
 		out->Validate();
 }
 
-std::vector<UniquePtr<TransitionBase>> RenderPass::GetInverseTransitions(const TransitionsArray& transitions)
-{
-	std::vector<UniquePtr<TransitionBase>> extraTransitions;
-
-	for (const auto& input : Inputs)
-	{
-		auto it = std::find_if(Outputs.begin(), Outputs.end(), [&input](UniquePtr<PassOutputBase>& output)
-				  {
-					  return input->GetRscPtr() == output->GetRscPtr();
-				  }
-		);
-
-		if (it == Outputs.end()) continue;
-
-		if (input->GetResourceState() == (*it)->GetResourceState()) continue;
-
-		auto& ptr = input->BuildTransition(input->GetResourceState(), (*it)->GetResourceState());
-		if (!ptr.has_value()) continue;
-
-		extraTransitions.emplace_back( std::move(ptr.value()));
-	}
-
-	return extraTransitions;
-}
-
 void RenderPass::Register(UniquePtr<PassInputBase> input)
 {
 	auto it = std::find_if(Inputs.begin(), Inputs.end(),
@@ -156,4 +166,14 @@ void RenderPass::Register(UniquePtr<PassOutputBase> output)
 
 	if (it != Outputs.end()) throw std::invalid_argument("Registered output in conflict with existing registered input");
 	Outputs.emplace_back(std::move(output));
+}
+
+void RenderPass::RegisterTransient(SharedPtr<ID3D12ResourcePtr>& resource,
+								   const D3D12_RESOURCE_DESC& desc,
+								   D3D12_RESOURCE_STATES initialState,
+								   std::optional<D3D12_CLEAR_VALUE> clearValue)
+{
+	// Inputs of later passes share the pointed-to object, so it has to exist before linking
+	if (!resource) resource = MakeShared<ID3D12ResourcePtr>();
+	Transients.push_back({ resource, desc, initialState, clearValue });
 }
\ No newline at end of file
@@ -4,12 +4,22 @@
 #include "Core/Layer.h"
 #include "Rendering/RootSignature.h"
 #include "Rendering/Resources.h"
+#include "Rendering/QueueSchedule.h"
 
 #include <optional>
 
 class PassOutputBase;
 class Scene;
 
+// Pass-owned texture the graph places in its shared transient heap once every lifetime is known
+struct TransientResourceDesc
+{
+	SharedPtr<ID3D12ResourcePtr> Resource;
+	D3D12_RESOURCE_DESC Desc{};
+	D3D12_RESOURCE_STATES InitialState{};
+	std::optional<D3D12_CLEAR_VALUE> ClearValue;
+};
+
 class PassInputBase
 {
 public:
@@ -24,9 +34,9 @@ public:
 
 	virtual void Bind(PassOutputBase& out) = 0;
 	virtual void Validate() const = 0;
-	virtual std::optional<UniquePtr<TransitionBase>> GetResourceTransition(D3D12_RESOURCE_STATES prev) const = 0;
 	virtual const void* const GetRscPtr() const = 0;
-	virtual std::optional<UniquePtr<TransitionBase>> BuildTransition(D3D12_RESOURCE_STATES prev, D3D12_RESOURCE_STATES next) const = 0;
+	// Resource barriers are recorded against - nullptr for inputs that need none (descriptor heaps)
+	virtual ID3D12ResourcePtr* GetBarrierResource() const = 0;
 
 protected:
 	PassInputBase(std::string&& name, D3D12_RESOURCE_STATES state);
@@ -49,7 +59,7 @@ public:
 		:PassInputBase(std::move(name), state), Resource(resource)
 	{}
 
-	PassInput(std::string&& name, SharedPtr<T>& resource) requires (std::is_base_of_v<ID3D12DescriptorHeapPtr, T>)
+	PassInput(std::string&& name, SharedPtr<T>& resource) requires (std::is_base_of_v<ID3D12DescriptorHeapPtr, T> || std::is_same_v<T, DescriptorTable>)
 		: PassInputBase(std::move(name), (D3D12_RESOURCE_STATES)0), Resource(resource)
 	{}
 
@@ -71,36 +81,14 @@ public:
 
 	inline const D3D12_RESOURCE_STATES GetResourceState() const { return State; }
 
-	virtual std::optional<UniquePtr<TransitionBase>> GetResourceTransition(D3D12_RESOURCE_STATES prev) const override
-	{
-		return GetResourceTransitionImpl(prev);
-	}
-
-	virtual std::optional<UniquePtr<TransitionBase>> BuildTransition(D3D12_RESOURCE_STATES prev, D3D12_RESOURCE_STATES next) const override
-	{
-		return BuildTransitionImpl(prev, next);
-	}
-
 	const void* const GetRscPtr() const override { return reinterpret_cast<void*>(Resource.get()); }
 
-
-private:
-	template <typename U = T>
-	std::optional<UniquePtr<TransitionBase>> GetResourceTransitionImpl(D3D12_RESOURCE_STATES prev) const
-	{
-		if constexpr (std::is_base_of_v<ID3D12DescriptorHeapPtr, U>)
-			return std::nullopt;
-		else
-			return MakeUnique<Transition<U>>(Resource, prev, State);
-	}
-
-	template <typename U = T>
-	std::optional<UniquePtr<TransitionBase>> BuildTransitionImpl(D3D12_RESOURCE_STATES prev, D3D12_RESOURCE_STATES next) const
+	ID3D12ResourcePtr* GetBarrierResource() const override
 	{
-		if constexpr (std::is_base_of_v<ID3D12DescriptorHeapPtr, U>)
-			return std::nullopt;
+		if constexpr (std::is_same_v<T, ID3D12ResourcePtr>)
+			return Resource.get();
 		else
-			return MakeUnique<Transition<U>>(Resource, prev, next);
+			return nullptr;
 	}
 
 private:
@@ -136,7 +124,7 @@ public:
 		:PassOutputBase(std::move(name), state), Resource(resource)
 	{}
 
-	PassOutput(std::string&& name, SharedPtr<T>& resource) requires(std::is_base_of_v<ID3D12DescriptorHeapPtr, T>)
+	PassOutput(std::string&& name, SharedPtr<T>& resource) requires(std::is_base_of_v<ID3D12DescriptorHeapPtr, T> || std::is_same_v<T, DescriptorTable>)
 		: PassOutputBase(std::move(name), (D3D12_RESOURCE_STATES)0), Resource(resource)
 	{}
 
@@ -160,20 +148,40 @@ private:
 
 class RenderPass
 {
-	using TransitionsArray = std::vector<UniquePtr<TransitionBase>>;
-
 public:
 	RenderPass(std::string&& name);
 	virtual ~RenderPass() = default;
 	
-	void Init(ID3D12Device5Ptr device);
+	// Startup runs in two phases. LinkResources goes in dependency order - consumers make views of what their
+	// producers created. BuildPipeline only makes the root signature and PSO and may run on any thread
+	void LinkResources(ID3D12Device5Ptr device);
+	void BuildPipeline();
+	// Hot reload - remakes the PSO from the current shader modules, the root signature is kept.
+	// The GPU must be done with the old PSO. Returns false and keeps the old PSO when the build fails
+	bool RebuildPipelineState();
+	// Shader files read while the pipeline was last built
+	inline const std::vector<std::string>& GetShaderFiles() const { return ShaderFiles; }
 	// Submit Render Pass commands to cmdList - Does not include cmdList execution
-	virtual void Submit(ID3D12GraphicsCommandList4Ptr cmdList, const Scene& scene) = 0;
-
-	inline ID3D12PipelineStatePtr GetPSO() { return PipelineState; }
+	virtual void Submit(CommandContext& cmdList, const Scene& scene) = 0;
+
+	// Parallel recording - a pass may split its commands over several command lists, recorded on
+	// different threads and executed in chunk order. Chunk 0 also records the pass's one-off work (clears)
+	virtual size_t GetRecordingChunks(const Scene& scene, size_t threadCount) const { return 1; }
+	virtual void SubmitChunk(CommandContext& cmdList, const Scene& scene, size_t chunk, size_t chunkCount) { Submit(cmdList, scene); }
+	// Passes that may return more than one chunk - the others share command lists with their neighbours
+	virtual bool RecordsInChunks() const { return false; }
+	// Passes touching state that is not thread-safe are recorded on the thread executing the graph
+	virtual bool RequiresMainThread() const { return false; }
+	// Queue the pass runs on when the graph records in parallel
+	virtual QueueType GetQueueAffinity() const { return QueueType::Graphics; }
+
+	// Called by the recording threads - passes with feature variants pick theirs here
+	virtual ID3D12PipelineStatePtr GetPSO() const { return PipelineState; }
+	inline const RootSignature& GetRootSignature() const { return RootSignatureData; }
 	inline const std::string& GetName() const noexcept { return Name; }
 	inline const std::vector<UniquePtr<PassInputBase>>& GetInputs() const { return Inputs; }
 	inline const std::vector<UniquePtr<PassOutputBase>>& GetOutputs() const { return Outputs; }
+	inline const std::vector<TransientResourceDesc>& GetTransients() const { return Transients; }
 
 	PassInputBase& GetInput(const std::string& name) const;
 	PassOutputBase& GetOutput(const std::string& name) const;
@@ -181,18 +189,26 @@ public:
 	void SetInput(const std::string& inputName, const std::string& targetName);
 	virtual void Validate();
 
-	// For resources that are not propagated further they must be transitioned back to where they were
-	// to be in proper state for the next frame iteration through the graph
-	std::vector<UniquePtr<TransitionBase>> GetInverseTransitions(const TransitionsArray& transitions);
+	// Feature switch evaluated by the graph compiler - disabled passes are culled from the frame
+	inline void SetCondition(std::function<bool()> condition) { Condition = std::move(condition); }
+	inline bool IsEnabled() const { return !Condition || Condition(); }
 
 protected:
-	virtual void Bind(ID3D12GraphicsCommandList4Ptr cmdList) const;
+	virtual void Bind(CommandContext& cmdList) const;
 	virtual void InitResources(ID3D12Device5Ptr device);
 	virtual void InitRootSignature() = 0;
 	virtual void InitPipelineState() = 0;
+	// Sets PipelineState from Globals.Pipelines - compiled only when no identical pipeline exists
+	void CreatePipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+	void CreatePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc);
 
 	void Register(UniquePtr<PassInputBase> input);
 	void Register(UniquePtr<PassOutputBase> output);
+	// The resource is created by the graph before InitResources runs, so views can be made there as usual
+	void RegisterTransient(SharedPtr<ID3D12ResourcePtr>& resource,
+						   const D3D12_RESOURCE_DESC& desc,
+						   D3D12_RESOURCE_STATES initialState,
+						   std::optional<D3D12_CLEAR_VALUE> clearValue = std::nullopt);
 
 	template<typename T, typename... Args>
 		requires std::is_constructible_v<T, Args...>
@@ -208,11 +224,16 @@ protected:
 
 	ID3D12PipelineStatePtr PipelineState;
 	RootSignature RootSignatureData;
-	DescriptorHeapComposite Heaps;
+	DescriptorTableSet Tables;
 
 	SharedPtr<ID3D12ResourcePtr> RTVBuffer{};
 	SharedPtr<ID3D12ResourcePtr> DSVBuffer{};
 
 	std::vector<UniquePtr<PassInputBase>> Inputs;
 	std::vector<UniquePtr<PassOutputBase>> Outputs;
+	std::vector<TransientResourceDesc> Transients;
+	std::vector<std::string> ShaderFiles;
+
+private:
+	std::function<bool()> Condition;
 };
\ No newline at end of file
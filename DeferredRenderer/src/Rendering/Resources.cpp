@@ -1,4 +1,5 @@
 #include "Resources.h"
+#include "Core/Exception.h"
 
 GlobalResources Globals{};
 
@@ -19,33 +20,27 @@ void GlobalResManager::SetCmdAllocator(ID3D12CommandAllocatorPtr cmdAllocator)
 	Globals.CmdAllocator = cmdAllocator;
 }
 
-void DescriptorHeapComposite::Bind(ID3D12GraphicsCommandList4Ptr cmdList) const
+void DescriptorTableSet::Bind(CommandContext& cmdList) const
 {
-	UINT rootParameterIndex = 0;
-	for (const auto& heap : Heaps)
-	{
-		BindDescriptorHeap(cmdList, heap);
-		cmdList->SetGraphicsRootDescriptorTable(rootParameterIndex++, heap->GetGPUDescriptorHandleForHeapStart());
-	}
+	for (UINT i = 0; i < Tables.size(); i++)
+		cmdList.SetGraphicsRootDescriptorTable(i, GetTableStart(i));
 }
 
-void DescriptorHeapComposite::BindCompute(ID3D12GraphicsCommandList4Ptr cmdList) const
+void DescriptorTableSet::BindCompute(CommandContext& cmdList) const
 {
-	UINT rootParameterIndex = 0;
-	for (const auto& heap : Heaps)
-	{
-		BindDescriptorHeap(cmdList, heap);
-		cmdList->SetComputeRootDescriptorTable(rootParameterIndex++, heap->GetGPUDescriptorHandleForHeapStart());
-	}
+	for (UINT i = 0; i < Tables.size(); i++)
+		cmdList.SetComputeRootDescriptorTable(i, GetTableStart(i));
 }
 
-void DescriptorHeapComposite::PushBack(ID3D12DescriptorHeapPtr heap)
+void DescriptorTableSet::PushBack(const DescriptorTable& table, UINT frameStride)
 {
-	Heaps.push_back(heap);
+	ASSERT(table.Count, "Pushing an unallocated descriptor table");
+
+	Tables.push_back(table);
+	FrameStrides.push_back(frameStride);
 }
 
-void DescriptorHeapComposite::BindDescriptorHeap(ID3D12GraphicsCommandList4Ptr cmdList, ID3D12DescriptorHeapPtr heap) const
+D3D12_GPU_DESCRIPTOR_HANDLE DescriptorTableSet::GetTableStart(size_t index) const
 {
-	std::array<ID3D12DescriptorHeap*, 1> heaps = { heap };
-	cmdList->SetDescriptorHeaps(heaps.size(), heaps.data());
+	return Tables[index].GetGPUHandle(Globals.FrameIndex * FrameStrides[index]);
 }
@@ -1,6 +1,14 @@
 ﻿#pragma once
 #include "Core/Core.h"
 #include "Buffer.h"
+#include "CommandContext.h"
+#include "DescriptorHeaps.h"
+#include "GpuAllocator.h"
+#include "D3D12PipelineCache.h"
+#include "RootSignature.h"
+#include "ShaderCache.h"
+#include "ShaderCompiler.h"
+#include "UploadService.h"
 #include "Shaders/HLSLCompat.h"
 
 #include <type_traits>
@@ -15,8 +23,9 @@ inline constexpr bool is_com_ptr_v = false;
 template <typename T>
 inline constexpr bool is_com_ptr_v<_com_ptr_t<T>> = true;
 
+// Tables of the global descriptor heaps travel between passes like resources
 template <typename T>
-concept ResourceType = is_com_ptr_v<T>;
+concept ResourceType = is_com_ptr_v<T> || std::is_same_v<T, DescriptorTable>;
 
 template <typename T>
 concept HasGetGPUVirtualAddress =
@@ -39,12 +48,14 @@ using is_base_of_template = typename is_base_of_template_impl<base, derived>::ty
 
 struct GlobalResources
 {
-	ID3D12DescriptorHeapPtr SRVHeap{};
-	ID3D12DescriptorHeapPtr UAVHeap{};
-	ID3D12DescriptorHeapPtr CBVHeap{};
-	ID3D12DescriptorHeapPtr SamplerHeap{};
-	ID3D12DescriptorHeapPtr LightsHeap{};
-	ConstantBuffer<PipelineConstants> CBGlobalConstants{};
+	// Every shader-visible descriptor lives in these heaps, bound once per command list
+	UniquePtr<GlobalDescriptorHeaps> Descriptors{};
+	DescriptorTable SRVTable{};
+	DescriptorTable UAVTable{};
+	DescriptorTable CBVTable{};
+	DescriptorTable SamplerTable{};
+	DescriptorTable LightsTable{};
+	FrameConstantBuffer<PipelineConstants> CBGlobalConstants{};
 
 	ID3D12ResourcePtr RTVBuffer{};
 	ID3D12ResourcePtr DSVBuffer{};
@@ -57,10 +68,32 @@ struct GlobalResources
 	ID3D12GraphicsCommandList4Ptr CmdList{};
 
 	glm::uvec2 WindowDimensions{1920, 1080};
+	// Frame slot currently being recorded [0, DefaultSwapChainBuffers)
+	uint32_t FrameIndex = 0;
 
 	ID3D12FencePtr Fence{};
 	HANDLE FenceEvent{};
 	uint64_t FenceValue = 0;
+
+	// Async compute - passes with compute affinity run here when the graph records in parallel
+	ID3D12CommandQueuePtr ComputeQueue{};
+	ID3D12FencePtr ComputeFence{};
+	uint64_t ComputeFenceValue = 0;
+
+	// Places every long-lived resource in shared heaps
+	UniquePtr<GpuAllocator> Allocator{};
+	// Per-frame constants - a segment per frame slot, reset once the slot's frame finished
+	UniquePtr<FrameUploadAllocator> FrameUploads{};
+	// Copy queue for static resource data - the graphics queue waits for its fence before the first frame
+	UniquePtr<UploadService> Uploads{};
+	// Every PSO, deduplicated and persisted in a pipeline library between runs
+	UniquePtr<D3D12PipelineCache> Pipelines{};
+	// Compiled shader modules shared by every pass, watched for changes in debug builds
+	UniquePtr<ShaderCache> Shaders{};
+	// Feature variants compiled from source with DXC, plus the thread building unused ones
+	UniquePtr<ShaderVariantCache> ShaderVariants{};
+	// Root signatures shared by passes with identical layouts, and the shader reflection deriving them
+	UniquePtr<RootSignatureCache> RootSignatures{};
 };
 
 extern GlobalResources Globals;
@@ -73,47 +106,12 @@ namespace GlobalResManager
 	void SetCmdAllocator(ID3D12CommandAllocatorPtr cmdAllocator);
 }
 
-struct TransitionBase
-{
-	virtual ~TransitionBase() = default;
-	virtual void Apply(ID3D12GraphicsCommandList4Ptr cmdList) = 0;
-
-	virtual const void* const GetResource() const = 0;
-	virtual D3D12_RESOURCE_STATES GetPrevious() const = 0;
-	virtual D3D12_RESOURCE_STATES GetNext() const = 0;
-};
-
-template<ResourceType T>
-struct Transition : public TransitionBase
-{
-	Transition(SharedPtr<T>& resource, D3D12_RESOURCE_STATES previous, D3D12_RESOURCE_STATES next)
-		:Resource(resource), Previous(previous), Next(next)
-	{}
-
-	void Apply(ID3D12GraphicsCommandList4Ptr cmdList) override
-	{
-		cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			*Resource,
-			Previous,
-			Next
-		));
-	}
-
-	const void* const GetResource() const { return reinterpret_cast<void*>(Resource.get()); }
-	D3D12_RESOURCE_STATES GetPrevious() const { return Previous; }
-	D3D12_RESOURCE_STATES GetNext() const { return Next; }
-
-	SharedPtr<T>& Resource;
-	D3D12_RESOURCE_STATES Previous{};
-	D3D12_RESOURCE_STATES Next{};
-};
-
 // To be used by actors to bind non-global variables to PSOs of the appropriate Render Pass
 struct ResourceGPUBase
 {
 	virtual ~ResourceGPUBase() = default;
-	virtual void Bind(ID3D12GraphicsCommandList4Ptr cmdList, UINT slot) const = 0;
-	virtual void BindCompute(ID3D12GraphicsCommandList4Ptr cmdList, UINT slot) const = 0;
+	virtual void Bind(CommandContext& cmdList, UINT slot) const = 0;
+	virtual void BindCompute(CommandContext& cmdList, UINT slot) const = 0;
 };
 
 template<typename T>
@@ -135,35 +133,44 @@ struct ResourceGPU : public ResourceGPUBase
 };
 
 template<typename T>
-requires is_base_of_template<ConstantBuffer, T>::value
+requires is_base_of_template<ConstantBuffer, T>::value || is_base_of_template<FrameConstantBuffer, T>::value
 struct ResourceGPU_ConstantBufferView : public ResourceGPU<T>
 {
 	using ResourceGPU::ResourceGPU;
-	virtual void Bind(ID3D12GraphicsCommandList4Ptr cmdList, UINT slot) const override
+	virtual void Bind(CommandContext& cmdList, UINT slot) const override
 	{
-		cmdList->SetGraphicsRootConstantBufferView(slot, GetGPUVirtualAddress());
+		cmdList.SetGraphicsRootConstantBufferView(slot, GetGPUVirtualAddress());
 	}
 
-	virtual void BindCompute(ID3D12GraphicsCommandList4Ptr cmdList, UINT slot) const override
+	virtual void BindCompute(CommandContext& cmdList, UINT slot) const override
 	{
-		cmdList->SetComputeRootConstantBufferView(slot, GetGPUVirtualAddress());
+		cmdList.SetComputeRootConstantBufferView(slot, GetGPUVirtualAddress());
 	}
 };
 
 template<typename T>
 using ResourceGPU_CBV = ResourceGPU_ConstantBufferView<ConstantBuffer<T>>;
 
-struct DescriptorHeapComposite
+template<typename T>
+using ResourceGPU_FrameCBV = ResourceGPU_ConstantBufferView<FrameConstantBuffer<T>>;
+
+// Root descriptor tables of a pass, table i is bound to root parameter i.
+// The global heaps are already set on the list, binding only sets the tables
+struct DescriptorTableSet
 {
 public:
-	virtual ~DescriptorHeapComposite() = default;
-	void Bind(ID3D12GraphicsCommandList4Ptr cmdList) const;
-	void BindCompute(ID3D12GraphicsCommandList4Ptr cmdList) const;
-	void PushBack(ID3D12DescriptorHeapPtr heap);
+	virtual ~DescriptorTableSet() = default;
+	void Bind(CommandContext& cmdList) const;
+	void BindCompute(CommandContext& cmdList) const;
+	// frameStride: descriptors between the per-frame copies of the table's descriptors.
+	// The table is bound at its start + Globals.FrameIndex * frameStride
+	void PushBack(const DescriptorTable& table, UINT frameStride = 0);
+	inline size_t GetCount() const { return Tables.size(); }
 
 private:
-	void BindDescriptorHeap(ID3D12GraphicsCommandList4Ptr cmdList, ID3D12DescriptorHeapPtr heap) const;
+	D3D12_GPU_DESCRIPTOR_HANDLE GetTableStart(size_t index) const;
 
 private:
-	std::vector<ID3D12DescriptorHeapPtr> Heaps;
+	std::vector<DescriptorTable> Tables;
+	std::vector<UINT> FrameStrides;
 };
\ No newline at end of file
@@ -1,8 +1,13 @@
 #include "RootSignature.h"
 #include "Core/Exception.h"
+#include "D3D12PipelineCache.h"
 #include "Resources.h"
 #include "Utils.h"
 
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
 RootSignature::RootSignature(ID3D12Device5Ptr device)
 {
 	D3D12_ROOT_SIGNATURE_DESC desc{};
@@ -31,6 +36,34 @@ void RootSignature::AddDescriptor(D3D12_ROOT_PARAMETER_TYPE rootParameterType, D
 	RootParameters.push_back(RootParameterBuilder::CreateDescriptor(rootParameterType, visibility, shaderRegister, registerSpace));
 }
 
+void RootSignature::AddConstants(UINT num32BitValues, D3D12_SHADER_VISIBILITY visibility, UINT shaderRegister, UINT registerSpace)
+{
+	RootParameters.push_back(RootParameterBuilder::CreateConstants(num32BitValues, visibility, shaderRegister, registerSpace));
+}
+
+void RootSignature::AddParameters(const RootSignatureLayout& layout)
+{
+	for (const auto& param : layout.GetParameters())
+	{
+		const ShaderBinding& binding = param.Binding;
+		switch (param.Type)
+		{
+		case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+		{
+			UINT count = binding.Count == 0 ? UINT_MAX : binding.Count;
+			AddDescriptorTable({ DescriptorRangeBuilder::CreateRange(binding.Type, count, binding.Register, binding.Space) }, param.Visibility);
+			break;
+		}
+		case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+			AddConstants((binding.ConstantsSize + 3) / 4, param.Visibility, binding.Register, binding.Space);
+			break;
+		default:
+			AddDescriptor(param.Type, param.Visibility, binding.Register, binding.Space);
+			break;
+		}
+	}
+}
+
 void RootSignature::Build(ID3D12Device5Ptr device, D3D12_ROOT_SIGNATURE_FLAGS flags)
 {
 	D3D12_ROOT_SIGNATURE_DESC desc{};
@@ -38,10 +71,34 @@ void RootSignature::Build(ID3D12Device5Ptr device, D3D12_ROOT_SIGNATURE_FLAGS fl
 	desc.pParameters = RootParameters.data();
 	desc.Flags = flags;
 
-	RootSignaturePtr = D3D::CreateRootSignature(device, desc);
+	PipelineHasher hasher;
+	hasher.Add(desc);
+	Hash = hasher.Get();
+
+	Size = 0;
+	for (const auto& param : RootParameters)
+	{
+		if (param.ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE) Size += 1;
+		else if (param.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS) Size += param.Constants.Num32BitValues;
+		else Size += 2;
+	}
+
+	RootSignaturePtr = Globals.RootSignatures->Get(device, desc, Hash, Size, BindCounter);
 	Interface = RootSignaturePtr.GetInterfacePtr();
 }
 
+void RootSignature::Bind(CommandContext& cmdList) const
+{
+	if (cmdList.SetGraphicsRootSignature(Interface) && BindCounter)
+		BindCounter->fetch_add(1, std::memory_order_relaxed);
+}
+
+void RootSignature::BindCompute(CommandContext& cmdList) const
+{
+	if (cmdList.SetComputeRootSignature(Interface) && BindCounter)
+		BindCounter->fetch_add(1, std::memory_order_relaxed);
+}
+
 D3D12_DESCRIPTOR_RANGE DescriptorRangeBuilder::CreateRange(D3D12_DESCRIPTOR_RANGE_TYPE type, UINT numDescriptors, UINT baseShaderRegister, UINT registerSpace, UINT offsetInDescriptorsFromTableStart)
 {
 	D3D12_DESCRIPTOR_RANGE range{};
@@ -78,3 +135,101 @@ D3D12_ROOT_PARAMETER RootParameterBuilder::CreateDescriptor(D3D12_ROOT_PARAMETER
 	return param;
 }
 
+D3D12_ROOT_PARAMETER RootParameterBuilder::CreateConstants(UINT num32BitValues, D3D12_SHADER_VISIBILITY visibility, UINT shaderRegister, UINT registerSpace)
+{
+	D3D12_ROOT_PARAMETER param{};
+	param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+	param.ShaderVisibility = visibility;
+	param.Constants.Num32BitValues = num32BitValues;
+	param.Constants.ShaderRegister = shaderRegister;
+	param.Constants.RegisterSpace = registerSpace;
+	return param;
+}
+
+RootSignatureCache::RootSignatureCache(UniquePtr<ShaderReflector> reflector)
+	:Reflector(std::move(reflector))
+{}
+
+ID3D12RootSignaturePtr RootSignatureCache::Get(ID3D12Device5Ptr device, const D3D12_ROOT_SIGNATURE_DESC& desc, uint64_t hash, UINT size,
+											   std::atomic<uint32_t>*& bindCounter)
+{
+	{
+		std::lock_guard lock(Mutex);
+		Stats.Requests++;
+		if (auto it = Signatures.find(hash); it != Signatures.end())
+		{
+			it->second.Users++;
+			bindCounter = &it->second.FrameBinds;
+			return it->second.Signature;
+		}
+	}
+
+	// Serialized and created outside the lock - passes build their signatures in parallel
+	ID3D12RootSignaturePtr signature = D3D::CreateRootSignature(device, desc);
+
+	std::lock_guard lock(Mutex);
+	auto [it, inserted] = Signatures.try_emplace(hash);
+	Entry& entry = it->second;
+	if (inserted)
+	{
+		entry.Signature = signature;
+		entry.Size = size;
+		Stats.Created++;
+	}
+	entry.Users++;
+	bindCounter = &entry.FrameBinds;
+	return entry.Signature;
+}
+
+ShaderBindings RootSignatureCache::Reflect(const ShaderModule& module)
+{
+	{
+		std::lock_guard lock(Mutex);
+		if (auto it = Reflections.find(module.Hash); it != Reflections.end())
+			return it->second;
+	}
+
+	if (!Reflector)
+		throw std::runtime_error("Reflecting " + module.File + " needs dxcompiler");
+
+	std::string errors;
+	auto bindings = Reflector->Reflect({ module.Bytecode->data(), module.Bytecode->size() }, errors);
+	if (!bindings)
+		throw std::runtime_error("Reflecting " + module.File + " failed: " + errors);
+
+	std::lock_guard lock(Mutex);
+	if (Reflections.try_emplace(module.Hash, *bindings).second)
+		Stats.Reflected++;
+	return *bindings;
+}
+
+void RootSignatureCache::EndFrame()
+{
+	std::lock_guard lock(Mutex);
+	Stats.Binds = 0;
+	for (auto& [hash, entry] : Signatures)
+	{
+		entry.LastFrameBinds = entry.FrameBinds.exchange(0, std::memory_order_relaxed);
+		Stats.Binds += entry.LastFrameBinds;
+	}
+}
+
+RootSignatureStats RootSignatureCache::GetStats()
+{
+	std::lock_guard lock(Mutex);
+	return Stats;
+}
+
+void RootSignatureCache::Dump(std::ostream& os)
+{
+	std::lock_guard lock(Mutex);
+	for (const auto& [hash, entry] : Signatures)
+	{
+		os << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << std::setfill(' ')
+		   << "  size " << std::setw(2) << entry.Size << "/64"
+		   << "  used by " << entry.Users
+		   << "  binds " << entry.LastFrameBinds << "\n";
+	}
+	os << "root signatures: " << Stats.Created << " for " << Stats.Requests << " requests, "
+	   << Stats.Reflected << " shaders reflected, " << Stats.Binds << " binds last frame\n";
+}
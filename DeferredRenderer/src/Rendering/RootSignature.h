@@ -2,8 +2,16 @@
 
 #include "Core/Core.h"
 #include "Buffer.h"
+#include "CommandContext.h"
+#include "ShaderCache.h"
+#include "ShaderReflection.h"
 #include "Shaders/HLSLCompat.h"
 
+#include <atomic>
+#include <iosfwd>
+#include <mutex>
+#include <unordered_map>
+
 enum RootParamTypes : uint32_t
 {
 	StandardDescriptors = 0,
@@ -49,6 +57,11 @@ namespace RootParameterBuilder
 										  UINT shaderRegister, 
 										  UINT registerSpace = 0);
 
+	D3D12_ROOT_PARAMETER CreateConstants(UINT num32BitValues,
+										 D3D12_SHADER_VISIBILITY visibility,
+										 UINT shaderRegister,
+										 UINT registerSpace = 0);
+
 };
 
 struct RootSignature
@@ -76,13 +89,79 @@ struct RootSignature
 		UINT shaderRegister, 
 		UINT registerSpace = 0);
 
+	void AddConstants(
+		UINT num32BitValues,
+		D3D12_SHADER_VISIBILITY visibility,
+		UINT shaderRegister,
+		UINT registerSpace = 0);
+
+	// Adds the parameters of a layout reflected from the pass's shaders, in the layout's slot order
+	void AddParameters(const RootSignatureLayout& layout);
+
+	// Shared through Globals.RootSignatures - passes building an identical description get the same signature
 	void Build(ID3D12Device5Ptr device, D3D12_ROOT_SIGNATURE_FLAGS flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
+	// Sets the signature unless the list has it already and counts the bind for the frame's report
+	void Bind(CommandContext& cmdList) const;
+	void BindCompute(CommandContext& cmdList) const;
+
 	ID3D12RootSignaturePtr RootSignaturePtr;
 	ID3D12RootSignature* Interface = nullptr;
 	D3D12_STATE_SUBOBJECT Subobject = {};
+	// Hash of the description Build used - part of the pipeline cache key. 0 for signatures made elsewhere
+	uint64_t Hash = 0;
+	// 32-bit values the parameters take of the 64 a signature may use - tables 1, root descriptors 2, constants 1 each
+	UINT Size = 0;
 
 private:
 	std::vector<D3D12_ROOT_PARAMETER> RootParameters;
+	std::atomic<uint32_t>* BindCounter = nullptr;
 	std::vector<std::vector<D3D12_DESCRIPTOR_RANGE>> DescriptorRangeStorage; // To manage descriptor range memory
-};
\ No newline at end of file
+};
+
+struct RootSignatureStats
+{
+	uint32_t Requests = 0;
+	uint32_t Created = 0;		// Distinct signatures - the other requests shared one of them
+	uint32_t Reflected = 0;		// Shader modules reflected, once per bytecode
+	uint32_t Binds = 0;			// Signatures set on command lists during the last finished frame
+};
+
+// Process-wide root signatures keyed by the hash of their description, passes with identical layouts
+// share one. Also reflects shader modules for RootSignatureLayout and counts binds per frame. Thread safe
+class RootSignatureCache
+{
+public:
+	// reflector may be null - Reflect then throws
+	explicit RootSignatureCache(UniquePtr<ShaderReflector> reflector);
+
+	// Creates the signature the first time its hash is asked for. bindCounter receives the signature's bind counter
+	ID3D12RootSignaturePtr Get(ID3D12Device5Ptr device, const D3D12_ROOT_SIGNATURE_DESC& desc, uint64_t hash, UINT size,
+							   std::atomic<uint32_t>*& bindCounter);
+	// Throws when the module cannot be reflected
+	ShaderBindings Reflect(const ShaderModule& module);
+
+	// Closes the frame's bind counts, see Dump and GetStats
+	void EndFrame();
+	RootSignatureStats GetStats();
+	// One line per signature - size, number of Get calls sharing it and binds during the last frame
+	void Dump(std::ostream& os);
+
+private:
+	struct Entry
+	{
+		ID3D12RootSignaturePtr Signature;
+		UINT Size = 0;
+		uint32_t Users = 0;
+		std::atomic<uint32_t> FrameBinds = 0;
+		uint32_t LastFrameBinds = 0;
+	};
+
+	UniquePtr<ShaderReflector> Reflector;
+
+	std::mutex Mutex;
+	// Node based, the bind counters handed out stay where they are
+	std::unordered_map<uint64_t, Entry> Signatures;
+	std::unordered_map<uint64_t, ShaderBindings> Reflections;
+	RootSignatureStats Stats;
+};
@@ -1,10 +1,10 @@
 #pragma once
 #include "Core/Core.h"
 #include "Buffer.h"
+#include "Resources.h"
+#include "ShaderCache.h"
 #include "Shaders/HLSLCompat.h"
 
-#include <filesystem>
-
 enum class ShaderType
 {
 	Vertex = 0,
@@ -20,38 +20,48 @@ constexpr ShaderType Compute = ShaderType::Compute;
 template<ShaderType Type>
 struct Shader final
 {
+	// Shared through Globals.Shaders - every pass asking for the same file gets the same bytecode
 	Shader(const std::string& shaderName)
-		:Name(shaderName)
+		:Name(shaderName), Module(Globals.Shaders->Get(shaderName + GetTag() + ".cso"))
+	{}
+	// Variant compiled from source with the given defines, see ShaderPermutations.h
+	Shader(const std::string& shaderName, const ShaderDefines& defines)
+		:Name(shaderName),
+		Module(Globals.ShaderVariants->Get(GetSourceFolder() + shaderName + ".hlsl", GetProfile(), shaderName + GetTag() + ".cso", defines))
+	{}
+
+	inline D3D12_SHADER_BYTECODE GetBytecode() const { return { Module->Bytecode->data(), Module->Bytecode->size() }; }
+	inline const ShaderModule& GetModule() const { return *Module; }
+
+private:
+	static constexpr const char* GetTag()
 	{
-		auto path = SetUpPath(Name) + string_2_wstring(Name) + GetTag() + L".cso";
-		D3DReadFileToBlob(path.c_str(), &Blob);
+		if constexpr (Type == ShaderType::Vertex) return "_VS";
+		else if constexpr (Type == ShaderType::Pixel) return "_PS";
+		else if constexpr (Type == ShaderType::Compute) return "_CS";
+		else
+		{
+			static_assert(Type != ShaderType::Size, "Invalid Shader Type");
+			return "_Unknown";
+		}
 	}
-	virtual ~Shader() = default;
-	const ID3DBlobPtr& GetBlob() const { return Blob; }
 
-private:
-	std::wstring SetUpPath(const std::string& shaderName)
+	// Matches the shader model and folders of the project's shader build
+	static std::string GetSourceFolder()
 	{
-		std::string currentDir = std::filesystem::current_path().parent_path().string();
-		return std::wstring(currentDir.begin(), currentDir.end()) + L"\\Content\\Shaders-bin\\";
+		if constexpr (Type == ShaderType::Vertex) return "VertexShaders/";
+		else if constexpr (Type == ShaderType::Pixel) return "PixelShaders/";
+		else return "ComputeShaders/";
 	}
 
-	virtual std::wstring GetTag()
+	static std::string GetProfile()
 	{
-		if constexpr (Type == ShaderType::Vertex) return L"_VS";
-		else if constexpr (Type == ShaderType::Pixel) return L"_PS";
-		else if constexpr (Type == ShaderType::Compute) return L"_CS";
-		else
-		{
-			assert(false && "Invalid Shader Type");
-			return L"_Unknown";
-		}
+		if constexpr (Type == ShaderType::Vertex) return "vs_6_0";
+		else if constexpr (Type == ShaderType::Pixel) return "ps_6_0";
+		else return "cs_6_0";
 	}
 
 private:
-	ID3DBlobPtr Blob;
 	std::string Name;
-
-private:
-	static const std::wstring Path;
+	SharedPtr<const ShaderModule> Module;
 };
\ No newline at end of file
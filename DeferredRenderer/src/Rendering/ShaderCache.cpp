@@ -0,0 +1,239 @@
+#include "ShaderCache.h"
+#include "Core/Hash.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+	thread_local std::vector<std::string>* RecordedFiles = nullptr;
+
+	uint64_t HashBytecode(const std::vector<uint8_t>& bytecode)
+	{
+		Hasher hasher;
+		hasher.Add(bytecode.data(), bytecode.size());
+		return hasher.Get();
+	}
+}
+
+DiskShaderSource::DiskShaderSource(std::filesystem::path directory)
+	:Directory(std::move(directory))
+{}
+
+std::optional<std::vector<uint8_t>> DiskShaderSource::Read(const std::string& file)
+{
+	std::ifstream stream(Directory / file, std::ios::binary | std::ios::ate);
+	if (!stream) return std::nullopt;
+
+	std::vector<uint8_t> data(static_cast<size_t>(stream.tellg()));
+	stream.seekg(0);
+	if (!stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+		return std::nullopt;
+	return data;
+}
+
+std::optional<std::filesystem::file_time_type> DiskShaderSource::GetWriteTime(const std::string& file)
+{
+	std::error_code error;
+	auto time = std::filesystem::last_write_time(Directory / file, error);
+	if (error) return std::nullopt;
+	return time;
+}
+
+std::optional<std::filesystem::path> FindShaderSourceDirectory(const std::vector<std::filesystem::path>& searchFrom, const char* overrideDirectory)
+{
+	std::error_code error;
+	if (overrideDirectory && *overrideDirectory)
+	{
+		std::filesystem::path directory(overrideDirectory);
+		if (!std::filesystem::is_directory(directory, error)) return std::nullopt;
+		return directory;
+	}
+
+	const std::filesystem::path shaders = std::filesystem::path("DeferredRenderer") / "src" / "Rendering" / "Shaders";
+	for (const auto& start : searchFrom)
+	{
+		for (auto directory = start; !directory.empty(); directory = directory.parent_path())
+		{
+			if (std::filesystem::is_directory(directory / shaders, error))
+				return directory / shaders;
+			// The root is its own parent
+			if (directory == directory.parent_path()) break;
+		}
+	}
+	return std::nullopt;
+}
+
+ShaderCache::ShaderCache(UniquePtr<ShaderSource> source)
+	:Source(std::move(source))
+{}
+
+ShaderCache::~ShaderCache()
+{
+	StopWatching();
+}
+
+SharedPtr<const ShaderModule> ShaderCache::Get(const std::string& file)
+{
+	ShaderDependencyScope::Record(file);
+	{
+		std::lock_guard lock(Mutex);
+		Stats.Requests++;
+		if (auto it = Entries.find(file); it != Entries.end())
+			return it->second.Module;
+	}
+
+	// Read outside the lock so passes building in parallel load different files concurrently
+	auto writeTime = Source->GetWriteTime(file);
+	auto bytecode = Source->Read(file);
+	if (!bytecode)
+		throw std::runtime_error("Cannot read shader " + file);
+	uint64_t hash = HashBytecode(*bytecode);
+
+	std::lock_guard lock(Mutex);
+	// Another thread may have read the same file meanwhile
+	if (auto it = Entries.find(file); it != Entries.end())
+		return it->second.Module;
+
+	Stats.Reads++;
+	auto module = MakeShared<ShaderModule>();
+	module->File = file;
+	module->Hash = hash;
+	module->Bytecode = ShareBytecode(std::move(*bytecode), hash);
+
+	Entries.emplace(file, Entry{ module, writeTime, std::nullopt });
+	return module;
+}
+
+SharedPtr<const std::vector<uint8_t>> ShaderCache::ShareBytecode(std::vector<uint8_t>&& bytecode, uint64_t hash)
+{
+	if (auto shared = Bytecode[hash].lock(); shared && *shared == bytecode)
+	{
+		Stats.SharedBytecode++;
+		return shared;
+	}
+
+	auto shared = MakeShared<const std::vector<uint8_t>>(std::move(bytecode));
+	Bytecode[hash] = shared;
+	return shared;
+}
+
+std::vector<std::string> ShaderCache::Poll()
+{
+	std::vector<std::string> files;
+	{
+		std::lock_guard lock(Mutex);
+		files.reserve(Entries.size());
+		for (const auto& [file, entry] : Entries)
+			files.push_back(file);
+	}
+
+	std::vector<std::string> changed;
+	for (const auto& file : files)
+	{
+		// Missing while the compiler replaces it - keep the current module
+		auto writeTime = Source->GetWriteTime(file);
+		if (!writeTime) continue;
+
+		{
+			std::lock_guard lock(Mutex);
+			Entry& entry = Entries[file];
+			if (entry.WriteTime == writeTime)
+			{
+				entry.PendingTime.reset();
+				continue;
+			}
+			// Reloaded once the write time held still for a whole poll
+			if (entry.PendingTime != writeTime)
+			{
+				entry.PendingTime = writeTime;
+				continue;
+			}
+		}
+
+		auto bytecode = Source->Read(file);
+		if (!bytecode) continue;
+		uint64_t hash = HashBytecode(*bytecode);
+
+		std::lock_guard lock(Mutex);
+		Entry& entry = Entries[file];
+		entry.WriteTime = writeTime;
+		entry.PendingTime.reset();
+		// Touched but rebuilt to the same bytecode - nothing to do
+		if (hash == entry.Module->Hash) continue;
+
+		auto module = MakeShared<ShaderModule>();
+		module->File = file;
+		module->Hash = hash;
+		module->Version = entry.Module->Version + 1;
+		module->Bytecode = ShareBytecode(std::move(*bytecode), hash);
+		entry.Module = module;
+
+		Stats.Reloads++;
+		changed.push_back(file);
+		if (std::ranges::find(Changed, file) == Changed.end())
+			Changed.push_back(file);
+	}
+	return changed;
+}
+
+void ShaderCache::StartWatching(std::chrono::milliseconds interval)
+{
+	if (Watcher.joinable()) return;
+
+	StopWatcher = false;
+	Watcher = std::thread([this, interval]()
+		{
+			std::unique_lock lock(Mutex);
+			while (!WatcherWake.wait_for(lock, interval, [this]() { return StopWatcher; }))
+			{
+				lock.unlock();
+				Poll();
+				lock.lock();
+			}
+		});
+}
+
+void ShaderCache::StopWatching()
+{
+	if (!Watcher.joinable()) return;
+
+	{
+		std::lock_guard lock(Mutex);
+		StopWatcher = true;
+	}
+	WatcherWake.notify_all();
+	Watcher.join();
+}
+
+std::vector<std::string> ShaderCache::TakeChanged()
+{
+	std::lock_guard lock(Mutex);
+	return std::exchange(Changed, {});
+}
+
+ShaderCacheStats ShaderCache::GetStats()
+{
+	std::lock_guard lock(Mutex);
+	return Stats;
+}
+
+ShaderDependencyScope::ShaderDependencyScope(std::vector<std::string>& files)
+	:Previous(RecordedFiles)
+{
+	files.clear();
+	RecordedFiles = &files;
+}
+
+ShaderDependencyScope::~ShaderDependencyScope()
+{
+	RecordedFiles = Previous;
+}
+
+void ShaderDependencyScope::Record(const std::string& file)
+{
+	if (RecordedFiles && std::ranges::find(*RecordedFiles, file) == RecordedFiles->end())
+		RecordedFiles->push_back(file);
+}
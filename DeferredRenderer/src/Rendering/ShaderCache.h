@@ -0,0 +1,126 @@
+#pragma once
+#include "Core/Memory.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Compiled bytecode of one .cso file. Immutable - a reload publishes a new module,
+// PSOs built from the old one keep it alive until they are rebuilt
+struct ShaderModule
+{
+	std::string File;
+	SharedPtr<const std::vector<uint8_t>> Bytecode;
+	uint64_t Hash = 0;		// Of the contents, modules with equal bytecode share it
+	uint32_t Version = 0;	// Reloads of this file so far
+};
+
+// File access of the cache. DiskShaderSource reads Content/Shaders-bin, a stand-in
+// can serve files from memory so caching and reloading run without a device or a disk
+class ShaderSource
+{
+public:
+	virtual ~ShaderSource() = default;
+
+	// nullopt when the file does not exist or cannot be read
+	virtual std::optional<std::vector<uint8_t>> Read(const std::string& file) = 0;
+	virtual std::optional<std::filesystem::file_time_type> GetWriteTime(const std::string& file) = 0;
+};
+
+class DiskShaderSource : public ShaderSource
+{
+public:
+	explicit DiskShaderSource(std::filesystem::path directory);
+
+	std::optional<std::vector<uint8_t>> Read(const std::string& file) override;
+	std::optional<std::filesystem::file_time_type> GetWriteTime(const std::string& file) override;
+
+private:
+	std::filesystem::path Directory;
+};
+
+// HLSL sources the shader variants compile from. A set overrideDirectory wins, otherwise the start
+// directories and the folders above them are searched for the project's Shaders folder.
+// nullopt when nothing is found or the override is not a directory
+std::optional<std::filesystem::path> FindShaderSourceDirectory(const std::vector<std::filesystem::path>& searchFrom, const char* overrideDirectory = nullptr);
+
+struct ShaderCacheStats
+{
+	uint32_t Requests = 0;
+	uint32_t Reads = 0;			// Files read from the source - once per file unless it is reloaded
+	uint32_t SharedBytecode = 0;	// Reads whose contents matched an already loaded module
+	uint32_t Reloads = 0;
+};
+
+// Process-wide shader modules keyed by file name, e.g. "FullScreenTriangle_VS.cso".
+// Every pass asking for the same file shares one module. Files are watched by polling their
+// write time, a changed file is re-read once its write time stayed the same for a whole poll
+// so half-written files from a running compiler are skipped. Thread safe
+class ShaderCache
+{
+public:
+	explicit ShaderCache(UniquePtr<ShaderSource> source);
+	~ShaderCache();
+
+	// Throws when the file cannot be read
+	SharedPtr<const ShaderModule> Get(const std::string& file);
+
+	// Re-reads the modules whose file changed - returns the files whose contents changed, they are also queued for TakeChanged
+	std::vector<std::string> Poll();
+	// Calls Poll on a background thread, changes are queued until TakeChanged
+	void StartWatching(std::chrono::milliseconds interval = std::chrono::milliseconds(500));
+	void StopWatching();
+	// Files changed since the last call
+	std::vector<std::string> TakeChanged();
+
+	ShaderCacheStats GetStats();
+
+private:
+	SharedPtr<const std::vector<uint8_t>> ShareBytecode(std::vector<uint8_t>&& bytecode, uint64_t hash);
+
+private:
+	struct Entry
+	{
+		SharedPtr<const ShaderModule> Module;
+		std::optional<std::filesystem::file_time_type> WriteTime;
+		// Write time seen by the previous poll when it differed from WriteTime
+		std::optional<std::filesystem::file_time_type> PendingTime;
+	};
+
+	UniquePtr<ShaderSource> Source;
+
+	std::mutex Mutex;
+	std::unordered_map<std::string, Entry> Entries;
+	// Content hash -> bytecode, so identical files are kept once
+	std::unordered_map<uint64_t, WeakPtr<const std::vector<uint8_t>>> Bytecode;
+	std::vector<std::string> Changed;
+	ShaderCacheStats Stats;
+
+	std::thread Watcher;
+	std::condition_variable WatcherWake;
+	bool StopWatcher = false;
+};
+
+// Records the files read through ShaderCache::Get on this thread while alive -
+// passes learn which shaders their pipeline depends on
+class ShaderDependencyScope
+{
+public:
+	explicit ShaderDependencyScope(std::vector<std::string>& files);
+	~ShaderDependencyScope();
+
+	ShaderDependencyScope(const ShaderDependencyScope&) = delete;
+	ShaderDependencyScope& operator=(const ShaderDependencyScope&) = delete;
+
+	static void Record(const std::string& file);
+
+private:
+	std::vector<std::string>* Previous = nullptr;
+};
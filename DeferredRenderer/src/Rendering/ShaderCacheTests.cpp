@@ -0,0 +1,283 @@
+#include "Test.h"
+#include "Rendering/ShaderCache.h"
+
+#include <fstream>
+#include <map>
+#include <thread>
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	// Serves files from memory, write times advance only when a test says so
+	class MemoryShaderSource : public ShaderSource
+	{
+	public:
+		struct File
+		{
+			std::vector<uint8_t> Contents;
+			std::filesystem::file_time_type WriteTime;
+		};
+		std::map<std::string, File> Files;
+		uint32_t Reads = 0;
+
+		void Write(const std::string& file, std::vector<uint8_t> contents)
+		{
+			auto& entry = Files[file];
+			entry.Contents = std::move(contents);
+			Touch(file);
+		}
+
+		void Touch(const std::string& file)
+		{
+			Files[file].WriteTime = std::filesystem::file_time_type() + std::chrono::seconds(++Clock);
+		}
+
+		std::optional<std::vector<uint8_t>> Read(const std::string& file) override
+		{
+			auto it = Files.find(file);
+			if (it == Files.end()) return std::nullopt;
+			Reads++;
+			return it->second.Contents;
+		}
+
+		std::optional<std::filesystem::file_time_type> GetWriteTime(const std::string& file) override
+		{
+			auto it = Files.find(file);
+			if (it == Files.end()) return std::nullopt;
+			return it->second.WriteTime;
+		}
+
+	private:
+		int Clock = 0;
+	};
+
+	struct TestCache
+	{
+		MemoryShaderSource* Source;
+		ShaderCache Cache;
+
+		TestCache(UniquePtr<MemoryShaderSource> source = MakeUnique<MemoryShaderSource>())
+			:Source(source.get()), Cache(std::move(source))
+		{}
+	};
+
+	// A temporary directory, removed with everything in it
+	struct TempDirectory
+	{
+		std::filesystem::path Path;
+
+		TempDirectory()
+			:Path(std::filesystem::temp_directory_path() / ("ShaderCacheTests-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())))
+		{
+			std::filesystem::create_directories(Path);
+		}
+
+		~TempDirectory()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(Path, error);
+		}
+
+		// Write times are set explicitly, file systems with a coarse clock would hide quick rewrites otherwise
+		void Write(const std::string& file, const std::string& contents, std::filesystem::file_time_type time)
+		{
+			std::ofstream(Path / file, std::ios::binary | std::ios::trunc) << contents;
+			std::filesystem::last_write_time(Path / file, time);
+		}
+	};
+
+	std::string Contents(const ShaderModule& module)
+	{
+		return std::string(module.Bytecode->begin(), module.Bytecode->end());
+	}
+}
+
+TEST_CASE(ShaderModulesAreSharedPerFileAndByContents)
+{
+	TestCache test;
+	test.Source->Write("Lighting_PS.cso", { 1, 2, 3 });
+	test.Source->Write("Copy_PS.cso", { 1, 2, 3 });
+	test.Source->Write("FullScreenTriangle_VS.cso", { 4, 5 });
+
+	auto lighting = test.Cache.Get("Lighting_PS.cso");
+	CHECK(test.Cache.Get("Lighting_PS.cso") == lighting);
+	CHECK_EQ(test.Source->Reads, 1u);
+
+	// Another file with the same bytecode is its own module over the same bytes
+	auto copy = test.Cache.Get("Copy_PS.cso");
+	CHECK(copy != lighting);
+	CHECK(copy->Bytecode == lighting->Bytecode);
+	CHECK_EQ(copy->Hash, lighting->Hash);
+
+	auto triangle = test.Cache.Get("FullScreenTriangle_VS.cso");
+	CHECK(triangle->Bytecode != lighting->Bytecode);
+	CHECK_EQ(triangle->Bytecode->size(), 2u);
+
+	auto stats = test.Cache.GetStats();
+	CHECK_EQ(stats.Requests, 4u);
+	CHECK_EQ(stats.Reads, 3u);
+	CHECK_EQ(stats.SharedBytecode, 1u);
+
+	bool threw = false;
+	try
+	{
+		test.Cache.Get("Missing_PS.cso");
+	}
+	catch (const std::exception&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+}
+
+TEST_CASE(DependencyScopesRecordTheFilesOfAPass)
+{
+	TestCache test;
+	test.Source->Write("A.cso", { 1 });
+	test.Source->Write("B.cso", { 2 });
+
+	std::vector<std::string> outer;
+	{
+		ShaderDependencyScope scope(outer);
+		test.Cache.Get("A.cso");
+
+		// A nested scope only sees its own files, the outer one continues after it
+		std::vector<std::string> inner;
+		{
+			ShaderDependencyScope nested(inner);
+			test.Cache.Get("B.cso");
+		}
+		CHECK(inner == std::vector<std::string>({ "B.cso" }));
+
+		test.Cache.Get("A.cso");
+		test.Cache.Get("B.cso");
+	}
+	CHECK(outer == std::vector<std::string>({ "A.cso", "B.cso" }));
+
+	// Nothing is recorded outside a scope
+	test.Cache.Get("A.cso");
+	CHECK_EQ(outer.size(), 2u);
+}
+
+TEST_CASE(ChangedShadersReloadOnceTheirWriteTimeHoldsStill)
+{
+	TestCache test;
+	test.Source->Write("Lighting_PS.cso", { 1, 2, 3 });
+	auto first = test.Cache.Get("Lighting_PS.cso");
+	CHECK(test.Cache.Poll().empty());
+
+	// Still being written while the first poll sees the new time - and again before the second one
+	test.Source->Write("Lighting_PS.cso", { 9 });
+	CHECK(test.Cache.Poll().empty());
+	test.Source->Write("Lighting_PS.cso", { 4, 5, 6 });
+	CHECK(test.Cache.Poll().empty());
+	CHECK(test.Cache.Get("Lighting_PS.cso") == first);
+
+	auto changed = test.Cache.Poll();
+	CHECK(changed == std::vector<std::string>({ "Lighting_PS.cso" }));
+	auto second = test.Cache.Get("Lighting_PS.cso");
+	CHECK(second != first);
+	CHECK_EQ(second->Version, 1u);
+	CHECK_EQ((*second->Bytecode)[0], 4);
+	// Pipelines built from the old module keep its bytes
+	CHECK_EQ((*first->Bytecode)[0], 1);
+
+	// Queued once, until taken
+	CHECK(test.Cache.TakeChanged() == changed);
+	CHECK(test.Cache.TakeChanged().empty());
+	CHECK_EQ(test.Cache.GetStats().Reloads, 1u);
+
+	// Rebuilt to the same bytecode - read, but nothing changed
+	test.Source->Touch("Lighting_PS.cso");
+	CHECK(test.Cache.Poll().empty());
+	CHECK(test.Cache.Poll().empty());
+	CHECK(test.Cache.Get("Lighting_PS.cso") == second);
+
+	// Gone while the compiler replaces it - the module stays
+	test.Source->Files.erase("Lighting_PS.cso");
+	CHECK(test.Cache.Poll().empty());
+	CHECK(test.Cache.Poll().empty());
+	CHECK(test.Cache.Get("Lighting_PS.cso") == second);
+	CHECK(test.Cache.TakeChanged().empty());
+	CHECK_EQ(test.Cache.GetStats().Reloads, 1u);
+}
+
+TEST_CASE(DiskShaderSourceReadsTheDirectory)
+{
+	TempDirectory directory;
+	auto time = std::filesystem::file_time_type::clock::now() - 1h;
+	directory.Write("Copy_CS.cso", "DXBC", time);
+
+	DiskShaderSource source(directory.Path);
+	auto bytecode = source.Read("Copy_CS.cso");
+	REQUIRE(bytecode.has_value());
+	CHECK(*bytecode == std::vector<uint8_t>({ 'D', 'X', 'B', 'C' }));
+	CHECK(source.GetWriteTime("Copy_CS.cso") == time);
+
+	CHECK(!source.Read("Missing_CS.cso").has_value());
+	CHECK(!source.GetWriteTime("Missing_CS.cso").has_value());
+}
+
+TEST_CASE(WatcherPicksUpRewrittenShaderFiles)
+{
+	TempDirectory directory;
+	auto time = std::filesystem::file_time_type::clock::now() - 1h;
+	directory.Write("Lighting_PS.cso", "old", time);
+	directory.Write("Copy_PS.cso", "old", time);
+
+	ShaderCache cache(MakeUnique<DiskShaderSource>(directory.Path));
+	auto lighting = cache.Get("Lighting_PS.cso");
+	auto copy = cache.Get("Copy_PS.cso");
+	CHECK(lighting->Bytecode == copy->Bytecode);
+
+	cache.StartWatching(5ms);
+	directory.Write("Lighting_PS.cso", "new", time + 1s);
+
+	// Two polls apart at least - generous, the watcher shares the machine with other tests
+	std::vector<std::string> changed;
+	auto deadline = std::chrono::steady_clock::now() + 5s;
+	while (changed.empty() && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::sleep_for(5ms);
+		changed = cache.TakeChanged();
+	}
+	cache.StopWatching();
+
+	REQUIRE(changed == std::vector<std::string>({ "Lighting_PS.cso" }));
+	auto reloaded = cache.Get("Lighting_PS.cso");
+	CHECK_EQ(reloaded->Version, 1u);
+	CHECK_EQ(Contents(*reloaded), "new");
+	// The untouched file keeps its module, and no longer shares bytes with the reloaded one
+	CHECK(cache.Get("Copy_PS.cso") == copy);
+	CHECK(reloaded->Bytecode != copy->Bytecode);
+
+	// Stopping twice and restarting is fine
+	cache.StopWatching();
+	cache.StartWatching(5ms);
+}
+
+TEST_CASE(ShaderSourcesAreFoundAboveTheStartDirectories)
+{
+	TempDirectory root;
+	auto shaders = root.Path / "DeferredRenderer" / "src" / "Rendering" / "Shaders";
+	auto bin = root.Path / "bin";
+	auto elsewhere = root.Path / "Elsewhere";
+	for (const auto& directory : { shaders, bin, elsewhere })
+		std::filesystem::create_directories(directory);
+
+	// From the executable in bin/, whatever the working directory
+	CHECK(FindShaderSourceDirectory({ bin, std::filesystem::temp_directory_path() }) == shaders);
+	CHECK(FindShaderSourceDirectory({ std::filesystem::temp_directory_path(), bin }) == shaders);
+	CHECK(FindShaderSourceDirectory({ root.Path }) == shaders);
+	CHECK(!FindShaderSourceDirectory({}).has_value());
+
+	// A set override wins, an empty one is ignored
+	std::string custom = elsewhere.string();
+	CHECK(FindShaderSourceDirectory({ bin }, custom.c_str()) == elsewhere);
+	CHECK(FindShaderSourceDirectory({ bin }, "") == shaders);
+
+	// ... and a wrong one is not silently replaced by the project folder
+	std::string missing = (root.Path / "Missing").string();
+	CHECK(!FindShaderSourceDirectory({ bin }, missing.c_str()).has_value());
+}
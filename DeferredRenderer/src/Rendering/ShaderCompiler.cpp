@@ -0,0 +1,229 @@
+#include "ShaderCompiler.h"
+#include "Core/Exception.h"
+#include "Core/Hash.h"
+#include "Utils.h"
+
+#include <algorithm>
+
+UniquePtr<DxcShaderCompiler> DxcShaderCompiler::Create()
+{
+	auto compiler = MakeUnique<DxcShaderCompiler>();
+	if (FAILED(compiler->Dll.Initialize()))
+		return nullptr;
+	return compiler;
+}
+
+std::optional<std::vector<uint8_t>> DxcShaderCompiler::Compile(const std::filesystem::path& source,
+															   const std::string& profile,
+															   const ShaderDefines& defines,
+															   std::string& errors)
+{
+	// DXC objects are not thread safe - every compile makes its own
+	IDxcLibraryPtr library;
+	IDxcCompilerPtr compiler;
+	GRAPHICS_ASSERT(Dll.CreateInstance(CLSID_DxcLibrary, &library));
+	GRAPHICS_ASSERT(Dll.CreateInstance(CLSID_DxcCompiler, &compiler));
+
+	std::wstring path = source.wstring();
+	IDxcBlobEncodingPtr sourceBlob;
+	if (FAILED(library->CreateBlobFromFile(path.c_str(), nullptr, &sourceBlob)))
+	{
+		errors = "Cannot read " + source.string();
+		return std::nullopt;
+	}
+
+	// Resolves the includes relative to the source, like the project's shader build
+	IDxcIncludeHandlerPtr includeHandler;
+	GRAPHICS_ASSERT(library->CreateIncludeHandler(&includeHandler));
+
+	// DxcDefine only points into these
+	std::vector<std::wstring> names;
+	std::vector<std::wstring> values;
+	names.reserve(defines.size());
+	values.reserve(defines.size());
+	std::vector<DxcDefine> dxcDefines;
+	for (const auto& define : defines)
+	{
+		names.push_back(string_2_wstring(define.Name));
+		values.push_back(string_2_wstring(define.Value));
+		dxcDefines.push_back({ names.back().c_str(), values.back().c_str() });
+	}
+
+	// The shaders use HLSL 2021 select(), pinned like the project's shader build
+	std::vector<LPCWSTR> arguments = { L"-HV", L"2021" };
+#ifndef NDEBUG
+	arguments.insert(arguments.end(), { L"-Zi", L"-Qembed_debug" });
+#endif
+
+	std::wstring targetProfile = string_2_wstring(profile);
+	IDxcOperationResultPtr result;
+	GRAPHICS_ASSERT(compiler->Compile(sourceBlob, path.c_str(), L"main", targetProfile.c_str(),
+									  arguments.data(), static_cast<UINT32>(arguments.size()),
+									  dxcDefines.data(), static_cast<UINT32>(dxcDefines.size()),
+									  includeHandler, &result));
+
+	HRESULT status = S_OK;
+	GRAPHICS_ASSERT(result->GetStatus(&status));
+	if (FAILED(status))
+	{
+		IDxcBlobEncodingPtr errorBlob;
+		result->GetErrorBuffer(&errorBlob);
+		if (errorBlob)
+			errors.assign(static_cast<const char*>(errorBlob->GetBufferPointer()), errorBlob->GetBufferSize());
+		return std::nullopt;
+	}
+
+	IDxcBlobPtr bytecode;
+	GRAPHICS_ASSERT(result->GetResult(&bytecode));
+	const uint8_t* data = static_cast<const uint8_t*>(bytecode->GetBufferPointer());
+	return std::vector<uint8_t>(data, data + bytecode->GetBufferSize());
+}
+
+ShaderVariantCache::ShaderVariantCache(UniquePtr<ShaderCompiler> compiler, std::filesystem::path sourceDirectory, ShaderCache& precompiled)
+	:Compiler(std::move(compiler)), SourceDirectory(std::move(sourceDirectory)), Precompiled(precompiled)
+{}
+
+ShaderVariantCache::~ShaderVariantCache()
+{
+	StopBackground();
+}
+
+SharedPtr<const ShaderModule> ShaderVariantCache::Get(const std::string& source,
+													  const std::string& profile,
+													  const std::string& precompiledFile,
+													  const ShaderDefines& defines)
+{
+	if (!Compiler)
+	{
+		{
+			std::lock_guard lock(Mutex);
+			Stats.Requests++;
+			Stats.Fallbacks++;
+		}
+		return Precompiled.Get(precompiledFile);
+	}
+
+	std::string key = GetVariantKey(source, profile, defines);
+	std::promise<SharedPtr<const ShaderModule>> promise;
+	std::shared_future<SharedPtr<const ShaderModule>> future;
+	bool owner = false;
+	{
+		std::lock_guard lock(Mutex);
+		Stats.Requests++;
+		auto [it, inserted] = Variants.try_emplace(key);
+		if (inserted)
+		{
+			it->second = promise.get_future().share();
+			owner = true;
+		}
+		future = it->second;
+	}
+
+	// The first request compiles, concurrent ones for the same variant wait for it
+	if (owner)
+	{
+		try
+		{
+			promise.set_value(Compile(source, profile, defines));
+		}
+		catch (...)
+		{
+			// The next request tries again - the source may be fixed by then
+			{
+				std::lock_guard lock(Mutex);
+				Variants.erase(key);
+			}
+			promise.set_exception(std::current_exception());
+		}
+	}
+	return future.get();
+}
+
+SharedPtr<const ShaderModule> ShaderVariantCache::Compile(const std::string& source, const std::string& profile, const ShaderDefines& defines)
+{
+	std::string errors;
+	auto bytecode = Compiler->Compile(SourceDirectory / source, profile, defines, errors);
+	if (!bytecode)
+		throw std::runtime_error("Compiling " + GetVariantKey(source, profile, defines) + " failed\n" + errors);
+
+	Hasher hasher;
+	hasher.Add(bytecode->data(), bytecode->size());
+
+	auto module = MakeShared<ShaderModule>();
+	module->File = GetVariantKey(source, profile, defines);
+	module->Hash = hasher.Get();
+	module->Bytecode = MakeShared<const std::vector<uint8_t>>(std::move(*bytecode));
+
+	std::lock_guard lock(Mutex);
+	Stats.Compiled++;
+	return module;
+}
+
+void ShaderVariantCache::Enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard lock(Mutex);
+		if (Stopping) return;
+
+		Jobs.push_back(std::move(job));
+		if (!Background.joinable())
+			Background = std::thread(&ShaderVariantCache::BackgroundLoop, this);
+	}
+	JobReady.notify_one();
+}
+
+void ShaderVariantCache::StopBackground()
+{
+	{
+		std::lock_guard lock(Mutex);
+		Stopping = true;
+		Jobs.clear();
+	}
+	JobReady.notify_all();
+
+	if (Background.joinable())
+		Background.join();
+}
+
+void ShaderVariantCache::BackgroundLoop()
+{
+	std::unique_lock lock(Mutex);
+	while (true)
+	{
+		JobReady.wait(lock, [this]() { return Stopping || !Jobs.empty(); });
+		if (Stopping) return;
+
+		auto job = std::move(Jobs.front());
+		Jobs.pop_front();
+		Stats.Background++;
+
+		lock.unlock();
+		try
+		{
+			job();
+		}
+		catch (const std::exception&)
+		{
+			// Reported when the variant is requested for rendering and compiled again
+		}
+		lock.lock();
+	}
+}
+
+ShaderVariantStats ShaderVariantCache::GetStats()
+{
+	std::lock_guard lock(Mutex);
+	return Stats;
+}
+
+std::string ShaderVariantCache::GetVariantKey(const std::string& source, const std::string& profile, const ShaderDefines& defines)
+{
+	// Sorted, so the order a pass lists its defines in does not make a new variant
+	ShaderDefines sorted = defines;
+	std::ranges::sort(sorted, {}, &ShaderDefine::Name);
+
+	std::string key = source + " " + profile;
+	for (const auto& define : sorted)
+		key += " " + define.Name + "=" + define.Value;
+	return key;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "Core/Core.h"
+#include "ShaderCache.h"
+
+#include <deque>
+#include <future>
+
+struct ShaderDefine
+{
+	std::string Name;
+	std::string Value;
+};
+using ShaderDefines = std::vector<ShaderDefine>;
+
+// Turns HLSL source into bytecode. DxcShaderCompiler uses the bundled DXC,
+// a stand-in can hand out fixed bytecode so variant selection runs without a compiler
+class ShaderCompiler
+{
+public:
+	virtual ~ShaderCompiler() = default;
+
+	// nullopt when compilation failed, errors then holds the compiler output
+	virtual std::optional<std::vector<uint8_t>> Compile(const std::filesystem::path& source,
+														const std::string& profile,
+														const ShaderDefines& defines,
+														std::string& errors) = 0;
+};
+
+class DxcShaderCompiler : public ShaderCompiler
+{
+public:
+	// nullptr when dxcompiler cannot be loaded
+	static UniquePtr<DxcShaderCompiler> Create();
+
+	std::optional<std::vector<uint8_t>> Compile(const std::filesystem::path& source,
+												const std::string& profile,
+												const ShaderDefines& defines,
+												std::string& errors) override;
+
+private:
+	dxc::DxcDllSupport Dll;
+};
+
+struct ShaderVariantStats
+{
+	uint32_t Requests = 0;
+	uint32_t Compiled = 0;
+	uint32_t Fallbacks = 0;		// Served by the precompiled shader because no compiler is available
+	uint32_t Background = 0;	// Jobs run on the background thread
+};
+
+// Shader modules compiled from source for a set of defines, cached per source, profile and defines.
+// Without a compiler every variant is the precompiled .cso from the ShaderCache - shaders keep their
+// runtime switch when a define is missing, so that stays correct, just slower.
+// Also runs the background jobs that compile variants nobody asked for yet. Thread safe
+class ShaderVariantCache
+{
+public:
+	// compiler may be null
+	ShaderVariantCache(UniquePtr<ShaderCompiler> compiler, std::filesystem::path sourceDirectory, ShaderCache& precompiled);
+	~ShaderVariantCache();
+
+	// source is relative to the source directory, e.g. "PixelShaders/LightingPass.hlsl".
+	// Throws with the compiler output when the variant does not compile
+	SharedPtr<const ShaderModule> Get(const std::string& source,
+									  const std::string& profile,
+									  const std::string& precompiledFile,
+									  const ShaderDefines& defines);
+
+	inline bool CanCompile() const { return Compiler != nullptr; }
+
+	// Runs job on the background thread, jobs run one after another in queue order
+	void Enqueue(std::function<void()> job);
+	// Drops queued jobs and waits for the running one - jobs may reference passes about to be destroyed
+	void StopBackground();
+
+	ShaderVariantStats GetStats();
+
+	static std::string GetVariantKey(const std::string& source, const std::string& profile, const ShaderDefines& defines);
+
+private:
+	SharedPtr<const ShaderModule> Compile(const std::string& source, const std::string& profile, const ShaderDefines& defines);
+	void BackgroundLoop();
+
+private:
+	UniquePtr<ShaderCompiler> Compiler;
+	std::filesystem::path SourceDirectory;
+	ShaderCache& Precompiled;
+
+	std::mutex Mutex;
+	std::unordered_map<std::string, std::shared_future<SharedPtr<const ShaderModule>>> Variants;
+	ShaderVariantStats Stats;
+
+	std::thread Background;
+	std::condition_variable JobReady;
+	std::deque<std::function<void()>> Jobs;
+	bool Stopping = false;
+};
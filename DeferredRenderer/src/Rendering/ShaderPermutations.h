@@ -0,0 +1,119 @@
+#pragma once
+#include "Core/Core.h"
+#include "Resources.h"
+#include "ShaderCompiler.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string_view>
+
+// String literal usable as a template argument - names a feature define
+template<size_t N>
+struct FeatureName
+{
+	constexpr FeatureName(const char(&name)[N]) { std::copy_n(name, N, Value); }
+	constexpr std::string_view View() const { return { Value, N - 1 }; }
+
+	char Value[N]{};
+};
+
+// Set of boolean feature defines a pass compiles its shaders with, declared at compile time:
+//     using Features = PermutationKey<"SSAO">;
+//     Features().Set<"SSAO">(enabled)
+// Every feature is passed to the compiler as 0 or 1. A name that is not declared does not compile
+template<FeatureName... Names>
+struct PermutationKey
+{
+	static constexpr uint32_t FeatureCount = sizeof...(Names);
+	static constexpr uint32_t VariantCount = 1u << FeatureCount;
+	static_assert(FeatureCount <= 8, "Every feature doubles the variants to build");
+
+	template<FeatureName Name>
+	static constexpr uint32_t Bit()
+	{
+		constexpr uint32_t index = IndexOf(Name.View());
+		static_assert(index < FeatureCount, "Feature not declared in the permutation key");
+		return 1u << index;
+	}
+
+	template<FeatureName Name>
+	constexpr PermutationKey& Set(bool enabled)
+	{
+		Bits = enabled ? Bits | Bit<Name>() : Bits & ~Bit<Name>();
+		return *this;
+	}
+
+	template<FeatureName Name>
+	constexpr bool Has() const { return (Bits & Bit<Name>()) != 0; }
+
+	ShaderDefines GetDefines() const
+	{
+		ShaderDefines defines;
+		uint32_t bit = 1;
+		((defines.push_back({ std::string(Names.View()), (Bits & bit) ? "1" : "0" }), bit <<= 1), ...);
+		return defines;
+	}
+
+	uint32_t Bits = 0;
+
+private:
+	static constexpr uint32_t IndexOf(std::string_view name)
+	{
+		std::array<std::string_view, FeatureCount> names = { Names.View()... };
+		for (uint32_t i = 0; i < FeatureCount; i++)
+			if (names[i] == name) return i;
+		return FeatureCount;
+	}
+};
+
+// One PSO per value of a PermutationKey. The requested variant is built right away, the others
+// are queued on the background thread of Globals.ShaderVariants so a feature toggle rarely waits.
+// Get is thread safe - it waits for a variant being built and builds one that was not started yet
+template<typename Key>
+class PipelineVariants
+{
+public:
+	using Builder = std::function<ID3D12PipelineStatePtr(Key)>;
+
+	void Init(Builder builder, Key initial)
+	{
+		// Background jobs of a previous Init keep building into the state they captured
+		Current = MakeShared<State>();
+		Current->Build = std::move(builder);
+		Get(initial);
+
+		for (uint32_t bits = 0; bits < Key::VariantCount; bits++)
+		{
+			if (bits == initial.Bits) continue;
+
+			Key key;
+			key.Bits = bits;
+			Globals.ShaderVariants->Enqueue([state = Current, key]() { Build(*state, key); });
+		}
+	}
+
+	inline ID3D12PipelineStatePtr Get(Key key) const { return Build(*Current, key); }
+
+private:
+	struct Slot
+	{
+		std::once_flag Once;
+		ID3D12PipelineStatePtr Pipeline;
+	};
+
+	struct State
+	{
+		Builder Build;
+		std::array<Slot, Key::VariantCount> Slots;
+	};
+
+	static ID3D12PipelineStatePtr Build(State& state, Key key)
+	{
+		Slot& slot = state.Slots[key.Bits];
+		std::call_once(slot.Once, [&state, &slot, key]() { slot.Pipeline = state.Build(key); });
+		return slot.Pipeline;
+	}
+
+private:
+	SharedPtr<State> Current;
+};
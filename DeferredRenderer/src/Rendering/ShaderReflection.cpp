@@ -0,0 +1,206 @@
+#include "ShaderReflection.h"
+#include "Core/Exception.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+namespace
+{
+	constexpr UINT32 MakeFourCC(char a, char b, char c, char d)
+	{
+		return static_cast<UINT32>(a) | static_cast<UINT32>(b) << 8 | static_cast<UINT32>(c) << 16 | static_cast<UINT32>(d) << 24;
+	}
+
+	// Newer compilers move the reflection data out of the DXIL part into the statistics part
+	constexpr UINT32 StatisticsPart = MakeFourCC('S', 'T', 'A', 'T');
+	constexpr UINT32 DxilPart = MakeFourCC('D', 'X', 'I', 'L');
+
+	std::optional<D3D12_DESCRIPTOR_RANGE_TYPE> GetRangeType(D3D_SHADER_INPUT_TYPE type, bool& buffer)
+	{
+		buffer = false;
+		switch (type)
+		{
+		case D3D_SIT_CBUFFER:
+			return D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
+		case D3D_SIT_STRUCTURED:
+		case D3D_SIT_BYTEADDRESS:
+			buffer = true;
+			return D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+		case D3D_SIT_TBUFFER:
+		case D3D_SIT_TEXTURE:
+		case D3D_SIT_RTACCELERATIONSTRUCTURE:
+			return D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+		case D3D_SIT_UAV_RWSTRUCTURED:
+		case D3D_SIT_UAV_RWBYTEADDRESS:
+			buffer = true;
+			return D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+		case D3D_SIT_UAV_RWTYPED:
+		case D3D_SIT_UAV_APPEND_STRUCTURED:
+		case D3D_SIT_UAV_CONSUME_STRUCTURED:
+		case D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER:
+			return D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+		case D3D_SIT_SAMPLER:
+			return D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
+		default:
+			return std::nullopt;
+		}
+	}
+
+	// Bytes the members of a constant buffer span - the padding to 16 bytes is not sent as root constants
+	UINT GetConstantsSize(ID3D12ShaderReflection* reflection, const char* name)
+	{
+		ID3D12ShaderReflectionConstantBuffer* buffer = reflection->GetConstantBufferByName(name);
+		D3D12_SHADER_BUFFER_DESC desc{};
+		if (FAILED(buffer->GetDesc(&desc)))
+			return 0;
+
+		UINT size = 0;
+		for (UINT i = 0; i < desc.Variables; i++)
+		{
+			D3D12_SHADER_VARIABLE_DESC variable{};
+			if (SUCCEEDED(buffer->GetVariableByIndex(i)->GetDesc(&variable)))
+				size = std::max(size, variable.StartOffset + variable.Size);
+		}
+		return size ? size : desc.Size;
+	}
+
+	D3D12_ROOT_PARAMETER_TYPE GetParameterType(const ShaderBinding& binding)
+	{
+		if (binding.Count != 1)
+			return D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+
+		UINT values = (binding.ConstantsSize + 3) / 4;
+		if (binding.Type == D3D12_DESCRIPTOR_RANGE_TYPE_CBV && values > 0 && values <= RootSignatureLayout::MaxRootConstants)
+			return D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+		if (binding.Buffer && binding.Type == D3D12_DESCRIPTOR_RANGE_TYPE_SRV)
+			return D3D12_ROOT_PARAMETER_TYPE_SRV;
+		if (binding.Buffer && binding.Type == D3D12_DESCRIPTOR_RANGE_TYPE_UAV)
+			return D3D12_ROOT_PARAMETER_TYPE_UAV;
+		return D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+	}
+
+	// Tables, then root descriptors, then constants
+	int GetParameterRank(D3D12_ROOT_PARAMETER_TYPE type)
+	{
+		switch (type)
+		{
+		case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE: return 0;
+		case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS: return 2;
+		default: return 1;
+		}
+	}
+}
+
+UniquePtr<DxcShaderReflector> DxcShaderReflector::Create()
+{
+	auto reflector = MakeUnique<DxcShaderReflector>();
+	if (FAILED(reflector->Dll.Initialize()))
+		return nullptr;
+	return reflector;
+}
+
+std::optional<ShaderBindings> DxcShaderReflector::Reflect(const D3D12_SHADER_BYTECODE& bytecode, std::string& errors)
+{
+	// DXC objects are not thread safe - every call makes its own
+	IDxcLibraryPtr library;
+	IDxcContainerReflectionPtr container;
+	GRAPHICS_ASSERT(Dll.CreateInstance(CLSID_DxcLibrary, &library));
+	GRAPHICS_ASSERT(Dll.CreateInstance(CLSID_DxcContainerReflection, &container));
+
+	IDxcBlobEncodingPtr blob;
+	GRAPHICS_ASSERT(library->CreateBlobWithEncodingOnHeapCopy(bytecode.pShaderBytecode, static_cast<UINT32>(bytecode.BytecodeLength), 0, &blob));
+	if (FAILED(container->Load(blob)))
+	{
+		errors = "Not a DXIL container";
+		return std::nullopt;
+	}
+
+	UINT32 part = 0;
+	if (FAILED(container->FindFirstPartKind(StatisticsPart, &part)) && FAILED(container->FindFirstPartKind(DxilPart, &part)))
+	{
+		errors = "No DXIL part in the container";
+		return std::nullopt;
+	}
+
+	ID3D12ShaderReflectionPtr reflection;
+	if (FAILED(container->GetPartReflection(part, IID_PPV_ARGS(&reflection))))
+	{
+		errors = "No reflection data - the shader was compiled with -Qstrip_reflect";
+		return std::nullopt;
+	}
+
+	D3D12_SHADER_DESC desc{};
+	GRAPHICS_ASSERT(reflection->GetDesc(&desc));
+
+	ShaderBindings bindings;
+	for (UINT i = 0; i < desc.BoundResources; i++)
+	{
+		D3D12_SHADER_INPUT_BIND_DESC bind{};
+		GRAPHICS_ASSERT(reflection->GetResourceBindingDesc(i, &bind));
+
+		ShaderBinding binding;
+		auto type = GetRangeType(bind.Type, binding.Buffer);
+		if (!type)
+		{
+			errors = std::string("Unsupported resource type of ") + bind.Name;
+			return std::nullopt;
+		}
+
+		binding.Name = bind.Name;
+		binding.Type = *type;
+		binding.Register = bind.BindPoint;
+		binding.Space = bind.Space;
+		binding.Count = bind.BindCount == UINT_MAX ? 0 : bind.BindCount;
+		if (binding.Type == D3D12_DESCRIPTOR_RANGE_TYPE_CBV && binding.Count == 1)
+			binding.ConstantsSize = GetConstantsSize(reflection, bind.Name);
+		bindings.push_back(std::move(binding));
+	}
+	return bindings;
+}
+
+void RootSignatureLayout::Add(const ShaderBindings& bindings, D3D12_SHADER_VISIBILITY visibility)
+{
+	for (const auto& binding : bindings)
+	{
+		auto it = std::ranges::find_if(Parameters, [&binding](const Parameter& param)
+			{
+				return param.Binding.Type == binding.Type && param.Binding.Space == binding.Space && param.Binding.Register == binding.Register;
+			});
+
+		if (it == Parameters.end())
+		{
+			Parameters.push_back({ binding, D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE, visibility });
+			continue;
+		}
+
+		// Used by several stages - one parameter visible to all of them covering what each declares
+		ShaderBinding& merged = it->Binding;
+		merged.Count = (merged.Count == 0 || binding.Count == 0) ? 0 : std::max(merged.Count, binding.Count);
+		merged.ConstantsSize = std::max(merged.ConstantsSize, binding.ConstantsSize);
+		merged.Buffer = merged.Buffer && binding.Buffer;
+		if (it->Visibility != visibility)
+			it->Visibility = D3D12_SHADER_VISIBILITY_ALL;
+	}
+
+	for (auto& param : Parameters)
+		param.Type = GetParameterType(param.Binding);
+
+	std::ranges::sort(Parameters, {}, [](const Parameter& param)
+		{
+			return std::make_tuple(GetParameterRank(param.Type), param.Binding.Type, param.Binding.Space, param.Binding.Register);
+		});
+}
+
+UINT RootSignatureLayout::GetSlot(const std::string& name) const
+{
+	auto it = std::ranges::find(Parameters, name, [](const Parameter& param) -> const std::string& { return param.Binding.Name; });
+	if (it == Parameters.end())
+		throw std::runtime_error("No shader of the root signature uses " + name);
+	return static_cast<UINT>(it - Parameters.begin());
+}
+
+UINT RootSignatureLayout::GetTableCount() const
+{
+	return static_cast<UINT>(std::ranges::count(Parameters, D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE, &Parameter::Type));
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <optional>
+
+// Resource a shader uses, as reflected from its DXIL. Declared but unused resources are
+// optimized out by the compiler and do not show up
+struct ShaderBinding
+{
+	std::string Name;
+	D3D12_DESCRIPTOR_RANGE_TYPE Type = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+	UINT Register = 0;
+	UINT Space = 0;
+	UINT Count = 1;				// 0 for unbounded arrays
+	UINT ConstantsSize = 0;		// Bytes a constant buffer's members span, 0 for other types
+	bool Buffer = false;		// Structured or raw buffer - may be bound as a root descriptor
+};
+using ShaderBindings = std::vector<ShaderBinding>;
+
+// Reads the bindings out of compiled shaders. DxcShaderReflector asks DXC's container reflection,
+// a stand-in can hand out fixed bindings so layouts are derived without a compiler
+class ShaderReflector
+{
+public:
+	virtual ~ShaderReflector() = default;
+
+	// nullopt when the bytecode holds no reflection data, errors then says why
+	virtual std::optional<ShaderBindings> Reflect(const D3D12_SHADER_BYTECODE& bytecode, std::string& errors) = 0;
+};
+
+class DxcShaderReflector : public ShaderReflector
+{
+public:
+	// nullptr when dxcompiler cannot be loaded
+	static UniquePtr<DxcShaderReflector> Create();
+
+	std::optional<ShaderBindings> Reflect(const D3D12_SHADER_BYTECODE& bytecode, std::string& errors) override;
+
+private:
+	dxc::DxcDllSupport Dll;
+};
+
+// Smallest root signature covering the shaders of one pipeline. Bindings used by several stages
+// are merged, each becomes one root parameter:
+//  - constant buffers of at most MaxRootConstants values become root constants
+//  - single structured/raw buffers become root descriptors
+//  - everything else gets a descriptor table of its own with exactly the declared range
+// Tables come first, then root descriptors, then constants, each ordered by type, space and register.
+// The order only depends on the bindings, so passes can keep their root slots as constants
+class RootSignatureLayout
+{
+public:
+	// Larger constant buffers stay behind a descriptor - the whole signature only has 64 values
+	static constexpr UINT MaxRootConstants = 16;
+
+	struct Parameter
+	{
+		ShaderBinding Binding;
+		D3D12_ROOT_PARAMETER_TYPE Type = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+		D3D12_SHADER_VISIBILITY Visibility = D3D12_SHADER_VISIBILITY_ALL;
+	};
+
+	// visibility: stage the bindings were reflected from
+	void Add(const ShaderBindings& bindings, D3D12_SHADER_VISIBILITY visibility);
+
+	// Root parameter index of the binding, throws when no shader uses it
+	UINT GetSlot(const std::string& name) const;
+	UINT GetTableCount() const;
+	inline const std::vector<Parameter>& GetParameters() const { return Parameters; }
+
+private:
+	std::vector<Parameter> Parameters;
+};
@@ -34,22 +34,52 @@ struct PipelineConstants
 	float IntensitySSAO;
 };
 
+// Actor data lives in a structured buffer, which packs tightly in HLSL - padding is spelled out
 struct ALIGNAS(16) MaterialData
 {
 	float3 MatericalColor;
 	float SpecularIntensity;
 	float Shininess;
 	float Reflectiveness;
+	vec2 Padding;
 };
 
 struct ActorData
 {
 	mat4x4 Model;
-	mat4x4 ModelView;
-	ALIGNAS(16) int KdID;
+	// Mesh positions are UNORM16 in the mesh bounds - decoded as PositionOffset + position * PositionScale
+	vec3 PositionOffset;
+	int KdID;
+	vec3 PositionScale;
 	int KnID;
 	int KsID;
-	ALIGNAS(16) MaterialData Material;
+	vec3 Padding;
+	MaterialData Material;
+};
+
+// Cluster of a static mesh, its triangles are contiguous in the shared index buffer. Bounds are in the
+// mesh space of the actor drawing it, the layout is that of a StructuredBuffer element so a compute pass
+// can cull the same data as the CPU
+struct MeshletData
+{
+	vec3 Center;			// Bounding sphere
+	float Radius;
+	vec3 BoundsMin;
+	UINT FirstIndex;		// Into the shared index buffer
+	vec3 BoundsMax;
+	UINT TriangleCount;
+	// Every triangle faces away from cameras where dot(normalize(ConeApex - camera), ConeAxis) >= ConeCutoff.
+	// Clusters without a usable cone have a zero axis and never pass
+	vec3 ConeApex;
+	float ConeCutoff;
+	vec3 ConeAxis;
+	UINT VertexCount;
+};
+
+// Root constants of a draw
+struct DrawConstants
+{
+	UINT ActorIndex;
 };
 
 struct DirLightData
@@ -9,6 +9,11 @@ SamplerState smplr : register(s0);
 ConstantBuffer<PipelineConstants> glConstants[] : register(b0, space0);
 static PipelineConstants globalConstants = glConstants[0];
 
+// Set to 0 or 1 by the permutation build, the project's shader build keeps the runtime switch
+#ifndef SSR
+#define SSR globalConstants.SSREnabled
+#endif
+
 float4 main(float4 position : SV_Position) : SV_TARGET
 {
     uint width, height, noMips;
@@ -20,7 +25,7 @@ float4 main(float4 position : SV_Position) : SV_TARGET
     float4 orgColor = OriginalColor.Sample(smplr, texCoords);
     float4 reflColor = ReflectionColor.Sample(smplr, texCoords);
     
-    if(!globalConstants.SSREnabled)
+    if (!SSR)
         return orgColor;
 
     float3 color = lerp(orgColor.rgb, reflColor.rgb, reflColor.a);
@@ -3,9 +3,11 @@
 
 Texture2D<float4> Textures[] : register(t0, space0);
 ConstantBuffer<PipelineConstants> glConstants[] : register(b0, space0);
-ConstantBuffer<ActorData> actorData : register(b0, space200);
+StructuredBuffer<ActorData> actors : register(t0, space200);
+ConstantBuffer<DrawConstants> drawConstants : register(b0, space200);
 
 static PipelineConstants globalConstants = glConstants[0];
+static ActorData actorData = actors[drawConstants.ActorIndex];
 SamplerState smplr : register(s0);
     
 Texture2D<float4> getTexture(uint texID)
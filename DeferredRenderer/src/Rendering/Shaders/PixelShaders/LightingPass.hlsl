@@ -8,6 +8,11 @@ SamplerState smplr : register(s0);
 static PipelineConstants globalConstants = glConstants[0];
 static DirLightData Sun = glLights[0];
 
+// Set to 0 or 1 by the permutation build, the project's shader build keeps the runtime switch
+#ifndef SSAO
+#define SSAO globalConstants.SSAOEnabled
+#endif
+
 // attenuation constants for sunlight
 static const float attConst = 1.0f;
 static const float attLin = 0.05f;
@@ -64,10 +69,11 @@ float4 main(float4 position : SV_Position) : SV_TARGET
     float3 specular = length(matSpecular.xyz) == 0.0f ? calcSpecular(posView.xyz, lightDir, normal, matSpecular.a) 
     : getSpecularFromTexture(posView.xyz, lightDir, normal, matSpecular);
     
-    float4 occlusion = AmbientOcclusion.Sample(smplr, texCoords);
+    float4 color = float4(saturate(diffuse + Sun.Ambient) * matDiffuse.rgb + attLin * specular, 1.0f);
     
-    if (globalConstants.SSAOEnabled)
-        return float4(saturate(diffuse + Sun.Ambient) * matDiffuse.rgb + attLin * specular, 1.0f) * occlusion;
+    // The occlusion target is only written while SSAO runs - with the passes culled it holds stale data
+    if (SSAO)
+        color *= AmbientOcclusion.Sample(smplr, texCoords);
     
-    return float4(saturate(diffuse + Sun.Ambient) * matDiffuse.rgb + attLin * specular, 1.0f);
+    return color;
 }
\ No newline at end of file
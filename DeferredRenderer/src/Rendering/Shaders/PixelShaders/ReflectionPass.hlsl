@@ -140,7 +140,8 @@ float4 main(float4 position : SV_Position) : SV_Target
     float reflectiveness = Positions.Sample(smplr, texCoords).a;
     float4 originalColor = PixelsColor.Sample(smplr, texCoords);
     
-    if (reflectiveness == 0 || length(normalView) == 0.0f || !globalConstants.SSREnabled)
+    // The graph culls this pass while SSR is disabled
+    if (reflectiveness == 0 || length(normalView) == 0.0f)
         discard;
     
     float4 positionScreen = float4(0, 0, 0, 0);
@@ -10,11 +10,15 @@ struct PSInput
     float4 position : SV_POSITION;
 };
 
-PSInput main(float3 position : POSITION,  float3 normal : NORMAL, float3 tangent : TANGENT, float3 bitangent : BITANGENT, 
-float2 texCoords : TEXCOORD)
+PSInput main(float4 packedPosition : POSITION, float2 packedNormal : NORMAL, float2 packedTangent : TANGENT, float2 texCoords : TEXCOORD)
 {
+    float3 position = decodePosition(packedPosition);
+    float3 normal = decodeOctahedral(packedNormal);
+    float3 tangent = decodeOctahedral(packedTangent);
+    float3 bitangent = decodeBitangent(normal, tangent, packedPosition);
+
     PSInput result;
-    float4x4 modelView = actorData.ModelView;
+    float4x4 modelView = mul(globalConstants.View, actorData.Model);
     float4 posView = mul(modelView, float4(position, 1.0f));
     
     result.posView = posView.xyz;
@@ -14,4 +14,24 @@ float3x3 calcTBNmatrix(in float3 normal, in float3 tangent, float3 bitangent)
     float3x3 TBN = float3x3(handedness * normalize(tangent), normalize(bitangent), normalize(normal));
     TBN = transpose(TBN);
     return TBN;
+}
+
+// Static mesh vertices are packed, see PackedVertex in VertexPacking.h
+float3 decodePosition(float4 packedPosition)
+{
+    return actorData.PositionOffset + packedPosition.xyz * actorData.PositionScale;
+}
+
+float3 decodeOctahedral(float2 encoded)
+{
+    float3 n = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-n.z);
+    n.xy += select(n.xy >= 0.0f, -t, t);
+    return normalize(n);
+}
+
+// packedPosition.w holds the sign of the bitangent as 0 or 1
+float3 decodeBitangent(float3 normal, float3 tangent, float4 packedPosition)
+{
+    return cross(normal, tangent) * (packedPosition.w * 2.0f - 1.0f);
 }
\ No newline at end of file
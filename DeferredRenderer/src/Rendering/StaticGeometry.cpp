@@ -0,0 +1,213 @@
+#include "StaticGeometry.h"
+#include "Core/Exception.h"
+
+#include <iomanip>
+#include <limits>
+
+StaticGeometry::StaticGeometry(bool analyze)
+	:Analyze(analyze)
+{}
+
+MeshRange StaticGeometry::Add(std::vector<StaticVertex> vertices, std::vector<uint32_t> indices, const std::string& name)
+{
+	ASSERT(!VertexResource, "Static geometry was already uploaded");
+	ASSERT(indices.size() % 3 == 0, "Static meshes are triangle lists");
+
+	auto report = OptimizeMesh(vertices, indices, Analyze);
+	if (Analyze)
+		Reports.push_back({ name, static_cast<uint32_t>(indices.size() / 3), report });
+
+	MeshRange range;
+	range.BaseVertex = static_cast<uint32_t>(Vertices.size());
+	range.Quantization = PositionQuantization::Fit(vertices);
+
+	// Every level is simplified from the full mesh, so its error is measured against that. The vertices
+	// stay in fetch order of the full mesh, only the triangles of a level are reordered
+	std::vector<std::vector<uint32_t>> levels;
+	std::vector<float> errors{ 0.0f };
+	levels.push_back(std::move(indices));
+	float maxError = glm::length(range.Quantization.Scale) * MaxLodError;
+	while (levels.size() < MaxMeshLods)
+	{
+		size_t previous = levels.back().size();
+		size_t target = previous / 6 * 3;
+		if (target / 3 < MinLodTriangles) break;
+
+		float error = 0.0f;
+		auto level = SimplifyMesh(vertices, levels.front(), target, maxError, error);
+		if (level.size() > previous * 3 / 4) break;
+
+		auto clusters = OptimizeVertexCache(level, vertices.size());
+		OptimizeOverdraw(level, vertices, clusters);
+		levels.push_back(std::move(level));
+		errors.push_back(error);
+	}
+
+	std::vector<PackedVertex> packed;
+	packed.reserve(vertices.size());
+	for (const auto& vertex : vertices)
+		packed.push_back(PackVertex(vertex, range.Quantization));
+	Stats.Error += MeasurePackingError(vertices, packed, range.Quantization);
+
+	// Bounds from the positions the vertex shader decodes, the culling has to hold for those
+	std::vector<StaticVertex> decoded;
+	decoded.reserve(packed.size());
+	for (const auto& vertex : packed)
+		decoded.push_back(UnpackVertex(vertex, range.Quantization));
+
+	glm::vec3 low(std::numeric_limits<float>::max()), high(std::numeric_limits<float>::lowest());
+	for (const auto& vertex : decoded)
+	{
+		low = glm::min(low, vertex.Position);
+		high = glm::max(high, vertex.Position);
+	}
+	range.Center = (low + high) * 0.5f;
+	for (const auto& vertex : decoded)
+		range.Radius = std::max(range.Radius, glm::length(vertex.Position - range.Center));
+
+	range.LodCount = static_cast<uint32_t>(levels.size());
+	for (uint32_t i = 0; i < range.LodCount; i++)
+	{
+		const auto& level = levels[i];
+		auto meshlets = BuildMeshlets(decoded, level);
+
+		auto& lod = range.Lods[i];
+		lod.FirstIndex = static_cast<uint32_t>(Indices.size());
+		lod.IndexCount = static_cast<uint32_t>(level.size());
+		lod.FirstMeshlet = static_cast<uint32_t>(Meshlets.size());
+		lod.MeshletCount = static_cast<uint32_t>(meshlets.size());
+		lod.Error = errors[i];
+
+		for (auto& meshlet : meshlets)
+		{
+			meshlet.FirstIndex += lod.FirstIndex;
+			Stats.ConeMeshlets += meshlet.ConeCutoff < 1.0f;
+		}
+		Meshlets.insert(Meshlets.end(), meshlets.begin(), meshlets.end());
+		Indices.insert(Indices.end(), level.begin(), level.end());
+
+		Stats.Meshlets += lod.MeshletCount;
+		Stats.LodMeshes[i]++;
+		Stats.LodTriangles[i] += lod.IndexCount / 3;
+	}
+
+	Vertices.insert(Vertices.end(), packed.begin(), packed.end());
+	MaxMeshVertices = std::max(MaxMeshVertices, static_cast<uint32_t>(vertices.size()));
+
+	Stats.Meshes++;
+	return range;
+}
+
+uint32_t SelectLod(const MeshRange& mesh, uint32_t current, float pixelsPerUnit)
+{
+	for (uint32_t i = mesh.LodCount; i-- > 1;)
+	{
+		float limit = i > current ? LodPixelError * (1.0f - LodHysteresis) : LodPixelError;
+		if (mesh.Lods[i].Error * pixelsPerUnit <= limit)
+			return i;
+	}
+	return 0;
+}
+
+void StaticGeometry::Upload()
+{
+	ASSERT(!VertexResource, "Static geometry was already uploaded");
+	if (Vertices.empty()) return;
+
+	// Indices are relative to their mesh, so only the largest mesh decides
+	bool shortIndices = MaxMeshVertices <= std::numeric_limits<uint16_t>::max() + 1u;
+	const uint32_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+	const uint64_t vertexBytes = sizeof(PackedVertex) * Vertices.size();
+	const uint64_t indexBytes = uint64_t(indexSize) * Indices.size();
+
+	VertexResource = CreateStaticBuffer(Vertices.data(), vertexBytes);
+	if (shortIndices)
+	{
+		std::vector<uint16_t> narrowed(Indices.begin(), Indices.end());
+		IndexResource = CreateStaticBuffer(narrowed.data(), indexBytes);
+	}
+	else
+		IndexResource = CreateStaticBuffer(Indices.data(), indexBytes);
+
+	VertexView = { VertexResource->GetGPUVirtualAddress(), static_cast<UINT>(vertexBytes), sizeof(PackedVertex) };
+	IndexView = { IndexResource->GetGPUVirtualAddress(), static_cast<UINT>(indexBytes), shortIndices ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT };
+
+	Stats.Vertices = static_cast<uint32_t>(Vertices.size());
+	Stats.Indices = static_cast<uint32_t>(Indices.size());
+	Stats.IndexSize = indexSize;
+	Stats.Bytes = vertexBytes + indexBytes;
+
+	// The upload service copied the data into its staging ring
+	Vertices = {};
+	Indices = {};
+}
+
+void StaticGeometry::Bind(CommandContext& cmdList) const
+{
+	cmdList.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	cmdList.IASetVertexBuffers(0, 1, &VertexView);
+	cmdList.IASetIndexBuffer(&IndexView);
+}
+
+void StaticGeometry::Dump(std::ostream& os) const
+{
+	auto toKB = [](uint64_t bytes) { return static_cast<double>(bytes) / 1024.0; };
+	uint64_t unpacked = uint64_t(sizeof(StaticVertex)) * Stats.Vertices + uint64_t(sizeof(uint32_t)) * Stats.Indices;
+
+	os << "Static geometry: " << Stats.Meshes << " meshes, " << Stats.Vertices << " vertices, " << Stats.Indices << " indices\n";
+	os << "  " << sizeof(PackedVertex) << " bytes per vertex (" << sizeof(StaticVertex) << " unpacked), "
+	   << Stats.IndexSize << " bytes per index (4 unpacked)\n";
+	os << "  " << toKB(Stats.Bytes) << " KB (" << toKB(unpacked) << " KB unpacked)\n";
+	os << "  Round trip error: position " << Stats.Error.Position << ", normal " << Stats.Error.NormalDegrees
+	   << " deg, tangent " << Stats.Error.TangentDegrees << " deg, uv " << Stats.Error.TexCoords << "\n";
+
+	if (Stats.Meshlets)
+	{
+		uint64_t vertices = 0;
+		for (const auto& meshlet : Meshlets)
+			vertices += meshlet.VertexCount;
+		os << "  " << Stats.Meshlets << " meshlets of at most " << MaxMeshletVertices << " vertices and " << MaxMeshletTriangles
+		   << " triangles, " << static_cast<double>(vertices) / Stats.Meshlets << " vertices and "
+		   << Stats.Indices / 3.0 / Stats.Meshlets << " triangles on average, " << Stats.ConeMeshlets << " with a normal cone\n";
+	}
+	for (uint32_t i = 0; i < MaxMeshLods && Stats.LodMeshes[i]; i++)
+		os << "  LOD " << i << ": " << Stats.LodMeshes[i] << " meshes, " << Stats.LodTriangles[i] << " triangles\n";
+
+	if (Reports.empty()) return;
+
+	// Totals weigh every mesh by its triangles
+	MeshOptimizationReport total;
+	uint64_t triangles = 0;
+	auto print = [&os](const std::string& name, const MeshOptimizationReport& report)
+		{
+			os << "  " << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(3)
+			   << " ACMR " << report.CacheBefore.ACMR << " -> " << report.CacheAfter.ACMR
+			   << ", ATVR " << report.CacheBefore.ATVR << " -> " << report.CacheAfter.ATVR
+			   << ", overdraw " << report.OverdrawBefore << " -> " << report.OverdrawAfter << "\n";
+		};
+
+	os << "Mesh reordering (FIFO cache of " << DefaultVertexCacheSize << "):\n";
+	for (const auto& [name, meshTriangles, report] : Reports)
+	{
+		print(name.empty() ? "<unnamed>" : name, report);
+
+		float weight = static_cast<float>(meshTriangles);
+		total.CacheBefore.ACMR += report.CacheBefore.ACMR * weight;
+		total.CacheAfter.ACMR += report.CacheAfter.ACMR * weight;
+		total.CacheBefore.ATVR += report.CacheBefore.ATVR * weight;
+		total.CacheAfter.ATVR += report.CacheAfter.ATVR * weight;
+		total.OverdrawBefore += report.OverdrawBefore * weight;
+		total.OverdrawAfter += report.OverdrawAfter * weight;
+		triangles += meshTriangles;
+	}
+
+	float scale = triangles ? 1.0f / triangles : 0.0f;
+	total.CacheBefore.ACMR *= scale;
+	total.CacheAfter.ACMR *= scale;
+	total.CacheBefore.ATVR *= scale;
+	total.CacheAfter.ATVR *= scale;
+	total.OverdrawBefore *= scale;
+	total.OverdrawAfter *= scale;
+	print("Total", total);
+	os << std::defaultfloat;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "Core/Core.h"
+#include "VertexPacking.h"
+#include "MeshOptimization.h"
+#include "Meshlets.h"
+#include "MeshSimplification.h"
+#include "CommandContext.h"
+
+#include <array>
+#include <ostream>
+
+// The full mesh and up to three simplified levels
+constexpr uint32_t MaxMeshLods = 4;
+
+// One level of detail of a mesh - the arguments of its indexed draw and the meshlets covering its indices
+struct MeshLod
+{
+	uint32_t FirstIndex = 0;
+	uint32_t IndexCount = 0;
+	uint32_t FirstMeshlet = 0;
+	uint32_t MeshletCount = 0;
+	float Error = 0.0f;			// Bound on how far the level is off the full mesh, in mesh units
+};
+
+// Where a mesh lives in the shared buffers and how to decode its positions. Every level indexes
+// the same vertices from BaseVertex
+struct MeshRange
+{
+	uint32_t BaseVertex = 0;
+	PositionQuantization Quantization;
+	glm::vec3 Center{ 0.0f };	// Bounding sphere in mesh space
+	float Radius = 0.0f;
+	uint32_t LodCount = 0;
+	std::array<MeshLod, MaxMeshLods> Lods;
+};
+
+// Levels switch where their error covers LodPixelError pixels. A coarser level is only taken once
+// its error is LodHysteresis below that, so a camera resting on the threshold does not flicker
+constexpr float LodPixelError = 1.0f;
+constexpr float LodHysteresis = 0.25f;
+
+// The coarsest level fine enough for the view. pixelsPerUnit: size of one mesh unit on screen at the
+// nearest the mesh can be
+uint32_t SelectLod(const MeshRange& mesh, uint32_t current, float pixelsPerUnit);
+
+struct StaticGeometryStats
+{
+	uint32_t Meshes = 0;
+	uint32_t Vertices = 0;
+	uint32_t Indices = 0;
+	uint32_t Meshlets = 0;
+	uint32_t ConeMeshlets = 0;	// Meshlets with a normal cone, the others are never culled as back facing
+	std::array<uint32_t, MaxMeshLods> LodMeshes{};		// Meshes that have each level
+	std::array<uint32_t, MaxMeshLods> LodTriangles{};	// Triangles of each level over all meshes
+	uint32_t IndexSize = 0;		// Bytes per index, 2 when every mesh has at most 65536 vertices
+	uint64_t Bytes = 0;			// Vertex and index buffer together
+	PackingError Error;			// Worst round trip error over all meshes
+};
+
+// Cache and overdraw simulation of one mesh before and after the import reordering
+struct MeshReport
+{
+	std::string Name;
+	uint32_t Triangles = 0;
+	MeshOptimizationReport Optimization;
+};
+
+// The vertices and indices of every static mesh in one vertex and one index buffer in a default heap.
+// Meshes are appended while loading, Upload places both buffers and queues a single staging copy of
+// each. Indices stay relative to their mesh and draws offset them by BaseVertex, so passes bind the
+// buffers once and draw every actor from its MeshRange.
+// Meshes are reordered for the vertex cache, overdraw and vertex fetch when added, simplified into
+// lower levels of detail, then packed to PackedVertex and split into meshlets. The levels follow
+// their mesh in the index buffer. Indices are 16-bit unless a mesh needs more
+class StaticGeometry
+{
+public:
+	// Each level aims for half the triangles of the one before. Levels stop at MaxLodError times the
+	// mesh diagonal, when one would keep more than three quarters of the one before or fall below MinLodTriangles
+	static constexpr float MaxLodError = 0.05f;
+	static constexpr uint32_t MinLodTriangles = 32;
+
+	// analyze: simulate every mesh before and after the reordering, see GetReports
+	explicit StaticGeometry(bool analyze = false);
+
+	MeshRange Add(std::vector<StaticVertex> vertices, std::vector<uint32_t> indices, const std::string& name = {});
+	// Creates the GPU buffers and drops the CPU copy of the vertices and indices - no meshes can be
+	// added afterwards. The meshlets stay, actors cull them every frame
+	void Upload();
+
+	// Sets the topology and both buffers
+	void Bind(CommandContext& cmdList) const;
+
+	inline const std::vector<MeshletData>& GetMeshlets() const { return Meshlets; }
+	inline const StaticGeometryStats& GetStats() const { return Stats; }
+	inline const std::vector<MeshReport>& GetReports() const { return Reports; }
+	// Sizes against the unpacked format, the round trip error of the packing and the mesh reports
+	void Dump(std::ostream& os) const;
+
+private:
+	std::vector<PackedVertex> Vertices;
+	std::vector<uint32_t> Indices;
+	std::vector<MeshletData> Meshlets;
+	uint32_t MaxMeshVertices = 0;
+	bool Analyze = false;
+
+	ID3D12ResourcePtr VertexResource;
+	ID3D12ResourcePtr IndexResource;
+	D3D12_VERTEX_BUFFER_VIEW VertexView{};
+	D3D12_INDEX_BUFFER_VIEW IndexView{};
+
+	StaticGeometryStats Stats;
+	std::vector<MeshReport> Reports;
+};
@@ -0,0 +1,80 @@
+#include "Test.h"
+#include "Rendering/StaticGeometry.h"
+
+namespace
+{
+	// Every level twice as coarse as the one before
+	MeshRange FourLevels()
+	{
+		MeshRange mesh;
+		mesh.LodCount = 4;
+		const float errors[] = { 0.0f, 0.01f, 0.02f, 0.04f };
+		for (uint32_t i = 0; i < mesh.LodCount; i++)
+			mesh.Lods[i].Error = errors[i];
+		return mesh;
+	}
+
+	// pixelsPerUnit at which the error of a level covers pixels pixels
+	float PixelsPerUnit(const MeshRange& mesh, uint32_t level, float pixels)
+	{
+		return pixels / mesh.Lods[level].Error;
+	}
+}
+
+TEST_CASE(LodStaysInsideTheHysteresisBand)
+{
+	const MeshRange mesh = FourLevels();
+	for (uint32_t level = 1; level < mesh.LodCount; level++)
+	{
+		// Between LodPixelError * (1 - LodHysteresis) and LodPixelError the current level is kept either way
+		float band = PixelsPerUnit(mesh, level, LodPixelError * (1.0f - LodHysteresis * 0.5f));
+		CHECK_EQ(SelectLod(mesh, level - 1, band), level - 1);
+		CHECK_EQ(SelectLod(mesh, level, band), level);
+
+		// Below the band the coarser level is taken, above it the finer one comes back
+		float coarse = PixelsPerUnit(mesh, level, LodPixelError * (1.0f - LodHysteresis) * 0.99f);
+		float fine = PixelsPerUnit(mesh, level, LodPixelError * 1.01f);
+		CHECK_EQ(SelectLod(mesh, level - 1, coarse), level);
+		CHECK_EQ(SelectLod(mesh, level, fine), level - 1);
+	}
+
+	// Far enough away nothing is finer than the coarsest level, close up only the full mesh is
+	CHECK_EQ(SelectLod(mesh, 0, 0.0f), mesh.LodCount - 1);
+	CHECK_EQ(SelectLod(mesh, mesh.LodCount - 1, 1e6f), 0u);
+}
+
+TEST_CASE(LodThresholdsAreMonotonic)
+{
+	const MeshRange mesh = FourLevels();
+
+	// Moving away only ever coarsens, moving back only ever refines, and each level is left
+	// closer up than where it was entered
+	std::vector<float> entered(mesh.LodCount, 0.0f);
+	uint32_t lod = 0;
+	for (float pixelsPerUnit = 200.0f; pixelsPerUnit > 1.0f; pixelsPerUnit *= 0.99f)
+	{
+		uint32_t next = SelectLod(mesh, lod, pixelsPerUnit);
+		CHECK(next >= lod);
+		if (next != lod) entered[next] = pixelsPerUnit;
+		lod = next;
+	}
+	CHECK_EQ(lod, mesh.LodCount - 1);
+
+	std::vector<float> left(mesh.LodCount, 0.0f);
+	for (float pixelsPerUnit = 1.0f; pixelsPerUnit < 200.0f; pixelsPerUnit *= 1.01f)
+	{
+		uint32_t next = SelectLod(mesh, lod, pixelsPerUnit);
+		CHECK(next <= lod);
+		if (next != lod) left[lod] = pixelsPerUnit;
+		lod = next;
+	}
+	CHECK_EQ(lod, 0u);
+
+	for (uint32_t level = 1; level < mesh.LodCount; level++)
+	{
+		CHECK(entered[level] > 0.0f);
+		CHECK(left[level] > entered[level]);
+		// Coarser levels switch further away
+		if (level > 1) CHECK(entered[level] < entered[level - 1]);
+	}
+}
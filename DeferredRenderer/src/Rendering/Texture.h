@@ -2,10 +2,12 @@
 #include "Core/Core.h"
 #include "DirectXTex.h"
 
+class UploadService;
+
 class Texture
 {
 public:
-	Texture(ID3D12Device5Ptr device, ID3D12CommandQueuePtr cmdQueue, D3D12_CPU_DESCRIPTOR_HANDLE destDescriptor, const std::string& filename);
+	Texture(ID3D12Device5Ptr device, UploadService& uploads, D3D12_CPU_DESCRIPTOR_HANDLE destDescriptor, const std::string& filename);
 
 	inline uint32_t GetWidth() const { return (uint32_t)Image.GetMetadata().width; }
 	inline uint32_t GetHeight() const { return (uint32_t)Image.GetMetadata().height; }
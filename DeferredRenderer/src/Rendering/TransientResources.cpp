@@ -0,0 +1,76 @@
+#include "TransientResources.h"
+#include "Rendering/Utils.h"
+
+#include <algorithm>
+#include <numeric>
+
+bool TransientPlanner::LifetimesOverlap(const TransientLifetime& a, const TransientLifetime& b)
+{
+	return a.FirstUse <= b.LastUse && b.FirstUse <= a.LastUse;
+}
+
+AliasingPlan TransientPlanner::Plan(const std::vector<TransientLifetime>& lifetimes)
+{
+	const size_t count = lifetimes.size();
+
+	AliasingPlan plan;
+	plan.Offsets.assign(count, 0);
+	plan.Predecessors.assign(count, std::nullopt);
+	plan.IsAliased.assign(count, false);
+
+	for (const auto& lifetime : lifetimes)
+		plan.NaiveSize += align_to(lifetime.Alignment, lifetime.Size);
+
+	// Largest resources first - they are the hardest to fit into the gaps left by others
+	std::vector<size_t> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&lifetimes](size_t a, size_t b)
+					 {
+						 return lifetimes[a].Size > lifetimes[b].Size;
+					 });
+
+	std::vector<size_t> placed;
+	for (size_t index : order)
+	{
+		const auto& lifetime = lifetimes[index];
+
+		// Memory taken by resources alive at the same time, sorted by offset
+		std::vector<std::pair<uint64_t, uint64_t>> taken;
+		for (size_t other : placed)
+			if (LifetimesOverlap(lifetime, lifetimes[other]))
+				taken.emplace_back(plan.Offsets[other], plan.Offsets[other] + lifetimes[other].Size);
+		std::sort(taken.begin(), taken.end());
+
+		// First gap the resource fits in
+		uint64_t offset = 0;
+		for (const auto& [begin, end] : taken)
+		{
+			if (offset + lifetime.Size <= begin) break;
+			offset = std::max(offset, align_to(lifetime.Alignment, end));
+		}
+
+		plan.Offsets[index] = offset;
+		plan.HeapSize = std::max(plan.HeapSize, offset + lifetime.Size);
+		placed.push_back(index);
+	}
+
+	// Resources sharing memory never share a lifetime, so any memory overlap is an alias
+	for (size_t i = 0; i < count; i++)
+	{
+		std::vector<size_t> aliases;
+		for (size_t j = 0; j < count; j++)
+		{
+			if (i == j) continue;
+
+			bool memoryOverlaps = plan.Offsets[i] < plan.Offsets[j] + lifetimes[j].Size &&
+				plan.Offsets[j] < plan.Offsets[i] + lifetimes[i].Size;
+			if (memoryOverlaps) aliases.push_back(j);
+		}
+
+		plan.IsAliased[i] = !aliases.empty();
+		if (aliases.size() == 1)
+			plan.Predecessors[i] = aliases.front();
+	}
+
+	return plan;
+}
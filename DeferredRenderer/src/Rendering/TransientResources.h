@@ -0,0 +1,35 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <optional>
+
+// Lifetime of a transient resource in the sorted pass order of the render graph
+struct TransientLifetime
+{
+	uint64_t Size = 0;
+	uint64_t Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	uint32_t FirstUse = 0;
+	uint32_t LastUse = 0;
+};
+
+struct AliasingPlan
+{
+	// Byte offset of every resource in the shared heap, indexed like the input lifetimes
+	std::vector<uint64_t> Offsets;
+	// Resource whose memory is handed over when a resource becomes active. nullopt when the
+	// region is shared with more than one resource - the barrier then aliases any of them
+	std::vector<std::optional<size_t>> Predecessors;
+	// Whether the resource shares memory with any other resource at all
+	std::vector<bool> IsAliased;
+
+	uint64_t HeapSize = 0;	// Peak memory - size of the shared heap
+	uint64_t NaiveSize = 0;	// Memory needed with one allocation per resource
+};
+
+// Packs resources whose lifetimes never overlap into the same heap memory. Only offsets - the render
+// graph creates the heap and places the resources at them
+namespace TransientPlanner
+{
+	bool LifetimesOverlap(const TransientLifetime& a, const TransientLifetime& b);
+	AliasingPlan Plan(const std::vector<TransientLifetime>& lifetimes);
+}
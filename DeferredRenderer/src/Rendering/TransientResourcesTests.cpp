@@ -0,0 +1,144 @@
+#include "Test.h"
+#include "Rendering/TransientResources.h"
+
+#include <random>
+
+namespace
+{
+	constexpr uint64_t MB = 1024 * 1024;
+
+	TransientLifetime Lifetime(uint64_t size, uint32_t firstUse, uint32_t lastUse, uint64_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
+	{
+		return { size, alignment, firstUse, lastUse };
+	}
+
+	bool MemoryOverlaps(const AliasingPlan& plan, const std::vector<TransientLifetime>& lifetimes, size_t a, size_t b)
+	{
+		return plan.Offsets[a] < plan.Offsets[b] + lifetimes[b].Size && plan.Offsets[b] < plan.Offsets[a] + lifetimes[a].Size;
+	}
+
+	// What every plan has to hold, whatever the packing found
+	void CheckPlan(const AliasingPlan& plan, const std::vector<TransientLifetime>& lifetimes)
+	{
+		REQUIRE(plan.Offsets.size() == lifetimes.size());
+		REQUIRE(plan.Predecessors.size() == lifetimes.size());
+		REQUIRE(plan.IsAliased.size() == lifetimes.size());
+
+		uint64_t naive = 0;
+		for (size_t i = 0; i < lifetimes.size(); i++)
+		{
+			CHECK_EQ(plan.Offsets[i] % lifetimes[i].Alignment, 0u);
+			CHECK(plan.Offsets[i] + lifetimes[i].Size <= plan.HeapSize);
+			naive += (lifetimes[i].Size + lifetimes[i].Alignment - 1) / lifetimes[i].Alignment * lifetimes[i].Alignment;
+
+			bool aliased = false;
+			for (size_t j = 0; j < lifetimes.size(); j++)
+			{
+				if (i == j || !MemoryOverlaps(plan, lifetimes, i, j)) continue;
+
+				// Resources alive at the same time never share memory
+				CHECK(!TransientPlanner::LifetimesOverlap(lifetimes[i], lifetimes[j]));
+				aliased = true;
+			}
+			CHECK_EQ(plan.IsAliased[i], aliased);
+			if (plan.Predecessors[i])
+				CHECK(MemoryOverlaps(plan, lifetimes, i, *plan.Predecessors[i]));
+		}
+
+		CHECK_EQ(plan.NaiveSize, naive);
+		CHECK(plan.HeapSize <= plan.NaiveSize);
+	}
+}
+
+TEST_CASE(LifetimesTouchingInOnePassOverlap)
+{
+	CHECK(TransientPlanner::LifetimesOverlap(Lifetime(MB, 0, 2), Lifetime(MB, 2, 4)));
+	CHECK(TransientPlanner::LifetimesOverlap(Lifetime(MB, 1, 1), Lifetime(MB, 0, 3)));
+	CHECK(!TransientPlanner::LifetimesOverlap(Lifetime(MB, 0, 1), Lifetime(MB, 2, 3)));
+}
+
+TEST_CASE(DisjointLifetimesShareMemory)
+{
+	std::vector<TransientLifetime> lifetimes = { Lifetime(4 * MB, 0, 1), Lifetime(4 * MB, 2, 3) };
+	auto plan = TransientPlanner::Plan(lifetimes);
+	CheckPlan(plan, lifetimes);
+
+	CHECK_EQ(plan.HeapSize, 4 * MB);
+	CHECK_EQ(plan.NaiveSize, 8 * MB);
+	CHECK(plan.IsAliased[0] && plan.IsAliased[1]);
+	// The memory changes hands in both directions over a frame
+	CHECK(plan.Predecessors[0] == std::optional<size_t>(1));
+	CHECK(plan.Predecessors[1] == std::optional<size_t>(0));
+}
+
+TEST_CASE(OverlappingLifetimesGetTheirOwnMemory)
+{
+	std::vector<TransientLifetime> lifetimes = { Lifetime(4 * MB, 0, 2), Lifetime(2 * MB, 1, 3), Lifetime(MB, 2, 2) };
+	auto plan = TransientPlanner::Plan(lifetimes);
+	CheckPlan(plan, lifetimes);
+
+	CHECK_EQ(plan.HeapSize, 7 * MB);
+	for (bool aliased : plan.IsAliased)
+		CHECK(!aliased);
+}
+
+TEST_CASE(SharedRegionHasNoSinglePredecessor)
+{
+	// Two small targets alive together reuse the memory of a large one that died before them
+	std::vector<TransientLifetime> lifetimes = { Lifetime(8 * MB, 0, 0), Lifetime(2 * MB, 1, 2), Lifetime(2 * MB, 1, 2) };
+	auto plan = TransientPlanner::Plan(lifetimes);
+	CheckPlan(plan, lifetimes);
+
+	CHECK_EQ(plan.HeapSize, 8 * MB);
+	CHECK(!plan.Predecessors[0].has_value());
+	CHECK(plan.Predecessors[1] == std::optional<size_t>(0));
+	CHECK(plan.Predecessors[2] == std::optional<size_t>(0));
+}
+
+TEST_CASE(PlacementHonoursAlignment)
+{
+	// A 64KB buffer first, then an MSAA target that needs 4MB alignment while it is alive
+	std::vector<TransientLifetime> lifetimes = {
+		Lifetime(64 * 1024, 0, 1),
+		Lifetime(8 * MB, 0, 1, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT),
+		Lifetime(100 * 1024, 1, 1) };
+	auto plan = TransientPlanner::Plan(lifetimes);
+	CheckPlan(plan, lifetimes);
+	CHECK_EQ(plan.NaiveSize, 64 * 1024 + 8 * MB + 128 * 1024);
+}
+
+TEST_CASE(RandomGraphsPackWithoutConflicts)
+{
+	std::mt19937 random(7);
+	for (int graph = 0; graph < 200; graph++)
+	{
+		std::vector<TransientLifetime> lifetimes(std::uniform_int_distribution<size_t>(1, 24)(random));
+		for (auto& lifetime : lifetimes)
+		{
+			uint32_t first = std::uniform_int_distribution<uint32_t>(0, 15)(random);
+			uint32_t last = first + std::uniform_int_distribution<uint32_t>(0, 4)(random);
+			uint64_t size = std::uniform_int_distribution<uint64_t>(1, 64)(random) * 64 * 1024;
+			lifetime = Lifetime(size, first, last);
+		}
+
+		CheckPlan(TransientPlanner::Plan(lifetimes), lifetimes);
+		if (Test::GetFailures()) return;
+	}
+}
+
+TEST_CASE(GBufferChainPeakMemory)
+{
+	// Full-HD targets of the deferred frame in pass order: positions, normals, diffuse and specular from the
+	// geometry pass, the occlusion and its blur, lighting, reflections and their blur
+	const uint64_t rgba32f = 1920ull * 1080 * 16;
+	const uint64_t r8 = 1920ull * 1080;
+	std::vector<TransientLifetime> lifetimes = {
+		Lifetime(rgba32f, 1, 5), Lifetime(rgba32f, 1, 5), Lifetime(rgba32f, 1, 4), Lifetime(rgba32f, 1, 4),
+		Lifetime(r8, 2, 3), Lifetime(r8, 3, 4),
+		Lifetime(rgba32f, 4, 7), Lifetime(rgba32f, 5, 6), Lifetime(rgba32f, 6, 7) };
+	auto plan = TransientPlanner::Plan(lifetimes);
+	CheckPlan(plan, lifetimes);
+
+	CHECK(plan.HeapSize < plan.NaiveSize);
+	std::cout << "    peak " << plan.HeapSize / MB << " MB, naive " << plan.NaiveSize / MB << " MB\n";
+}
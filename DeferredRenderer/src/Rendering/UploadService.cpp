@@ -0,0 +1,178 @@
+#include "UploadService.h"
+#include "Core/Exception.h"
+#include "Utils.h"
+
+UploadRing::UploadRing(uint64_t capacity)
+	:Capacity(capacity)
+{}
+
+std::optional<uint64_t> UploadRing::Allocate(uint64_t size, uint64_t alignment)
+{
+	// Nothing in flight - start over so the whole ring is contiguous
+	if (Used == 0) Head = 0;
+
+	uint64_t offset = align_to(alignment, Head);
+	uint64_t needed = offset - Head + size;
+	if (offset + size > Capacity)
+	{
+		// Doesn't fit before the end - skip the rest of the ring and start at 0
+		offset = 0;
+		needed = Capacity - Head + size;
+	}
+
+	if (Used + needed > Capacity) return std::nullopt;
+
+	Head = offset + size;
+	Used += needed;
+	Open += needed;
+	return offset;
+}
+
+void UploadRing::Close(uint64_t fenceValue)
+{
+	if (Open == 0) return;
+
+	InFlight.push_back({ fenceValue, Open });
+	Open = 0;
+}
+
+void UploadRing::Retire(uint64_t completedValue)
+{
+	while (!InFlight.empty() && InFlight.front().FenceValue <= completedValue)
+	{
+		Used -= InFlight.front().Size;
+		InFlight.pop_front();
+	}
+}
+
+std::optional<uint64_t> UploadRing::GetOldestFenceValue() const
+{
+	if (InFlight.empty()) return std::nullopt;
+	return InFlight.front().FenceValue;
+}
+
+UploadService::UploadService(ID3D12Device5Ptr device, uint64_t ringCapacity)
+	:Device(device), Ring(ringCapacity)
+{
+	CopyQueue = D3D::CreateCommandQueue(Device, D3D12_COMMAND_LIST_TYPE_COPY);
+	GRAPHICS_ASSERT(Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&Fence)));
+	FenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	// Created closed, the first upload starts with a Reset
+	GRAPHICS_ASSERT(Device->CreateCommandList1(0, D3D12_COMMAND_LIST_TYPE_COPY, D3D12_COMMAND_LIST_FLAG_NONE, IID_PPV_ARGS(&CmdList)));
+
+	RingBuffer = D3D::CreateBuffer(Device, ringCapacity, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_HEAP_TYPE_UPLOAD);
+
+	// Stays mapped for the lifetime of the service
+	CD3DX12_RANGE readRange(0, 0);
+	GRAPHICS_ASSERT(RingBuffer->Map(0, &readRange, reinterpret_cast<void**>(&RingData)));
+}
+
+UploadService::~UploadService()
+{
+	Flush();
+	WaitIdle();
+	RingBuffer->Unmap(0, nullptr);
+	CloseHandle(FenceEvent);
+}
+
+void UploadService::UploadBuffer(ID3D12ResourcePtr dest, uint64_t destOffset, const void* data, uint64_t size)
+{
+	uint64_t offset = Allocate(size, 16);
+	BeginRecording();
+
+	std::memcpy(RingData + offset, data, size);
+	CmdList->CopyBufferRegion(dest, destOffset, RingBuffer, offset, size);
+
+	Stats.Uploads++;
+	Stats.Bytes += size;
+}
+
+void UploadService::UploadTexture(ID3D12ResourcePtr dest, uint32_t firstSubresource, const D3D12_SUBRESOURCE_DATA* data, uint32_t count)
+{
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(count);
+	std::vector<UINT> numRows(count);
+	std::vector<UINT64> rowSizes(count);
+	uint64_t size = 0;
+
+	auto desc = dest->GetDesc();
+	Device->GetCopyableFootprints(&desc, firstSubresource, count, 0, layouts.data(), numRows.data(), rowSizes.data(), &size);
+
+	uint64_t offset = Allocate(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	BeginRecording();
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		auto& layout = layouts[i];
+		layout.Offset += offset;
+
+		D3D12_MEMCPY_DEST memcpyDest{ RingData + layout.Offset, layout.Footprint.RowPitch, SIZE_T(layout.Footprint.RowPitch) * numRows[i] };
+		MemcpySubresource(&memcpyDest, &data[i], static_cast<SIZE_T>(rowSizes[i]), numRows[i], layout.Footprint.Depth);
+
+		CD3DX12_TEXTURE_COPY_LOCATION dst(dest, firstSubresource + i);
+		CD3DX12_TEXTURE_COPY_LOCATION src(RingBuffer, layout);
+		CmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
+
+	Stats.Uploads++;
+	Stats.Bytes += size;
+}
+
+uint64_t UploadService::Flush()
+{
+	if (!Recording) return FenceValue;
+
+	FenceValue = D3D::SubmitCommandList(CmdList, CopyQueue, Fence, FenceValue);
+	Ring.Close(FenceValue);
+	Allocators.emplace_back(FenceValue, CurrentAllocator);
+	CurrentAllocator = nullptr;
+	Recording = false;
+
+	Stats.Submissions++;
+	return FenceValue;
+}
+
+void UploadService::QueueWait(ID3D12CommandQueuePtr queue, uint64_t value) const
+{
+	GRAPHICS_ASSERT(queue->Wait(Fence, value));
+}
+
+void UploadService::WaitIdle()
+{
+	D3D::WaitForFence(Fence, FenceValue, FenceEvent);
+	Ring.Retire(FenceValue);
+}
+
+uint64_t UploadService::Allocate(uint64_t size, uint64_t alignment)
+{
+	ASSERT(size <= Ring.GetCapacity(), "Upload of " + std::to_string(size) + " bytes doesn't fit in the staging ring");
+
+	while (true)
+	{
+		Ring.Retire(Fence->GetCompletedValue());
+		if (auto offset = Ring.Allocate(size, alignment)) return *offset;
+
+		// The open batch holds ring space as well - submit it so it can be given back
+		Flush();
+		Stats.Stalls++;
+		D3D::WaitForFence(Fence, *Ring.GetOldestFenceValue(), FenceEvent);
+	}
+}
+
+void UploadService::BeginRecording()
+{
+	if (Recording) return;
+
+	// Reuse the oldest allocator once the GPU is done with its list
+	if (!Allocators.empty() && Allocators.front().first <= Fence->GetCompletedValue())
+	{
+		CurrentAllocator = Allocators.front().second;
+		Allocators.pop_front();
+		GRAPHICS_ASSERT(CurrentAllocator->Reset());
+	}
+	else
+		GRAPHICS_ASSERT(Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&CurrentAllocator)));
+
+	GRAPHICS_ASSERT(CmdList->Reset(CurrentAllocator, nullptr));
+	Recording = true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <deque>
+#include <optional>
+
+// Offsets into a staging buffer used as a FIFO ring. Allocations are closed into regions tagged
+// with the fence value of the submission reading them and given back once that value completed.
+// Only the offsets - UploadService owns the buffer, fills it and signals the fences
+class UploadRing
+{
+public:
+	explicit UploadRing(uint64_t capacity);
+
+	// Offset of size free bytes - nullopt while the space is still read by the GPU
+	std::optional<uint64_t> Allocate(uint64_t size, uint64_t alignment);
+	// Hands everything allocated since the last Close to the submission signaling fenceValue
+	void Close(uint64_t fenceValue);
+	// Frees the regions of every submission up to completedValue
+	void Retire(uint64_t completedValue);
+
+	// Fence value of the oldest region still in flight
+	std::optional<uint64_t> GetOldestFenceValue() const;
+	inline uint64_t GetCapacity() const { return Capacity; }
+	inline uint64_t GetUsed() const { return Used; }
+
+private:
+	struct Region
+	{
+		uint64_t FenceValue = 0;
+		uint64_t Size = 0;
+	};
+
+	uint64_t Capacity = 0;
+	uint64_t Head = 0;
+	// Bytes between the oldest region in flight and Head, alignment and wrap padding included
+	uint64_t Used = 0;
+	// Bytes allocated since the last Close
+	uint64_t Open = 0;
+	std::deque<Region> InFlight;
+};
+
+struct UploadStats
+{
+	uint32_t Uploads = 0;
+	uint32_t Submissions = 0;
+	uint64_t Bytes = 0;
+	uint32_t Stalls = 0;	// Times the CPU waited for the copy queue to free ring space
+};
+
+// Uploads static data through a dedicated copy queue. Copies are recorded into one command list
+// and submitted together on Flush, their source data lives in a persistently mapped ring.
+// Destinations are expected in the COMMON state. Copy queue writes decay back to COMMON, from which
+// buffers and shader resource textures are promoted implicitly on the graphics queue - callers only
+// have to make that queue wait for the fence value returned by Flush
+class UploadService
+{
+public:
+	static constexpr uint64_t DefaultRingCapacity = 64ull * 1024 * 1024;
+
+	UploadService(ID3D12Device5Ptr device, uint64_t ringCapacity = DefaultRingCapacity);
+	~UploadService();
+
+	UploadService(const UploadService&) = delete;
+	UploadService& operator=(const UploadService&) = delete;
+
+	void UploadBuffer(ID3D12ResourcePtr dest, uint64_t destOffset, const void* data, uint64_t size);
+	void UploadTexture(ID3D12ResourcePtr dest, uint32_t firstSubresource, const D3D12_SUBRESOURCE_DATA* data, uint32_t count);
+
+	// Submits the recorded copies - returns the fence value signaled once they are done
+	uint64_t Flush();
+	// Makes queue wait on the GPU until the copies up to value are done
+	void QueueWait(ID3D12CommandQueuePtr queue, uint64_t value) const;
+	// Blocks the CPU until every submitted copy is done
+	void WaitIdle();
+
+	inline const UploadStats& GetStats() const { return Stats; }
+
+private:
+	// Ring offset of size bytes - submits and waits for older copies while the ring is full
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+	void BeginRecording();
+
+private:
+	ID3D12Device5Ptr Device;
+	ID3D12CommandQueuePtr CopyQueue;
+	ID3D12FencePtr Fence;
+	HANDLE FenceEvent{};
+	uint64_t FenceValue = 0;
+
+	ID3D12GraphicsCommandList4Ptr CmdList;
+	// Allocators of submitted lists with the fence value after which they can be reset
+	std::deque<std::pair<uint64_t, ID3D12CommandAllocatorPtr>> Allocators;
+	ID3D12CommandAllocatorPtr CurrentAllocator;
+	bool Recording = false;
+
+	ID3D12ResourcePtr RingBuffer;
+	uint8_t* RingData = nullptr;
+	UploadRing Ring;
+
+	UploadStats Stats;
+};
@@ -0,0 +1,120 @@
+#include "Test.h"
+#include "Rendering/UploadService.h"
+
+#include <deque>
+#include <random>
+
+namespace
+{
+	struct Allocation
+	{
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+		uint64_t FenceValue = 0;
+	};
+
+	bool Overlaps(const Allocation& a, const Allocation& b)
+	{
+		return a.Offset < b.Offset + b.Size && b.Offset < a.Offset + a.Size;
+	}
+}
+
+TEST_CASE(UploadRingWrapsOnceTheGpuIsDone)
+{
+	UploadRing ring(1024);
+	CHECK(!ring.GetOldestFenceValue());
+
+	CHECK_EQ(ring.Allocate(400, 1).value(), 0u);
+	ring.Close(1);
+	CHECK_EQ(ring.Allocate(400, 1).value(), 400u);
+	ring.Close(2);
+	CHECK_EQ(ring.GetOldestFenceValue().value(), 1u);
+
+	// 224 bytes left before the end, the start is still read by submission 1
+	CHECK(!ring.Allocate(400, 1));
+	ring.Retire(0);
+	CHECK(!ring.Allocate(400, 1));
+
+	// Once it completed the tail is skipped and the allocation starts over at 0
+	ring.Retire(1);
+	CHECK_EQ(ring.GetUsed(), 400u);
+	CHECK_EQ(ring.Allocate(400, 1).value(), 0u);
+	CHECK_EQ(ring.GetUsed(), ring.GetCapacity());
+	ring.Close(3);
+
+	ring.Retire(3);
+	CHECK_EQ(ring.GetUsed(), 0u);
+	CHECK(!ring.GetOldestFenceValue());
+}
+
+TEST_CASE(UploadRingAlignsAndClosesOnlyOpenBytes)
+{
+	UploadRing ring(4096);
+
+	// The padding in front of an aligned allocation belongs to its region
+	CHECK_EQ(ring.Allocate(10, 1).value(), 0u);
+	CHECK_EQ(ring.Allocate(10, 256).value(), 256u);
+	CHECK_EQ(ring.GetUsed(), 266u);
+
+	// A Close without allocations since the last one adds no region
+	ring.Close(1);
+	ring.Close(2);
+	CHECK_EQ(ring.GetOldestFenceValue().value(), 1u);
+	ring.Retire(1);
+	CHECK(!ring.GetOldestFenceValue());
+	CHECK_EQ(ring.GetUsed(), 0u);
+
+	// An empty ring starts at 0 again instead of after the last allocation
+	CHECK_EQ(ring.Allocate(64, 64).value(), 0u);
+}
+
+TEST_CASE(UploadRingNeverHandsOutBytesInFlight)
+{
+	UploadRing ring(64 * 1024);
+	std::mt19937 random(11);
+	std::uniform_int_distribution<uint64_t> size(1, 8 * 1024);
+
+	// Submissions complete two fence values behind the CPU, as the copy queue would
+	std::deque<Allocation> live;
+	uint64_t fenceValue = 1;
+	uint32_t failed = 0;
+	for (uint32_t submission = 0; submission < 500; submission++)
+	{
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			uint64_t bytes = size(random);
+			uint64_t alignment = uint64_t(1) << (random() % 9);
+			auto offset = ring.Allocate(bytes, alignment);
+			if (!offset)
+			{
+				failed++;
+				continue;
+			}
+
+			Allocation allocation = { *offset, bytes, fenceValue };
+			CHECK_EQ(allocation.Offset % alignment, 0u);
+			CHECK(allocation.Offset + bytes <= ring.GetCapacity());
+			for (const auto& other : live)
+				CHECK(!Overlaps(allocation, other));
+			live.push_back(allocation);
+		}
+		ring.Close(fenceValue);
+
+		if (fenceValue > 2)
+		{
+			ring.Retire(fenceValue - 2);
+			while (!live.empty() && live.front().FenceValue <= fenceValue - 2)
+				live.pop_front();
+		}
+		CHECK(ring.GetUsed() <= ring.GetCapacity());
+		fenceValue++;
+	}
+
+	// Three submissions of up to 32 KB in flight can ask for more than the ring holds - some allocations
+	// have to wait, most do not
+	CHECK(failed > 0);
+	CHECK(failed < 100);
+
+	ring.Retire(fenceValue);
+	CHECK_EQ(ring.GetUsed(), 0u);
+}
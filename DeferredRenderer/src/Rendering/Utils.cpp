@@ -34,12 +34,12 @@ ID3D12DescriptorHeapPtr D3D::CreateDescriptorHeap(ID3D12Device5Ptr device, uint3
 	return heap;
 }
 
-ID3D12CommandQueuePtr D3D::CreateCommandQueue(ID3D12Device5Ptr device)
+ID3D12CommandQueuePtr D3D::CreateCommandQueue(ID3D12Device5Ptr device, D3D12_COMMAND_LIST_TYPE type)
 {
 	ID3D12CommandQueuePtr queue;
 	D3D12_COMMAND_QUEUE_DESC desc{};
 	desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-	desc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+	desc.Type = type;
 	GRAPHICS_ASSERT(device->CreateCommandQueue(&desc, IID_PPV_ARGS(&queue)));
 	return queue;
 }
@@ -90,6 +90,29 @@ uint64_t D3D::SubmitCommandList(ID3D12GraphicsCommandList4Ptr cmdList, ID3D12Com
 	return fenceValue;
 }
 
+uint64_t D3D::SubmitCommandLists(const std::vector<ID3D12GraphicsCommandList4Ptr>& cmdLists, ID3D12CommandQueuePtr cmdQueue, ID3D12FencePtr fence, uint64_t fenceValue)
+{
+	std::vector<ID3D12CommandList*> lists;
+	lists.reserve(cmdLists.size());
+	for (const auto& cmdList : cmdLists)
+	{
+		cmdList->Close();
+		lists.push_back(cmdList.GetInterfacePtr());
+	}
+
+	cmdQueue->ExecuteCommandLists(static_cast<UINT>(lists.size()), lists.data());
+	cmdQueue->Signal(fence, ++fenceValue);
+	return fenceValue;
+}
+
+void D3D::WaitForFence(ID3D12FencePtr fence, uint64_t value, HANDLE event)
+{
+	if (fence->GetCompletedValue() >= value) return;
+
+	fence->SetEventOnCompletion(value, event);
+	WaitForSingleObject(event, INFINITE);
+}
+
 ID3D12RootSignaturePtr D3D::CreateRootSignature(ID3D12Device5Ptr pDevice,
 										   const D3D12_ROOT_SIGNATURE_DESC& desc)
 {
@@ -54,7 +54,7 @@ namespace D3D
 												 D3D12_DESCRIPTOR_HEAP_TYPE type,
 												 bool shaderVisible);
 
-	ID3D12CommandQueuePtr CreateCommandQueue(ID3D12Device5Ptr device);
+	ID3D12CommandQueuePtr CreateCommandQueue(ID3D12Device5Ptr device, D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
 
 	D3D12_CPU_DESCRIPTOR_HANDLE CreateRTV(ID3D12Device5Ptr device,
 										  ID3D12ResourcePtr resource,
@@ -78,6 +78,14 @@ namespace D3D
 							   ID3D12FencePtr fence,
 							   uint64_t fenceValue);
 
+	uint64_t SubmitCommandLists(const std::vector<ID3D12GraphicsCommandList4Ptr>& cmdLists,
+								ID3D12CommandQueuePtr cmdQueue,
+								ID3D12FencePtr fence,
+								uint64_t fenceValue);
+
+	// Blocks the calling thread until fence reaches value - returns immediately if it already has
+	void WaitForFence(ID3D12FencePtr fence, uint64_t value, HANDLE event);
+
 	ID3D12RootSignaturePtr CreateRootSignature(ID3D12Device5Ptr pDevice,
 											const D3D12_ROOT_SIGNATURE_DESC& desc);
 
@@ -0,0 +1,139 @@
+#include "VertexPacking.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+
+namespace
+{
+	uint16_t PackUnorm16(float value)
+	{
+		return static_cast<uint16_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+	}
+
+	int16_t PackSnorm16(float value)
+	{
+		return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	// The conversions the input assembler does
+	float UnpackUnorm16(uint16_t value) { return value / 65535.0f; }
+	float UnpackSnorm16(int16_t value) { return std::max(value / 32767.0f, -1.0f); }
+
+	float SignNotZero(float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+
+	// Vectors that are not set (primitives carry no tangents) have no direction to compare.
+	// atan2 rather than acos, which cannot resolve angles below ~0.02 degrees in float
+	float AngleDegrees(const glm::float3& a, const glm::float3& b)
+	{
+		if (glm::length(a) * glm::length(b) == 0.0f) return 0.0f;
+		return glm::degrees(std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b)));
+	}
+}
+
+PositionQuantization PositionQuantization::Fit(const std::vector<StaticVertex>& vertices)
+{
+	if (vertices.empty()) return {};
+
+	glm::float3 min = vertices.front().Position;
+	glm::float3 max = min;
+	for (const auto& vertex : vertices)
+	{
+		min = glm::min(min, vertex.Position);
+		max = glm::max(max, vertex.Position);
+	}
+
+	// Flat axes keep a unit scale - every vertex sits on the offset
+	glm::float3 extent = max - min;
+	for (int i = 0; i < 3; i++)
+		if (extent[i] == 0.0f) extent[i] = 1.0f;
+	return { min, extent };
+}
+
+const BufferLayout& PackedVertex::GetLayout()
+{
+	// Pipelines are built on several threads, the static is initialized once
+	static const BufferLayout layout{ {"POSITION", DataType::unorm16x4},
+									  {"NORMAL", DataType::snorm16x2},
+									  {"TANGENT", DataType::snorm16x2},
+									  {"TEXCOORD", DataType::half2}, };
+	return layout;
+}
+
+glm::float2 EncodeOctahedral(const glm::float3& direction)
+{
+	float sum = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+	if (sum == 0.0f) return { 0.0f, 0.0f };
+
+	glm::float3 n = direction / sum;
+	if (n.z >= 0.0f) return { n.x, n.y };
+
+	// Lower hemisphere folds over the diagonals
+	return { (1.0f - std::abs(n.y)) * SignNotZero(n.x), (1.0f - std::abs(n.x)) * SignNotZero(n.y) };
+}
+
+glm::float3 DecodeOctahedral(const glm::float2& encoded)
+{
+	glm::float3 n(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+	float t = std::max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return glm::normalize(n);
+}
+
+PackedVertex PackVertex(const StaticVertex& vertex, const PositionQuantization& quantization)
+{
+	glm::float3 position = (vertex.Position - quantization.Offset) / quantization.Scale;
+	// Same handedness test as calcTBNmatrix in the shaders
+	bool positive = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) >= 0.0f;
+	glm::float2 normal = EncodeOctahedral(vertex.Normal);
+	glm::float2 tangent = EncodeOctahedral(vertex.Tangent);
+
+	PackedVertex packed;
+	packed.Position = { PackUnorm16(position.x), PackUnorm16(position.y), PackUnorm16(position.z), static_cast<uint16_t>(positive ? 65535 : 0) };
+	packed.Normal = { PackSnorm16(normal.x), PackSnorm16(normal.y) };
+	packed.Tangent = { PackSnorm16(tangent.x), PackSnorm16(tangent.y) };
+	packed.TexCoords = { glm::packHalf1x16(vertex.TexCoords.x), glm::packHalf1x16(vertex.TexCoords.y) };
+	return packed;
+}
+
+StaticVertex UnpackVertex(const PackedVertex& vertex, const PositionQuantization& quantization)
+{
+	glm::float3 position(UnpackUnorm16(vertex.Position[0]), UnpackUnorm16(vertex.Position[1]), UnpackUnorm16(vertex.Position[2]));
+	float sign = UnpackUnorm16(vertex.Position[3]) * 2.0f - 1.0f;
+
+	StaticVertex unpacked;
+	unpacked.Position = quantization.Offset + position * quantization.Scale;
+	unpacked.Normal = DecodeOctahedral({ UnpackSnorm16(vertex.Normal[0]), UnpackSnorm16(vertex.Normal[1]) });
+	unpacked.Tangent = DecodeOctahedral({ UnpackSnorm16(vertex.Tangent[0]), UnpackSnorm16(vertex.Tangent[1]) });
+	unpacked.Bitangent = glm::cross(unpacked.Normal, unpacked.Tangent) * sign;
+	unpacked.TexCoords = { glm::unpackHalf1x16(vertex.TexCoords[0]), glm::unpackHalf1x16(vertex.TexCoords[1]) };
+	return unpacked;
+}
+
+PackingError& PackingError::operator+=(const PackingError& other)
+{
+	Position = std::max(Position, other.Position);
+	NormalDegrees = std::max(NormalDegrees, other.NormalDegrees);
+	TangentDegrees = std::max(TangentDegrees, other.TangentDegrees);
+	TexCoords = std::max(TexCoords, other.TexCoords);
+	return *this;
+}
+
+PackingError MeasurePackingError(const std::vector<StaticVertex>& vertices, const std::vector<PackedVertex>& packed, const PositionQuantization& quantization)
+{
+	PackingError error;
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		const auto& source = vertices[i];
+		auto unpacked = UnpackVertex(packed[i], quantization);
+
+		glm::float3 position = glm::abs(unpacked.Position - source.Position);
+		glm::float2 texCoords = glm::abs(unpacked.TexCoords - source.TexCoords);
+		error += { std::max({ position.x, position.y, position.z }),
+				   AngleDegrees(unpacked.Normal, source.Normal),
+				   AngleDegrees(unpacked.Tangent, source.Tangent),
+				   std::max(texCoords.x, texCoords.y) };
+	}
+	return error;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Core/Core.h"
+#include "Buffer.h"
+
+// Full precision vertex of a static mesh, as imported - StaticGeometry packs it for the GPU
+struct StaticVertex : VertexElement
+{
+	glm::float3 Normal;
+	glm::float3 Tangent;
+	glm::float3 Bitangent;
+	glm::float2 TexCoords;
+};
+
+// Positions of a mesh are stored as UNORM16 inside its bounds: Offset + packed * Scale
+struct PositionQuantization
+{
+	glm::float3 Offset{ 0.0f };
+	glm::float3 Scale{ 1.0f };
+
+	static PositionQuantization Fit(const std::vector<StaticVertex>& vertices);
+};
+
+// 20 bytes instead of the 56 of StaticVertex:
+//  - POSITION  UNORM16 x4, xyz quantized in the mesh bounds, w the sign of the bitangent (0 for -1, 1 for +1)
+//  - NORMAL    SNORM16 x2, octahedral
+//  - TANGENT   SNORM16 x2, octahedral. The bitangent is cross(normal, tangent) * sign
+//  - TEXCOORD  half x2
+// Decoded by the vertex shaders, see VertexShaders/core.hlsli
+struct PackedVertex
+{
+	std::array<uint16_t, 4> Position;
+	std::array<int16_t, 2> Normal;
+	std::array<int16_t, 2> Tangent;
+	std::array<uint16_t, 2> TexCoords;
+
+	// Input layout of the pipelines drawing static meshes
+	static const BufferLayout& GetLayout();
+};
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex is read through its BufferLayout");
+
+PackedVertex PackVertex(const StaticVertex& vertex, const PositionQuantization& quantization);
+// What the vertex shader reconstructs - the bitangent comes out orthogonal to normal and tangent
+StaticVertex UnpackVertex(const PackedVertex& vertex, const PositionQuantization& quantization);
+
+// Unit vector to the [-1, 1] square of the octahedral mapping, zero vectors map to +Z
+glm::float2 EncodeOctahedral(const glm::float3& direction);
+glm::float3 DecodeOctahedral(const glm::float2& encoded);
+
+// Largest difference between vertices and their packed round trip
+struct PackingError
+{
+	float Position = 0.0f;		// Mesh units
+	float NormalDegrees = 0.0f;
+	float TangentDegrees = 0.0f;
+	float TexCoords = 0.0f;
+
+	PackingError& operator+=(const PackingError& other);	// Keeps the larger of each
+};
+
+PackingError MeasurePackingError(const std::vector<StaticVertex>& vertices, const std::vector<PackedVertex>& packed, const PositionQuantization& quantization);
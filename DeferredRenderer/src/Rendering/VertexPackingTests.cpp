@@ -0,0 +1,162 @@
+#include "Test.h"
+#include "Rendering/VertexPacking.h"
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	// SNORM16 octahedral vectors are good to a few thousandths of a degree
+	constexpr float MaxPackedDegrees = 0.005f;
+
+	float AngleDegrees(const glm::float3& a, const glm::float3& b)
+	{
+		return glm::degrees(std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b)));
+	}
+
+	StaticVertex Vertex(const glm::float3& position, const glm::float3& normal, const glm::float3& tangent, const glm::float3& bitangent)
+	{
+		StaticVertex vertex;
+		vertex.Position = position;
+		vertex.Normal = normal;
+		vertex.Tangent = tangent;
+		vertex.Bitangent = bitangent;
+		vertex.TexCoords = { 0.25f, 0.75f };
+		return vertex;
+	}
+
+	// The axes, both poles, the diagonals the lower hemisphere folds over and directions just off them
+	std::vector<glm::float3> SpecialDirections()
+	{
+		std::vector<glm::float3> directions = {
+			{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+			{ 1e-4f, -1e-4f, -1 }, { -1e-4f, 1e-4f, 1 },
+		};
+		for (float x : { -1.0f, 1.0f })
+			for (float y : { -1.0f, 1.0f })
+			{
+				directions.push_back(glm::normalize(glm::float3(x, y, 0.0f)));
+				for (float z : { -1.0f, 1.0f })
+					directions.push_back(glm::normalize(glm::float3(x, y, z)));
+				directions.push_back(glm::normalize(glm::float3(x, y, -1e-3f)));
+				directions.push_back(glm::normalize(glm::float3(x, 1e-3f * y, -1.0f)));
+			}
+		return directions;
+	}
+}
+
+TEST_CASE(OctahedralMappingRoundTripsAxesPolesAndFolds)
+{
+	for (const auto& direction : SpecialDirections())
+	{
+		glm::float2 encoded = EncodeOctahedral(direction);
+		CHECK(std::abs(encoded.x) <= 1.0f && std::abs(encoded.y) <= 1.0f);
+		// Exact up to float rounding before quantization
+		CHECK(AngleDegrees(DecodeOctahedral(encoded), direction) < 1e-3f);
+	}
+
+	// The -Z pole lands on a corner of the square, the fold diagonals on its border
+	glm::float2 pole = glm::abs(EncodeOctahedral({ 0, 0, -1 }));
+	CHECK_NEAR(pole.x, 1.0f, 1e-6f);
+	CHECK_NEAR(pole.y, 1.0f, 1e-6f);
+	glm::float2 fold = glm::abs(EncodeOctahedral(glm::normalize(glm::float3(1, -1, 0))));
+	CHECK_NEAR(fold.x + fold.y, 1.0f, 1e-6f);
+
+	// Zero vectors come back as +Z
+	CHECK(glm::all(glm::equal(DecodeOctahedral(EncodeOctahedral({ 0, 0, 0 })), glm::float3(0, 0, 1))));
+}
+
+TEST_CASE(PackedNormalsAndTangentsStayWithinTheirErrorBound)
+{
+	std::vector<StaticVertex> vertices;
+	for (const auto& normal : SpecialDirections())
+	{
+		// Any direction orthogonal to the normal will do as tangent
+		glm::float3 helper = std::abs(normal.z) < 0.9f ? glm::float3(0, 0, 1) : glm::float3(1, 0, 0);
+		glm::float3 tangent = glm::normalize(glm::cross(helper, normal));
+		vertices.push_back(Vertex({ 0, 0, 0 }, normal, tangent, glm::cross(normal, tangent)));
+		vertices.push_back(Vertex({ 0, 0, 0 }, tangent, normal, glm::cross(tangent, normal)));
+	}
+
+	std::mt19937 random(5);
+	std::normal_distribution<float> gaussian;
+	for (int i = 0; i < 10000; i++)
+	{
+		glm::float3 normal = glm::normalize(glm::float3(gaussian(random), gaussian(random), gaussian(random)));
+		glm::float3 tangent = glm::normalize(glm::cross(normal, glm::float3(gaussian(random), gaussian(random), gaussian(random))));
+		vertices.push_back(Vertex({ gaussian(random), gaussian(random), gaussian(random) }, normal, tangent, glm::cross(normal, tangent)));
+	}
+
+	auto quantization = PositionQuantization::Fit(vertices);
+	std::vector<PackedVertex> packed;
+	for (const auto& vertex : vertices)
+		packed.push_back(PackVertex(vertex, quantization));
+
+	auto error = MeasurePackingError(vertices, packed, quantization);
+	CHECK(error.NormalDegrees < MaxPackedDegrees);
+	CHECK(error.TangentDegrees < MaxPackedDegrees);
+
+	// Half a UNORM16 step of the bounds per axis, plus float rounding
+	float maxScale = std::max({ quantization.Scale.x, quantization.Scale.y, quantization.Scale.z });
+	CHECK(error.Position <= maxScale / 65535.0f * 0.5f * 1.01f);
+	// Halves hold 11 significant bits
+	CHECK(error.TexCoords <= 0.75f / 2048.0f);
+}
+
+TEST_CASE(MirroredBitangentsKeepTheirSign)
+{
+	const glm::float3 normal(0, 0, 1);
+	const glm::float3 tangent(1, 0, 0);
+	const glm::float3 bitangent = glm::cross(normal, tangent);
+
+	// UV islands mirrored by the artist have a bitangent opposite to cross(normal, tangent)
+	std::vector<StaticVertex> vertices = {
+		Vertex({ 0, 0, 0 }, normal, tangent, bitangent),
+		Vertex({ 1, 1, 1 }, normal, tangent, -bitangent),
+		// Not exactly orthogonal, as imported tangent frames often are
+		Vertex({ 1, 0, 1 }, normal, tangent, glm::normalize(-bitangent + glm::float3(0.1f, 0, 0.2f))),
+	};
+	auto quantization = PositionQuantization::Fit(vertices);
+
+	std::vector<PackedVertex> packed;
+	for (const auto& vertex : vertices)
+		packed.push_back(PackVertex(vertex, quantization));
+	CHECK_EQ(packed[0].Position[3], 65535);
+	CHECK_EQ(packed[1].Position[3], 0);
+	CHECK_EQ(packed[2].Position[3], 0);
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		auto unpacked = UnpackVertex(packed[i], quantization);
+		glm::float3 expected = i == 0 ? bitangent : -bitangent;
+		CHECK(AngleDegrees(unpacked.Bitangent, expected) < MaxPackedDegrees);
+		CHECK_NEAR(glm::length(unpacked.Bitangent), 1.0f, 1e-3f);
+	}
+}
+
+TEST_CASE(PositionsQuantizeInsideTheMeshBounds)
+{
+	// Flat in y - the axis keeps a unit scale and every vertex decodes onto it exactly
+	std::vector<StaticVertex> vertices = {
+		Vertex({ -2, 3, 10 }, { 0, 1, 0 }, { 1, 0, 0 }, { 0, 0, 1 }),
+		Vertex({ 6, 3, 12 }, { 0, 1, 0 }, { 1, 0, 0 }, { 0, 0, 1 }),
+		Vertex({ 1, 3, 11.5f }, { 0, 1, 0 }, { 1, 0, 0 }, { 0, 0, 1 }),
+	};
+	auto quantization = PositionQuantization::Fit(vertices);
+	CHECK(glm::all(glm::equal(quantization.Offset, glm::float3(-2, 3, 10))));
+	CHECK(glm::all(glm::equal(quantization.Scale, glm::float3(8, 1, 2))));
+
+	for (const auto& vertex : vertices)
+	{
+		auto unpacked = UnpackVertex(PackVertex(vertex, quantization), quantization);
+		CHECK_EQ(unpacked.Position.y, 3.0f);
+		CHECK(std::abs(unpacked.Position.x - vertex.Position.x) <= 8.0f / 65535.0f);
+		CHECK(std::abs(unpacked.Position.z - vertex.Position.z) <= 2.0f / 65535.0f);
+	}
+
+	// The corners of the bounds are exact
+	auto low = PackVertex(vertices[0], quantization);
+	auto high = PackVertex(vertices[1], quantization);
+	CHECK(low.Position[0] == 0 && low.Position[2] == 0);
+	CHECK(high.Position[0] == 65535 && high.Position[2] == 65535);
+}
@@ -7,8 +7,8 @@
 #include <unordered_map>
 #include <iostream>
 
-Scene::Scene(ID3D12Device5Ptr device, const Camera& camera)
-	:Device(device), DebugMode(false)
+Scene::Scene(ID3D12Device5Ptr device, const Camera& camera, bool analyzeMeshes)
+	:Geometry(analyzeMeshes), Device(device), DebugMode(false)
 {
 	FilesLocation = std::filesystem::current_path().parent_path().string()
 		+ std::string(DebugMode ? "\\Content\\Model\\Nanosuit\\" : "\\Content\\Model\\Sponza\\");
@@ -20,8 +20,16 @@ Scene::Scene(ID3D12Device5Ptr device, const Camera& camera)
 
 void Scene::Tick()
 {
+	// Only actors that changed are written, the buffer uploads just those ranges
+	for (uint32_t i = 0; i < Actors.size(); i++)
+		if (Actors[i].Tick())
+			ActorBuffer.Write(i, Actors[i].GetData());
+	ActorBuffer.Upload(Globals.CmdQueue);
+
+	// The camera moved before the scene ticks, every pass of the frame draws what is left
+	MeshletStats = {};
 	for (auto& actor : Actors)
-		actor.Tick();
+		MeshletStats += actor.Cull(Geometry);
 
 	for (auto& light : Lights)
 	{
@@ -29,27 +37,29 @@ void Scene::Tick()
 	}
 }
 
-void Scene::CreateShaderResources(ID3D12Device5Ptr device, ID3D12CommandQueuePtr cmdQueue)
+void Scene::CreateShaderResources(ID3D12Device5Ptr device, UploadService& uploads)
 {
-	auto uavHandle = Globals.UAVHeap->GetCPUDescriptorHandleForHeapStart();
-	auto srvHandle = Globals.SRVHeap->GetCPUDescriptorHandleForHeapStart();
-	auto cbvHandle = Globals.CBVHeap->GetCPUDescriptorHandleForHeapStart();
-	auto lightsHandle = Globals.LightsHeap->GetCPUDescriptorHandleForHeapStart();
+	auto lightsHandle = Globals.LightsTable.GetCPUHandle();
 
-	cbvHandle.ptr += Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV); // 1st element of desc table occupied
-	for (auto& actor : Actors)
+	// Every actor goes up once while loading, frames only upload what changed
+	std::vector<ActorData> actorData;
+	actorData.reserve(Actors.size());
+	for (uint32_t i = 0; i < Actors.size(); i++)
 	{
-		actor.SetUpGPUResources(Device, cbvHandle);
-		cbvHandle.ptr += Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		Actors[i].SceneIndex = i;
+		Actors[i].Tick();
+		actorData.push_back(Actors[i].GetData());
 	}
+	ActorBuffer.Init(device, uploads, actorData);
+	Geometry.Upload();
 
+	// Lights are read through a table bound at LightsTable start + frame index,
+	// so the table holds the per-frame copies of a single light
+	ASSERT(Lights.size() == 1, "Only a single directional light is supported");
 	for (auto& light : Lights)
-	{
 		light.SetUpGPUResources(device, lightsHandle);
-		lightsHandle.ptr += Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	}
 
-	InitializeTextures(device, cmdQueue);
+	InitializeTextures(device, uploads);
 
 	D3D12_SAMPLER_DESC samplerDesc = {};
 	samplerDesc.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR; // Linear filtering
@@ -62,22 +72,18 @@ void Scene::CreateShaderResources(ID3D12Device5Ptr device, ID3D12CommandQueuePtr
 	samplerDesc.MinLOD = 0.0f;
 	samplerDesc.MaxLOD = D3D12_FLOAT32_MAX;
 
-	// Get the handle to the sampler heap
-	CD3DX12_CPU_DESCRIPTOR_HANDLE samplerHandle(Globals.SamplerHeap->GetCPUDescriptorHandleForHeapStart());
-	device->CreateSampler(&samplerDesc, samplerHandle);
+	device->CreateSampler(&samplerDesc, Globals.SamplerTable.GetCPUHandle());
 
 }
 
-void Scene::InitializeTextures(ID3D12Device5Ptr device, ID3D12CommandQueuePtr cmdQueue)
+void Scene::InitializeTextures(ID3D12Device5Ptr device, UploadService& uploads)
 {
 	// Create Texture
-	auto srvHandle = Globals.SRVHeap->GetCPUDescriptorHandleForHeapStart();
+	ASSERT(TextureIndexMap.size() <= Globals.SRVTable.Count, "More textures than the global SRV table holds");
 
+	uint32_t index = 0;
 	for (const auto& pair : TextureIndexMap)
-	{
-		TextureResources.emplace_back(MakeUnique<Texture>(device, cmdQueue, srvHandle, FilesLocation + pair.first));
-		srvHandle.ptr += device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	}
+		TextureResources.emplace_back(MakeUnique<Texture>(device, uploads, Globals.SRVTable.GetCPUHandle(index++), FilesLocation + pair.first));
 }
 
 void Scene::LoadModels(const Camera& camera)
@@ -102,7 +108,7 @@ void Scene::LoadModels(const Camera& camera)
 	for (size_t i = 0; i < scene->mNumMeshes; i++)
 	{
 		const auto mesh = scene->mMeshes[i];
-		Actors.emplace_back(Model{ Device, camera, *mesh, materials, TextureIndexMap });
+		Actors.emplace_back(Model{ Device, camera, Geometry, *mesh, materials, TextureIndexMap });
 		auto& actor = Actors.back();
 		actor.SetScale({ scalingFactor, scalingFactor, scalingFactor });
 	}
@@ -5,32 +5,58 @@
 #include "Rendering/Shader.h"
 #include "Rendering/Texture.h"
 #include "Rendering/RootSignature.h"
+#include "Rendering/GpuScene.h"
+#include "Rendering/StaticGeometry.h"
 
 
 class Scene
 {
 public:
-	Scene(ID3D12Device5Ptr device, const class Camera& camera);
+	// analyzeMeshes: simulate the mesh reordering for the geometry report
+	Scene(ID3D12Device5Ptr device, const class Camera& camera, bool analyzeMeshes);
 
 	template<typename Pass>
 	requires std::is_base_of_v<RenderPass, Pass>
-	void Bind(ID3D12GraphicsCommandList4Ptr cmdList) const
+	void Bind(CommandContext& cmdList) const
 	{
 		for (const auto& actor : Actors)
 			actor.Bind<Pass>(cmdList);
 	}
+
+	// Binds the actors in [first, last) - lets a pass record its actors in chunks on several threads
+	template<typename Pass>
+	requires std::is_base_of_v<RenderPass, Pass>
+	void Bind(CommandContext& cmdList, size_t first, size_t last) const
+	{
+		for (size_t i = first; i < last; i++)
+			Actors[i].Bind<Pass>(cmdList);
+	}
+
+	// Vertex and index buffer every actor draws from - passes bind them once before their draws
+	inline void BindGeometry(CommandContext& cmdList) const { Geometry.Bind(cmdList); }
+	inline const StaticGeometry& GetGeometry() const { return Geometry; }
+
+	inline size_t GetActorCount() const { return Actors.size(); }
+	inline D3D12_GPU_VIRTUAL_ADDRESS GetActorBufferAddress() const { return ActorBuffer.GetGPUVirtualAddress(); }
+	// Actor data uploaded by the last Tick
+	inline const GpuSceneStats& GetGpuSceneStats() const { return ActorBuffer.GetStats(); }
+	// Meshlets of all actors culled by the last Tick
+	inline const MeshletCullStats& GetMeshletStats() const { return MeshletStats; }
 	
 	void Tick();
 
-	void CreateShaderResources(ID3D12Device5Ptr device, ID3D12CommandQueuePtr cmdQueue);
+	void CreateShaderResources(ID3D12Device5Ptr device, UploadService& uploads);
 
 private:
-	void InitializeTextures(ID3D12Device5Ptr device, ID3D12CommandQueuePtr cmdQueue);
+	void InitializeTextures(ID3D12Device5Ptr device, UploadService& uploads);
 	void LoadModels(const Camera& camera);
 	void InitializeTextureIndices();
 
 private:
 	std::vector<Actor> Actors;
+	StaticGeometry Geometry;
+	GpuSceneBuffer ActorBuffer;
+	MeshletCullStats MeshletStats;
 	std::vector<DirectionalLight> Lights;
 	ID3D12Device5Ptr Device;
 
@@ -42,7 +68,7 @@ private:
 };
 
 template<>
-inline void Scene::Bind<GUIPass>(ID3D12GraphicsCommandList4Ptr cmdList) const
+inline void Scene::Bind<GUIPass>(CommandContext& cmdList) const
 {
 	for (auto& light : Lights)
 		light.GUI();
@@ -9,7 +9,7 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _
 		Application::Init(1920, 1080, GetModuleHandle(nullptr), "RTR 2024 Deferred Renderer");
 		);
 
-	EXCEPTION_WRAP(Application::InitGraphics(););
+	EXCEPTION_WRAP(Application::InitGraphics(GraphicsOptions::Parse(lpCmdLine)););
 
 	int msg{ 0 };
 	EXCEPTION_WRAP(
@@ -0,0 +1,79 @@
+#pragma once
+#include "Core/Core.h"
+#include "Rendering/CommandContext.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Stands in for ID3D12GraphicsCommandList4 in BasicCommandContext - records the calls that reach it
+// instead of executing them
+struct RecordingCommandList
+{
+	// Method names in call order
+	std::vector<std::string> Calls;
+	// Barriers of every ResourceBarrier call
+	std::vector<std::vector<D3D12_RESOURCE_BARRIER>> Barriers;
+	std::vector<ID3D12Resource*> Discarded;
+	// Arguments of the last call to the methods below
+	std::vector<D3D12_VERTEX_BUFFER_VIEW> VertexBuffers;
+	bool NullVertexBuffers = false;
+	BOOL SingleHandle = FALSE;
+	uint64_t RootArgument = 0;
+
+	inline size_t Count(const std::string& method) const { return std::ranges::count(Calls, method); }
+	inline void Clear() { *this = {}; }
+
+	void SetPipelineState(ID3D12PipelineState*) { Calls.push_back("SetPipelineState"); }
+	void SetGraphicsRootSignature(ID3D12RootSignature*) { Calls.push_back("SetGraphicsRootSignature"); }
+	void SetComputeRootSignature(ID3D12RootSignature*) { Calls.push_back("SetComputeRootSignature"); }
+	void SetDescriptorHeaps(UINT, ID3D12DescriptorHeap* const*) { Calls.push_back("SetDescriptorHeaps"); }
+	void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY) { Calls.push_back("IASetPrimitiveTopology"); }
+
+	void IASetVertexBuffers(UINT, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views)
+	{
+		Calls.push_back("IASetVertexBuffers");
+		NullVertexBuffers = views == nullptr;
+		VertexBuffers.assign(views, views ? views + count : views);
+	}
+
+	void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW*) { Calls.push_back("IASetIndexBuffer"); }
+	void RSSetViewports(UINT, const D3D12_VIEWPORT*) { Calls.push_back("RSSetViewports"); }
+	void RSSetScissorRects(UINT, const D3D12_RECT*) { Calls.push_back("RSSetScissorRects"); }
+
+	void OMSetRenderTargets(UINT, const D3D12_CPU_DESCRIPTOR_HANDLE*, BOOL singleHandle, const D3D12_CPU_DESCRIPTOR_HANDLE*)
+	{
+		Calls.push_back("OMSetRenderTargets");
+		SingleHandle = singleHandle;
+	}
+
+	void SetGraphicsRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE table) { Root("SetGraphicsRootDescriptorTable", table.ptr); }
+	void SetComputeRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE table) { Root("SetComputeRootDescriptorTable", table.ptr); }
+	void SetGraphicsRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS address) { Root("SetGraphicsRootConstantBufferView", address); }
+	void SetComputeRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS address) { Root("SetComputeRootConstantBufferView", address); }
+	void SetGraphicsRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS address) { Root("SetGraphicsRootShaderResourceView", address); }
+	void SetGraphicsRoot32BitConstant(UINT, UINT value, UINT) { Root("SetGraphicsRoot32BitConstant", value); }
+
+	void ResourceBarrier(UINT count, const D3D12_RESOURCE_BARRIER* barriers)
+	{
+		Calls.push_back("ResourceBarrier");
+		Barriers.emplace_back(barriers, barriers + count);
+	}
+
+	void DiscardResource(ID3D12Resource* resource, const void*)
+	{
+		Calls.push_back("DiscardResource");
+		Discarded.push_back(resource);
+	}
+
+	void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) { Calls.push_back("DrawIndexedInstanced"); }
+
+private:
+	void Root(const char* method, uint64_t argument)
+	{
+		Calls.push_back(method);
+		RootArgument = argument;
+	}
+};
+
+using RecordingContext = BasicCommandContext<RecordingCommandList>;
@@ -0,0 +1,63 @@
+#pragma once
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Self-registering test cases for the device-free parts of the renderer. Test files sit next to the
+// module they cover (Rendering/QueueScheduleTests.cpp) and are only built into the Tests project
+namespace Test
+{
+	struct Case
+	{
+		const char* Name;
+		void (*Run)();
+	};
+
+	std::vector<Case>& GetCases();
+	// Failed checks of the running case
+	uint32_t& GetFailures();
+
+	struct Registrar
+	{
+		Registrar(const char* name, void (*run)()) { GetCases().push_back({ name, run }); }
+	};
+
+	inline void Fail(const char* file, int line, const std::string& message)
+	{
+		GetFailures()++;
+		std::cerr << file << "(" << line << "): " << message << "\n";
+	}
+
+	template<typename A, typename B>
+	std::string Describe(const char* expression, const A& a, const B& b)
+	{
+		std::ostringstream os;
+		os << expression << " (" << a << " vs " << b << ")";
+		return os.str();
+	}
+}
+
+#define TEST_CASE(name)\
+	static void name();\
+	static Test::Registrar name##Registrar(#name, name);\
+	static void name()
+
+#define CHECK(condition)\
+	do { if (!(condition)) Test::Fail(__FILE__, __LINE__, #condition); } while (false)
+
+#define CHECK_EQ(a, b)\
+	do { if (!((a) == (b))) Test::Fail(__FILE__, __LINE__, Test::Describe(#a " == " #b, (a), (b))); } while (false)
+
+#define CHECK_NEAR(a, b, tolerance)\
+	do { if (!(std::abs((a) - (b)) <= (tolerance))) Test::Fail(__FILE__, __LINE__, Test::Describe(#a " ~= " #b, (a), (b))); } while (false)
+
+// Stops the case - for checks the rest of it depends on
+#define REQUIRE(condition)\
+	do { if (!(condition)) { Test::Fail(__FILE__, __LINE__, #condition); throw std::runtime_error("requirement failed"); } } while (false)
+
+// The statement has to throw a std::exception
+#define CHECK_THROWS(...)\
+	do { bool thrown = false; try { __VA_ARGS__; } catch (const std::exception&) { thrown = true; } if (!thrown) Test::Fail(__FILE__, __LINE__, #__VA_ARGS__ " does not throw"); } while (false)
@@ -0,0 +1,49 @@
+#include "Test.h"
+
+#include <chrono>
+#include <cstring>
+
+std::vector<Test::Case>& Test::GetCases()
+{
+	static std::vector<Case> cases;
+	return cases;
+}
+
+uint32_t& Test::GetFailures()
+{
+	static uint32_t failures = 0;
+	return failures;
+}
+
+// Runs every case, or those whose name contains the first argument. Returns the number of failed cases
+int main(int argc, char** argv)
+{
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+	uint32_t run = 0;
+	uint32_t failed = 0;
+
+	for (const auto& testCase : Test::GetCases())
+	{
+		if (filter && !std::strstr(testCase.Name, filter)) continue;
+
+		Test::GetFailures() = 0;
+		auto start = std::chrono::steady_clock::now();
+		try
+		{
+			testCase.Run();
+		}
+		catch (const std::exception& e)
+		{
+			Test::Fail(testCase.Name, 0, std::string("exception: ") + e.what());
+		}
+		float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		run++;
+		bool passed = Test::GetFailures() == 0;
+		if (!passed) failed++;
+		std::cout << (passed ? "[ ok ] " : "[FAIL] ") << testCase.Name << " (" << ms << " ms)\n";
+	}
+
+	std::cout << run - failed << "/" << run << " passed\n";
+	return static_cast<int>(failed);
+}
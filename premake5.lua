@@ -1,7 +1,10 @@
 workspace "DeferredRenderer"
     architecture "x64"
     startproject "DeferredRenderer"
-    toolset "v143"
+
+    filter "action:vs*"
+        toolset "v143"
+    filter {}
 
     configurations
     {
@@ -66,8 +69,13 @@ project "DeferredRenderer"
         "%{prj.name}/src/**.hlsli"
     }
 
+    -- Built into the Tests project only
+    removefiles { "%{prj.name}/src/**Tests.cpp" }
+
     filter "files:**.hlsl"
         shadermodel "6.0"
+        -- core.hlsli uses HLSL 2021 select(), the runtime variant builds pass the same version
+        shaderoptions ("-HV 2021")
         buildmessage 'Compiling HLSL shader %{file.relpath}'
 
     filter { "files:**/VertexShaders/*.hlsl" }
@@ -111,4 +119,133 @@ project "DeferredRenderer"
         defines
         {
             "NDEBUG"
-        }
\ No newline at end of file
+        }
+
+-- Device-free tests and benchmarks of the renderer's CPU side. Test files sit next to the module they
+-- cover (Rendering/QueueScheduleTests.cpp), the renderer sources are built in so any module can be tested.
+-- Exits with the number of failed cases, an argument runs only the cases whose name contains it
+project "Tests"
+    location "Tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++latest"
+    staticruntime "off"
+    floatingpoint "fast"
+
+    targetdir ("bin/")
+    objdir ("bin-int/".. OutputDir)
+    debugdir ("bin/")
+
+    includedirs
+    {
+        "%{prj.name}",
+        "DeferredRenderer/src",
+        "%{wks.location}/ThirdParty/dxc",
+        "%{wks.location}/ThirdParty/glm",
+        "%{wks.location}/ThirdParty/core",
+        "%{wks.location}/ThirdParty/DirectXTex/include",
+        "%{wks.location}/ThirdParty/ImGui",
+        "%{wks.location}/ThirdParty/assimp/include"
+    }
+
+    libdirs
+    {
+        "%{wks.location}/dxcompiler"
+    }
+
+    links
+    {
+        "d3d12.lib",
+        "DXGI.lib",
+        "dxguid.lib",
+        "d3dcompiler.lib",
+        "DirectXTex.lib",
+        "DirectXTK12.lib",
+        "ImGui",
+        "assimp"
+    }
+
+    files
+    {
+        "%{prj.name}/**.h",
+        "%{prj.name}/**.cpp",
+        "DeferredRenderer/src/**.h",
+        "DeferredRenderer/src/**.cpp"
+    }
+
+    removefiles { "DeferredRenderer/src/main.cpp" }
+
+    filter "action:vs*"
+        buildoptions { "/permissive" }
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        symbols "on"
+        libdirs {"%{wks.location}/ThirdParty/DirectXTex/bin/debug",
+                 "%{wks.location}/ThirdParty/core/bin/debug"}
+        targetname ("%{prj.name}_d")
+
+    filter "configurations:Release"
+        runtime "Release"
+        symbols "on"
+        optimize "Full"
+        libdirs {"%{wks.location}/ThirdParty/DirectXTex/bin/release",
+                "%{wks.location}/ThirdParty/core/bin/release" }
+        targetname ("%{prj.name}")
+
+        defines
+        {
+            "NDEBUG"
+        }
+
+-- Tests of the modules that build without Windows, D3D12 and the rest of the renderer. The same cases
+-- run in Tests, this project builds them on any platform premake generates for (premake5 gmake2)
+project "PortableTests"
+    location "PortableTests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+    staticruntime "off"
+
+    targetdir ("bin/")
+    objdir ("bin-int/".. OutputDir)
+
+    includedirs
+    {
+        "Tests",
+        "DeferredRenderer/src"
+    }
+
+    files
+    {
+        "Tests/Test.h",
+        "Tests/main.cpp",
+        "DeferredRenderer/src/Core/Hash.h",
+        "DeferredRenderer/src/Core/Memory.h",
+        "DeferredRenderer/src/Rendering/PipelineCache.h",
+        "DeferredRenderer/src/Rendering/PipelineCache.cpp",
+        "DeferredRenderer/src/Rendering/PipelineCacheTests.cpp",
+        "DeferredRenderer/src/Rendering/ShaderCache.h",
+        "DeferredRenderer/src/Rendering/ShaderCache.cpp",
+        "DeferredRenderer/src/Rendering/ShaderCacheTests.cpp"
+    }
+
+    -- The shader cache watches its directory from a thread
+    filter "system:linux"
+        links { "pthread" }
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        symbols "on"
+        targetname ("%{prj.name}_d")
+
+    filter "configurations:Release"
+        runtime "Release"
+        symbols "on"
+        optimize "Full"
+        targetname ("%{prj.name}")
+
+        defines
+        {
+            "NDEBUG"
+        }